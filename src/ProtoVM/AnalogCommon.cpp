@@ -7,7 +7,7 @@ AnalogNodeBase::AnalogNodeBase() {
 
 bool AnalogNodeBase::Tick() {
     // Update simulation time
-    simulation_time += SIMULATION_TIMESTEP;
+    simulation_time += time_step;
     
     // Process analog behavior
     UpdateState();
@@ -19,6 +19,37 @@ bool AnalogNodeBase::Tick() {
     return true;
 }
 
+bool AnalogNodeBase::Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) {
+    if (type == WRITE) {
+        byte level = GetDigitalLevel(conn_id) ? 1 : 0;
+        return dest.PutRaw(dest_conn_id, &level, 0, 1);
+    }
+    return true;
+}
+
+bool AnalogNodeBase::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) {
+    // A digital output driving the pin; AnalogSimulation holds the net at this voltage
+    if (data_bytes == 0 && data_bits == 1) {
+        SetAnalogValue(conn_id, (*data & 1) ? LOGIC_HIGH_VOLTAGE : LOGIC_LOW_VOLTAGE);
+        return true;
+    }
+    LOG("error: AnalogNodeBase::PutRaw: unsupported " << data_bytes << " byte " << data_bits << " bit write in " << GetClassName());
+    return false;
+}
+
+void AnalogNodeBase::SetDigitalLevel(int pin_id, bool high) {
+    if (pin_id >= 0) {
+        if (pin_id >= (int)digital_levels.size()) {
+            digital_levels.resize(pin_id + 1, 0);
+        }
+        digital_levels[pin_id] = high;
+    }
+}
+
+bool AnalogNodeBase::GetDigitalLevel(int pin_id) const {
+    return pin_id >= 0 && pin_id < (int)digital_levels.size() && digital_levels[pin_id];
+}
+
 bool AnalogNodeBase::ProcessAnalog(double input_voltage, int pin_id) {
     if (pin_id >= 0 && pin_id < analog_values.size()) {
         analog_values[pin_id] = input_voltage;
@@ -61,6 +92,42 @@ double AnalogNodeBase::RCResponse(double initial_voltage, double target_voltage,
            exp(-time_elapsed / time_constant);
 }
 
+AnalogNodeBase::Integration AnalogNodeBase::Integration::BackwardEuler(double h) {
+    Integration in;
+    in.a0 = 1.0 / h;
+    in.a1 = -1.0 / h;
+    return in;
+}
+
+AnalogNodeBase::Integration AnalogNodeBase::Integration::Trapezoidal(double h) {
+    // x'(n+1) + x'(n) = 2 * (x(n+1) - x(n)) / h
+    Integration in;
+    in.a0 = 2.0 / h;
+    in.a1 = -2.0 / h;
+    in.b1 = -1.0;
+    return in;
+}
+
+AnalogNodeBase::Integration AnalogNodeBase::Integration::Gear2(double h, double previous_h) {
+    // Second order backward differentiation formula for unequal steps
+    Integration in;
+    in.a0 = (2.0 * h + previous_h) / (h * (h + previous_h));
+    in.a1 = -(h + previous_h) / (h * previous_h);
+    in.a2 = h / (previous_h * (h + previous_h));
+    return in;
+}
+
+double AnalogNodeBase::JunctionExp(double x) {
+    if (x > JUNCTION_EXP_LIMIT) {
+        return exp(JUNCTION_EXP_LIMIT) * (1.0 + x - JUNCTION_EXP_LIMIT);
+    }
+    return exp(x);
+}
+
+double AnalogNodeBase::JunctionExpSlope(double x) {
+    return exp(x > JUNCTION_EXP_LIMIT ? JUNCTION_EXP_LIMIT : x);
+}
+
 void AnalogNodeBase::UpdateState() {
     // Default implementation - to be overridden by subclasses
 }
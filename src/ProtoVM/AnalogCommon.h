@@ -19,6 +19,17 @@ public:
     // Override Tick to handle analog behavior
     virtual bool Tick() override;
     
+    // A/D boundary with digital components linked to the pins. A one bit write drives
+    // the pin to a logic voltage; the pin writes back the level AnalogSimulation last
+    // set on a threshold crossing of its voltage.
+    virtual bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
+    virtual bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
+    void SetDigitalLevel(int pin_id, bool high);
+    bool GetDigitalLevel(int pin_id) const;
+    
+    static constexpr double LOGIC_LOW_VOLTAGE = 0.0;
+    static constexpr double LOGIC_HIGH_VOLTAGE = 5.0;
+    
     // Process analog signal
     virtual bool ProcessAnalog(double input_voltage, int pin_id);
     
@@ -37,6 +48,42 @@ public:
     // Calculate voltage across a capacitor at time t
     static double RCResponse(double initial_voltage, double target_voltage, 
                             double time_constant, double time_elapsed);
+    
+    // Modified nodal analysis. Devices returning true from IsStamped are solved by
+    // AnalogSimulation instead of setting their own pin voltages: GetPinCurrents gives
+    // the current flowing into the device at each pin for the pin voltages v, and the
+    // solver linearizes it around every Newton iterate. Tick runs once the step has
+    // converged, with the solved voltages in analog_values, and only updates state.
+    virtual bool IsStamped() const { return false; }
+    virtual void GetPinCurrents(const double* v, double* i) const {}
+    // Optional analytic linearization: fills i like GetPinCurrents and g, pins * pins
+    // row-major, with the derivative of the current into pin p by the voltage at pin
+    // q, and returns true. Devices returning false are linearized by perturbing their
+    // pins one at a time instead.
+    virtual bool GetPinConductances(const double* v, double* i, double* g) const { return false; }
+    // Stamped devices whose pin currents are affine in the pin voltages. A circuit
+    // made of them alone needs a single Newton iteration.
+    virtual bool IsLinear() const { return false; }
+    // Reactive devices report the quantity they integrate over time (a capacitor's
+    // voltage, an inductor's current) at the pin voltages v, with the absolute
+    // tolerance that applies to it, for the solver's step size control
+    virtual bool GetIntegratedState(const double* v, double& x, double& abs_tol) const { return false; }
+    
+    // Discretization of d/dt over the step being solved:
+    // x'(n+1) ~ a0 * x(n+1) + a1 * x(n) + a2 * x(n-1) + b1 * x'(n)
+    struct Integration {
+        double a0 = 0.0, a1 = 0.0, a2 = 0.0, b1 = 0.0;
+        
+        static Integration BackwardEuler(double h);
+        static Integration Trapezoidal(double h);
+        static Integration Gear2(double h, double previous_h);
+    };
+    
+    // Step the analog solver advances by, SIMULATION_TIMESTEP with backward Euler
+    // unless it set another
+    void SetTimeStep(double dt) { SetIntegration(dt, Integration::BackwardEuler(dt)); }
+    void SetIntegration(double dt, const Integration& in) { time_step = dt; integration = in; }
+    double GetTimeStep() const { return time_step; }
 
 protected:
     // Simulation time step (in seconds)
@@ -44,6 +91,17 @@ protected:
 
     // Time in seconds since start of simulation
     double simulation_time = 0.0;
+    double time_step = SIMULATION_TIMESTEP;
+    Integration integration = Integration::BackwardEuler(SIMULATION_TIMESTEP);
+    
+    // exp(x) continued linearly above JUNCTION_EXP_LIMIT, so that junction currents
+    // stay finite while Newton iterates are far from the solution
+    static double JunctionExp(double x);
+    static double JunctionExpSlope(double x);  // derivative of JunctionExp
+    static constexpr double JUNCTION_EXP_LIMIT = 40.0;
+    
+    // Level each pin reads as on the digital side
+    std::vector<char> digital_levels;
     
     // Function to update internal state based on analog inputs
     virtual void UpdateState();
@@ -1,5 +1,16 @@
 #include "AnalogComponents.h"
 
+// Pin currents and conductances of a two-terminal element whose current flows into
+// the first terminal and out of the second
+static void StampTwoTerminal(double current, double conductance, double* i, double* g) {
+    i[0] = current;
+    i[1] = -current;
+    g[0] = conductance;
+    g[1] = -conductance;
+    g[2] = -conductance;
+    g[3] = conductance;
+}
+
 // AnalogResistor Implementation
 AnalogResistor::AnalogResistor(double resistance) : resistance(resistance < MIN_RESISTANCE ? MIN_RESISTANCE : resistance) {
     // A resistor has two terminals
@@ -9,23 +20,23 @@ AnalogResistor::AnalogResistor(double resistance) : resistance(resistance < MIN_
 }
 
 bool AnalogResistor::Tick() {
-    // Apply Ohm's law: V = I * R, or I = V / R
-    // For simulation, we'll determine current based on voltage difference
-    
-    double voltage_a = GetAnalogValue(0);  // Voltage at terminal A
-    double voltage_b = GetAnalogValue(1);  // Voltage at terminal B
-    double voltage_diff = voltage_a - voltage_b;
-    
-    // Current flows from higher potential to lower potential
-    double current = voltage_diff / resistance;
-    
-    // In a real simulation, we'd interface this with connected components
-    // For now, we'll just update the internal representation
-    
+    // The pin voltages come from AnalogSimulation, which applies Ohm's law through
+    // GetPinCurrents; there is no further state to update here
     AnalogNodeBase::Tick();  // Call parent tick
     return true;
 }
 
+void AnalogResistor::GetPinCurrents(const double* v, double* i) const {
+    double g[4];
+    GetPinConductances(v, i, g);
+}
+
+bool AnalogResistor::GetPinConductances(const double* v, double* i, double* g) const {
+    // Ohm's law: I = V / R, flowing from terminal A to terminal B
+    StampTwoTerminal((v[0] - v[1]) / resistance, 1.0 / resistance, i, g);
+    return true;
+}
+
 void AnalogResistor::SetResistance(double r) {
     resistance = r < MIN_RESISTANCE ? MIN_RESISTANCE : r;
 }
@@ -34,6 +45,8 @@ void AnalogResistor::SetResistance(double r) {
 AnalogCapacitor::AnalogCapacitor(double capacitance) 
     : capacitance(capacitance < MIN_CAPACITANCE ? MIN_CAPACITANCE : capacitance),
       voltage_across_capacitor(0.0),
+      previous_voltage(0.0),
+      capacitor_current(0.0),
       charge(0.0) {
     // A capacitor has two terminals
     AddBidirectional("POS");
@@ -42,32 +55,40 @@ AnalogCapacitor::AnalogCapacitor(double capacitance)
 }
 
 bool AnalogCapacitor::Tick() {
-    // Calculate voltage difference across the capacitor
-    double voltage_pos = GetAnalogValue(0);  // Positive terminal
-    double voltage_neg = GetAnalogValue(1);  // Negative terminal
-    double voltage_diff = voltage_pos - voltage_neg;
-    
-    // Update internal voltage based on the applied voltage
-    // In a real circuit simulation, we would consider the current flowing in/out
-    // For now, we'll make a simple approximation
-    
-    // Simple model: capacitor charges/discharges towards applied voltage
-    // with a time constant related to the external circuit
-    double time_constant = 0.001; // 1ms for demo purposes, in real use this should come from circuit
-    double time_step = SIMULATION_TIMESTEP;
-    
-    // Exponential approximation for charging/discharging
-    voltage_across_capacitor = RCResponse(voltage_across_capacitor, voltage_diff, time_constant, time_step);
-    
-    // Update terminal voltages based on internal voltage
-    // For a simple model, we'll just make the output reflect the internal voltage
-    UpdateAnalogValue(0, voltage_across_capacitor + voltage_neg);
-    UpdateAnalogValue(1, voltage_neg);  // Keep negative terminal stable for this simple model
+    // The step has converged: the solved voltage and the current it took become the
+    // history of the next step
+    double v[2] = {GetAnalogValue(0), GetAnalogValue(1)};
+    double i[2];
+    GetPinCurrents(v, i);
+    previous_voltage = voltage_across_capacitor;
+    voltage_across_capacitor = v[0] - v[1];
+    capacitor_current = i[0];
+    charge = capacitance * voltage_across_capacitor;
     
     AnalogNodeBase::Tick();  // Call parent tick
     return true;
 }
 
+void AnalogCapacitor::GetPinCurrents(const double* v, double* i) const {
+    double g[4];
+    GetPinConductances(v, i, g);
+}
+
+bool AnalogCapacitor::GetPinConductances(const double* v, double* i, double* g) const {
+    // I = C * dV/dt, with dV/dt discretized by the solver's integration method
+    double current = capacitance * (integration.a0 * (v[0] - v[1])
+        + integration.a1 * voltage_across_capacitor + integration.a2 * previous_voltage)
+        + integration.b1 * capacitor_current;
+    StampTwoTerminal(current, capacitance * integration.a0, i, g);
+    return true;
+}
+
+bool AnalogCapacitor::GetIntegratedState(const double* v, double& x, double& abs_tol) const {
+    x = v[0] - v[1];
+    abs_tol = VOLTAGE_TOLERANCE;
+    return true;
+}
+
 void AnalogCapacitor::SetCapacitance(double c) {
     capacitance = c < MIN_CAPACITANCE ? MIN_CAPACITANCE : c;
 }
@@ -75,7 +96,9 @@ void AnalogCapacitor::SetCapacitance(double c) {
 // AnalogInductor Implementation
 AnalogInductor::AnalogInductor(double inductance) 
     : inductance(inductance < MIN_INDUCTANCE ? MIN_INDUCTANCE : inductance),
-      current_through_inductor(0.0) {
+      current_through_inductor(0.0),
+      previous_current(0.0),
+      inductor_voltage(0.0) {
     // An inductor has two terminals
     AddBidirectional("A");
     AddBidirectional("B");
@@ -83,33 +106,46 @@ AnalogInductor::AnalogInductor(double inductance)
 }
 
 bool AnalogInductor::Tick() {
-    // Calculate voltage difference across the inductor
-    double voltage_a = GetAnalogValue(0);  // Terminal A
-    double voltage_b = GetAnalogValue(1);  // Terminal B
-    double voltage_diff = voltage_a - voltage_b;
-    
-    // In a real simulation, we'd apply the inductor equation: V = L * di/dt
-    // For our discrete simulation: di = (V / L) * dt
-    double dt = SIMULATION_TIMESTEP;
-    double di = (voltage_diff / inductance) * dt;
-    
-    // Update current through the inductor
-    current_through_inductor += di;
+    // Take the current of the converged step, the same way GetPinCurrents did
+    double v[2] = {GetAnalogValue(0), GetAnalogValue(1)};
+    double i[2];
+    GetPinCurrents(v, i);
+    previous_current = current_through_inductor;
+    current_through_inductor = i[0];
+    inductor_voltage = v[0] - v[1];
     
     // Limit current to reasonable bounds
     if (current_through_inductor > 100.0) current_through_inductor = 100.0;   // 100A max
     if (current_through_inductor < -100.0) current_through_inductor = -100.0; // -100A min
     
-    // The voltage across the inductor affects the connected nodes
-    // For now, we'll simply pass through the voltage with some inductive effect
-    double back_emf = -inductance * (di / dt);  // Back EMF effect
-    UpdateAnalogValue(0, voltage_a + back_emf);
-    UpdateAnalogValue(1, voltage_b);
-    
     AnalogNodeBase::Tick();  // Call parent tick
     return true;
 }
 
+void AnalogInductor::GetPinCurrents(const double* v, double* i) const {
+    double g[4];
+    GetPinConductances(v, i, g);
+}
+
+bool AnalogInductor::GetPinConductances(const double* v, double* i, double* g) const {
+    // V = L * dI/dt with dI/dt discretized by the solver's integration method,
+    // solved for I
+    double resistance = inductance * integration.a0;
+    double current = ((v[0] - v[1]) - integration.b1 * inductor_voltage
+        - inductance * (integration.a1 * current_through_inductor + integration.a2 * previous_current))
+        / resistance;
+    StampTwoTerminal(current, 1.0 / resistance, i, g);
+    return true;
+}
+
+bool AnalogInductor::GetIntegratedState(const double* v, double& x, double& abs_tol) const {
+    double i[2];
+    GetPinCurrents(v, i);
+    x = i[0];
+    abs_tol = CURRENT_TOLERANCE;
+    return true;
+}
+
 void AnalogInductor::SetInductance(double l) {
     inductance = l < MIN_INDUCTANCE ? MIN_INDUCTANCE : l;
 }
\ No newline at end of file
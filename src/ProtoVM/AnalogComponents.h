@@ -37,6 +37,10 @@ public:
     
     virtual bool Tick() override;
     virtual String GetClassName() const override { return "AnalogResistor"; }
+    virtual bool IsStamped() const override { return true; }
+    virtual bool IsLinear() const override { return true; }
+    virtual void GetPinCurrents(const double* v, double* i) const override;
+    virtual bool GetPinConductances(const double* v, double* i, double* g) const override;
     
     void SetResistance(double r);
     double GetResistance() const { return resistance; }
@@ -56,6 +60,11 @@ public:
     
     virtual bool Tick() override;
     virtual String GetClassName() const override { return "AnalogCapacitor"; }
+    virtual bool IsStamped() const override { return true; }
+    virtual bool IsLinear() const override { return true; }
+    virtual void GetPinCurrents(const double* v, double* i) const override;
+    virtual bool GetPinConductances(const double* v, double* i, double* g) const override;
+    virtual bool GetIntegratedState(const double* v, double& x, double& abs_tol) const override;
     
     void SetCapacitance(double c);
     double GetCapacitance() const { return capacitance; }
@@ -63,10 +72,13 @@ public:
 private:
     double capacitance;
     double voltage_across_capacitor;  // Voltage stored in capacitor
+    double previous_voltage;  // Voltage one step before
+    double capacitor_current;  // Current at the last step, for the trapezoidal rule
     double charge;  // Charge stored in capacitor
     
     static constexpr double MIN_CAPACITANCE = 1e-12;  // 1pF minimum
     static constexpr double IDEAL_VOLTAGE_TOLERANCE = 1e-9;  // For numerical stability
+    static constexpr double VOLTAGE_TOLERANCE = 1e-5;  // Truncation error allowed per step
 };
 
 // Analog Inductor component
@@ -79,6 +91,11 @@ public:
     
     virtual bool Tick() override;
     virtual String GetClassName() const override { return "AnalogInductor"; }
+    virtual bool IsStamped() const override { return true; }
+    virtual bool IsLinear() const override { return true; }
+    virtual void GetPinCurrents(const double* v, double* i) const override;
+    virtual bool GetPinConductances(const double* v, double* i, double* g) const override;
+    virtual bool GetIntegratedState(const double* v, double& x, double& abs_tol) const override;
     
     void SetInductance(double l);
     double GetInductance() const { return inductance; }
@@ -86,8 +103,11 @@ public:
 private:
     double inductance;
     double current_through_inductor;  // Current flowing through inductor
+    double previous_current;  // Current one step before
+    double inductor_voltage;  // Voltage at the last step, for the trapezoidal rule
     
     static constexpr double MIN_INDUCTANCE = 1e-12;  // 1pH minimum
+    static constexpr double CURRENT_TOLERANCE = 1e-7;  // Truncation error allowed per step
 };
 
 #endif
\ No newline at end of file
@@ -12,32 +12,30 @@ AnalogDiode::AnalogDiode(double saturation_current, double emission_coefficient)
 }
 
 bool AnalogDiode::Tick() {
-    double anode_voltage = GetAnalogValue(0);
-    double cathode_voltage = GetAnalogValue(1);
-    double voltage_across_diode = anode_voltage - cathode_voltage;
-    
+    // The pin voltages come from AnalogSimulation, which solves the Shockley
+    // equation through GetPinCurrents
+    AnalogNodeBase::Tick();  // Call parent tick
+    return true;
+}
+
+void AnalogDiode::GetPinCurrents(const double* v, double* i) const {
+    double g[4];
+    GetPinConductances(v, i, g);
+}
+
+bool AnalogDiode::GetPinConductances(const double* v, double* i, double* g) const {
     // Use Shockley diode equation: I = IS * (e^(Vd/n*VT) - 1)
-    double exponent = voltage_across_diode / (emission_coefficient * VT);
-    
-    // Limit the exponent to prevent overflow issues
-    exponent = std::max(-300.0, std::min(300.0, exponent));
-    
-    double diode_current = saturation_current * (exp(exponent) - 1.0);
-    
-    // For simulation purposes, we'll update the voltages based on the current
-    // In a real simulation, this would be connected to a circuit solver
-    if (voltage_across_diode > 0.7) {  // Forward bias, silicon diode
-        // Diode is conducting, drop voltage accordingly
-        UpdateAnalogValue(0, std::max(anode_voltage, cathode_voltage + 0.7));
-        UpdateAnalogValue(1, std::min(cathode_voltage, anode_voltage - 0.7));
-    } else {
-        // Diode is not conducting, just pass voltages through
-        // but with some leakage
-        UpdateAnalogValue(0, anode_voltage);
-        UpdateAnalogValue(1, cathode_voltage);
-    }
+    double nvt = emission_coefficient * VT;
+    double exponent = (v[0] - v[1]) / nvt;
+    double diode_current = saturation_current * (JunctionExp(exponent) - 1.0);
+    double conductance = saturation_current * JunctionExpSlope(exponent) / nvt;
     
-    AnalogNodeBase::Tick();  // Call parent tick
+    i[0] = diode_current;
+    i[1] = -diode_current;
+    g[0] = conductance;
+    g[1] = -conductance;
+    g[2] = -conductance;
+    g[3] = conductance;
     return true;
 }
 
@@ -62,67 +60,49 @@ AnalogNPNTransistor::AnalogNPNTransistor(double beta) : beta(beta),
 }
 
 bool AnalogNPNTransistor::Tick() {
-    double collector_voltage = GetAnalogValue(0);
-    double base_voltage = GetAnalogValue(1);
-    double emitter_voltage = GetAnalogValue(2);
+    // Record the terminal currents at the voltages AnalogSimulation solved for
+    double v[3] = {GetAnalogValue(0), GetAnalogValue(1), GetAnalogValue(2)};
+    double i[3];
+    GetPinCurrents(v, i);
+    collector_current = i[0];
+    base_current = i[1];
+    emitter_current = -i[2];
+    
+    AnalogNodeBase::Tick();  // Call parent tick
+    return true;
+}
+
+void AnalogNPNTransistor::GetPinCurrents(const double* v, double* i) const {
+    double g[9];
+    GetPinConductances(v, i, g);
+}
+
+bool AnalogNPNTransistor::GetPinConductances(const double* v, double* i, double* g) const {
+    // Ebers-Moll transport model. Pins are collector, base and emitter.
+    double vbe = v[1] - v[2];
+    double vbc = v[1] - v[0];
+    double forward = IS * (JunctionExp(vbe / VT) - 1.0);
+    double reverse = IS * (JunctionExp(vbc / VT) - 1.0);
+    double gf = IS * JunctionExpSlope(vbe / VT) / VT;  // d forward / d vbe
+    double gr = IS * JunctionExpSlope(vbc / VT) / VT;  // d reverse / d vbc
     
-    // Calculate base-emitter and base-collector voltages
-    double vbe = base_voltage - emitter_voltage;
-    double vbc = base_voltage - collector_voltage;
+    double ic = forward - reverse - reverse / BETA_R;
+    double ib = forward / beta + reverse / BETA_R;
+    i[0] = ic;
+    i[1] = ib;
+    i[2] = -(ic + ib);
     
-    // Determine operating region
-    if (vbe > 0.7 && vbc < 0.4) {
-        // Forward active region - transistor is on
-        // Ebers-Moll model approximation
-        
-        // Base current from base-emitter voltage (simplified)
-        if (vbe > 0.7) {
-            // Base-emitter junction is forward biased
-            double ib_temp = (vbe - 0.7) / 0.026;  // Simplified
-            base_current = std::max(0.0, ib_temp);
-        } else {
-            base_current = 0.0;
-        }
-        
-        // Collector current based on beta
-        collector_current = beta * base_current;
-        emitter_current = collector_current + base_current;
-        
-        // Update voltages based on current and external circuit
-        // This is a simplified model - in a real simulator, 
-        // this would interact with the circuit equations
-        if (collector_current > 0) {
-            // Transistor conducting
-            UpdateAnalogValue(0, collector_voltage);  // Collector
-            UpdateAnalogValue(1, base_voltage);       // Base
-            UpdateAnalogValue(2, emitter_voltage);    // Emitter
-        } else {
-            // Transistor off
-            UpdateAnalogValue(0, collector_voltage);
-            UpdateAnalogValue(1, base_voltage);
-            UpdateAnalogValue(2, emitter_voltage);
-        }
-    } else if (vbe <= 0.7 && vbc <= 0.7) {
-        // Cut-off region - transistor is off
-        collector_current = MIN_CURRENT;
-        base_current = MIN_CURRENT;
-        emitter_current = MIN_CURRENT;
-        
-        UpdateAnalogValue(0, collector_voltage);
-        UpdateAnalogValue(1, base_voltage);
-        UpdateAnalogValue(2, emitter_voltage);
-    } else {
-        // Saturation or reverse active region
-        // Simplified treatment
-        collector_current = beta * base_current;
-        emitter_current = collector_current + base_current;
-        
-        UpdateAnalogValue(0, collector_voltage);
-        UpdateAnalogValue(1, base_voltage);
-        UpdateAnalogValue(2, emitter_voltage);
+    // Rows are the pin currents, columns the collector, base and emitter voltages
+    double grc = gr * (1.0 + 1.0 / BETA_R);
+    g[0] = grc;
+    g[1] = gf - grc;
+    g[2] = -gf;
+    g[3] = -gr / BETA_R;
+    g[4] = gf / beta + gr / BETA_R;
+    g[5] = -gf / beta;
+    for (int q = 0; q < 3; q++) {
+        g[6 + q] = -(g[q] + g[3 + q]);
     }
-    
-    AnalogNodeBase::Tick();  // Call parent tick
     return true;
 }
 
@@ -13,6 +13,9 @@ public:
     
     virtual bool Tick() override;
     virtual String GetClassName() const override { return "AnalogDiode"; }
+    virtual bool IsStamped() const override { return true; }
+    virtual void GetPinCurrents(const double* v, double* i) const override;
+    virtual bool GetPinConductances(const double* v, double* i, double* g) const override;
     
     void SetSaturationCurrent(double is);
     void SetEmissionCoefficient(double n);
@@ -42,9 +45,15 @@ public:
     
     virtual bool Tick() override;
     virtual String GetClassName() const override { return "AnalogNPNTransistor"; }
+    virtual bool IsStamped() const override { return true; }
+    virtual void GetPinCurrents(const double* v, double* i) const override;
+    virtual bool GetPinConductances(const double* v, double* i, double* g) const override;
     
     void SetBeta(double b);
     double GetBeta() const { return beta; }
+    double GetCollectorCurrent() const { return collector_current; }
+    double GetBaseCurrent() const { return base_current; }
+    double GetEmitterCurrent() const { return emitter_current; }
     
 private:
     double beta;  // Current gain (IC / IB)
@@ -61,6 +70,8 @@ private:
     static constexpr double VT = (K * T) / Q;    // Thermal voltage (~25.85mV at 300K)
     
     static constexpr double MIN_CURRENT = 1e-15; // Minimum detectable current (1fA)
+    static constexpr double IS = 1e-14;          // Transport saturation current (Ebers-Moll)
+    static constexpr double BETA_R = 1.0;        // Reverse current gain
 };
 
 #endif
\ No newline at end of file
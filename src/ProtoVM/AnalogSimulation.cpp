@@ -2,8 +2,11 @@
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
 
-AnalogSimulation::AnalogSimulation() 
+AnalogSimulation::AnalogSimulation()
     : time_step(1.0/44100.0),  // Match audio sample rate
       max_iterations(50),
       tolerance(1e-6) {
@@ -11,244 +14,766 @@ AnalogSimulation::AnalogSimulation()
 
 void AnalogSimulation::RegisterAnalogComponent(AnalogNodeBase* component) {
     analog_components.push_back(component);
+    topology_dirty = true;
+}
+
+// Value at `at` of the polynomial through (t[k], x[k]), k < count
+static double Extrapolate(const double* t, const double* x, int count, double at) {
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) {
+        double weight = 1.0;
+        for (int j = 0; j < count; j++) {
+            if (j != i) {
+                weight *= (at - t[j]) / (t[i] - t[j]);
+            }
+        }
+        sum += weight * x[i];
+    }
+    return sum;
 }
 
 bool AnalogSimulation::Tick() {
-    // Initialize node voltages based on component states
+    if (topology_dirty && !BuildSystemEquations()) {
+        return false;
+    }
+    crossings.clear();
+
+    // Components outside the solver go first, as they drive the fixed nets. They
+    // advance by the output period.
+    for (auto* component : unstamped) {
+        component->SetTimeStep(time_step);
+        if (!component->Tick()) {
+            return false;
+        }
+    }
+
+    tick_time += time_step;
     InitializeNodeVoltages();
-    
-    // Build the system of equations for the circuit
-    BuildSystemEquations();
-    
-    // Solve the system using Newton-Raphson method
-    if (!NewtonRaphsonIteration()) {
+    bool fixed_changed = false;
+    for (size_t k = 0; k < fixed_nets.size(); k++) {
+        if (fixed_nets[k].voltage != solved_fixed[k]) {
+            fixed_changed = true;
+        }
+    }
+
+    // When the next step reaches past the following tick and nothing drives the
+    // circuit differently, it is solved ahead, ending on the last tick it covers.
+    // The ticks up to there get voltages interpolated between the two solutions, and
+    // the step is accepted on its last tick.
+    double epsilon = time_step * 1e-6;
+    if (fixed_changed) {
+        pending.valid = false;
+    }
+    else if (adaptive && history.size() > 1) {
+        if (!pending.valid && solved_time + next_step > tick_time + time_step - epsilon && !SolveAhead()) {
+            return false;
+        }
+        // A boundary about to cross the threshold ends the step on this tick instead
+        if (pending.valid && PredictsCrossing(tick_time)) {
+            pending.valid = false;
+        }
+        if (pending.valid && pending.end - tick_time > epsilon) {
+            if (resample_outputs) {
+                InterpolateNodeVoltages(tick_time, node_voltages);
+                UpdateComponentValues();
+            }
+            CheckBoundaries(tick_time, false);
+            return true;
+        }
+        if (pending.valid) {
+            pending.valid = false;
+            node_voltages = pending.voltages;
+            IntegrationMethod used;
+            SetupIntegration(pending.end - solved_time, used);
+            if (!AcceptStep(pending.end, pending.error, pending.order, pending.cut)) {
+                return false;
+            }
+            CheckBoundaries(tick_time, false);
+            return true;
+        }
+    }
+
+    // A change of the fixed nets takes effect on this tick: the ticks a deferred step
+    // covered until now are solved with the voltages they had
+    double previous_tick = tick_time - time_step;
+    if (fixed_changed && previous_tick - solved_time > epsilon) {
+        std::vector<double> changed(fixed_nets.size());
+        for (size_t k = 0; k < fixed_nets.size(); k++) {
+            changed[k] = fixed_nets[k].voltage;
+            fixed_nets[k].voltage = solved_fixed[k];
+        }
+        if (!AdvanceTo(previous_tick)) {
+            return false;
+        }
+        for (size_t k = 0; k < fixed_nets.size(); k++) {
+            fixed_nets[k].voltage = changed[k];
+        }
+    }
+
+    if (!AdvanceTo(tick_time)) {
+        return false;
+    }
+
+    CheckBoundaries(tick_time, false);
+    return true;
+}
+
+bool AnalogSimulation::AdvanceTo(double t) {
+    double epsilon = time_step * 1e-6;
+    while (t - solved_time > epsilon) {
+        double end = adaptive ? std::min(t, solved_time + next_step) : t;
+        // Don't leave a sliver for a step of its own
+        if (t - end < min_step) {
+            end = t;
+        }
+        if (!TakeStep(end)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AnalogSimulation::TakeStep(double end) {
+    // A step cut short to end on a tick says little about the step the error allows
+    bool cut = end - solved_time < next_step;
+    double error;
+    int order;
+    if (!SolveStep(end, error, order, cut)) {
         std::cerr << "Failed to converge in analog simulation" << std::endl;
         return false;
     }
-    
-    // Update all component values with the solutions
+    return AcceptStep(end, error, order, cut);
+}
+
+bool AnalogSimulation::SolveStep(double& end, double& error, int& order, bool& cut) {
+    for (;;) {
+        double h = end - solved_time;
+        IntegrationMethod used;
+        order = SetupIntegration(h, used);
+
+        // Newton starts from the extrapolated solution
+        PredictNodeVoltages(end, node_voltages);
+        bool converged = NewtonRaphsonIteration();
+        error = converged && adaptive ? EstimateTruncationError(end, order, used) : 0.0;
+
+        if (adaptive && (!converged || error > 1.0) && h > min_step) {
+            // Retry shorter, by the error estimate or by a fixed factor when Newton failed
+            double factor = converged
+                ? std::max(MIN_STEP_SHRINK, STEP_SAFETY * std::pow(error, -1.0 / (order + 1)))
+                : 0.125;
+            end = solved_time + std::max(min_step, h * factor);
+            cut = false;
+            rejected_steps++;
+            continue;
+        }
+        return converged;
+    }
+}
+
+bool AnalogSimulation::AcceptStep(double end, double error, int order, bool cut) {
+    // The solution joins the history, then the stamped components take the step
+    double h = end - solved_time;
     UpdateComponentValues();
-    
-    // Call the Tick method for each analog component
-    for (auto* component : analog_components) {
-        if (!component->Tick()) {
+    PushHistory(end);
+    CheckBoundaries(end, true);
+    for (Device& device : devices) {
+        if (!device.node->Tick()) {
             return false;
         }
     }
-    
+    for (size_t k = 0; k < fixed_nets.size(); k++) {
+        solved_fixed[k] = fixed_nets[k].voltage;
+    }
+    solved_time = end;
+    previous_step = h;
+    accepted_steps++;
+
+    if (adaptive) {
+        double growth = error > 0.0 ? STEP_SAFETY * std::pow(error, -1.0 / (order + 1)) : MAX_STEP_GROWTH;
+        double wanted = std::min(MAX_STEP_GROWTH * (cut ? next_step : h), h * growth);
+        next_step = std::min(max_step, std::max(min_step, wanted));
+    }
     return true;
 }
 
-void AnalogSimulation::InitializeNodeVoltages() {
-    // We need to determine how many unique nodes we have in the system
-    // This is a simplified approach and would need to be more sophisticated
-    // in a real implementation to properly identify connected nodes
-    
-    int total_pins = 0;
-    for (auto* component : analog_components) {
-        total_pins += component->GetConnectorCount();
+bool AnalogSimulation::SolveAhead() {
+    // The last tick the step covers
+    double epsilon = time_step * 1e-6;
+    double ticks = std::floor((solved_time + next_step - tick_time) / time_step + 1e-6);
+    double end = tick_time + ticks * time_step;
+    bool cut = end - solved_time < next_step - epsilon;
+    double error;
+    int order;
+    double solved_end = end;
+    if (!SolveStep(solved_end, error, order, cut)) {
+        std::cerr << "Failed to converge in analog simulation" << std::endl;
+        return false;
+    }
+
+    // A step the error cut short no longer ends on a tick; the ticks take steps of
+    // the size it allows instead
+    if (end - solved_end > epsilon) {
+        next_step = std::max(min_step, solved_end - solved_time);
+        return true;
+    }
+    pending.valid = true;
+    pending.end = end;
+    pending.error = error;
+    pending.order = order;
+    pending.cut = cut;
+    pending.voltages = node_voltages;
+    return true;
+}
+
+int AnalogSimulation::SetupIntegration(double h, IntegrationMethod& used) {
+    // The first step of a history has no earlier one to be second order with
+    used = history.size() < 2 ? BACKWARD_EULER : method;
+
+    AnalogNodeBase::Integration in;
+    switch (used) {
+    case TRAPEZOIDAL:
+        in = AnalogNodeBase::Integration::Trapezoidal(h);
+        break;
+    case GEAR2:
+        in = AnalogNodeBase::Integration::Gear2(h, previous_step);
+        break;
+    default:
+        in = AnalogNodeBase::Integration::BackwardEuler(h);
+        break;
+    }
+
+    for (Device& device : devices) {
+        device.node->SetIntegration(h, in);
+    }
+    return used == BACKWARD_EULER ? 1 : 2;
+}
+
+double AnalogSimulation::EstimateTruncationError(double end, int order, IntegrationMethod used) {
+    // Milne's estimate: a predictor through order + 1 accepted points errs by a
+    // multiple of the same derivative as the integration method, so the difference
+    // between the two scales to the method's own error. The factors are for equal
+    // steps.
+    int points = order + 1;
+    if ((int)history.size() < points) {
+        return 0.0;
+    }
+    double scale = used == BACKWARD_EULER ? 1.0 / 3.0 : used == TRAPEZOIDAL ? 1.0 / 11.0 : 2.0 / 7.0;
+
+    double times[HISTORY_POINTS];
+    double states[HISTORY_POINTS];
+    for (int k = 0; k < points; k++) {
+        times[k] = history[k].time;
+    }
+
+    double error = 0.0;
+    for (size_t d = 0; d < devices.size(); d++) {
+        double x, abs_tol;
+        if (!devices[d].controlled || !GetDeviceState(devices[d], x, abs_tol)) {
+            continue;
+        }
+        for (int k = 0; k < points; k++) {
+            states[k] = history[k].states[d];
+        }
+        double predicted = Extrapolate(times, states, points, end);
+        double allowed = abs_tol + truncation_tolerance * std::abs(x);
+        error = std::max(error, scale * std::abs(x - predicted) / allowed);
+    }
+    return error;
+}
+
+void AnalogSimulation::PredictNodeVoltages(double t, std::vector<double>& out) const {
+    int points = std::min((int)history.size(), HISTORY_POINTS);
+    if (points == 0) {
+        return;
     }
-    
-    node_voltages.resize(total_pins, 0.0);
-    
-    // Initialize with current component values
-    int pin_offset = 0;
+
+    double times[HISTORY_POINTS];
+    double values[HISTORY_POINTS];
+    for (int k = 0; k < points; k++) {
+        times[k] = history[k].time;
+    }
+    for (size_t i = 0; i < out.size(); i++) {
+        for (int k = 0; k < points; k++) {
+            values[k] = history[k].voltages[i];
+        }
+        out[i] = Extrapolate(times, values, points, t);
+    }
+}
+
+void AnalogSimulation::CheckBoundaries(double t, bool solved) {
+    for (Boundary& boundary : boundaries) {
+        if ((boundary.stamped && boundary.net >= 0) != solved) {
+            continue;
+        }
+
+        double voltage = GetBoundaryVoltage(boundary);
+        double level;
+        if (CrossesThreshold(boundary, voltage, level)) {
+            // Linear between the two checks around the crossing
+            double fraction = (level - boundary.voltage) / (voltage - boundary.voltage);
+            Crossing crossing;
+            crossing.node = boundary.node;
+            crossing.pin = boundary.pin;
+            crossing.high = !boundary.high;
+            crossing.time = boundary.time + std::min(1.0, std::max(0.0, fraction)) * (t - boundary.time);
+            crossings.push_back(crossing);
+
+            boundary.high = crossing.high;
+            boundary.node->SetDigitalLevel(boundary.pin, boundary.high);
+        }
+        boundary.voltage = voltage;
+        boundary.time = t;
+    }
+}
+
+bool AnalogSimulation::CrossesThreshold(const Boundary& boundary, double voltage, double& level) const {
+    if (boundary.high) {
+        level = logic_threshold - 0.5 * logic_hysteresis;
+        return voltage < level;
+    }
+    level = logic_threshold + 0.5 * logic_hysteresis;
+    return voltage > level;
+}
+
+bool AnalogSimulation::PredictsCrossing(double t) const {
+    for (const Boundary& boundary : boundaries) {
+        if (!boundary.stamped || boundary.net < 0) {
+            continue;
+        }
+        double level;
+        if (CrossesThreshold(boundary, EstimateNetVoltage(boundary.net, t), level)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double AnalogSimulation::EstimateNetVoltage(int net, double t) const {
+    // Through the solution ahead and the newest accepted ones when a step is pending,
+    // otherwise extrapolated from the accepted ones
+    double times[HISTORY_POINTS];
+    double values[HISTORY_POINTS];
+    int points = 0;
+    if (pending.valid) {
+        times[points] = pending.end;
+        values[points++] = pending.voltages[net];
+    }
+    for (int k = 0; k < (int)history.size() && points < HISTORY_POINTS; k++) {
+        times[points] = history[k].time;
+        values[points++] = history[k].voltages[net];
+    }
+    return points ? Extrapolate(times, values, points, t) : node_voltages[net];
+}
+
+void AnalogSimulation::InterpolateNodeVoltages(double t, std::vector<double>& out) const {
+    for (size_t i = 0; i < out.size(); i++) {
+        out[i] = EstimateNetVoltage((int)i, t);
+    }
+}
+
+double AnalogSimulation::GetBoundaryVoltage(const Boundary& boundary) const {
+    // Unknown nets are read from the accepted solution, not from the extrapolation
+    // the pins may hold between steps
+    if (!boundary.stamped) {
+        return boundary.node->GetAnalogValue(boundary.pin);
+    }
+    if (boundary.net >= 0) {
+        return history.empty() ? node_voltages[boundary.net] : history[0].voltages[boundary.net];
+    }
+    return fixed_nets[-1 - boundary.net].voltage;
+}
+
+void AnalogSimulation::PushHistory(double t) {
+    if ((int)history.size() < HISTORY_POINTS) {
+        history.insert(history.begin(), HistoryPoint());
+    }
+    else {
+        std::rotate(history.begin(), history.end() - 1, history.end());
+    }
+
+    HistoryPoint& point = history[0];
+    point.time = t;
+    point.voltages = node_voltages;
+    point.states.resize(devices.size());
+    for (size_t d = 0; d < devices.size(); d++) {
+        double abs_tol;
+        if (!devices[d].controlled || !GetDeviceState(devices[d], point.states[d], abs_tol)) {
+            point.states[d] = 0.0;
+        }
+    }
+}
+
+bool AnalogSimulation::GetDeviceState(const Device& device, double& x, double& abs_tol) {
+    for (size_t p = 0; p < device.nets.size(); p++) {
+        pin_voltages[p] = GetNetVoltage(device.nets[p]);
+    }
+    return device.node->GetIntegratedState(pin_voltages.data(), x, abs_tol);
+}
+
+// Connectors of digital components, or only those that drive a value
+static bool IsDigital(const ElcConn& c, bool drivers_only) {
+    return !dynamic_cast<const AnalogNodeBase*>(c.base) && (c.is_src || !drivers_only);
+}
+
+// Connectors linked to a digital component
+static bool IsDigitalBoundary(const ElcConn& c, bool drivers_only) {
+    for (const ElcBase::CLink& link : c.links) {
+        if (link.conn && IsDigital(*link.conn, drivers_only)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AnalogSimulation::BuildSystemEquations() {
+    devices.clear();
+    unstamped.clear();
+    fixed_nets.clear();
+    boundaries.clear();
+    node_voltages.clear();
+
+    // Every connector reachable over links from a stamped pin, with a union-find
+    // forest that ends up with one tree per net
+    std::unordered_map<const ElcConn*, int> conn_index;
+    std::vector<const ElcConn*> conns;
+    std::vector<int> parent;
+    std::unordered_set<const ElcBase*> stamped;
+
+    auto index_of = [&](const ElcConn* c) {
+        auto it = conn_index.find(c);
+        if (it != conn_index.end()) {
+            return it->second;
+        }
+        int i = (int)conns.size();
+        conn_index[c] = i;
+        conns.push_back(c);
+        parent.push_back(i);
+        return i;
+    };
+    auto find = [&](int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+
     for (auto* component : analog_components) {
-        AnalogNodeBase* analog_comp = dynamic_cast<AnalogNodeBase*>(component);
-        if (analog_comp) {
-            for (int i = 0; i < component->GetConnectorCount(); i++) {
-                if (pin_offset + i < node_voltages.size()) {
-                    node_voltages[pin_offset + i] = analog_comp->GetAnalogValue(i);
+        if (!component->IsStamped()) {
+            unstamped.push_back(component);
+            continue;
+        }
+        devices.emplace_back();
+        devices.back().node = component;
+        stamped.insert(component);
+        for (int p = 0; p < component->GetConnectorCount(); p++) {
+            index_of(&component->GetConnector(p));
+        }
+    }
+
+    // The list grows while walking it, so whole nets get collected
+    for (size_t i = 0; i < conns.size(); i++) {
+        for (const ElcBase::CLink& link : conns[i]->links) {
+            if (link.conn) {
+                int a = find((int)i);
+                int b = find(index_of(link.conn));
+                parent[a] = b;
+            }
+        }
+    }
+
+    // Classify the nets. A net is fixed when it reaches a connector of something
+    // other than a stamped component that can drive it, or when it is a single
+    // unconnected pin. It follows an analog source on it, else the stamped pin a
+    // digital output writes. Digital inputs only read the net.
+    struct NetInfo {
+        int members = 0;
+        const ElcConn* stamped_pin = nullptr;
+        const ElcConn* digital_pin = nullptr;
+        const ElcConn* analog_source = nullptr;
+        bool foreign = false;
+        int code = 0;
+    };
+    std::vector<NetInfo> info(conns.size());
+    for (size_t i = 0; i < conns.size(); i++) {
+        NetInfo& net = info[find((int)i)];
+        const ElcConn* c = conns[i];
+        net.members++;
+        if (stamped.count(c->base)) {
+            if (!net.stamped_pin) {
+                net.stamped_pin = c;
+            }
+            if (!net.digital_pin && IsDigitalBoundary(*c, true)) {
+                net.digital_pin = c;
+            }
+        }
+        else if (!IsDigital(*c, false)) {
+            net.foreign = true;
+            if (!net.analog_source) {
+                net.analog_source = c;
+            }
+        }
+        else if (IsDigital(*c, true)) {
+            net.foreign = true;
+        }
+    }
+
+    int unknowns = 0;
+    for (size_t i = 0; i < conns.size(); i++) {
+        if (find((int)i) != (int)i) {
+            continue;
+        }
+        NetInfo& net = info[i];
+        const ElcConn* source = net.analog_source ? net.analog_source
+            : net.digital_pin ? net.digital_pin : net.stamped_pin;
+        const AnalogNodeBase* node = source ? dynamic_cast<const AnalogNodeBase*>(source->base) : nullptr;
+        if (net.foreign || net.members == 1) {
+            FixedNet fixed;
+            fixed.source = node;
+            fixed.pin = source ? source->id : 0;
+            net.code = -1 - (int)fixed_nets.size();
+            fixed_nets.push_back(fixed);
+        }
+        else {
+            // Start from the voltage the pins already have
+            net.code = unknowns++;
+            node_voltages.push_back(node ? node->GetAnalogValue(source->id) : 0.0);
+        }
+    }
+
+    // Lay out the matrix: each device couples the unknown nets of its pins
+    std::vector<std::pair<int, int>> entries;
+    for (Device& device : devices) {
+        int pins = device.node->GetConnectorCount();
+        device.nets.resize(pins);
+        for (int p = 0; p < pins; p++) {
+            device.nets[p] = info[find(conn_index[&device.node->GetConnector(p)])].code;
+        }
+        for (int p = 0; p < pins; p++) {
+            for (int q = 0; q < pins; q++) {
+                if (device.nets[p] >= 0 && device.nets[q] >= 0) {
+                    entries.push_back(std::make_pair(device.nets[p], device.nets[q]));
                 }
             }
-            pin_offset += component->GetConnectorCount();
-        }
-    }
-}
-
-void AnalogSimulation::BuildSystemEquations() {
-    // In a real implementation, this would create a system of equations
-    // based on Kirchhoff's Current Law (KCL) and Kirchhoff's Voltage Law (KVL)
-    // as well as the constitutive relations for each component type
-    
-    // For now, we'll just resize the system matrices appropriately
-    int n = node_voltages.size();
-    if (n == 0) return;
-    
-    jacobian.resize(n, std::vector<double>(n, 0.0));
-    residuals.resize(n, 0.0);
-    corrections.resize(n, 0.0);
-    
-    // Initialize jacobian to zero
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            jacobian[i][j] = 0.0;
-        }
-        residuals[i] = 0.0;
-        corrections[i] = 0.0;
-    }
-    
-    // A real implementation would populate these based on circuit topology and component equations
-    // For example, for a resistor R between nodes i and j:
-    // Gii += 1/R, Gij -= 1/R, Gji -= 1/R, Gjj += 1/R
-    // where G is the conductance matrix (part of the Jacobian)
-    
-    // For now, we'll create a simplified example for testing
-    // This would be replaced with a proper circuit analysis algorithm
-    for (size_t i = 0; i < analog_components.size(); i++) {
-        // Each component contributes to the system equations
-        // This is where the real circuit analysis would happen
+        }
+    }
+    for (auto* component : analog_components) {
+        for (int p = 0; p < component->GetConnectorCount(); p++) {
+            const ElcConn& conn = component->GetConnector(p);
+            if (!IsDigitalBoundary(conn, false)) {
+                continue;
+            }
+            Boundary boundary;
+            boundary.node = component;
+            boundary.pin = p;
+            boundary.stamped = component->IsStamped();
+            if (boundary.stamped) {
+                boundary.net = info[find(conn_index[&conn])].code;
+            }
+            boundaries.push_back(boundary);
+        }
+    }
+
+    matrix.Build(unknowns, entries);
+    if (!lu.Analyze(matrix)) {
+        LOG("Error: analog system has no diagonal to factor");
+        return false;
+    }
+
+    size_t max_pins = 0;
+    all_linear = true;
+    for (Device& device : devices) {
+        all_linear = all_linear && device.node->IsLinear();
+        int pins = (int)device.nets.size();
+        max_pins = std::max(max_pins, (size_t)pins);
+        device.slots.assign(pins * pins, -1);
+        for (int p = 0; p < pins; p++) {
+            for (int q = 0; q < pins; q++) {
+                device.slots[p * pins + q] = matrix.Find(device.nets[p], device.nets[q]);
+            }
+        }
+    }
+    diagonal_slots.resize(unknowns);
+    for (int i = 0; i < unknowns; i++) {
+        diagonal_slots[i] = matrix.Find(i, i);
+    }
+    rhs.assign(unknowns, 0.0);
+    pin_voltages.resize(max_pins);
+    pin_currents.resize(max_pins);
+    perturbed_currents.resize(max_pins);
+    pin_conductances.resize(max_pins * max_pins);
+
+    // Devices whose integrated state sits on an unknown net take part in the step
+    // size control; across fixed nets it is whatever drives them
+    for (Device& device : devices) {
+        bool unknown = false;
+        for (int net : device.nets) {
+            unknown = unknown || net >= 0;
+        }
+        double x, abs_tol;
+        device.controlled = unknown && device.node->GetIntegratedState(pin_voltages.data(), x, abs_tol);
+    }
+
+    // The integration restarts from here
+    InitializeNodeVoltages();
+    history.clear();
+    pending.valid = false;
+    solved_time = tick_time;
+    previous_step = 0.0;
+    next_step = std::min(time_step, max_step);
+    solved_fixed.assign(fixed_nets.size(), std::numeric_limits<double>::quiet_NaN());
+    PushHistory(solved_time);
+
+    // The boundaries start at the level of their present voltage
+    for (Boundary& boundary : boundaries) {
+        boundary.voltage = GetBoundaryVoltage(boundary);
+        boundary.time = solved_time;
+        boundary.high = boundary.voltage > logic_threshold;
+        boundary.node->SetDigitalLevel(boundary.pin, boundary.high);
+    }
+
+    LOG("Analog system: " << (int)devices.size() << " stamped components, "
+        << unknowns << " unknown nets, " << (int)fixed_nets.size() << " fixed nets, "
+        << (int)boundaries.size() << " digital boundaries, "
+        << matrix.GetNonZeroCount() << " nonzeros, " << lu.GetFillCount() << " in the factors");
+
+    topology_dirty = false;
+    return true;
+}
+
+void AnalogSimulation::InitializeNodeVoltages() {
+    // The fixed nets follow whatever drives them, which may change every step
+    for (FixedNet& net : fixed_nets) {
+        net.voltage = net.source ? net.source->GetAnalogValue(net.pin) : 0.0;
+    }
+}
+
+double AnalogSimulation::GetNetVoltage(int net) const {
+    return net >= 0 ? node_voltages[net] : fixed_nets[-1 - net].voltage;
+}
+
+bool AnalogSimulation::SolveAnalogSystem() {
+    InitializeNodeVoltages();
+
+    if (node_voltages.empty()) {
+        return true;  // Every net is fixed, nothing to solve
     }
+
+    return NewtonRaphsonIteration();
 }
 
 bool AnalogSimulation::NewtonRaphsonIteration() {
     int iteration = 0;
-    
+
     while (iteration < max_iterations) {
-        // Calculate residuals (function values)
-        for (size_t i = 0; i < residuals.size(); i++) {
-            // In a real implementation, this would calculate the residual
-            // based on the system of equations
-            residuals[i] = 0.0;  // Placeholder
-        }
-        
-        // Check for convergence
-        double max_residual = 0.0;
-        for (double r : residuals) {
-            max_residual = std::max(max_residual, std::abs(r));
-        }
-        
-        if (max_residual < tolerance) {
-            return true;  // Converged
-        }
-        
-        // Calculate Jacobian matrix
+        // Linearize every device at the present voltages and solve the linear
+        // system for the next iterate
         if (!CalculateJacobian()) {
             return false;
         }
-        
-        // Solve J * dx = -residuals for corrections (dx)
-        // Using a simplified Gaussian elimination approach
+
         if (!SolveLinearSystem()) {
             return false;
         }
-        
-        // Apply corrections to node voltages
+
+        // Check for convergence on the size of the update
+        bool converged = true;
         for (size_t i = 0; i < node_voltages.size(); i++) {
-            node_voltages[i] -= corrections[i];  // Newton-Raphson update
+            double change = std::abs(rhs[i] - node_voltages[i]);
+            if (change > tolerance + RELATIVE_TOLERANCE * std::abs(rhs[i])) {
+                converged = false;
+            }
+            node_voltages[i] = rhs[i];
         }
-        
+
+        // Without nonlinear devices the first solution is exact
+        if (converged || all_linear) {
+            return true;
+        }
+
         iteration++;
     }
-    
+
     // Failed to converge
     return false;
 }
 
 bool AnalogSimulation::CalculateJacobian() {
-    // In a real implementation, this would calculate the Jacobian matrix
-    // numerically by perturbing each voltage and observing the change in residuals
-    
-    int n = node_voltages.size();
-    if (n == 0) return true;
-    
-    std::vector<double> original_voltages = node_voltages;
-    std::vector<double> perturbed_residuals(n);
-    const double perturbation = 1e-9;  // Small voltage perturbation
-    
-    for (int j = 0; j < n; j++) {
-        // Perturb voltage j
-        node_voltages[j] += perturbation;
-        
-        // Calculate residuals with perturbed voltage
-        for (int i = 0; i < n; i++) {
-            // Placeholder - in real implementation this calculates the residual for node i
-            perturbed_residuals[i] = 0.0; 
-        }
-        
-        // Calculate Jacobian column (partial derivatives)
-        for (int i = 0; i < n; i++) {
-            jacobian[i][j] = (perturbed_residuals[i] - residuals[i]) / perturbation;
-        }
-        
-        // Restore original voltage
-        node_voltages[j] = original_voltages[j];
-    }
-    
-    return true;
-}
+    // Each device contributes i(v) ~ i(v0) + G * (v - v0) to the current law of the
+    // nets its pins are on. G comes from the device's analytic derivatives when it
+    // has them. Otherwise the device's own pins are perturbed one at a time, so the
+    // cost is its pin count and not the size of the circuit.
+    matrix.Zero();
+    std::fill(rhs.begin(), rhs.end(), 0.0);
 
-bool AnalogSimulation::SolveLinearSystem() {
-    // Simple Gaussian elimination to solve J * x = -residuals
-    // This is a basic implementation; a robust solution would use
-    // a library like Eigen, BLAS/LAPACK, etc.
-    
-    int n = jacobian.size();
-    if (n == 0) return true;
-    
-    // Create augmented matrix [J | -residuals]
-    std::vector<std::vector<double>> aug(n, std::vector<double>(n + 1));
-    
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            aug[i][j] = jacobian[i][j];
-        }
-        aug[i][n] = -residuals[i];  // Right-hand side
-    }
-    
-    // Forward elimination
-    for (int i = 0; i < n; i++) {
-        // Find pivot
-        int max_row = i;
-        for (int k = i + 1; k < n; k++) {
-            if (std::abs(aug[k][i]) > std::abs(aug[max_row][i])) {
-                max_row = k;
-            }
+    for (int slot : diagonal_slots) {
+        matrix.values[slot] += GMIN;
+    }
+
+    for (Device& device : devices) {
+        int pins = (int)device.nets.size();
+        double* v = pin_voltages.data();
+        double* g = pin_conductances.data();
+        for (int p = 0; p < pins; p++) {
+            v[p] = GetNetVoltage(device.nets[p]);
         }
-        
-        // Swap rows
-        std::swap(aug[i], aug[max_row]);
-        
-        // Check for singular matrix
-        if (std::abs(aug[i][i]) < 1e-12) {
-            std::cerr << "Singular matrix in analog simulation" << std::endl;
-            return false;
+
+        if (!device.node->GetPinConductances(v, pin_currents.data(), g)) {
+            device.node->GetPinCurrents(v, pin_currents.data());
+
+            // Derivatives by fixed pins cancel out of the equations and are skipped
+            for (int q = 0; q < pins; q++) {
+                if (device.nets[q] < 0) {
+                    continue;
+                }
+
+                double original = v[q];
+                double perturbation = 1e-8 * (1.0 + std::abs(original));
+                v[q] = original + perturbation;
+                device.node->GetPinCurrents(v, perturbed_currents.data());
+                v[q] = original;
+
+                for (int p = 0; p < pins; p++) {
+                    g[p * pins + q] = (perturbed_currents[p] - pin_currents[p]) / perturbation;
+                }
+            }
         }
-        
-        // Eliminate column i
-        for (int k = i + 1; k < n; k++) {
-            double factor = aug[k][i] / aug[i][i];
-            for (int j = i; j <= n; j++) {
-                aug[k][j] -= factor * aug[i][j];
+
+        for (int p = 0; p < pins; p++) {
+            int row = device.nets[p];
+            if (row < 0) {
+                continue;
+            }
+            rhs[row] -= pin_currents[p];
+            for (int q = 0; q < pins; q++) {
+                if (device.nets[q] >= 0) {
+                    matrix.values[device.slots[p * pins + q]] += g[p * pins + q];
+                    rhs[row] += g[p * pins + q] * v[q];
+                }
             }
         }
     }
-    
-    // Back substitution
-    for (int i = n - 1; i >= 0; i--) {
-        corrections[i] = aug[i][n];
-        for (int j = i + 1; j < n; j++) {
-            corrections[i] -= aug[i][j] * corrections[j];
-        }
-        corrections[i] /= aug[i][i];
+
+    return true;
+}
+
+bool AnalogSimulation::SolveLinearSystem() {
+    // Numeric refactorization on the pattern analyzed with the nets, then G * v = rhs
+    // solved in place
+    if (!lu.Refactor(matrix)) {
+        std::cerr << "Singular matrix in analog simulation" << std::endl;
+        return false;
     }
-    
+
+    lu.Solve(rhs);
     return true;
 }
 
 void AnalogSimulation::UpdateComponentValues() {
-    // Update the analog values in each component based on the solved node voltages
-    int pin_offset = 0;
-    for (auto* component : analog_components) {
-        AnalogNodeBase* analog_comp = dynamic_cast<AnalogNodeBase*>(component);
-        if (analog_comp) {
-            int num_pins = component->GetConnectorCount();
-            for (int i = 0; i < num_pins; i++) {
-                if ((pin_offset + i) < node_voltages.size()) {
-                    analog_comp->UpdateAnalogValue(i, node_voltages[pin_offset + i]);
-                }
-            }
-            pin_offset += num_pins;
+    // Update the analog values in each stamped component from the solved nets
+    for (Device& device : devices) {
+        for (int p = 0; p < (int)device.nets.size(); p++) {
+            device.node->UpdateAnalogValue(p, GetNetVoltage(device.nets[p]));
         }
     }
 }
@@ -257,10 +782,20 @@ void AnalogSimulation::SetTimeStep(double dt) {
     time_step = dt;
 }
 
+void AnalogSimulation::SetLogicThreshold(double threshold, double hysteresis) {
+    logic_threshold = threshold;
+    logic_hysteresis = hysteresis;
+}
+
+void AnalogSimulation::SetStepLimits(double shortest, double longest) {
+    min_step = shortest;
+    max_step = longest;
+}
+
 void AnalogSimulation::SetMaxIterations(int max_iter) {
     max_iterations = max_iter;
 }
 
 void AnalogSimulation::SetTolerance(double tol) {
     tolerance = tol;
-}
\ No newline at end of file
+}
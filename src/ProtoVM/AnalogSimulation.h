@@ -4,71 +4,279 @@
 #include "AnalogCommon.h"
 #include "AnalogComponents.h"
 #include "AnalogSemiconductors.h"
+#include "AnalogSparse.h"
 #include "Machine.h"
 #include <vector>
 
-// Analog simulation system that works alongside digital simulation
+// Analog simulation system that works alongside digital simulation.
+//
+// Stamped components (AnalogNodeBase::IsStamped) are solved with modified nodal
+// analysis: their connectors are grouped into nets by following the links between
+// them, and every net whose voltage is unknown gets one Kirchhoff current law row in
+// a sparse matrix. A net is instead held at a fixed voltage when it also reaches a
+// connector of anything that is not a stamped component (a voltage source, another
+// analog model or a digital pin), or when it is a single unconnected pin; those act
+// as ideal voltage sources at the value of that connector.
+//
+// The pattern of the matrix only depends on the netlist, so its ordering and symbolic
+// factorization are done once when the nets are built. Each Newton iteration then
+// refactors numerically, and AnalogSparseLU leaves alone the rows that no changed
+// value reaches, such as those only linear components touch while the step stays
+// the same.
+//
+// Each Tick advances the simulation by the output period set with SetTimeStep. With
+// adaptive stepping (the default) the integration steps inside it are sized by the
+// local truncation error of the reactive devices, estimated from the difference
+// between the solution and a polynomial extrapolation of the accepted ones: steps
+// that exceed the tolerance are rejected and retried shorter, and quiet stretches
+// grow the step up to the maximum. A step longer than the period is solved ahead to
+// the last tick it covers, and the ticks before that get voltages interpolated
+// between it and the accepted solutions, so a quiescent circuit costs a solve every
+// few hundred ticks. If the fixed nets change first, the step is dropped and the
+// ticks it covered are solved again with the voltages they had. Sinks see the
+// solution resampled at the tick rate either way, unless SetResampleOutputs turns
+// that off and the pins keep the last solution between steps.
+//
+// Pins linked to digital connectors are A/D boundaries. A digital output drives its
+// net like a voltage source (AnalogNodeBase::PutRaw), so a change takes effect on
+// the next tick and ends the step in progress there. Toward the digital side each
+// boundary pin has a level with hysteresis around the logic threshold. A step also
+// ends on the tick where the interpolation predicts that a boundary crosses it.
+// Crossings are located between the two solutions around them, and the level flips
+// in the tick that solves them. The Machine then delivers the new level.
 class AnalogSimulation {
 public:
+    enum IntegrationMethod {
+        BACKWARD_EULER,
+        TRAPEZOIDAL,
+        GEAR2
+    };
+
+    // A boundary pin changing its digital level at the interpolated time
+    struct Crossing {
+        AnalogNodeBase* node = nullptr;
+        int pin = 0;
+        bool high = false;
+        double time = 0.0;
+    };
+
     AnalogSimulation();
-    
+
     // Add an analog component to the simulation
     void RegisterAnalogComponent(AnalogNodeBase* component);
-    
+
+    // Rebuild the nets on the next Tick, after links between components changed
+    void InvalidateTopology() { topology_dirty = true; }
+
     // Run the analog portion of the simulation
     bool Tick();
-    
+
     // Solve the system of equations for the analog components
     bool SolveAnalogSystem();
-    
-    // Calculate the Jacobian matrix for Newton-Raphson method
+
+    // Stamp the linearized device currents at the present iterate into the matrix,
+    // with analytic device derivatives where the devices provide them
     bool CalculateJacobian();
-    
+
     // Solve linear system of equations
     bool SolveLinearSystem();
-    
+
     // Perform Newton-Raphson iteration to solve non-linear circuits
     bool NewtonRaphsonIteration();
-    
-    // Set simulation parameters
+
+    // Set simulation parameters. The time step is the output period; without
+    // adaptive stepping it is also the integration step.
     void SetTimeStep(double dt);
     void SetMaxIterations(int max_iter);
     void SetTolerance(double tol);
-    
+    void SetIntegrationMethod(IntegrationMethod m) { method = m; }
+    void SetAdaptiveStep(bool b) { adaptive = b; }
+    void SetStepLimits(double shortest, double longest);
+    // Relative tolerance on the truncation error of each step
+    void SetTruncationTolerance(double tol) { truncation_tolerance = tol; }
+    void SetResampleOutputs(bool b) { resample_outputs = b; }
+    void SetLogicThreshold(double threshold, double hysteresis);
+
     // Get simulation parameters
     double GetTimeStep() const { return time_step; }
     int GetMaxIterations() const { return max_iterations; }
     double GetTolerance() const { return tolerance; }
-    
+    IntegrationMethod GetIntegrationMethod() const { return method; }
+    bool IsAdaptiveStep() const { return adaptive; }
+    double GetMinStep() const { return min_step; }
+    double GetMaxStep() const { return max_step; }
+    double GetTruncationTolerance() const { return truncation_tolerance; }
+    bool IsResampleOutputs() const { return resample_outputs; }
+    double GetLogicThreshold() const { return logic_threshold; }
+    double GetLogicHysteresis() const { return logic_hysteresis; }
+
+    // Boundary pins whose level changed during the last Tick
+    const std::vector<Crossing>& GetCrossings() const { return crossings; }
+    int GetBoundaryCount() const { return (int)boundaries.size(); }
+
+    // Time reached by the ticks, and by the last accepted step
+    double GetTime() const { return tick_time; }
+    double GetSolvedTime() const { return solved_time; }
+    int GetStepCount() const { return accepted_steps; }
+    int GetRejectedStepCount() const { return rejected_steps; }
+
+    // Size of the last built system
+    int GetUnknownCount() const { return (int)node_voltages.size(); }
+    int GetNonZeroCount() const { return matrix.GetNonZeroCount(); }
+    int GetFillCount() const { return lu.GetFillCount(); }
+    int GetRefactoredRows() const { return lu.GetRefactoredRows(); }
+
 private:
     std::vector<AnalogNodeBase*> analog_components;
-    
+
     // Simulation parameters
     double time_step;
     int max_iterations;
     double tolerance;
-    
-    // System state (voltages at each node)
+    IntegrationMethod method = TRAPEZOIDAL;
+    bool adaptive = true;
+    double min_step = 1e-9;
+    double max_step = 1e-2;
+    double truncation_tolerance = 1e-3;
+    bool resample_outputs = true;
+    double logic_threshold = 0.5 * (AnalogNodeBase::LOGIC_LOW_VOLTAGE + AnalogNodeBase::LOGIC_HIGH_VOLTAGE);
+    double logic_hysteresis = 0.1;
+
+    // A stamped component with the net of each pin: an unknown index when >= 0,
+    // otherwise -1 - the index into fixed_nets
+    struct Device {
+        AnalogNodeBase* node = nullptr;
+        std::vector<int> nets;
+        std::vector<int> slots;  // matrix slot of (row pin, column pin), pins * pins
+        bool controlled = false;  // integrates a state over time on an unknown net
+    };
+
+    // A net held at the voltage of one of its connectors
+    struct FixedNet {
+        const AnalogNodeBase* source = nullptr;
+        int pin = 0;
+        double voltage = 0.0;
+    };
+
+    // A pin linked to a digital connector, with the net it is on (as in Device) when
+    // the pin is stamped. The voltage and time are those of the last check.
+    struct Boundary {
+        AnalogNodeBase* node = nullptr;
+        int pin = 0;
+        bool stamped = false;
+        int net = 0;
+        bool high = false;
+        double voltage = 0.0;
+        double time = 0.0;
+    };
+
+    std::vector<Device> devices;
+    std::vector<AnalogNodeBase*> unstamped;
+    std::vector<FixedNet> fixed_nets;
+    std::vector<Boundary> boundaries;
+    std::vector<Crossing> crossings;
+    bool topology_dirty = true;
+    bool all_linear = false;
+
+    // System state (voltages at each unknown net)
     std::vector<double> node_voltages;
-    
-    // Jacobian matrix for solving non-linear systems
-    std::vector<std::vector<double>> jacobian;
-    
-    // Solution vectors
-    std::vector<double> residuals;
-    std::vector<double> corrections;
-    
-    // Node to component mapping for circuit analysis
-    std::vector<std::vector<AnalogNodeBase*>> node_connections;
-    
-    // Initialize the node voltage vector based on components
+
+    // Accepted solutions, newest first, for the predictor: the node voltages and the
+    // integrated state of every controlled device
+    struct HistoryPoint {
+        double time = 0.0;
+        std::vector<double> voltages;
+        std::vector<double> states;
+    };
+    std::vector<HistoryPoint> history;
+    std::vector<double> solved_fixed;  // fixed net voltages of the last accepted step
+
+    // A step solved ahead of the ticks, accepted on the tick it ends on
+    struct PendingStep {
+        bool valid = false;
+        double end = 0.0;
+        double error = 0.0;
+        int order = 1;
+        bool cut = false;
+        std::vector<double> voltages;
+    };
+    PendingStep pending;
+    double tick_time = 0.0;
+    double solved_time = 0.0;
+    double next_step = 0.0;
+    double previous_step = 0.0;
+    int accepted_steps = 0;
+    int rejected_steps = 0;
+
+    // Nodal equations G * v = rhs, with G in sparse form
+    AnalogSparseMatrix matrix;
+    AnalogSparseLU lu;
+    std::vector<double> rhs;
+    std::vector<int> diagonal_slots;
+
+    // Scratch space for linearizing one device
+    std::vector<double> pin_voltages;
+    std::vector<double> pin_currents;
+    std::vector<double> perturbed_currents;
+    std::vector<double> pin_conductances;
+
+    // Conductance from every unknown net to ground, keeping floating nets solvable
+    static constexpr double GMIN = 1e-12;
+    // Relative tolerance on the node voltage updates
+    static constexpr double RELATIVE_TOLERANCE = 1e-6;
+    // Most a step grows by, and least it shrinks by, after one estimate
+    static constexpr double MAX_STEP_GROWTH = 2.0;
+    static constexpr double MIN_STEP_SHRINK = 0.2;
+    static constexpr double STEP_SAFETY = 0.9;
+    static constexpr int HISTORY_POINTS = 3;
+
+    // Group connectors into nets and lay out the sparse matrix
+    bool BuildSystemEquations();
+
+    // Load the voltages of the fixed nets for this step
     void InitializeNodeVoltages();
-    
-    // Build the system of equations from the circuit
-    void BuildSystemEquations();
-    
+
+    // Take steps from the last accepted solution until time t
+    bool AdvanceTo(double t);
+
+    // Integrate from the last accepted solution to end, shortening the step until its
+    // truncation error is within the tolerance
+    bool TakeStep(double end);
+    // TakeStep in two halves: SolveStep leaves the solution in node_voltages and may
+    // move end closer, AcceptStep commits it
+    bool SolveStep(double& end, double& error, int& order, bool& cut);
+    bool AcceptStep(double end, double error, int order, bool cut);
+
+    // Solve the next step ahead to the last tick it covers, into pending
+    bool SolveAhead();
+
+    // Hand every device the discretization for a step of h; returns its order
+    int SetupIntegration(double h, IntegrationMethod& used);
+
+    // Largest truncation error of the solved step relative to its tolerance
+    double EstimateTruncationError(double end, int order, IntegrationMethod used);
+
+    // Extrapolate the node voltages of the history to time t
+    void PredictNodeVoltages(double t, std::vector<double>& out) const;
+    // Voltage at time t before the step ending past it is accepted: interpolated when
+    // a step is pending, extrapolated otherwise
+    double EstimateNetVoltage(int net, double t) const;
+    void InterpolateNodeVoltages(double t, std::vector<double>& out) const;
+
+    // Flip the levels of the boundaries whose voltage crossed the threshold since
+    // their last check, those on unknown nets after a step and the rest on a tick
+    void CheckBoundaries(double t, bool solved);
+    bool CrossesThreshold(const Boundary& boundary, double voltage, double& level) const;
+    bool PredictsCrossing(double t) const;
+    double GetBoundaryVoltage(const Boundary& boundary) const;
+
+    void PushHistory(double t);
+    bool GetDeviceState(const Device& device, double& x, double& abs_tol);
+
     // Update all component values after solving
     void UpdateComponentValues();
+
+    double GetNetVoltage(int net) const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,275 @@
+#include "AnalogSparse.h"
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+void AnalogSparseMatrix::Build(int size, std::vector<std::pair<int, int>>& entries) {
+    n = size;
+    for (int i = 0; i < n; i++) {
+        entries.push_back(std::make_pair(i, i));
+    }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    row_start.assign(n + 1, 0);
+    cols.clear();
+    cols.reserve(entries.size());
+    for (const auto& e : entries) {
+        row_start[e.first + 1]++;
+        cols.push_back(e.second);
+    }
+    for (int i = 0; i < n; i++) {
+        row_start[i + 1] += row_start[i];
+    }
+    values.assign(cols.size(), 0.0);
+}
+
+void AnalogSparseMatrix::Clear() {
+    n = 0;
+    row_start.assign(1, 0);
+    cols.clear();
+    values.clear();
+}
+
+void AnalogSparseMatrix::Zero() {
+    std::fill(values.begin(), values.end(), 0.0);
+}
+
+int AnalogSparseMatrix::Find(int row, int col) const {
+    if (row < 0 || row >= n) {
+        return -1;
+    }
+    auto begin = cols.begin() + row_start[row];
+    auto end = cols.begin() + row_start[row + 1];
+    auto it = std::lower_bound(begin, end, col);
+    if (it == end || *it != col) {
+        return -1;
+    }
+    return (int)(it - cols.begin());
+}
+
+void AnalogSparseLU::OrderMinimumDegree(const AnalogSparseMatrix& a) {
+    // Elimination graph of A + A^T: eliminating a node joins its remaining
+    // neighbours into a clique, and the next node is the one of least degree
+    std::vector<std::vector<int>> adjacency(n);
+    for (int i = 0; i < n; i++) {
+        for (int s = a.row_start[i]; s < a.row_start[i + 1]; s++) {
+            int j = a.cols[s];
+            if (j != i) {
+                adjacency[i].push_back(j);
+                adjacency[j].push_back(i);
+            }
+        }
+    }
+
+    std::vector<char> eliminated(n, 0);
+    std::vector<int> seen(n, -1);
+    std::vector<int> neighbours;
+    int stamp = 0;
+    for (int i = 0; i < n; i++) {
+        std::vector<int>& adj = adjacency[i];
+        std::sort(adj.begin(), adj.end());
+        adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+    }
+
+    order.clear();
+    for (int step = 0; step < n; step++) {
+        int best = -1;
+        for (int i = 0; i < n; i++) {
+            if (!eliminated[i] && (best < 0 || adjacency[i].size() < adjacency[best].size())) {
+                best = i;
+            }
+        }
+        order.push_back(best);
+        eliminated[best] = 1;
+
+        neighbours.clear();
+        for (int j : adjacency[best]) {
+            if (!eliminated[j]) {
+                neighbours.push_back(j);
+            }
+        }
+        for (int u : neighbours) {
+            std::vector<int>& adj = adjacency[u];
+            int count = 0;
+            stamp++;
+            for (int j : adj) {
+                if (!eliminated[j]) {
+                    seen[j] = stamp;
+                    adj[count++] = j;
+                }
+            }
+            adj.resize(count);
+            for (int j : neighbours) {
+                if (j != u && seen[j] != stamp) {
+                    seen[j] = stamp;
+                    adj.push_back(j);
+                }
+            }
+        }
+        std::vector<int>().swap(adjacency[best]);
+    }
+
+    inverse.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        inverse[order[i]] = i;
+    }
+}
+
+bool AnalogSparseLU::Analyze(const AnalogSparseMatrix& a) {
+    n = a.n;
+    analyzed = false;
+    factored = false;
+    OrderMinimumDegree(a);
+
+    // Symbolic elimination, row by row in the new order. The columns left of the
+    // diagonal are taken in increasing order, each bringing in the pattern of its U
+    // row; fill-in left of the diagonal joins the heap, always right of the column
+    // being used.
+    l_start.assign(1, 0);
+    l_cols.clear();
+    u_start.assign(1, 0);
+    u_cols.clear();
+    mark.assign(n, -1);
+    std::vector<int> lower, upper;
+
+    for (int i = 0; i < n; i++) {
+        lower.clear();
+        upper.clear();
+        int r = order[i];
+        for (int s = a.row_start[r]; s < a.row_start[r + 1]; s++) {
+            int j = inverse[a.cols[s]];
+            mark[j] = i;
+            (j < i ? lower : upper).push_back(j);
+        }
+
+        std::make_heap(lower.begin(), lower.end(), std::greater<int>());
+        while (!lower.empty()) {
+            std::pop_heap(lower.begin(), lower.end(), std::greater<int>());
+            int k = lower.back();
+            lower.pop_back();
+            l_cols.push_back(k);
+
+            for (int s = u_start[k] + 1; s < u_start[k + 1]; s++) {
+                int j = u_cols[s];
+                if (mark[j] != i) {
+                    mark[j] = i;
+                    if (j < i) {
+                        lower.push_back(j);
+                        std::push_heap(lower.begin(), lower.end(), std::greater<int>());
+                    } else {
+                        upper.push_back(j);
+                    }
+                }
+            }
+        }
+        l_start.push_back((int)l_cols.size());
+
+        std::sort(upper.begin(), upper.end());
+        if (upper.empty() || upper[0] != i) {
+            return false;  // The pattern lacks the diagonal
+        }
+        u_cols.insert(u_cols.end(), upper.begin(), upper.end());
+        u_start.push_back((int)u_cols.size());
+    }
+
+    l_values.assign(l_cols.size(), 0.0);
+    u_values.assign(u_cols.size(), 0.0);
+    work.assign(n, 0.0);
+    row_changed.assign(n, 1);
+    last_values.clear();
+    analyzed = true;
+    return true;
+}
+
+bool AnalogSparseLU::Refactor(const AnalogSparseMatrix& a) {
+    if (!analyzed || a.n != n) {
+        return false;
+    }
+
+    // Rows of A whose values moved since the last successful factorization
+    bool compare = factored && last_values.size() == a.values.size();
+    for (int r = 0; r < n; r++) {
+        bool changed = !compare;
+        for (int s = a.row_start[r]; s < a.row_start[r + 1] && !changed; s++) {
+            changed = a.values[s] != last_values[s];
+        }
+        row_changed[inverse[r]] = changed;
+    }
+    factored = false;
+    refactored_rows = 0;
+
+    for (int i = 0; i < n; i++) {
+        // A row stays as it was when its entries and every U row it is eliminated
+        // with stay as they were
+        bool changed = row_changed[i];
+        for (int t = l_start[i]; t < l_start[i + 1] && !changed; t++) {
+            changed = row_changed[l_cols[t]];
+        }
+        row_changed[i] = changed;
+        if (!changed) {
+            continue;
+        }
+        refactored_rows++;
+
+        for (int t = l_start[i]; t < l_start[i + 1]; t++) {
+            work[l_cols[t]] = 0.0;
+        }
+        for (int s = u_start[i]; s < u_start[i + 1]; s++) {
+            work[u_cols[s]] = 0.0;
+        }
+        int r = order[i];
+        for (int s = a.row_start[r]; s < a.row_start[r + 1]; s++) {
+            work[inverse[a.cols[s]]] = a.values[s];
+        }
+
+        for (int t = l_start[i]; t < l_start[i + 1]; t++) {
+            int k = l_cols[t];
+            double lik = work[k] / u_values[u_start[k]];
+            l_values[t] = lik;
+            for (int s = u_start[k] + 1; s < u_start[k + 1]; s++) {
+                work[u_cols[s]] -= lik * u_values[s];
+            }
+        }
+
+        if (std::abs(work[i]) < MIN_PIVOT) {
+            return false;
+        }
+        for (int s = u_start[i]; s < u_start[i + 1]; s++) {
+            u_values[s] = work[u_cols[s]];
+        }
+    }
+
+    last_values = a.values;
+    factored = true;
+    return true;
+}
+
+void AnalogSparseLU::Solve(std::vector<double>& b) const {
+    permuted.resize(n);
+    for (int i = 0; i < n; i++) {
+        permuted[i] = b[order[i]];
+    }
+
+    // Forward substitution with the unit lower triangle
+    for (int i = 0; i < n; i++) {
+        double sum = permuted[i];
+        for (int s = l_start[i]; s < l_start[i + 1]; s++) {
+            sum -= l_values[s] * permuted[l_cols[s]];
+        }
+        permuted[i] = sum;
+    }
+
+    // Back substitution with U
+    for (int i = n - 1; i >= 0; i--) {
+        double sum = permuted[i];
+        for (int s = u_start[i] + 1; s < u_start[i + 1]; s++) {
+            sum -= u_values[s] * permuted[u_cols[s]];
+        }
+        permuted[i] = sum / u_values[u_start[i]];
+    }
+
+    for (int i = 0; i < n; i++) {
+        b[order[i]] = permuted[i];
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef _ProtoVM_AnalogSparse_h_
+#define _ProtoVM_AnalogSparse_h_
+
+#include <vector>
+#include <utility>
+
+// Square sparse matrix in compressed sparse row form, used for the nodal equations
+// of AnalogSimulation. The pattern is fixed by Build and always holds the diagonal;
+// values are cleared and restamped in place through the slot index Find returns.
+class AnalogSparseMatrix {
+public:
+    // Sets the pattern from (row, col) pairs, duplicates allowed. Clears the values.
+    void Build(int n, std::vector<std::pair<int, int>>& entries);
+    void Clear();
+    void Zero();
+
+    // Index into values of entry (row, col), or -1 outside the pattern
+    int Find(int row, int col) const;
+
+    int GetSize() const { return n; }
+    int GetNonZeroCount() const { return (int)cols.size(); }
+
+    int n = 0;
+    std::vector<int> row_start;  // n + 1 offsets into cols/values
+    std::vector<int> cols;       // sorted within each row
+    std::vector<double> values;
+};
+
+// Sparse LU factorization P * A * P^T = L * U with a symmetric permutation P and
+// no pivoting. The matrix is expected to keep a usable diagonal, which nodal
+// equations with a conductance to ground on every node do.
+//
+// Analyze orders the unknowns by minimum degree on the pattern of A + A^T, to keep
+// the fill-in small, and works out the patterns of L and U. This depends only on
+// the pattern, so it runs once per netlist. Refactor then only does the numeric
+// work, and skips the rows whose entries in A did not change since the previous
+// call when none of the rows they are eliminated with changed either. Circuits
+// whose linear part is most of the matrix refactor only what the nonlinear
+// devices touch.
+class AnalogSparseLU {
+public:
+    bool Analyze(const AnalogSparseMatrix& a);
+    // Returns false if a pivot vanishes. The pattern must be the analyzed one.
+    bool Refactor(const AnalogSparseMatrix& a);
+    bool Factor(const AnalogSparseMatrix& a) { return Analyze(a) && Refactor(a); }
+    // Solves A * x = b in place
+    void Solve(std::vector<double>& b) const;
+
+    bool IsAnalyzed() const { return analyzed; }
+    int GetFillCount() const { return (int)(l_cols.size() + u_cols.size()); }
+    // Rows the last Refactor recomputed
+    int GetRefactoredRows() const { return refactored_rows; }
+
+private:
+    int n = 0;
+    bool analyzed = false;
+    bool factored = false;
+    int refactored_rows = 0;
+
+    std::vector<int> order;    // permuted row i is row order[i] of A
+    std::vector<int> inverse;  // and row r of A is permuted row inverse[r]
+
+    // L is unit lower triangular and stores only the part below the diagonal. U rows
+    // start with their diagonal entry. Both in permuted indices, sorted per row.
+    std::vector<int> l_start, l_cols;
+    std::vector<double> l_values;
+    std::vector<int> u_start, u_cols;
+    std::vector<double> u_values;
+
+    // Values of A at the previous Refactor, for finding the rows that changed
+    std::vector<double> last_values;
+    std::vector<char> row_changed;
+
+    // Scratch space
+    std::vector<double> work;
+    std::vector<int> mark;
+    mutable std::vector<double> permuted;
+
+    void OrderMinimumDegree(const AnalogSparseMatrix& a);
+
+    static constexpr double MIN_PIVOT = 1e-300;
+};
+
+#endif
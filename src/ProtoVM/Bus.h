@@ -28,6 +28,11 @@ public:
 	
 	int GetMemorySize() const override {return Width / 8 + ((Width % 8) == 0 ? 0 : 1);}
 	
+	void SerializeState(Stream& s) override {
+		s.SerializeRaw(data, BYTES);
+		s.SerializeRaw((byte*)is_driven, sizeof(is_driven));
+	}
+	
 	void Clear() {
 		for(int i = 0; i < BYTES; i++)
 			data[i] = 0;
@@ -17,6 +17,11 @@ typedef enum {
 
 class Pcb;
 struct LinkBase;
+class ElectricNodeBase;
+
+// Calls T::Tick without going through the vtable (see ElectricNodeBase::GetTickFn)
+template <class T>
+bool DirectTick(ElectricNodeBase& n) {return static_cast<T&>(n).T::Tick();}
 
 class ElectricNodeBase {
 	
@@ -56,8 +61,11 @@ public:
 	
 protected:
 	friend class Pcb;
+	friend struct LinkBase;
 	friend class LinkBaseMap;
 	friend class Machine;  // Allow Machine to access connections for topological sort
+	friend class CompiledSchedule;
+	friend class PackedNetlist;
 	
 	Pcb* pcb = 0;
 	ElectricNodeBase* ptr = 0;
@@ -71,6 +79,11 @@ protected:
 	int src_count = 0;
 	int bi_count = 0;
 	
+	// Event-driven scheduling, filled by LinkBaseMap::UpdateFanout
+	Vector<int> fanout;  // rt_ops indices of the WRITE ops this node drives
+	Vector<int> clearing_fanin;  // WRITE ops into this node that it clears after use
+	int tick_op = -1;    // rt_ops index of this node's TICK op
+	int order = -1;      // position in the machine's node lists, for address-free sorting
 	
 	
 
@@ -78,6 +91,29 @@ protected:
 	Connector& AddSink(String name);
 	Connector& AddBidirectional(String name);
 	
+public:
+	typedef bool (*TickFn)(ElectricNodeBase&);
+	
+	// Storage behind a connector, for the compiled schedule to copy bits directly
+	struct PinStorage {
+		byte* data = 0;
+		int bit = 0;  // bit offset of the pin inside *data
+	};
+	
+	// Logic function of plain single-output gates, for the packed netlist
+	typedef enum : byte {
+		GATE_NONE,
+		GATE_NOT,
+		GATE_NAND,
+		GATE_NOR,
+		GATE_XOR,
+		GATE_XNOR,
+	} GateOp;
+	
+protected:
+	static bool SetPinStorage(bool& b, PinStorage& s) {s.data = (byte*)&b; s.bit = 0; return true;}
+	static bool SetPinStorage(byte& b, PinStorage& s) {s.data = &b; s.bit = 0; return true;}
+	
 public:
 	typedef ElectricNodeBase CLASSNAME;
 	ElectricNodeBase();
@@ -108,6 +144,27 @@ public:
 	
 	virtual int GetMemorySize() const {return 0;}
 	virtual int GetFixedPriority() const {return -1;}
+	// Combinational nodes have no state of their own: their outputs depend only on the
+	// current inputs, so the event-driven scheduler ticks them only when an input changed.
+	// They must keep their inputs across ticks, as unchanged writes into them are dropped.
+	virtual bool IsCombinational() const {return false;}
+	// Nodes may expose the byte holding a pin's value, but only where Process/PutRaw on
+	// that connector do nothing except load/store it and Tick never clears it. Returns
+	// false to keep the calls.
+	virtual bool GetPinStorage(uint16 conn_id, PinStorage& s) {return false;}
+	// Non-virtual entry point for Tick, normally &DirectTick<Class>
+	virtual TickFn GetTickFn() const {return 0;}
+	// Gates whose Tick is exactly out = op(inputs) report it here. Inputs must be
+	// connectors 0..n-1 and the output connector n, all exposed by GetPinStorage.
+	virtual GateOp GetGateOp() const {return GATE_NONE;}
+	// Snapshot support: stores, or loads when s.IsLoading(), the node's own state. Pin
+	// values exposed by GetPinStorage are saved by Machine::SerializeState already.
+	virtual void SerializeState(Stream& s) {}
+	// Large memories are saved by Machine page by page instead, so that delta snapshots
+	// hold only the pages written since the previous snapshot. Returns the memory and
+	// a bitmap with one bit per STATE_PAGE_SIZE bytes, or 0 for nodes without one.
+	static const int STATE_PAGE_SIZE = 256;
+	virtual byte* GetStateMemory(int& size, Vector<uint64>*& dirty) {return 0;}
 private:
 	bool has_changed = true;  // Default to true to ensure first update
 	int delay_ticks = 0;  // Propagation delay for this component in simulation ticks
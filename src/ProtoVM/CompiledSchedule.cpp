@@ -0,0 +1,73 @@
+#include "ProtoVM.h"
+
+
+
+
+void CompiledSchedule::Clear() {
+	ops.SetCount(0);
+	ticks.SetCount(0);
+	early_ops.SetCount(0);
+	copy_count = 0;
+	direct_tick_count = 0;
+}
+
+bool CompiledSchedule::Compile(const LinkBaseMap& l) {
+	Clear();
+	ops.Reserve(l.rt_ops.GetCount());
+	
+	for(int i = 0; i < l.rt_ops.GetCount(); i++) {
+		const ProcessOp& op = l.rt_ops[i];
+		CompiledOp& c = ops.Add();
+		c.index = i;
+		
+		if (op.type == TICK) {
+			c.kind = CompiledOp::CALL_TICK;
+			c.index = ticks.GetCount();
+			CompiledTick& t = ticks.Add();
+			t.node = op.dest;
+			t.fn = op.dest->GetTickFn();
+			if (t.fn)
+				direct_tick_count++;
+			continue;
+		}
+		
+		if (op.type != WRITE) {
+			LOG("CompiledSchedule::Compile: unhandled ProcessType");
+			return false;
+		}
+		
+		ASSERT(op.processor);
+		if (op.dest->tick_op >= 0 && op.dest->tick_op < i)
+			c.flags |= CompiledOp::FEEDBACK;
+		if (op.processor->tick_op > i) {
+			c.flags |= CompiledOp::EARLY;
+			early_ops.Add(ops.GetCount() - 1);
+		}
+		
+		ElcBase::PinStorage src, dst;
+		if (op.mem_bytes == 0 && op.mem_bits == 1 &&
+			op.src && op.src->is_src && op.sink && op.sink->is_sink &&
+			op.processor->GetPinStorage(op.id, src) &&
+			op.dest->GetPinStorage(op.dest_id, dst)) {
+			c.kind = CompiledOp::COPY_BIT;
+			c.src = src.data;
+			c.src_bit = src.bit;
+			c.dst = dst.data;
+			c.dst_bit = dst.bit;
+			copy_count++;
+		}
+		else {
+			c.kind = CompiledOp::CALL_WRITE;
+		}
+	}
+	
+	return true;
+}
+
+String CompiledSchedule::ToString() const {
+	String s;
+	s << ops.GetCount() << " ops, " << copy_count << " bit copies, "
+	  << ticks.GetCount() << " ticks (" << direct_tick_count << " direct), "
+	  << early_ops.GetCount() << " early writes";
+	return s;
+}
@@ -0,0 +1,55 @@
+#ifndef _ProtoVM_CompiledSchedule_h_
+#define _ProtoVM_CompiledSchedule_h_
+
+
+
+
+// One instruction of the compiled schedule. Single-bit links between nodes that expose
+// their pin storage are lowered to a plain bit copy; everything else still goes
+// through the virtual Process/Tick calls of the original ProcessOp.
+struct CompiledOp : Moveable<CompiledOp> {
+	typedef enum : byte {
+		COPY_BIT,
+		CALL_WRITE,
+		CALL_TICK,
+	} Kind;
+	
+	typedef enum : byte {
+		FEEDBACK = 1,  // sink has already ticked when this write runs
+		EARLY    = 2,  // processor ticks after this write runs
+	} Flag;
+	
+	Kind kind = CALL_WRITE;
+	byte flags = 0;
+	byte src_bit = 0;
+	byte dst_bit = 0;
+	byte last = 0xFF;      // COPY_BIT: last delivered bit, 0xFF before the first write
+	byte* src = 0;
+	byte* dst = 0;
+	int index = -1;        // rt_ops index, or CompiledSchedule::ticks index for CALL_TICK
+};
+
+struct CompiledTick : Moveable<CompiledTick> {
+	ElcBase* node = 0;
+	ElcBase::TickFn fn = 0;  // non-virtual entry point, or 0 to call node->Tick()
+};
+
+class CompiledSchedule {
+public:
+	Vector<CompiledOp> ops;
+	Vector<CompiledTick> ticks;
+	Vector<int> early_ops;  // indices into ops of the EARLY writes
+	int copy_count = 0;
+	int direct_tick_count = 0;
+	
+	void Clear();
+	bool Compile(const LinkBaseMap& l);
+	bool IsEmpty() const {return ops.IsEmpty();}
+	String ToString() const;
+	
+};
+
+
+
+
+#endif
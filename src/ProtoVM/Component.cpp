@@ -42,6 +42,13 @@ bool Pin::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) {
 	return true;  // Always return true to avoid Process failures
 }
 
+bool Pin::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	// Both the reference source and the bidirectional pin live in is_high
+	if (conn_id == 0)
+		return SetPinStorage(is_high, s);
+	return false;
+}
+
 int Pin::GetFixedPriority() const {
 	return is_high ? INT_MAX : 0;
 }
@@ -145,6 +152,10 @@ bool FlipFlopD::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits
 	return true;
 }
 
+void FlipFlopD::SerializeState(Stream& s) {
+	s % d % clk % q % qn % en % clr % last_clk;
+}
+
 
 
 
@@ -208,6 +219,15 @@ bool ElcNor::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) {
 	return true;
 }
 
+bool ElcNor::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	switch (conn_id) {
+	case 0: return SetPinStorage(in0, s);
+	case 1: return SetPinStorage(in1, s);
+	case 2: return SetPinStorage(out, s);
+	default: return false;
+	}
+}
+
 ElcNand::ElcNand() {
 	AddSink("I0");
 	AddSink("I1");
@@ -263,6 +283,15 @@ bool ElcNand:: PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits)
 	return true;
 }
 
+bool ElcNand::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	switch (conn_id) {
+	case 0: return SetPinStorage(in0, s);
+	case 1: return SetPinStorage(in1, s);
+	case 2: return SetPinStorage(out, s);
+	default: return false;
+	}
+}
+
 ElcNot::ElcNot() {
 	AddSink("I");
 	AddSource("O").SetMultiConn();
@@ -312,6 +341,14 @@ bool ElcNot::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) {
 	return true;
 }
 
+bool ElcNot::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	switch (conn_id) {
+	case 0: return SetPinStorage(in, s);
+	case 1: return SetPinStorage(out, s);
+	default: return false;
+	}
+}
+
 ElcXor::ElcXor() {
 	AddSink("I0");
 	AddSink("I1");
@@ -366,6 +403,15 @@ bool ElcXor::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) {
 	return true;
 }
 
+bool ElcXor::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	switch (conn_id) {
+	case 0: return SetPinStorage(in0, s);
+	case 1: return SetPinStorage(in1, s);
+	case 2: return SetPinStorage(out, s);
+	default: return false;
+	}
+}
+
 ElcXnor::ElcXnor() {
 	AddSink("I0");
 	AddSink("I1");
@@ -420,6 +466,15 @@ bool ElcXnor::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits)
 	return true;
 }
 
+bool ElcXnor::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	switch (conn_id) {
+	case 0: return SetPinStorage(in0, s);
+	case 1: return SetPinStorage(in1, s);
+	case 2: return SetPinStorage(out, s);
+	default: return false;
+	}
+}
+
 Mux2to1::Mux2to1() {
 	AddSink("I0");      // Input 0
 	AddSink("I1");      // Input 1
@@ -478,6 +533,16 @@ bool Mux2to1::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits)
 	return true;
 }
 
+bool Mux2to1::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	switch (conn_id) {
+	case 0: return SetPinStorage(in0, s);
+	case 1: return SetPinStorage(in1, s);
+	case 2: return SetPinStorage(sel, s);
+	case 3: return SetPinStorage(out, s);
+	default: return false;
+	}
+}
+
 Mux4to1::Mux4to1() {
 	AddSink("I0");      // Input 0
 	AddSink("I1");      // Input 1
@@ -560,6 +625,16 @@ bool Mux4to1::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits)
 	return true;
 }
 
+bool Mux4to1::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	if (conn_id < 4)
+		return SetPinStorage(in[conn_id], s);
+	if (conn_id >= 4 && conn_id < 6)
+		return SetPinStorage(sel[conn_id - 4], s);
+	if (conn_id == 6)
+		return SetPinStorage(out, s);
+	return false;
+}
+
 Demux1to2::Demux1to2() {
 	AddSink("I");       // Input
 	AddSink("SEL");     // Select line
@@ -623,6 +698,16 @@ bool Demux1to2::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits
 	return true;
 }
 
+bool Demux1to2::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	if (conn_id == 0)
+		return SetPinStorage(input, s);
+	if (conn_id == 1)
+		return SetPinStorage(sel, s);
+	if (conn_id >= 2 && conn_id < 4)
+		return SetPinStorage(out[conn_id - 2], s);
+	return false;
+}
+
 Demux1to4::Demux1to4() {
 	AddSink("I");       // Input
 	AddSink("S0");      // Select line 0
@@ -701,6 +786,16 @@ bool Demux1to4::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits
 	return true;
 }
 
+bool Demux1to4::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	if (conn_id == 0)
+		return SetPinStorage(input, s);
+	if (conn_id >= 1 && conn_id < 3)
+		return SetPinStorage(sel[conn_id - 1], s);
+	if (conn_id >= 3 && conn_id < 7)
+		return SetPinStorage(out[conn_id - 3], s);
+	return false;
+}
+
 Decoder2to4::Decoder2to4() {
 	AddSink("A0");      // Input bit 0
 	AddSink("A1");      // Input bit 1
@@ -784,6 +879,16 @@ bool Decoder2to4::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bi
 	return true;
 }
 
+bool Decoder2to4::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	if (conn_id < 2)
+		return SetPinStorage(in[conn_id], s);
+	if (conn_id == 2)
+		return SetPinStorage(en, s);
+	if (conn_id >= 3 && conn_id < 7)
+		return SetPinStorage(out[conn_id - 3], s);
+	return false;
+}
+
 Decoder3to8::Decoder3to8() {
 	AddSink("A0");      // Input bit 0
 	AddSink("A1");      // Input bit 1
@@ -889,6 +994,16 @@ bool Decoder3to8::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bi
 	return true;
 }
 
+bool Decoder3to8::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	if (conn_id < 3)
+		return SetPinStorage(in[conn_id], s);
+	if (conn_id == 3)
+		return SetPinStorage(en, s);
+	if (conn_id >= 4 && conn_id < 12)
+		return SetPinStorage(out[conn_id - 4], s);
+	return false;
+}
+
 Encoder4to2::Encoder4to2() {
 	AddSink("I0");      // Input 0
 	AddSink("I1");      // Input 1
@@ -973,6 +1088,16 @@ bool Encoder4to2::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bi
 	return true;
 }
 
+bool Encoder4to2::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	if (conn_id < 4)
+		return SetPinStorage(in[conn_id], s);
+	if (conn_id >= 4 && conn_id < 6)
+		return SetPinStorage(out[conn_id - 4], s);
+	if (conn_id == 6)
+		return SetPinStorage(valid, s);
+	return false;
+}
+
 Encoder8to3::Encoder8to3() {
 	AddSink("I0");      // Input 0
 	AddSink("I1");      // Input 1
@@ -1086,6 +1211,16 @@ bool Encoder8to3::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bi
 	return true;
 }
 
+bool Encoder8to3::GetPinStorage(uint16 conn_id, PinStorage& s) {
+	if (conn_id < 8)
+		return SetPinStorage(in[conn_id], s);
+	if (conn_id >= 8 && conn_id < 11)
+		return SetPinStorage(out[conn_id - 8], s);
+	if (conn_id == 11)
+		return SetPinStorage(valid, s);
+	return false;
+}
+
 ElcCapacitor::ElcCapacitor() {
 	AddSink("I");
 	AddSource("O").SetMultiConn();
@@ -1892,6 +2027,12 @@ bool Register4Bit::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_b
 	return true;
 }
 
+void Register4Bit::SerializeState(Stream& s) {
+	s.SerializeRaw((byte*)d, sizeof(d));
+	s.SerializeRaw((byte*)q, sizeof(q));
+	s % clk % en % clr % last_clk;
+}
+
 
 
 
@@ -15,6 +15,7 @@ struct Pin : public ElcBase {
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
 	int GetFixedPriority() const override;
 };
 
@@ -90,6 +91,10 @@ class ElcNor : public ElcBase {
 public:
 	ElcNor();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<ElcNor>;}
+	GateOp GetGateOp() const override {return GATE_NOR;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -105,6 +110,10 @@ class ElcNand : public ElcBase {
 public:
 	ElcNand();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<ElcNand>;}
+	GateOp GetGateOp() const override {return GATE_NAND;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -119,6 +128,10 @@ class ElcNot : public ElcBase {
 public:
 	ElcNot();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<ElcNot>;}
+	GateOp GetGateOp() const override {return GATE_NOT;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -133,6 +146,10 @@ class ElcXor : public ElcBase {
 public:
 	ElcXor();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<ElcXor>;}
+	GateOp GetGateOp() const override {return GATE_XOR;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -147,6 +164,10 @@ class ElcXnor : public ElcBase {
 public:
 	ElcXnor();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<ElcXnor>;}
+	GateOp GetGateOp() const override {return GATE_XNOR;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -163,6 +184,9 @@ class Mux2to1 : public ElcBase {
 public:
 	Mux2to1();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<Mux2to1>;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -178,6 +202,9 @@ class Mux4to1 : public ElcBase {
 public:
 	Mux4to1();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<Mux4to1>;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -193,6 +220,9 @@ class Demux1to2 : public ElcBase {
 public:
 	Demux1to2();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<Demux1to2>;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -208,6 +238,9 @@ class Demux1to4 : public ElcBase {
 public:
 	Demux1to4();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<Demux1to4>;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -223,6 +256,9 @@ class Decoder2to4 : public ElcBase {
 public:
 	Decoder2to4();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<Decoder2to4>;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -238,6 +274,9 @@ class Decoder3to8 : public ElcBase {
 public:
 	Decoder3to8();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<Decoder3to8>;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -253,6 +292,9 @@ class Encoder4to2 : public ElcBase {
 public:
 	Encoder4to2();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<Encoder4to2>;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -268,6 +310,9 @@ class Encoder8to3 : public ElcBase {
 public:
 	Encoder8to3();
 	
+	bool IsCombinational() const override {return true;}
+	bool GetPinStorage(uint16 conn_id, PinStorage& s) override;
+	TickFn GetTickFn() const override {return &DirectTick<Encoder8to3>;}
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
@@ -435,6 +480,7 @@ public:
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
+	void SerializeState(Stream& s) override;
 };
 class Register4Bit : public ElcBase {
 	//RTTI_DECL1(Register4Bit, ElcBase);
@@ -451,6 +497,7 @@ public:
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
+	void SerializeState(Stream& s) override;
 };
 
 #include "TubeLogic.h"
@@ -316,6 +316,113 @@ bool FaultInjectionManager::VerifyFaultTolerance(const String& test_name, int ma
     return true;
 }
 
+int FaultInjectionManager::RunStuckAtCampaign(const Vector<Vector<byte>>& patterns, const Vector<int>& input_nets, const Vector<int>& output_nets) {
+    if (!machine || machine->GetPackedNetlist().IsEmpty()) {
+        LOG("Stuck-at campaign needs a machine with a packed netlist (use_packed_nets)");
+        return -1;
+    }
+    const PackedNetlist& nl = machine->GetPackedNetlist();
+    
+    // Resolve the scheduled stuck-at faults to nets
+    Vector<int> fault_index, fault_net;
+    for (int i = 0; i < scheduled_faults.GetCount(); i++) {
+        const FaultDescriptor& fault = scheduled_faults[i];
+        if (fault.fault_type != FAULT_STUCK_AT_0 && fault.fault_type != FAULT_STUCK_AT_1)
+            continue;
+        int net = nl.FindNet(fault.component_name, fault.pin_name);
+        if (net < 0) {
+            LOG("Skipping fault " << fault.fault_id << ": " << fault.component_name << "."
+                 << fault.pin_name << " is not a packed net");
+            continue;
+        }
+        fault_index.Add(i);
+        fault_net.Add(net);
+    }
+    
+    LaneNetlist sim;
+    sim.Init(nl);
+    const int per_pass = LaneNetlist::LANES - 1;
+    int detected_count = 0, unknown_count = 0;
+    
+    for (int first = 0; first < fault_index.GetCount(); first += per_pass) {
+        int count = min(per_pass, fault_index.GetCount() - first);
+        uint64 batch_mask = (count == 63 ? ~(uint64)0 : (((uint64)1 << (count + 1)) - 1)) & ~(uint64)1;
+        
+        sim.ClearForces();
+        for (int i = 0; i < count; i++) {
+            const FaultDescriptor& fault = scheduled_faults[fault_index[first + i]];
+            sim.Force(fault_net[first + i], (uint64)1 << (i + 1), fault.fault_type == FAULT_STUCK_AT_1);
+        }
+        
+        uint64 detected = 0, unknown = 0;
+        Vector<int> detected_at, unknown_at;
+        detected_at.SetCount(count + 1, -1);
+        unknown_at.SetCount(count + 1, -1);
+        for (int p = 0; p < patterns.GetCount() && (detected & batch_mask) != batch_mask; p++) {
+            // Every lane sees the same pattern
+            for (int b = 0; b < input_nets.GetCount(); b++) {
+                bool bit = b / 8 < patterns[p].GetCount() && ((patterns[p][b / 8] >> (b % 8)) & 1);
+                sim.SetLanes(input_nets[b], bit ? ~(uint64)0 : 0);
+            }
+            
+            // Outputs of a lane that did not settle say nothing about its fault, and
+            // without a settled lane 0 there is nothing to compare against
+            uint64 settled = ~(uint64)0;
+            if (!sim.Eval()) {
+                LOG("Warning: lanes did not settle for pattern " << p);
+                settled = (sim.unsettled & 1) ? 0 : ~sim.unsettled;
+            }
+            uint64 fresh_unknown = batch_mask & ~settled & ~detected & ~unknown;
+            for (int lane = 1; lane <= count; lane++)
+                if ((fresh_unknown >> lane) & 1)
+                    unknown_at[lane] = p;
+            unknown |= fresh_unknown;
+            
+            // A fault is detected when its lane differs from the fault-free lane 0
+            uint64 diff = 0;
+            for (int net : output_nets) {
+                uint64 v = sim.GetLanes(net);
+                diff |= v ^ ((v & 1) ? ~(uint64)0 : 0);
+            }
+            uint64 fresh = diff & settled & batch_mask & ~detected;
+            for (int lane = 1; lane <= count; lane++)
+                if ((fresh >> lane) & 1)
+                    detected_at[lane] = p;
+            detected |= fresh;
+        }
+        
+        // A fault that was never detected but oscillated on some pattern may or may
+        // not be detectable, so it is reported as unknown rather than undetected
+        for (int i = 0; i < count; i++) {
+            bool is_detected = detected_at[i + 1] >= 0;
+            if (!is_detected && unknown_at[i + 1] < 0)
+                continue;
+            const FaultDescriptor& fault = scheduled_faults[fault_index[first + i]];
+            FaultInjectionResult result;
+            result.fault_id = fault.fault_id;
+            result.fault_description = String().Cat() << "Stuck-at-" << (fault.fault_type == FAULT_STUCK_AT_1 ? 1 : 0)
+                                       << " on " << fault.component_name << "." << fault.pin_name;
+            result.caused_failure = is_detected;
+            if (is_detected) {
+                result.failure_type = "Output mismatch";
+                result.tick_of_failure = detected_at[i + 1];  // index of the first detecting pattern
+                detected_count++;
+            }
+            else {
+                result.failure_type = "Oscillating (unknown)";
+                result.tick_of_failure = unknown_at[i + 1];  // index of the first unsettled pattern
+                unknown_count++;
+            }
+            results.Add(result);
+        }
+    }
+    
+    LOG("Stuck-at campaign: " << detected_count << " of " << fault_index.GetCount()
+         << " faults detected, " << unknown_count << " unknown (oscillating) with "
+         << patterns.GetCount() << " patterns");
+    return detected_count;
+}
+
 void FaultInjectionManager::RunFaultToleranceTests() {
     LOG("Running comprehensive fault tolerance tests...");
     
@@ -94,6 +94,15 @@ public:
     // Verification methods
     bool VerifyFaultTolerance(const String& test_name, int max_ticks = 1000);
     void RunFaultToleranceTests();
+    
+    // Stuck-at campaign on the machine's packed netlist: lane 0 is the fault-free
+    // circuit and every other lane carries one scheduled stuck-at fault, so 63 faults
+    // are simulated per pass. Input bits map to input_nets (LSB of pattern[0] first).
+    // A fault on an input pin only affects that pin (see PackedNetlist::FindNet). Faults
+    // whose lane oscillated before being detected get an "Oscillating (unknown)" result
+    // with caused_failure unset; undetected faults get no result.
+    // Returns the number of faults detected at output_nets, or -1 on error.
+    int RunStuckAtCampaign(const Vector<Vector<byte>>& patterns, const Vector<int>& input_nets, const Vector<int>& output_nets);
 };
 
 // Specialized fault injectors for specific fault types
@@ -311,6 +311,17 @@ bool IC4004::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) {
     return true;
 }
 
+void IC4004::SerializeState(Stream& s) {
+    s.SerializeRaw(registers, sizeof(registers));
+    s.SerializeRaw(stack, sizeof(stack));
+    s % accumulator % stack_pointer % program_counter % address_register;
+    s % carry_flag % aux_carry_flag % test_mode;
+    s % current_instruction % instruction_cycle % is_executing;
+    s % memory_read_active % memory_write_active % is_reading;
+    s % in_data % in_addr % in_pins % in_pins_mask;
+    s % current_cycle % total_cycles % clock_divider % clock_count;
+}
+
 void IC4004::SetPin(int i, bool b) {
     uint32 mask = 1UL << i;
     if (b)
@@ -221,6 +221,15 @@ bool IC6502::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) {
 	return true;
 }
 
+void IC6502::SerializeState(Stream& s) {
+	// m6502_t is plain data: registers, pins and the decoder position
+	s.SerializeRaw((byte*)&cpu, sizeof(cpu));
+	s.SerializeRaw((byte*)&pins, sizeof(pins));
+	s.SerializeRaw((byte*)&in_pins, sizeof(in_pins));
+	s.SerializeRaw((byte*)&in_pins_mask, sizeof(in_pins_mask));
+	s % reading % sync % in_data % in_addr;
+}
+
 void IC6502::SetPin(int i, bool b) {
 	uint64 mask = 1ULL << (uint64)i;
 	if (b)
@@ -10,6 +10,9 @@ ICMem8Base::ICMem8Base(byte* data, int size, bool writable) {
 	
 	memset(data, 0, size);
 	
+	int pages = (size + STATE_PAGE_SIZE - 1) / STATE_PAGE_SIZE;
+	dirty_pages.SetCount((pages + 63) / 64, 0);
+	
 	// NOTE: incorrect order for any real package
 	
 	AddSink("A0"); // 0
@@ -60,6 +63,7 @@ bool ICMem8Base::Tick() {
 	
 	if (writing && addr < size) {
 		data[addr] = in_data;
+		MarkDirty(addr);
 	}
 	
 	if (verbose) {
@@ -188,6 +192,20 @@ bool ICMem8Base::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bit
 	return true;
 }
 
+void ICMem8Base::SerializeState(Stream& s) {
+	s % addr % writing % reading % enabled;
+	s % in_data % in_addr % in_writing % in_reading % in_enabled;
+}
+
+byte* ICMem8Base::GetStateMemory(int& size, Vector<uint64>*& dirty) {
+	// ROM contents come with the circuit, only RAM is part of the state
+	if (!writable)
+		return 0;
+	size = this->size;
+	dirty = &dirty_pages;
+	return data;
+}
+
 
 
 
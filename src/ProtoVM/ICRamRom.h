@@ -29,12 +29,18 @@ protected:
 	bool in_reading = 0;
 	bool in_enabled = 0;
 	
+	Vector<uint64> dirty_pages;  // pages written since the last snapshot, see GetStateMemory
+	
+	void MarkDirty(int a) {dirty_pages[a / STATE_PAGE_SIZE / 64] |= (uint64)1 << (a / STATE_PAGE_SIZE % 64);}
+	
 public:
 	ICMem8Base(byte* data, int size, bool writable);
 	
 	bool Tick() override;
 	bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override;
 	bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
+	void SerializeState(Stream& s) override;
+	byte* GetStateMemory(int& size, Vector<uint64>*& dirty) override;
 };
 
 
@@ -124,6 +130,7 @@ public:
         }
         if (addr >= 0 && addr < size) {
             memory[addr] = value;
+            MarkDirty(addr);
             return true;
         }
         LOG("ICRamRom::WriteByte: Address out of bounds: 0x" << HexStr(addr));
@@ -9,11 +9,12 @@ LinkBase::LinkBase() {
 
 bool LinkBase::operator()(const LinkBase& a, const LinkBase& b) const {
 	//if (a.layer != b.layer) return a.layer < b.layer;
-	if (a.sink->base != b.sink->base) return a.sink->base < b.sink->base;
+	// Node and link order instead of addresses, so that equal circuits get equal schedules
+	if (a.sink->base != b.sink->base) return a.sink->base->order < b.sink->base->order;
 	if (a.sink->id != b.sink->id) return a.sink->id < b.sink->id;
-	if (a.src->base != b.src->base) return a.src->base < b.src->base;
+	if (a.src->base != b.src->base) return a.src->base->order < b.src->base->order;
 	if (a.src->id != b.src->id) return a.src->id < b.src->id;
-	return &a < &b;
+	return a.order < b.order;
 }
 
 String LinkBase::ToString() const {
@@ -334,9 +335,53 @@ bool LinkBaseMap::UpdateProcess() {
 		// DUMPC(rt_ops); // Commented out to reduce verbosity
 	}
 	
+	UpdateFanout();
+	
 	return true;
 }
 
+void LinkBaseMap::UpdateFanout() {
+	// Note: UnitOps::read_ops/write_ops may point to ops removed by the byte merge,
+	// so the fanout is built from the final rt_ops order instead.
+	stateful_tick_ops.SetCount(0);
+	early_write_ops.SetCount(0);
+	for (UnitOps& unit : units.GetValues()) {
+		unit.unit->fanout.SetCount(0);
+		unit.unit->clearing_fanin.SetCount(0);
+		unit.unit->tick_op = -1;
+	}
+	
+	for(int i = 0; i < rt_ops.GetCount(); i++) {
+		ProcessOp& op = rt_ops[i];
+		if (op.type == TICK) {
+			op.dest->tick_op = i;
+			if (!op.dest->IsCombinational())
+				stateful_tick_ops.Add(i);
+		}
+	}
+	
+	for(int i = 0; i < rt_ops.GetCount(); i++) {
+		ProcessOp& op = rt_ops[i];
+		if (op.type == WRITE) {
+			ASSERT(op.processor);
+			op.processor->fanout.Add(i);
+			
+			// Cycles and bidirectional links leave writes ahead of the tick that
+			// produces their value, so they deliver the previous output.
+			if (op.processor->tick_op > i)
+				early_write_ops.Add(i);
+			
+			// Sinks like IC6502 or ICMem8Base latch their inputs and clear them in Tick,
+			// so they need every write, changed or not. Only combinational units and
+			// plain pin storage are known to hold the last value.
+			ElectricNodeBase::PinStorage ps;
+			op.sink_retains = op.dest->IsCombinational() || op.dest->GetPinStorage(op.dest_id, ps);
+			if (!op.sink_retains)
+				op.dest->clearing_fanin.Add(i);
+		}
+	}
+}
+
 #else
 void LinkBaseMap::UpdateLinkBaseLayers() {
 	for (LinkBase& l : links)
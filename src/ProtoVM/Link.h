@@ -8,6 +8,7 @@ struct LinkBase {
 	LinkBase* to = 0;
 	ElectricNodeBase::Connector* sink = 0;
 	ElectricNodeBase::Connector* src = 0;
+	int order = -1;
 	
 	typedef LinkBase CLASSNAME;
 	LinkBase();
@@ -31,6 +32,7 @@ struct ProcessOp {
 	int mem_bits = 0;
 	int mem_bytes = 0;
 	//int mem_id = -1;
+	bool sink_retains = false; // WRITE: the sink keeps the value until it is written again
 	
 	bool operator()(const ProcessOp& a, const ProcessOp& b) const;
 	bool IsBiDir() const {return type == WRITE && successor != 0;}
@@ -55,10 +57,13 @@ public:
 	Array<LinkBase> links;
 	Array<ProcessOp> rt_ops;
 	VectorMap<size_t, UnitOps> units;
+	Vector<int> stateful_tick_ops;  // TICK ops of non-combinational units, run on every tick
+	Vector<int> early_write_ops;    // WRITE ops scheduled before their processor's TICK op
 	
 	
 	void UpdateLinkBaseLayers();
 	bool UpdateProcess();
+	void UpdateFanout();
 	//void GetLayerRange(const ElectricNodeBase& n, int& min, int& max);
 	
 };
@@ -128,6 +128,8 @@ Vector<ElectricNodeBase*>& ElectricNodeBase::GetDependencies() {
 void ElectricNodeBase::SetClockDomain(int domain_id, int freq_hz) {
 	clock_domain_id = domain_id;
 	clock_frequency_hz = freq_hz;
+	if (pcb && pcb->mach)
+		pcb->mach->InvalidateFeatures();
 }
 
 int ElectricNodeBase::GetClockDomainId() const {
@@ -141,6 +143,15 @@ int ElectricNodeBase::GetClockFrequency() const {
 
 bool Machine::Init() {
 	
+	// Tick runs the rt_ops with exactly one scheduler, see the flags in Machine.h
+	int schedulers = (int)use_topological_ordering + (int)use_partitions + (int)use_event_driven +
+	                 (int)use_compiled_schedule + (int)use_packed_nets;
+	if (schedulers > 1) {
+		LOG("Machine::Init: use_topological_ordering, use_partitions, use_event_driven, "
+			"use_compiled_schedule and use_packed_nets can't be combined");
+		return false;
+	}
+	
 	// Check that all pins are connected
 	for (Pcb& pcb : pcbs) {
 		if (!pcb.IsAllConnected()) {
@@ -150,6 +161,13 @@ bool Machine::Init() {
 	}
 	// LOG("Machine::Init: all pcbs fully connected!"); // Commented out to reduce verbosity
 	
+	int order = 0;
+	for (Pcb& pcb : pcbs) {
+		for (ElectricNodeBase& n : pcb.nodes)
+			n.order = order++;
+		for (ElectricNodeBase& n : pcb.refs)
+			n.order = order++;
+	}
 	for (Pcb& pcb : pcbs) {
 		pcb.GetLinkBases(l.links);
 	}
@@ -159,6 +177,52 @@ bool Machine::Init() {
 	if (!l.UpdateProcess())
 		return false;
 	
+	// Registered analog components are ticked by the analog simulation; the digital
+	// schedule only keeps their writes at the A/D boundaries. A write between two of
+	// them would put a logic level over the solved voltage of their shared net.
+	if (!analog_components.IsEmpty()) {
+		Index<size_t> analog;
+		for (AnalogNodeBase* component : analog_components)
+			analog.FindAdd((size_t)static_cast<ElcBase*>(component));
+		Vector<int> rm_list;
+		for(int i = 0; i < l.rt_ops.GetCount(); i++) {
+			const ProcessOp& op = l.rt_ops[i];
+			if (analog.Find((size_t)op.dest) < 0)
+				continue;
+			if (op.type == ProcessType::TICK ||
+				(op.type == ProcessType::WRITE && analog.Find((size_t)op.processor) >= 0))
+				rm_list.Add(i);
+		}
+		if (!rm_list.IsEmpty()) {
+			l.rt_ops.Remove(rm_list);
+			l.UpdateFanout();
+		}
+	}
+	
+	event_full_sweep = true;
+	
+	// The compiled schedule points into rt_ops and node storage, so it is rebuilt with them
+	compiled.Clear();
+	if (use_compiled_schedule && !CompileSchedule())
+		return false;
+	packed.Clear();
+	if (use_packed_nets && !BuildPackedNetlist())
+		return false;
+	tick_levels.Clear();
+	tick_levels_built = false;
+	if (use_topological_ordering)
+		BuildTickLevels();
+	partitions.Clear();
+	partitions_built = false;
+	if (use_partitions && !BuildPartitions())
+		return false;
+	features_dirty = true;
+	snapshot_records.Clear();
+	
+	// The analog nets follow the links, which may have changed since registration
+	if (analog_sim)
+		analog_sim->InvalidateTopology();
+	
 	RunInitOps();
 	
 	return true;
@@ -175,6 +239,25 @@ bool Machine::RunInitOps() {
 }
 
 bool Machine::RunRtOps() {
+	if (use_packed_nets) {
+		bool changed = false;
+		if (packed.op_flags.GetCount() != l.rt_ops.GetCount() && !BuildPackedNetlist())
+			return false;
+		return RunPacked(changed);
+	}
+	if (use_compiled_schedule) {
+		bool changed = false;
+		if (compiled.IsEmpty() && !CompileSchedule())
+			return false;
+		return RunCompiled(changed);
+	}
+	if (use_partitions) {
+		bool changed = false;
+		if (!partitions_built && !BuildPartitions())
+			return false;
+		return RunPartitioned(changed);
+	}
+	
 	int op_i = 0;
 	for (const ProcessOp& op : l.rt_ops) {
 		switch (op.type) {
@@ -207,6 +290,9 @@ bool Machine::Tick() {
 			return false;
 	}*/
 	
+	if (features_dirty)
+		UpdateFeatures();
+	
 	// Process any delayed events scheduled for this tick
 	ProcessDelayedEvents();
 	
@@ -214,19 +300,24 @@ bool Machine::Tick() {
 	current_tick++;
 	
 	// Simulate clock domains to update their states
-	SimulateClockDomains();
+	if (features & FEATURE_CLOCK_DOMAINS)
+		SimulateClockDomains();
 	
 	// Check for clock domain crossings if needed
 	// For now, we'll perform this check periodically, maybe every N ticks
 	// In a real implementation, this might be configurable
-	if (current_tick % 100 == 0) {  // Check every 100 ticks
+	if ((features & FEATURE_DOMAIN_CROSSINGS) && current_tick % 100 == 0) {  // Check every 100 ticks
 		CheckClockDomainCrossings();
 	}
 	
-	// Run the analog simulation first to update analog voltages
-	if (!RunAnalogSimulation()) {
-		LOG("Error: Analog simulation failed at tick " << current_tick);
-		return false;
+	// Run the analog simulation first to update analog voltages, and hand the
+	// threshold crossings it found to the digital side of this tick
+	if (features & FEATURE_ANALOG) {
+		if (!RunAnalogSimulation()) {
+			LOG("Error: Analog simulation failed at tick " << current_tick);
+			return false;
+		}
+		HandleAnalogDigitalInterface();
 	}
 	
 	// Implement convergence-based simulation to handle feedback loops and signal propagation
@@ -235,16 +326,48 @@ bool Machine::Tick() {
 	const int max_iterations = 1000; // Prevent infinite loops in oscillating circuits
 	
 	// Track if we've seen the same state to detect oscillations
-	Vector<uint64> state_history;
+	state_history.SetCount(0);
 	const int max_state_history = 10; // Only track last 10 states for oscillation detection
 	
+	if (use_event_driven)
+		SeedEvents();
+	else if (use_packed_nets && packed.op_flags.GetCount() != l.rt_ops.GetCount() && !BuildPackedNetlist())
+		return false;
+	else if (use_compiled_schedule && compiled.IsEmpty() && !l.rt_ops.IsEmpty() && !CompileSchedule())
+		return false;
+	else if (use_partitions && !partitions_built && !BuildPartitions())
+		return false;
+	
 	while (changed && iteration < max_iterations) {
 		changed = false;
-		if (!RunRtOpsWithChangeDetection(changed))
+		if (use_event_driven) {
+			if (!RunEventDriven(changed))
+				return false;
+		}
+		else if (use_packed_nets) {
+			if (!RunPacked(changed))
+				return false;
+		}
+		else if (use_compiled_schedule) {
+			if (!RunCompiled(changed))
+				return false;
+		}
+		else if (use_partitions) {
+			if (!RunPartitioned(changed))
+				return false;
+		}
+		else if (!RunRtOpsWithChangeDetection(changed))
 			return false;
 		
-		// Check for oscillation by looking for repeating states
+		// A pass that delivered no new values leaves the hash as it was: the tick has
+		// converged, even when every write counts as a change (detect_write_changes off)
 		uint64 current_state_hash = GetStateHash();
+		if (!state_history.IsEmpty() && state_history.Top() == current_state_hash) {
+			iteration++;
+			break;
+		}
+		
+		// Check for oscillation by looking for repeating states
 		if (IsStateInHistory(current_state_hash, state_history)) {
 			LOG("Warning: Oscillation detected in Machine::Tick() at iteration " << iteration);
 			break; // Exit the convergence loop to prevent infinite oscillation
@@ -259,12 +382,15 @@ bool Machine::Tick() {
 		iteration++;
 	}
 	
+	stat_ticks++;
+	stat_iterations += iteration;
+	
 	if (iteration >= max_iterations) {
 		LOG("Warning: Machine::Tick() reached max iterations - possible oscillation detected");
 	}
 	
 	// Check if we've reached a breakpoint
-	if (HasBreakpointAt(current_tick)) {
+	if ((features & FEATURE_BREAKPOINTS) && HasBreakpointAt(current_tick)) {
 		LOG("Breakpoint hit at tick " << current_tick);
 		simulation_paused = true;
 	}
@@ -274,50 +400,14 @@ bool Machine::Tick() {
 		LogSignalTraces();  // Log the current state of all traced signals
 	}
 	
-	// Log signal transitions summary for this tick
-	if (!signal_transitions.IsEmpty()) {
-		// Only log if there were transitions in this tick
-		bool hasCurrentTickTransitions = false;
-		for (int i = 0; i < signal_transitions.GetCount(); i++) {
-			if (signal_transitions[i].tick_number == current_tick) {
-				hasCurrentTickTransitions = true;
-				break;
-			}
-		}
-		
-		if (hasCurrentTickTransitions) {
-			LogAllSignalTransitions();  // Log all transitions from the current tick
-		}
+	// Log signal transitions summary for this tick, only if there were transitions in it
+	if (last_transition_tick == current_tick && !signal_transitions.IsEmpty()) {
+		LogAllSignalTransitions();  // Log all transitions from the current tick
 	}
 	
-	// Handle analog-digital interface interactions
-	HandleAnalogDigitalInterface();
-	
 	return true;
 }
 
-uint64 Machine::GetStateHash() {
-	uint64 hash = 0;
-	uint64 multiplier = 31;
-	
-	// Create a simple hash based on the current state of components
-	for (Pcb& pcb : pcbs) {
-		for (int i = 0; i < pcb.nodes.GetCount(); i++) {
-			ElcBase& node = pcb.nodes[i];
-			// Use the name and some basic properties to create a hash
-			String node_name = node.GetName();
-			for (int j = 0; j < node_name.GetCount(); j++) {
-				hash = hash * multiplier + node_name[j];
-			}
-			
-			// Add some basic state information if available
-			hash = hash * multiplier + node.GetMemorySize();
-		}
-	}
-	
-	return hash;
-}
-
 bool Machine::IsStateInHistory(uint64 current_state, const Vector<uint64>& history) {
 	for (uint64 past_state : history) {
 		if (past_state == current_state) {
@@ -329,86 +419,53 @@ bool Machine::IsStateInHistory(uint64 current_state, const Vector<uint64>& histo
 
 bool Machine::RunRtOpsWithChangeDetection(bool& changed) {
 	changed = false; // Start with no changes detected
-	int op_i = 0;
+	
+	if (write_values.GetCount() != l.rt_ops.GetCount())
+		ResetWriteValues();
 	
 	if (use_topological_ordering) {
-		// Use topological ordering for TICK operations
-		// Get components in topological order
-		Vector<ElectricNodeBase*> topo_order = PerformTopologicalSort();
+		// Use topological ordering for TICK operations, levelized once per Init
+		if (!tick_levels_built)
+			BuildTickLevels();
 		
-		// First process all WRITE operations in the original order
-		for (const ProcessOp& op : l.rt_ops) {
-			if (op.type == ProcessType::WRITE) {
-				ASSERT(op.processor);
-				// For write operations, remember the destination's change state before processing
+		// Writes out of units that never tick feed the first level
+		for (int op_i : level_writes[0]) {
+			bool op_changed = false;
+			if (!RunWriteOp(l.rt_ops[op_i], op_i, op_changed))
+				return false;
+			if (!detect_write_changes && op_changed)
+				changed = true;
+		}
+		
+		// Each level ticks and then delivers its outputs, so one pass carries a value
+		// through every level downstream of it
+		for (int i = 0; i < tick_levels.GetCount(); i++) {
+			if (!RunTickLevel(tick_levels[i], changed))
+				return false;
+			for (int op_i : level_writes[i + 1]) {
 				bool op_changed = false;
-				bool dest_changed_before = op.dest->HasChanged();
-				if (!op.processor->Process(op.type, op.mem_bytes, op.mem_bits, op.id, *op.dest, op.dest_id)) {
-					LOG("error: processing failed in " << op.processor->GetClassName());
+				if (!RunWriteOp(l.rt_ops[op_i], op_i, op_changed))
 					return false;
-				}
-				// Check if the destination state changed as a result
-				if (op.dest->HasChanged() != dest_changed_before) {
-					op_changed = true;
-				} else {
-					// The write operation may have changed the destination without setting the flag
-					// Conservatively assume it changed to ensure proper simulation
-					op_changed = true;
-				}
-				
-				if (op_changed) {
+				// A new value only needs another pass if its sink has already ticked
+				if (detect_write_changes && !write_feeds_back[op_i])
+					op_changed = false;
+				if (op_changed)
 					changed = true;
-				}
-			}
-		}
-		
-		// Then process TICK operations in topological order
-		for (ElectricNodeBase* comp : topo_order) {
-			// Find the corresponding TICK operation for this component
-			for (const ProcessOp& op : l.rt_ops) {
-				if (op.type == ProcessType::TICK && op.dest == comp) {
-					// Clear the change flag before ticking to detect changes properly
-					op.dest->SetChanged(false);
-					// Call the Tick method - it should internally call SetChanged if state changes
-					if (!op.dest->Tick()) {
-						return false;
-					}
-					// Check if the component indicated its state changed
-					bool op_changed = false;
-					if (op.dest->HasChanged()) {
-						op_changed = true;
-					}
-					// Check timing constraints after the component has processed its tick
-					CheckComponentTiming(*op.dest);
-					
-					if (op_changed) {
-						changed = true;
-					}
-					break; // Found and processed the tick for this component
-				}
 			}
 		}
 	} else {
 		// Use the original order
-		for (const ProcessOp& op : l.rt_ops) {
+		for (int op_i = 0; op_i < l.rt_ops.GetCount(); op_i++) {
+			const ProcessOp& op = l.rt_ops[op_i];
 			bool op_changed = false;
 			switch (op.type) {
 			//case ProcessType::READ:
 			case ProcessType::WRITE: {
-				ASSERT(op.processor);
-				// For write operations, remember the destination's change state before processing
-				bool dest_changed_before = op.dest->HasChanged();
-				if (!op.processor->Process(op.type, op.mem_bytes, op.mem_bits, op.id, *op.dest, op.dest_id)) {
-					LOG("error: processing failed in " << op.processor->GetClassName());
+				if (!RunWriteOp(op, op_i, op_changed))
 					return false;
-				}
-				// Check if the destination state changed as a result
-				if (op.dest->HasChanged() != dest_changed_before) {
-					op_changed = true;
-				} else {
-					// The write operation may have changed the destination without setting the flag
-					// Conservatively assume it changed to ensure proper simulation
-					op_changed = true;
+				// A new value only needs another pass if its sink has already ticked
+				if (detect_write_changes && op.dest->tick_op > op_i) {
+					op_changed = false;
 				}
 				break;
 			}
@@ -419,12 +476,14 @@ bool Machine::RunRtOpsWithChangeDetection(bool& changed) {
 				if (!op.dest->Tick()) {
 					return false;
 				}
-				// Check if the component indicated its state changed
-				if (op.dest->HasChanged()) {
+				// Without value detection, rely on the component's own change flag;
+				// otherwise any effect on other units shows up in its WRITE ops
+				if (!detect_write_changes && op.dest->HasChanged()) {
 					op_changed = true;
 				}
 				// Check timing constraints after the component has processed its tick
-				CheckComponentTiming(*op.dest);
+				if (check_component_timing)
+					CheckComponentTiming(*op.dest);
 				break;
 			}
 			default:
@@ -435,12 +494,493 @@ bool Machine::RunRtOpsWithChangeDetection(bool& changed) {
 			if (op_changed) {
 				changed = true;
 			}
-			op_i++;
+		}
+		
+		// Writes scheduled before their processor ticked carried the previous output
+		if (detect_write_changes && !changed) {
+			for (int op_i : l.early_write_ops) {
+				if (!CaptureWrite(l.rt_ops[op_i]))
+					return false;
+				if (IsCapturedWriteChanged(op_i)) {
+					changed = true;
+					break;
+				}
+			}
 		}
 	}
 	return true;
 }
 
+void Machine::SeedEvents() {
+	int op_count = l.rt_ops.GetCount();
+	
+	if (write_values.GetCount() != op_count || op_queued.GetCount() != op_count)
+		event_full_sweep = true;
+	
+	if (event_full_sweep) {
+		// Forget the delivered values so that every sink gets written again
+		ResetWriteValues();
+		op_queued.SetCount(op_count);
+		for (byte& queued : op_queued)
+			queued = 0;
+		event_queue = decltype(event_queue)();
+		event_next.SetCount(0);
+		
+		for(int i = 0; i < op_count; i++)
+			QueueOp(i, -1);
+		
+		event_full_sweep = false;
+	}
+}
+
+void Machine::QueueOp(int op_i, int cursor) {
+	if (op_i < 0 || op_queued[op_i])
+		return;
+	op_queued[op_i] = 1;
+	
+	// Ops at or behind the cursor would break the schedule order of this pass
+	bool behind = op_i <= cursor;
+	
+	// A unit that clears its inputs in Tick needs them written again every time it
+	// ticks, whether they changed or not. If one of the writes ahead of the tick is
+	// already behind the cursor, the tick waits for it in the next pass.
+	const ProcessOp& op = l.rt_ops[op_i];
+	if (op.type == ProcessType::TICK) {
+		for (int write_op : op.dest->clearing_fanin) {
+			QueueOp(write_op, cursor);
+			if (write_op < op_i && write_op <= cursor)
+				behind = true;
+		}
+	}
+	
+	if (!behind)
+		event_queue.push(op_i);
+	else
+		event_next.Add(op_i);
+}
+
+// Deterministic (splitmix64) key for one byte of one op's value, so that equal
+// states give equal hashes across runs and machines
+static inline uint64 ZobristKey(int op_i, int pos, byte value) {
+	uint64 z = ((uint64)op_i << 32) ^ ((uint64)pos << 8) ^ value;
+	z += 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+void Machine::ResetWriteValues() {
+	write_values.Clear();
+	write_values.SetCount(l.rt_ops.GetCount());
+	for (CompiledOp& op : compiled.ops)
+		op.last = 0xFF;
+	state_hash = 0;
+}
+
+bool Machine::CaptureWrite(const ProcessOp& op, WriteCapture& capture) {
+	ASSERT(op.processor);
+	capture.Reset();
+	if (!op.processor->Process(op.type, op.mem_bytes, op.mem_bits, op.id, capture, op.dest_id)) {
+		LOG("error: processing failed in " << op.processor->GetClassName());
+		return false;
+	}
+	return true;
+}
+
+bool Machine::IsCapturedWriteChanged(int op_i, const WriteCapture& capture) const {
+	const Vector<byte>& last = write_values[op_i];
+	const Vector<byte>& data = capture.data;
+	return last.GetCount() != data.GetCount() ||
+	       (data.GetCount() && memcmp(last.Begin(), data.Begin(), data.GetCount()) != 0);
+}
+
+void Machine::StoreCapturedWrite(int op_i, const WriteCapture& capture, uint64& hash) {
+	Vector<byte>& last = write_values[op_i];
+	const Vector<byte>& data = capture.data;
+	
+	for(int i = 0; i < last.GetCount(); i++)
+		hash ^= ZobristKey(op_i, i, last[i]);
+	for(int i = 0; i < data.GetCount(); i++)
+		hash ^= ZobristKey(op_i, i, data[i]);
+	
+	last.SetCount(data.GetCount());
+	if (data.GetCount())
+		memcpy(last.Begin(), data.Begin(), data.GetCount());
+}
+
+bool Machine::RunWriteOp(const ProcessOp& op, int op_i, bool& changed) {
+	if (!CaptureWrite(op))
+		return false;
+	
+	changed = IsCapturedWriteChanged(op_i);
+	if (changed)
+		StoreCapturedWrite(op_i);
+	else if (detect_write_changes && op.sink_retains)
+		return true;
+	// Unchanged values still reach sinks that clear their inputs, but don't count
+	
+	// Without value detection every write is delivered and counts as a change
+	if (!detect_write_changes)
+		changed = true;
+	
+	return write_capture.Forward(*op.dest);
+}
+
+bool Machine::RunEventDriven(bool& changed) {
+	changed = false;
+	
+	for (int op_i : event_next)
+		event_queue.push(op_i);
+	event_next.SetCount(0);
+	
+	// Stateful units may change their outputs without any input changing, and the
+	// full-tick passes tick them every time, so they run in every pass here too.
+	// Queueing their ticks also re-drives the inputs of the ones that clear them.
+	for (int op_i : l.stateful_tick_ops)
+		QueueOp(op_i, -1);
+	
+	while (!event_queue.empty()) {
+		int op_i = event_queue.top();
+		event_queue.pop();
+		op_queued[op_i] = 0;
+		
+		const ProcessOp& op = l.rt_ops[op_i];
+		switch (op.type) {
+		case ProcessType::WRITE: {
+			bool op_changed = false;
+			if (!RunWriteOp(op, op_i, op_changed))
+				return false;
+			if (op_changed) {
+				QueueOp(op.dest->tick_op, op_i);
+				// As in RunRtOpsWithChangeDetection, a new value needs another pass
+				// only if its sink has already ticked
+				if (op.dest->tick_op < op_i)
+					changed = true;
+			}
+			break;
+		}
+		case ProcessType::TICK:
+			if (!op.dest->Tick())
+				return false;
+			if (check_component_timing)
+				CheckComponentTiming(*op.dest);
+			
+			// Unchanged outputs are filtered out by RunWriteOp
+			for (int write_op : op.dest->fanout)
+				QueueOp(write_op, op_i);
+			break;
+			
+		default:
+			LOG("Machine::RunEventDriven: unhandled ProcessType");
+			return false;
+		}
+	}
+	
+	// Writes behind the cursor were scheduled before their processor ticked, so they
+	// carry the previous output. Another pass is only needed if that output changed;
+	// otherwise they wait in event_next for the next tick.
+	for (int i = 0; i < event_next.GetCount() && !changed; i++) {
+		int op_i = event_next[i];
+		const ProcessOp& op = l.rt_ops[op_i];
+		if (op.type != ProcessType::WRITE)
+			continue;
+		if (!CaptureWrite(op))
+			return false;
+		changed = IsCapturedWriteChanged(op_i);
+	}
+	return true;
+}
+
+bool Machine::CompileSchedule() {
+	if (!compiled.Compile(l))
+		return false;
+	
+	// Bit copies keep their own last value, so start the fingerprint from scratch
+	ResetWriteValues();
+	
+	LOG("Machine::CompileSchedule: " << compiled.ToString());
+	return true;
+}
+
+bool Machine::RunCompiled(bool& changed) {
+	changed = false;
+	
+	if (write_values.GetCount() != l.rt_ops.GetCount())
+		ResetWriteValues();
+	
+	for (CompiledOp& op : compiled.ops) {
+		switch (op.kind) {
+		case CompiledOp::COPY_BIT: {
+			byte v = (*op.src >> op.src_bit) & 1;
+			if (v == op.last && detect_write_changes)
+				break;
+			if (v != op.last) {
+				if (op.last <= 1)
+					state_hash ^= ZobristKey(op.index, 0, op.last);
+				state_hash ^= ZobristKey(op.index, 0, v);
+				op.last = v;
+			}
+			*op.dst = (*op.dst & ~(1 << op.dst_bit)) | (v << op.dst_bit);
+			if (!detect_write_changes || (op.flags & CompiledOp::FEEDBACK))
+				changed = true;
+			break;
+		}
+		case CompiledOp::CALL_WRITE: {
+			bool op_changed = false;
+			if (!RunWriteOp(l.rt_ops[op.index], op.index, op_changed))
+				return false;
+			if (op_changed && (!detect_write_changes || (op.flags & CompiledOp::FEEDBACK)))
+				changed = true;
+			break;
+		}
+		case CompiledOp::CALL_TICK: {
+			const CompiledTick& t = compiled.ticks[op.index];
+			if (!(t.fn ? t.fn(*t.node) : t.node->Tick()))
+				return false;
+			break;
+		}
+		}
+	}
+	
+	// Writes scheduled before their processor ticked carried the previous output
+	if (detect_write_changes && !changed) {
+		for (int i : compiled.early_ops) {
+			const CompiledOp& op = compiled.ops[i];
+			if (op.kind == CompiledOp::COPY_BIT) {
+				changed = ((*op.src >> op.src_bit) & 1) != op.last;
+			}
+			else {
+				if (!CaptureWrite(l.rt_ops[op.index]))
+					return false;
+				changed = IsCapturedWriteChanged(op.index);
+			}
+			if (changed)
+				break;
+		}
+	}
+	
+	return true;
+}
+
+bool Machine::BuildPartitions() {
+	partitions.Clear();
+	partitions_built = true;
+	
+	VectorMap<size_t, int> pcb_index;
+	for (Pcb& pcb : pcbs) {
+		pcb_index.Add((size_t)&pcb, partitions.GetCount());
+		partitions.Add().pcb = &pcb;
+	}
+	
+	for (int op_i = 0; op_i < l.rt_ops.GetCount(); op_i++) {
+		const ProcessOp& op = l.rt_ops[op_i];
+		int i = pcb_index.Find((size_t)(op.type == WRITE ? op.processor->pcb : op.dest->pcb));
+		if (i < 0) {
+			LOG("Machine::BuildPartitions: " << op.ToString() << " has no board");
+			return false;
+		}
+		PcbPartition& part = partitions[pcb_index[i]];
+		
+		if (op.type == WRITE && op.dest->pcb != op.processor->pcb) {
+			part.outbound.Add(op_i);
+			part.outbox.Add();
+			continue;
+		}
+		part.ops.Add(op_i);
+		if (op.type == WRITE && op.processor->tick_op > op_i)
+			part.early_ops.Add(op_i);
+	}
+	
+	int boundary = 0;
+	for (const PcbPartition& part : partitions)
+		boundary += part.outbound.GetCount();
+	LOG("Machine::BuildPartitions: " << partitions.GetCount() << " boards, "
+		<< boundary << " boundary writes");
+	return true;
+}
+
+bool Machine::RunPartition(PcbPartition& part) {
+	part.changed = false;
+	
+	for (int op_i : part.ops) {
+		const ProcessOp& op = l.rt_ops[op_i];
+		if (op.type == WRITE) {
+			if (!CaptureWrite(op, part.capture))
+				return false;
+			bool op_changed = IsCapturedWriteChanged(op_i, part.capture);
+			if (op_changed)
+				StoreCapturedWrite(op_i, part.capture, part.hash_delta);
+			else if (detect_write_changes && op.sink_retains)
+				continue;
+			if (!part.capture.Forward(*op.dest))
+				return false;
+			// A new value only needs another round if its sink has already ticked
+			if (!detect_write_changes || (op_changed && op.dest->tick_op < op_i))
+				part.changed = true;
+		}
+		else {
+			op.dest->SetChanged(false);
+			if (!op.dest->Tick()) {
+				LOG("error: tick failed in " << op.dest->GetClassName());
+				return false;
+			}
+			if (!detect_write_changes && op.dest->HasChanged())
+				part.changed = true;
+			if (check_component_timing)
+				CheckComponentTiming(*op.dest);
+		}
+	}
+	
+	if (detect_write_changes && !part.changed) {
+		for (int op_i : part.early_ops) {
+			if (!CaptureWrite(l.rt_ops[op_i], part.capture))
+				return false;
+			if (IsCapturedWriteChanged(op_i, part.capture)) {
+				part.changed = true;
+				break;
+			}
+		}
+	}
+	
+	// Capture what leaves the board after all of its ticks; delivered at the barrier
+	for (int i = 0; i < part.outbound.GetCount(); i++)
+		if (!CaptureWrite(l.rt_ops[part.outbound[i]], part.outbox[i]))
+			return false;
+	
+	return true;
+}
+
+bool Machine::RunPartitioned(bool& changed) {
+	changed = false;
+	
+	if (write_values.GetCount() != l.rt_ops.GetCount())
+		ResetWriteValues();
+	
+	// Boards only touch their own components here, so they can run concurrently
+	CoWork co;
+	for (PcbPartition& part : partitions) {
+		part.ok = true;
+		part.hash_delta = 0;
+		if (part.ops.IsEmpty() && part.outbound.IsEmpty())
+			continue;
+		PcbPartition* p = &part;
+		co & [this, p] {p->ok = RunPartition(*p);};
+	}
+	co.Finish();
+	
+	// Barrier: merge the results and deliver the boundary writes in a fixed order
+	for (PcbPartition& part : partitions) {
+		if (!part.ok)
+			return false;
+		state_hash ^= part.hash_delta;
+		if (part.changed)
+			changed = true;
+	}
+	for (PcbPartition& part : partitions) {
+		for (int i = 0; i < part.outbound.GetCount(); i++) {
+			int op_i = part.outbound[i];
+			const WriteCapture& capture = part.outbox[i];
+			bool op_changed = IsCapturedWriteChanged(op_i, capture);
+			if (op_changed)
+				StoreCapturedWrite(op_i, capture, state_hash);
+			else if (detect_write_changes && l.rt_ops[op_i].sink_retains)
+				continue;
+			if (!part.outbox[i].Forward(*l.rt_ops[op_i].dest))
+				return false;
+			if (op_changed || !detect_write_changes)
+				changed = true;
+		}
+	}
+	
+	return true;
+}
+
+bool Machine::BuildPackedNetlist() {
+	if (!packed.Build(l))
+		return false;
+	LOG("Machine::BuildPackedNetlist: " << packed.ToString());
+	return true;
+}
+
+bool Machine::RunPacked(bool& changed) {
+	changed = false;
+	
+	if (write_values.GetCount() != l.rt_ops.GetCount())
+		ResetWriteValues();
+	
+	for (int op_i = 0; op_i < l.rt_ops.GetCount(); op_i++) {
+		if (op_i == packed.eval_op)
+			packed.Eval();
+		
+		byte flags = packed.op_flags[op_i];
+		if (flags & PackedNetlist::SKIP)
+			continue;
+		
+		const ProcessOp& op = l.rt_ops[op_i];
+		bool op_changed = false;
+		switch (op.type) {
+		case ProcessType::WRITE: {
+			if (!RunWriteOp(op, op_i, op_changed))
+				return false;
+			if (detect_write_changes && !(flags & PackedNetlist::FEEDBACK))
+				op_changed = false;
+			break;
+		}
+		case ProcessType::TICK: {
+			op.dest->SetChanged(false);
+			if (!op.dest->Tick())
+				return false;
+			if (!detect_write_changes && op.dest->HasChanged())
+				op_changed = true;
+			if (check_component_timing)
+				CheckComponentTiming(*op.dest);
+			break;
+		}
+		default:
+			LOG("Machine::RunPacked: unhandled ProcessType");
+			return false;
+		}
+		
+		if (op_changed)
+			changed = true;
+	}
+	
+	if (detect_write_changes && !changed) {
+		for (int op_i : packed.early_ops) {
+			if (!CaptureWrite(l.rt_ops[op_i]))
+				return false;
+			if (IsCapturedWriteChanged(op_i)) {
+				changed = true;
+				break;
+			}
+		}
+	}
+	
+	return true;
+}
+
+bool WriteCapture::PutRaw(uint16 conn_id, byte* src, int data_bytes, int data_bits) {
+	Put& put = puts.Add();
+	put.conn_id = conn_id;
+	put.bytes = data_bytes;
+	put.bits = data_bits;
+	put.offset = data.GetCount();
+	
+	int len = data_bytes + (data_bits ? 1 : 0);
+	data.SetCount(put.offset + len);
+	if (len)
+		memcpy(data.Begin() + put.offset, src, len);
+	return true;
+}
+
+bool WriteCapture::Forward(ElcBase& dest) {
+	for (const Put& put : puts) {
+		if (!dest.PutRaw(put.conn_id, data.Begin() + put.offset, put.bytes, put.bits))
+			return false;
+	}
+	return true;
+}
+
 Pcb& Machine::AddPcb() {
 	Pcb& p = pcbs.Add();
 	p.mach = this;
@@ -453,35 +993,278 @@ void Machine::ScheduleEvent(int delay, std::function<bool()> action) {
 		delay = 0;
 	}
 	
-	DelayedEvent event;
-	event.delay = delay;
-	event.original_tick = current_tick;
-	event.action = action;
+	delay_queue.AddAction(current_tick + delay, pick(action));
+}
+
+void Machine::SchedulePut(int delay, ElcBase& dest, uint16 conn_id, const byte* data, int data_bytes, int data_bits) {
+	if (delay < 0) {
+		LOG("Warning: Negative delay value passed to SchedulePut, clamping to 0");
+		delay = 0;
+	}
 	
-	delay_queue.push(event);
+	int size = data_bytes + (data_bits + 7) / 8;
+	if (size > (int)sizeof(DelayedEvent::value)) {
+		// Too wide to store inline
+		String copy((const char*)data, size);
+		ElcBase* d = &dest;
+		delay_queue.AddAction(current_tick + delay, [d, conn_id, copy, data_bytes, data_bits]() {
+			return d->PutRaw(conn_id, (byte*)copy.Begin(), data_bytes, data_bits);
+		});
+		return;
+	}
+	
+	DelayedEvent e;
+	e.dest = &dest;
+	e.conn_id = conn_id;
+	e.bytes = data_bytes;
+	e.bits = data_bits;
+	if (size)
+		memcpy(e.value, data, size);
+	delay_queue.Add(current_tick + delay, e);
 }
 
 void Machine::ProcessDelayedEvents() {
-	// Process all events that are scheduled for the current tick
-	while (!delay_queue.empty()) {
-		const DelayedEvent& event = delay_queue.top();
-		int execution_tick = event.original_tick + event.delay;
-		
-		// If the next event is scheduled for a future tick, stop processing
-		if (execution_tick > current_tick) {
-			break;
-		}
-		
-		// We need to copy the action since we can't call it on a const reference
-		// So we'll pop the event, then execute it
-		DelayedEvent current_event = delay_queue.top();
-		delay_queue.pop();
-		
-		// Execute the event's action
-		if (!current_event.action()) {
+	// Process all events that are scheduled up to the current tick
+	delay_queue.Run(current_tick, [this](const DelayedEvent& e) {
+		bool ok = e.dest ? e.dest->PutRaw(e.conn_id, (byte*)e.value, e.bytes, e.bits)
+		                 : delay_queue.RunAction(e);
+		if (!ok) {
 			LOG("Warning: Delayed event action failed");
 		}
+	});
+}
+
+bool Machine::SerializeState(Stream& s, bool delta) {
+	dword magic = 0x534D5650; // "PVMS"
+	int version = STATE_VERSION;
+	s % magic % version;
+	if (s.IsLoading() && (magic != 0x534D5650 || version != STATE_VERSION)) {
+		LOG("error: Machine::SerializeState: not a machine snapshot, or unsupported version " << version);
+		return false;
+	}
+	
+	// A delta needs the records of a previous snapshot to compare with
+	if (s.IsStoring() && !CanStoreDelta())
+		delta = false;
+	s % delta;
+	if (s.IsLoading() && delta && !CanStoreDelta()) {
+		LOG("error: Machine::SerializeState: delta snapshot without a base");
+		return false;
+	}
+	
+	s % current_tick % timing_violations;
+	
+	// Nodes, in construction order; the circuit must match
+	Index<size_t> node_ptrs;
+	int pcb_count = pcbs.GetCount();
+	s % pcb_count;
+	if (pcb_count != pcbs.GetCount()) {
+		LOG("error: Machine::SerializeState: snapshot has " << pcb_count << " pcbs, machine has " << pcbs.GetCount());
+		return false;
+	}
+	for (Pcb& pcb : pcbs) {
+		int node_count = pcb.nodes.GetCount();
+		s % node_count;
+		if (node_count != pcb.nodes.GetCount()) {
+			LOG("error: Machine::SerializeState: node count mismatch in pcb " << pcb.GetName());
+			return false;
+		}
+		for (ElcBase& n : pcb.nodes) {
+			node_ptrs.Add((size_t)&n);
+			if (!SerializeNodeState(n, node_ptrs.GetCount() - 1, s, delta))
+				return false;
+		}
+	}
+	
+	// Clock domains are created by the circuit too, only their phase is state
+	int domain_count = clock_domains.GetCount();
+	s % domain_count;
+	if (domain_count != clock_domains.GetCount()) {
+		LOG("error: Machine::SerializeState: clock domain count mismatch");
+		return false;
+	}
+	for (ClockDomain& domain : clock_domains)
+		s % domain.last_edge_tick % domain.next_edge_tick % domain.clock_state;
+	
+	int bp_count = breakpoints.GetCount();
+	s % bp_count;
+	if (s.IsLoading())
+		breakpoints.SetCount(bp_count);
+	for (int& bp : breakpoints)
+		s % bp;
+	
+	// Pending delayed writes. Scheduled actions are opaque functions and can't be saved.
+	if (s.IsStoring()) {
+		Vector<int64> ticks;
+		Vector<int> nodes;
+		Vector<DelayedEvent> events;
+		int dropped = 0;
+		delay_queue.ForEach([&](int64 tick, const DelayedEvent& e) {
+			int node = e.dest ? node_ptrs.Find((size_t)e.dest) : -1;
+			if (node < 0) {
+				dropped++;
+				return;
+			}
+			ticks.Add(tick);
+			nodes.Add(node);
+			events.Add(e);
+		});
+		if (dropped)
+			LOG("warning: Machine::SerializeState: " << dropped << " scheduled actions not saved");
+		int count = events.GetCount();
+		s % count;
+		for (int i = 0; i < count; i++) {
+			DelayedEvent& e = events[i];
+			s % ticks[i] % nodes[i] % e.conn_id % e.bytes % e.bits;
+			s.SerializeRaw(e.value, sizeof(e.value));
+		}
+	}
+	else {
+		delay_queue.Clear();
+		int count = 0;
+		s % count;
+		for (int i = 0; i < count && !s.IsError(); i++) {
+			int64 tick;
+			int node;
+			DelayedEvent e;
+			s % tick % node % e.conn_id % e.bytes % e.bits;
+			s.SerializeRaw(e.value, sizeof(e.value));
+			if (node < 0 || node >= node_ptrs.GetCount()) {
+				LOG("error: Machine::SerializeState: invalid delayed event target");
+				return false;
+			}
+			e.dest = (ElcBase*)node_ptrs[node];
+			delay_queue.Add(tick, e);
+		}
+	}
+	
+	if (s.IsError()) {
+		LOG("error: Machine::SerializeState: stream error");
+		return false;
+	}
+	
+	if (s.IsLoading() && node_ptrs.GetCount() != snapshot_records.GetCount()) {
+		LOG("error: Machine::SerializeState: incomplete snapshot");
+		return false;
+	}
+	
+	if (s.IsLoading()) {
+		// Values were replaced behind the change detection, so start it over
+		ResetWriteValues();
+		RequestFullSweep();
+		InvalidateFeatures();
+	}
+	return true;
+}
+
+bool Machine::SerializeNodeState(ElcBase& n, int node_i, Stream& s, bool delta) {
+	if (!delta) {
+		String cls = n.GetClassName();
+		String stored_cls = cls;
+		s % stored_cls;
+		if (stored_cls != cls) {
+			LOG("error: Machine::SerializeState: expected " << cls << " but snapshot has " << stored_cls);
+			return false;
+		}
+		if (node_i == 0)
+			snapshot_records.Clear();
+		snapshot_records.Add();
+	}
+	if (node_i >= snapshot_records.GetCount()) {
+		LOG("error: Machine::SerializeState: snapshot has more nodes than the machine");
+		return false;
+	}
+	String& last = snapshot_records[node_i];
+	
+	// The pin values that live in plain storage and the node's own state form one
+	// length prefixed record. That detects a node reading too much or too little, and
+	// the previous record tells whether a delta needs to include the node at all.
+	if (s.IsStoring()) {
+		StringStream ss;
+		for (const ElcBase::Connector& conn : n.conns) {
+			ElcBase::PinStorage ps;
+			if (n.GetPinStorage(conn.id, ps)) {
+				bool b = (*ps.data >> ps.bit) & 1;
+				ss % b;
+			}
+		}
+		n.SerializeState(ss);
+		String rec = ss.GetResult();
+		bool changed = !delta || rec != last;
+		s % changed;
+		if (changed) {
+			s % rec;
+			last = pick(rec);
+		}
+	}
+	else {
+		bool changed = true;
+		s % changed;
+		if (changed) {
+			s % last;
+			MemReadStream ms(last.Begin(), last.GetCount());
+			for (const ElcBase::Connector& conn : n.conns) {
+				ElcBase::PinStorage ps;
+				if (n.GetPinStorage(conn.id, ps)) {
+					bool b = false;
+					ms % b;
+					*ps.data = (byte)((*ps.data & ~(1 << ps.bit)) | ((int)b << ps.bit));
+				}
+			}
+			n.SerializeState(ms);
+			if (ms.IsError() || !ms.IsEof()) {
+				LOG("error: Machine::SerializeState: state of " << n.GetDynamicName() << " does not match");
+				return false;
+			}
+		}
+	}
+	
+	// Memory pages: all of them in a full snapshot, the dirty ones in a delta
+	int size = 0;
+	Vector<uint64>* dirty = 0;
+	byte* mem = n.GetStateMemory(size, dirty);
+	int stored_size = mem ? size : 0;
+	s % stored_size;
+	if (stored_size != (mem ? size : 0)) {
+		LOG("error: Machine::SerializeState: memory size mismatch in " << n.GetDynamicName());
+		return false;
 	}
+	if (mem) {
+		const int page = ElcBase::STATE_PAGE_SIZE;
+		int page_count = (size + page - 1) / page;
+		if (!delta)
+			s.SerializeRaw(mem, size);
+		else if (s.IsStoring()) {
+			int count = 0;
+			for (int i = 0; i < page_count; i++)
+				if (((*dirty)[i / 64] >> (i % 64)) & 1)
+					count++;
+			s % count;
+			for (int i = 0; i < page_count; i++) {
+				if (((*dirty)[i / 64] >> (i % 64)) & 1) {
+					s % i;
+					s.SerializeRaw(mem + i * page, min(page, size - i * page));
+				}
+			}
+		}
+		else {
+			int count = 0;
+			s % count;
+			for (int j = 0; j < count && !s.IsError(); j++) {
+				int i = -1;
+				s % i;
+				if (i < 0 || i >= page_count) {
+					LOG("error: Machine::SerializeState: invalid memory page in " << n.GetDynamicName());
+					return false;
+				}
+				s.SerializeRaw(mem + i * page, min(page, size - i * page));
+			}
+		}
+		// The snapshot now matches the memory
+		for (uint64& w : *dirty)
+			w = 0;
+	}
+	return true;
 }
 
 void Machine::ReportTimingViolation(const String& component_name, const String& violation_details) {
@@ -503,7 +1286,142 @@ void Machine::CheckComponentTiming(ElectricNodeBase& component) {
 	// tracking of when clock edges occurred relative to data changes
 }
 
-// Build the dependency graph by analyzing connections between components
+// A partial reference ticks and is linked through the node it points into
+ElectricNodeBase* Machine::GetTickUnit(ElectricNodeBase* node) {
+	if ((node->type == ElectricNodeBase::V_PARTIAL || node->type == ElectricNodeBase::V_PARTIAL_RANGE) && node->ptr)
+		return node->ptr;
+	return node;
+}
+
+// Levelize the TICK ops by the dependency graph, and group every WRITE op behind the
+// level of the unit it reads from
+void Machine::BuildTickLevels() {
+	BuildDependencyGraph();
+	
+	tick_levels.Clear();
+	level_writes.Clear();
+	tick_levels_built = true;
+	
+	// Kahn's algorithm by layers: a level holds every node whose dependencies are all
+	// in earlier levels, so the ticks of one level never read each other's results
+	VectorMap<size_t, int> indegree;
+	Vector<ElectricNodeBase*> current;
+	for (Pcb& pcb : pcbs) {
+		for (int i = 0; i < pcb.nodes.GetCount() + pcb.refs.GetCount(); i++) {
+			ElectricNodeBase* node = GetTickUnit(i < pcb.nodes.GetCount() ? &pcb.nodes[i] : &pcb.refs[i - pcb.nodes.GetCount()]);
+			if (indegree.Find((size_t)node) >= 0)
+				continue;
+			int deps = node->GetDependencies().GetCount();
+			indegree.Add((size_t)node, deps);
+			if (!deps)
+				current.Add(node);
+		}
+	}
+	
+	int placed = 0;
+	while (!current.IsEmpty()) {
+		Vector<int>& level = tick_levels.Add();
+		Vector<ElectricNodeBase*> next;
+		for (ElectricNodeBase* node : current) {
+			placed++;
+			if (node->tick_op >= 0)
+				level.Add(node->tick_op);
+			for (ElectricNodeBase* dependent : node->GetDependents()) {
+				int& deg = indegree.Get((size_t)dependent);
+				if (--deg == 0)
+					next.Add(dependent);
+			}
+		}
+		// Keep the rt_ops order inside a level
+		Sort(level);
+		if (level.IsEmpty())
+			tick_levels.Drop();
+		current = pick(next);
+	}
+	
+	// Nodes on a dependency cycle still tick, after everything else, in rt_ops order
+	if (placed != indegree.GetCount()) {
+		LOG("Warning: Topological sort detected a cycle in the dependency graph. "
+			<< (indegree.GetCount() - placed) << " components are ticked in a final serial level.");
+		Vector<int> rest;
+		for (int i = 0; i < indegree.GetCount(); i++) {
+			ElectricNodeBase* node = (ElectricNodeBase*)indegree.GetKey(i);
+			if (indegree[i] > 0 && node->tick_op >= 0)
+				rest.Add(node->tick_op);
+		}
+		Sort(rest);
+		if (!rest.IsEmpty())
+			tick_levels.Add() = pick(rest);
+	}
+	
+	Vector<int> op_level;
+	op_level.SetCount(l.rt_ops.GetCount(), -1);
+	for (int i = 0; i < tick_levels.GetCount(); i++)
+		for (int op_i : tick_levels[i])
+			op_level[op_i] = i;
+	
+	// level_writes[0] holds the writes of units without a TICK op, level_writes[i + 1]
+	// the ones run after level i. A write feeds back when its sink ticked at or before
+	// that level, or never ticks, as in the original order.
+	level_writes.SetCount(tick_levels.GetCount() + 1);
+	write_feeds_back.SetCount(l.rt_ops.GetCount());
+	for (int op_i = 0; op_i < l.rt_ops.GetCount(); op_i++) {
+		const ProcessOp& op = l.rt_ops[op_i];
+		write_feeds_back[op_i] = 0;
+		if (op.type != ProcessType::WRITE)
+			continue;
+		int src_tick = op.processor ? op.processor->tick_op : -1;
+		int level = src_tick >= 0 ? op_level[src_tick] : -1;
+		int sink_level = op.dest->tick_op >= 0 ? op_level[op.dest->tick_op] : -1;
+		level_writes[level + 1].Add(op_i);
+		write_feeds_back[op_i] = sink_level < 0 || sink_level <= level;
+	}
+}
+
+bool Machine::RunTickLevel(const Vector<int>& level, bool& changed) {
+	int n = level.GetCount();
+	
+	for (int op_i : level)
+		l.rt_ops[op_i].dest->SetChanged(false);
+	
+	tick_results.SetCount(n);
+	if (tick_threads > 1 && n >= parallel_level_min) {
+		// Every tick only touches its own component, and the results are collected in
+		// level order below, so the outcome is the same for any thread count
+		std::atomic<int> next(0);
+		CoWork co;
+		for (int t = 0; t < tick_threads; t++) {
+			co & [&] {
+				for (int i = next++; i < n; i = next++)
+					tick_results[i] = l.rt_ops[level[i]].dest->Tick();
+			};
+		}
+		co.Finish();
+	}
+	else {
+		for (int i = 0; i < n; i++) {
+			tick_results[i] = l.rt_ops[level[i]].dest->Tick();
+			if (!tick_results[i])
+				return false;
+		}
+	}
+	
+	for (int i = 0; i < n; i++) {
+		ElectricNodeBase& node = *l.rt_ops[level[i]].dest;
+		if (!tick_results[i]) {
+			LOG("error: tick failed in " << node.GetClassName());
+			return false;
+		}
+		// Without value detection, rely on the component's own change flag
+		if (!detect_write_changes && node.HasChanged())
+			changed = true;
+		// Check timing constraints after the component has processed its tick
+		if (check_component_timing)
+			CheckComponentTiming(node);
+	}
+	return true;
+}
+
 void Machine::BuildDependencyGraph() {
 	// Clear existing dependencies
 	for (Pcb& pcb : pcbs) {
@@ -512,34 +1430,38 @@ void Machine::BuildDependencyGraph() {
 			node.dependencies.Clear();
 			node.dependents.Clear();
 		}
+		for (int i = 0; i < pcb.refs.GetCount(); i++) {
+			pcb.refs[i].dependencies.Clear();
+			pcb.refs[i].dependents.Clear();
+		}
 	}
 	
 	// Analyze each PCB's connections to build dependency graph
 	for (Pcb& pcb : pcbs) {
-		// Process each link to establish dependencies
-		// In this system, when one component's output is connected to another's input,
-		// the output component should be evaluated before the input component
-		// So input component depends on output component
-		
-		for (int i = 0; i < pcb.nodes.GetCount(); i++) {
-			ElectricNodeBase& node = pcb.nodes[i];
+		// When one component's output is connected to another's input, the output
+		// component is evaluated first, so the input component depends on it.
+		// Links through partial references count for the node they point into.
+		for (int i = 0; i < pcb.nodes.GetCount() + pcb.refs.GetCount(); i++) {
+			ElectricNodeBase& base = i < pcb.nodes.GetCount() ? pcb.nodes[i] : pcb.refs[i - pcb.nodes.GetCount()];
+			ElectricNodeBase* node = GetTickUnit(&base);
 			
-			// Look at each connector of this node
-			for (int j = 0; j < node.conns.GetCount(); j++) {
-				ElectricNodeBase::Connector& conn = node.conns[j];
-				
-				// If this is a sink (input), it depends on its source(s)
-				if (conn.IsConnected()) {
-					for (int k = 0; k < conn.links.GetCount(); k++) {
-						ElectricNodeBase::CLink& cLink = conn.links[k];
-						if (cLink.link) {
-							ElectricNodeBase::Connector* src_conn = cLink.link->src;
-							if (src_conn && src_conn->base) {
-								// This node (sink) depends on the source component
-								node.AddDependency(*src_conn->base);
-							}
-						}
-					}
+			for (int j = 0; j < base.conns.GetCount(); j++) {
+				ElectricNodeBase::Connector& conn = base.conns[j];
+				// Only inputs depend on what they are linked to
+				if (!conn.is_sink)
+					continue;
+				for (int k = 0; k < conn.links.GetCount(); k++) {
+					ElectricNodeBase::CLink& cLink = conn.links[k];
+					if (!cLink.link)
+						continue;
+					// A bidirectional connector may be the source side of its own link
+					ElectricNodeBase::Connector* src_conn =
+						cLink.link->src == &conn ? cLink.link->sink : cLink.link->src;
+					if (!src_conn || !src_conn->base || !src_conn->is_src)
+						continue;
+					ElectricNodeBase* src = GetTickUnit(src_conn->base);
+					if (src != node)
+						node->AddDependency(*src);
 				}
 			}
 		}
@@ -637,6 +1559,7 @@ int Machine::CreateClockDomain(int frequency_hz) {
 	domain.clock_state = false;
 	
 	clock_domains.Add(domain);
+	InvalidateFeatures();
 	
 	LOG("Created clock domain " << domain.id << " with frequency " << frequency_hz << " Hz");
 	return domain.id;
@@ -709,33 +1632,61 @@ void Machine::CheckClockDomainCrossings() {
 
 void Machine::AddBreakpoint(int tick_number) {
 	if (tick_number >= 0) {
-		if (!HasBreakpointAt(tick_number)) {
-			breakpoints.Add(tick_number);
-			// Sort for efficient lookup
+		// Kept sorted for efficient lookup
+		auto pos = std::lower_bound(breakpoints.begin(), breakpoints.end(), tick_number);
+		if (pos == breakpoints.end() || *pos != tick_number) {
+			breakpoints.Insert(int(pos - breakpoints.begin()), tick_number);
+			InvalidateFeatures();
 		}
 	}
 }
 
 void Machine::RemoveBreakpoint(int tick_number) {
-	for (int i = 0; i < breakpoints.GetCount(); i++) {
-		if (breakpoints[i] == tick_number) {
-			breakpoints.Remove(i);
-			break;
-		}
+	auto pos = std::lower_bound(breakpoints.begin(), breakpoints.end(), tick_number);
+	if (pos != breakpoints.end() && *pos == tick_number) {
+		breakpoints.Remove(int(pos - breakpoints.begin()));
+		InvalidateFeatures();
 	}
 }
 
 void Machine::ClearBreakpoints() {
 	breakpoints.Clear();
+	InvalidateFeatures();
 }
 
 bool Machine::HasBreakpointAt(int tick_number) const {
-	for (int i = 0; i < breakpoints.GetCount(); i++) {
-		if (breakpoints[i] == tick_number) {
-			return true;
+	return std::binary_search(breakpoints.begin(), breakpoints.end(), tick_number);
+}
+
+void Machine::UpdateFeatures() {
+	features = 0;
+	
+	for (const ClockDomain& domain : clock_domains) {
+		if (domain.frequency_hz > 0) {
+			features |= FEATURE_CLOCK_DOMAINS;
+			break;
 		}
 	}
-	return false;
+	
+	// A crossing needs components in at least two domains
+	int domain_id = -1;
+	for (Pcb& pcb : pcbs) {
+		for (int i = 0; i < pcb.nodes.GetCount() && !(features & FEATURE_DOMAIN_CROSSINGS); i++) {
+			int id = pcb.nodes[i].GetClockDomainId();
+			if (domain_id < 0)
+				domain_id = id;
+			else if (id != domain_id)
+				features |= FEATURE_DOMAIN_CROSSINGS;
+		}
+	}
+	
+	if (!breakpoints.IsEmpty())
+		features |= FEATURE_BREAKPOINTS;
+	
+	if (analog_sim && !analog_components.IsEmpty())
+		features |= FEATURE_ANALOG;
+	
+	features_dirty = false;
 }
 
 // Implementation for signal tracing methods
@@ -766,6 +1717,22 @@ void Machine::ClearSignalTraces() {
     LOG("Cleared all signal traces");
 }
 
+bool Machine::FindPinStorage(const String& component_name, const String& pin_name, ElcBase::PinStorage& ps) {
+    for (Pcb& pcb : pcbs) {
+        for (int i = 0; i < pcb.GetNodeCount(); i++) {
+            ElcBase& n = pcb.GetNode(i);
+            if (n.GetName() != component_name)
+                continue;
+            for (int j = 0; j < n.GetConnectorCount(); j++) {
+                const ElcBase::Connector& conn = n.GetConnector(j);
+                if (conn.name == pin_name)
+                    return n.GetPinStorage(conn.id, ps);
+            }
+        }
+    }
+    return false;
+}
+
 void Machine::EnableSignalTrace(int trace_id, bool enable) {
     if (trace_id >= 0 && trace_id < signal_traces.GetCount()) {
         signal_traces[trace_id].trace_enabled = enable;
@@ -917,6 +1884,7 @@ void Machine::LogSignalTransition(ElectricNodeBase* component, const String& pin
     
     // Add to the transitions log
     signal_transitions.Add(trans);
+    last_transition_tick = current_tick;
     
     // If we exceed the maximum log size, remove the oldest entries
     if (signal_transitions.GetCount() > max_transitions_to_store) {
@@ -942,6 +1910,7 @@ void Machine::LogAllSignalTransitions() {
 
 void Machine::ClearSignalTransitionLog() {
     signal_transitions.Clear();
+    last_transition_tick = -1;
     LOG("Cleared signal transition log");
 }
 
@@ -1117,6 +2086,9 @@ void Machine::ReportProfilingResults() {
     LOG("PERFORMANCE PROFILING REPORT");
     LOG("=============================");
     LOG("Total simulation time: " << total_simulation_time << " ms");
+    LOG("Ticks simulated: " << stat_ticks);
+    LOG("Convergence passes: " << stat_iterations << " (avg " << GetAverageIterationsPerTick() << " per tick, "
+         << "write change detection " << (detect_write_changes ? "on" : "off") << ")");
     LOG("Number of components profiled: " << component_profiles.GetCount());
     
     // Sort components by time spent (descending)
@@ -1143,6 +2115,8 @@ void Machine::ReportProfilingResults() {
 void Machine::ResetProfilingData() {
     profiling_enabled = false;
     total_simulation_time = 0;
+    stat_ticks = 0;
+    stat_iterations = 0;
     component_profiles.Clear();
     LOG("Performance profiling data reset");
 }
@@ -1287,6 +2261,7 @@ void Machine::RegisterAnalogComponent(AnalogNodeBase* component) {
     
     // Add to the list of analog components
     analog_components.Add(component);
+    InvalidateFeatures();
     if (analog_sim) {
         analog_sim->RegisterAnalogComponent(component);
     }
@@ -1305,14 +2280,18 @@ bool Machine::RunAnalogSimulation() {
 }
 
 void Machine::HandleAnalogDigitalInterface() {
-    // Handle any interfaces between analog and digital components
-    // For example, ADCs, DACs, comparators, etc.
-    // In this implementation, we'll look for components that may need
-    // analog values to drive digital behavior or vice versa
+    // Analog pins linked to digital inputs write the level AnalogSimulation keeps for
+    // them, which only changes on a threshold crossing. The other schedulers run
+    // every write on each pass; the event-driven one needs the crossings queued, as
+    // nothing else ticks the analog components. A full sweep queues them anyway.
+    if (!use_event_driven || event_full_sweep || op_queued.GetCount() != l.rt_ops.GetCount())
+        return;
     
-    LOG("Handling analog-digital interface");
-    
-    // In a complete implementation, this would identify and handle
-    // components that bridge analog and digital domains
-    // For example, a comparator that converts an analog value to a digital output
+    for (const AnalogSimulation::Crossing& crossing : analog_sim->GetCrossings()) {
+        uint16 conn_id = crossing.node->GetConnector(crossing.pin).id;
+        for (int op_i : crossing.node->fanout) {
+            if (l.rt_ops[op_i].id == conn_id)
+                QueueOp(op_i, -1);
+        }
+    }
 }
@@ -3,22 +3,47 @@
 #include <queue>
 #include <functional>
 #include "Link.h"  // For LinkBaseMap definition
+#include "CompiledSchedule.h"  // For CompiledSchedule
+#include "PackedNetlist.h"  // For PackedNetlist
+#include "TimingWheel.h"  // For TimingWheel
 #include "Pcb.h"  // For Pcb class
 #include "Component.h"  // For ElectricNodeBase
 #include "Common.h"  // For basic types
 
 
 
-// Structure to represent a delayed event
-struct DelayedEvent {
-	int delay;  // Number of ticks to delay
-	int original_tick;  // Simulation tick when event was scheduled
-	std::function<bool()> action;  // Function to execute when delay expires
-	bool operator>(const DelayedEvent& other) const {
-		// Priority queue is max-heap by default, but we want min-heap behavior based on remaining delay
-		// So we compare based on when the event should execute (original_tick + delay)
-		return (original_tick + delay) > (other.original_tick + other.delay);
-	}
+// Stand-in destination for a WRITE op: records the PutRaw calls made by the
+// processor so the value can be compared with the previous one before it is
+// forwarded to the real sink.
+struct WriteCapture : public ElcBase {
+	struct Put : Moveable<Put> {
+		uint16 conn_id = 0;
+		int bytes = 0;
+		int bits = 0;
+		int offset = 0;
+	};
+	
+	Vector<Put> puts;
+	Vector<byte> data;
+	
+	void Reset() {puts.SetCount(0); data.SetCount(0);}
+	bool Forward(ElcBase& dest);
+	String GetClassName() const override {return "WriteCapture";}
+	bool PutRaw(uint16 conn_id, byte* src, int data_bytes, int data_bits) override;
+};
+
+// One board of a partitioned machine. The rt_ops that stay on the board run on its own
+// worker; writes that leave it are captured there and delivered at the round barrier.
+struct PcbPartition {
+	Pcb* pcb = 0;
+	Vector<int> ops;        // local rt_ops indices, in rt_ops order
+	Vector<int> early_ops;  // local writes scheduled before their processor's TICK
+	Vector<int> outbound;   // rt_ops indices of the writes into other boards
+	Array<WriteCapture> outbox;  // values captured for outbound, one per op
+	WriteCapture capture;
+	uint64 hash_delta = 0;
+	bool changed = false;
+	bool ok = true;
 };
 
 // Forward declarations for analog components
@@ -32,27 +57,89 @@ public:
 	LinkBaseMap l;
 	
 	// Delay queue for handling propagation delays
-	std::priority_queue<DelayedEvent, std::vector<DelayedEvent>, std::greater<DelayedEvent>> delay_queue;
+	TimingWheel delay_queue;
 	int current_tick = 0;  // Current simulation tick
 	
 	// Timing violation tracking
 	int timing_violations = 0;  // Count of timing violations detected
 	
+	// Scheduler selection. The flags use_topological_ordering, use_partitions,
+	// use_event_driven, use_compiled_schedule and use_packed_nets each replace the
+	// default pass over rt_ops, so at most one of them may be set; Init fails
+	// otherwise. detect_write_changes applies to all of them.
+	
 	// Topological ordering flag
 	bool use_topological_ordering = false;  // Whether to use topological ordering for component evaluation
 	
+	// Topological mode: ticks of levels at least parallel_level_min wide are spread over
+	// this many CoWork jobs (0 or 1 runs everything on the calling thread)
+	int tick_threads = 0;
+	int parallel_level_min = 32;
+	
+	// Run every Pcb on its own CoWork job; links between boards are synchronized once
+	// per convergence round
+	bool use_partitions = false;
+	
+	// Event-driven evaluation: combinational units only run downstream of a changed
+	// value. Stateful units tick in every pass, and the writes into units that clear
+	// their inputs are repeated with them, as in the full-tick passes.
+	bool use_event_driven = false;
+	
+	// Compare the value of each WRITE op with the previous one, so that unchanged writes
+	// no longer force another convergence pass. They are only dropped when the sink
+	// retains its inputs (ProcessOp::sink_retains); sinks that latch and clear them
+	// still get every write. When false, every write is delivered and counts as a
+	// change (the original behaviour).
+	bool detect_write_changes = true;
+	
+	// Run rt_ops from the flat schedule built by CompileSchedule instead of the ProcessOps
+	bool use_compiled_schedule = false;
+	
+	// Evaluate the plain logic gates from a bit-packed netlist, level by level
+	bool use_packed_nets = false;
+	
+private:
+	dword features = 0;
+	bool features_dirty = true;
+	int last_transition_tick = -1;   // tick of the latest LogSignalTransition
+	Vector<uint64> state_history;    // oscillation detection, reused by every Tick
+	
+public:
 	bool Init();
 	bool Tick();
 	bool RunInitOps();
 	bool RunRtOps();
 	bool RunRtOpsWithChangeDetection(bool& changed);
-	uint64 GetStateHash();
+	bool RunEventDriven(bool& changed);
+	bool CompileSchedule();
+	bool RunCompiled(bool& changed);
+	const CompiledSchedule& GetCompiledSchedule() const {return compiled;}
+	bool BuildPartitions();
+	bool RunPartitioned(bool& changed);
+	int GetPartitionCount() const {return partitions.GetCount();}
+	bool BuildPackedNetlist();
+	bool RunPacked(bool& changed);
+	const PackedNetlist& GetPackedNetlist() const {return packed;}
+	void RequestFullSweep() {event_full_sweep = true;}  // Re-evaluate every op on the next tick
+	
+	// Versioned binary snapshot of the simulation state: tick counters, the pins and
+	// SerializeState blob of every node, node memories, clock domain phases, breakpoints
+	// and pending delayed writes. Loading expects a Machine built from the same circuit
+	// and already initialized, so schedules are rebuilt by Init rather than stored.
+	// A delta snapshot only holds the nodes and memory pages changed since the previous
+	// snapshot this Machine stored or loaded, and is loaded on top of that state.
+	static const int STATE_VERSION = 2;
+	bool SerializeState(Stream& s, bool delta = false);
+	bool CanStoreDelta() const {return !snapshot_records.IsEmpty();}
+	void DiscardSnapshotBase() {snapshot_records.Clear();}  // The next snapshot stored is full
+	uint64 GetStateHash() const {return state_hash;}
 	bool IsStateInHistory(uint64 current_state, const Vector<uint64>& history);
 	
 	Pcb& AddPcb();
 	
 	// Methods for handling delayed events
 	void ScheduleEvent(int delay, std::function<bool()> action);
+	void SchedulePut(int delay, ElcBase& dest, uint16 conn_id, const byte* data, int data_bytes, int data_bits);
 	void ProcessDelayedEvents();
 	
 	// Methods for timing violation reporting
@@ -60,9 +147,23 @@ public:
 	int GetTimingViolationCount() const { return timing_violations; }
 	void ResetTimingViolationCount() { timing_violations = 0; }
 	
-	// Method to check component timing constraints
+	// Method to check component timing constraints, called per tick only when enabled
+	bool check_component_timing = false;
 	void CheckComponentTiming(ElectricNodeBase& component);
 	
+	// Optional per-tick work. Tick recomputes the mask lazily after any of the setters
+	// below changed, and skips the steps whose feature is unused.
+	typedef enum {
+		FEATURE_CLOCK_DOMAINS    = 1,  // a clock domain with a nonzero frequency exists
+		FEATURE_DOMAIN_CROSSINGS = 2,  // components are spread over several clock domains
+		FEATURE_BREAKPOINTS      = 4,
+		FEATURE_ANALOG           = 8,  // analog simulation with registered components
+	} Feature;
+	
+	void UpdateFeatures();
+	void InvalidateFeatures() {features_dirty = true;}
+	dword GetFeatures() const {return features;}
+	
 	// Methods for timing analysis
 	void PerformTimingAnalysis();  // Overall timing analysis of the circuit
 	void ReportTimingAnalysis();   // Report timing analysis results
@@ -70,6 +171,9 @@ public:
 	// Methods for topological sorting
 	Vector<ElectricNodeBase*> PerformTopologicalSort();
 	void BuildDependencyGraph();
+	static ElectricNodeBase* GetTickUnit(ElectricNodeBase* node);
+	void BuildTickLevels();
+	int GetTickLevelCount() const {return tick_levels.GetCount();}
 	
 	// Methods for clock domain management
 	int CreateClockDomain(int frequency_hz = 0);  // Create a new clock domain with given frequency
@@ -84,9 +188,53 @@ public:
 	
 	//Port& GetPower() {return power;}
 	
+	// Event-driven scheduler state
+private:
+	WriteCapture write_capture;
+	Vector<Vector<byte>> write_values;  // Last value delivered by each WRITE op, indexed like l.rt_ops
+	Vector<byte> op_queued;             // Non-zero while the rt_ops index is waiting in a pass
+	std::priority_queue<int, std::vector<int>, std::greater<int>> event_queue;  // Current pass, in schedule order
+	Vector<int> event_next;             // Ops scheduled behind the cursor, run in the next pass
+	bool event_full_sweep = true;
+	
+	// Zobrist fingerprint of the values last delivered by every WRITE op. It is updated
+	// in O(changed bytes) whenever a write delivers a new value, see StoreCapturedWrite.
+	uint64 state_hash = 0;
+	
+	// Topological mode: rt_ops indices of the TICK ops per level and of the WRITE ops
+	// run behind each level, cached by BuildTickLevels
+	Vector<Vector<int>> tick_levels;
+	Vector<Vector<int>> level_writes;
+	Vector<byte> write_feeds_back;
+	Vector<byte> tick_results;
+	bool tick_levels_built = false;
+	
+	Array<PcbPartition> partitions;
+	bool partitions_built = false;
+	
+	CompiledSchedule compiled;
+	PackedNetlist packed;
+	
+	bool RunTickLevel(const Vector<int>& level, bool& changed);
+	bool RunPartition(PcbPartition& part);
+	void SeedEvents();
+	void QueueOp(int op_i, int cursor);
+	void ResetWriteValues();
+	bool CaptureWrite(const ProcessOp& op) {return CaptureWrite(op, write_capture);}
+	bool IsCapturedWriteChanged(int op_i) const {return IsCapturedWriteChanged(op_i, write_capture);}
+	void StoreCapturedWrite(int op_i) {StoreCapturedWrite(op_i, write_capture, state_hash);}
+	bool CaptureWrite(const ProcessOp& op, WriteCapture& capture);
+	bool IsCapturedWriteChanged(int op_i, const WriteCapture& capture) const;
+	void StoreCapturedWrite(int op_i, const WriteCapture& capture, uint64& hash);
+	bool RunWriteOp(const ProcessOp& op, int op_i, bool& changed);
+	bool SerializeNodeState(ElcBase& n, int node_i, Stream& s, bool delta);
+	
+	Vector<String> snapshot_records;  // per node state as of the last snapshot
+	
+public:
 	// Breakpoint functionality
 private:
-	Vector<int> breakpoints;  // List of tick numbers where simulation should pause
+	Vector<int> breakpoints;  // Sorted list of tick numbers where simulation should pause
 	bool simulation_paused = false;  // Whether simulation is currently paused
 public:
 	void AddBreakpoint(int tick_number);  // Add a breakpoint at specified tick
@@ -113,6 +261,15 @@ private:
 	
 	Vector<ComponentProfile> component_profiles;  // Profile data for each component
 	int max_components_to_profile = 50;  // Maximum number of components to profile individually
+	
+	// Convergence statistics, always collected
+	int64 stat_ticks = 0;       // Calls to Tick
+	int64 stat_iterations = 0;  // Convergence passes over all ticks
+	
+public:
+	double GetAverageIterationsPerTick() const { return stat_ticks ? (double)stat_iterations / stat_ticks : 0.0; }
+	
+private:
 
 	// Clock domain management
 	struct ClockDomain : Moveable<ClockDomain> {
@@ -205,6 +362,10 @@ public:
 	void DisableSignalTrace(int trace_id);
 	void LogSignalTraces();  // Log all traced signals
 	const Vector<SignalTrace>& GetSignalTraces() const { return signal_traces; }
+	// Storage behind a component's pin, so that callers polling it while the machine
+	// runs don't search for it every time. False if there is no such pin or its value
+	// doesn't live in plain storage.
+	bool FindPinStorage(const String& component_name, const String& pin_name, ElcBase::PinStorage& ps);
 
 	// Methods for signal transition logging
 	void LogSignalTransition(ElectricNodeBase* component, const String& pin_name, byte old_val, byte new_val);
@@ -245,10 +406,12 @@ public:
 	// Accessor for analog simulation
 	AnalogSimulation* GetAnalogSimulation() { return analog_sim; }
 	
-	// Run the analog portion of the simulation during each tick
+	// Run the analog portion of the simulation during each tick. The analog side
+	// takes its own steps and only solves when one is due, a digital output into it
+	// changed or a boundary is about to cross the logic threshold.
 	bool RunAnalogSimulation();
 	
-	// Methods for mixed-signal interactions
+	// Deliver the threshold crossings of the last analog tick to the digital side
 	void HandleAnalogDigitalInterface();
 };
 
@@ -0,0 +1,468 @@
+#include "ProtoVM.h"
+
+
+
+
+void PackedNetlist::Clear() {
+	nets.SetCount(0);
+	gates.SetCount(0);
+	groups.SetCount(0);
+	moves.SetCount(0);
+	inputs.SetCount(0);
+	outputs.SetCount(0);
+	op_flags.SetCount(0);
+	early_ops.SetCount(0);
+	gate_index.Clear();
+	eval_op = -1;
+	level_count = 0;
+	net_count = 0;
+}
+
+void PackedNetlist::SetNet(int net, bool b) {
+	uint64& w = nets[net >> 6];
+	uint64 mask = (uint64)1 << (net & 63);
+	w = b ? (w | mask) : (w & ~mask);
+}
+
+static inline uint64 EvalGateOp(ElcBase::GateOp op, uint64 a, uint64 b) {
+	switch (op) {
+	case ElcBase::GATE_NOT:  return ~a;
+	case ElcBase::GATE_NAND: return ~(a & b);
+	case ElcBase::GATE_NOR:  return ~(a | b);
+	case ElcBase::GATE_XOR:  return a ^ b;
+	case ElcBase::GATE_XNOR: return ~(a ^ b);
+	default: ASSERT(0); return 0;
+	}
+}
+
+// Copies count bits starting at net src to net dst, in chunks that stay inside one
+// word at both ends
+static inline void CopyNetBits(uint64* nets, int src, int dst, int count) {
+	while (count > 0) {
+		int sbit = src & 63, dbit = dst & 63;
+		int n = min(count, 64 - max(sbit, dbit));
+		uint64 mask = n == 64 ? ~(uint64)0 : (((uint64)1 << n) - 1);
+		uint64& w = nets[dst >> 6];
+		w = (w & ~(mask << dbit)) | (((nets[src >> 6] >> sbit) & mask) << dbit);
+		src += n;
+		dst += n;
+		count -= n;
+	}
+}
+
+static bool IsBitLink(const ProcessOp& op) {
+	return op.mem_bytes == 0 && op.mem_bits == 1 &&
+		op.src && op.src->is_src && op.sink && op.sink->is_sink;
+}
+
+bool PackedNetlist::Build(const LinkBaseMap& l) {
+	Clear();
+	int op_count = l.rt_ops.GetCount();
+	
+	// Candidates: gates with a GateOp and storage behind every pin
+	Vector<PackedGate> cand;
+	Index<size_t> cand_index;
+	for (int i = 0; i < op_count; i++) {
+		const ProcessOp& op = l.rt_ops[i];
+		if (op.type != TICK)
+			continue;
+		ElcBase::GateOp gop = op.dest->GetGateOp();
+		if (gop == ElcBase::GATE_NONE || cand_index.Find((size_t)op.dest) >= 0)
+			continue;
+		ElcBase::PinStorage s;
+		bool has_storage = true;
+		for (int j = 0; j <= GetInputCount(gop) && has_storage; j++)
+			has_storage = op.dest->GetPinStorage(j, s);
+		if (!has_storage)
+			continue;
+		cand_index.Add((size_t)op.dest);
+		PackedGate& g = cand.Add();
+		g.node = op.dest;
+		g.op = gop;
+		g.tick_op = i;
+	}
+	
+	// Gates must only be written through their inputs and read through their output,
+	// since the nets between packed gates never reach the gate objects
+	Vector<bool> rejected;
+	rejected.SetCount(cand.GetCount(), false);
+	for (const ProcessOp& op : l.rt_ops) {
+		if (op.type != WRITE)
+			continue;
+		int pi = cand_index.Find((size_t)op.processor);
+		if (pi >= 0 && op.id != GetInputCount(cand[pi].op))
+			rejected[pi] = true;
+		int di = cand_index.Find((size_t)op.dest);
+		if (di >= 0 && op.dest_id >= GetInputCount(cand[di].op))
+			rejected[di] = true;
+	}
+	
+	Vector<PackedGate> packed;
+	for (int i = 0; i < cand.GetCount(); i++) {
+		if (rejected[i])
+			continue;
+		gate_index.Add((size_t)cand[i].node, packed.GetCount());
+		packed.Add(cand[i]);
+	}
+	int gate_count = packed.GetCount();
+	if (!gate_count) {
+		Clear();
+		return true;
+	}
+	
+	// An input driven only by another packed gate's output becomes an internal net
+	Vector<int> driver_count, alias_src, alias_op;
+	driver_count.SetCount(gate_count * 2, 0);
+	alias_src.SetCount(gate_count * 2, -1);
+	alias_op.SetCount(gate_count * 2, -1);
+	for (int i = 0; i < op_count; i++) {
+		const ProcessOp& op = l.rt_ops[i];
+		if (op.type != WRITE)
+			continue;
+		int di = gate_index.Find((size_t)op.dest);
+		if (di < 0)
+			continue;
+		int slot = di * 2 + op.dest_id;
+		driver_count[slot]++;
+		int pi = gate_index.Find((size_t)op.processor);
+		if (pi >= 0 && IsBitLink(op)) {
+			alias_src[slot] = pi;
+			alias_op[slot] = i;
+		}
+	}
+	for (int i = 0; i < alias_src.GetCount(); i++) {
+		if (driver_count[i] != 1) {
+			alias_src[i] = -1;
+			alias_op[i] = -1;
+		}
+	}
+	
+	// Levelize along the internal nets. Feedback loops are cut at the gate that comes
+	// first in rt_ops, whose looping inputs are then loaded like boundary inputs.
+	Vector<int> indeg, queue;
+	Vector<Vector<int>> users;
+	Vector<bool> queued;
+	indeg.SetCount(gate_count, 0);
+	users.SetCount(gate_count);
+	queued.SetCount(gate_count, false);
+	for (int i = 0; i < alias_src.GetCount(); i++) {
+		if (alias_src[i] >= 0) {
+			indeg[i / 2]++;
+			users[alias_src[i]].Add(i / 2);
+		}
+	}
+	for (int i = 0; i < gate_count; i++) {
+		if (!indeg[i]) {
+			queue.Add(i);
+			queued[i] = true;
+		}
+	}
+	Vector<int> cut_src;
+	cut_src.SetCount(gate_count * 2, -1);
+	Vector<bool> done;
+	done.SetCount(gate_count, false);
+	int next_cut = 0;
+	for (int head = 0; head < gate_count; head++) {
+		if (head == queue.GetCount()) {
+			while (queued[next_cut])
+				next_cut++;
+			for (int pin = 0; pin < 2; pin++) {
+				int slot = next_cut * 2 + pin;
+				if (alias_src[slot] >= 0 && !done[alias_src[slot]]) {
+					cut_src[slot] = alias_src[slot];
+					alias_src[slot] = -1;
+					alias_op[slot] = -1;
+				}
+			}
+			queue.Add(next_cut);
+			queued[next_cut] = true;
+		}
+		int gi = queue[head];
+		PackedGate& g = packed[gi];
+		for (int pin = 0; pin < 2; pin++) {
+			int src = alias_src[gi * 2 + pin];
+			if (src >= 0)
+				g.level = max(g.level, packed[src].level + 1);
+		}
+		level_count = max(level_count, g.level + 1);
+		done[gi] = true;
+		for (int user : users[gi]) {
+			if (!queued[user] && --indeg[user] == 0) {
+				queue.Add(user);
+				queued[user] = true;
+			}
+		}
+	}
+	
+	// Group by level and function
+	Vector<int> order;
+	order.SetCount(gate_count);
+	for (int i = 0; i < gate_count; i++)
+		order[i] = i;
+	Sort(order, [&](int a, int b) {
+		const PackedGate& ga = packed[a];
+		const PackedGate& gb = packed[b];
+		if (ga.level != gb.level) return ga.level < gb.level;
+		if (ga.op != gb.op) return ga.op < gb.op;
+		return ga.tick_op < gb.tick_op;
+	});
+	
+	// Output nets, each group starting on a word boundary. Inside a group the gates are
+	// ordered by the nets that drive their inputs, which the lower levels have placed
+	// already, so that neighbouring gates read neighbouring bits and the operand
+	// gathers in Eval move long runs instead of single bits.
+	Vector<int> out_net;
+	out_net.SetCount(gate_count, -1);
+	int net = 0;
+	for (int first = 0; first < gate_count;) {
+		int end = first + 1;
+		while (end < gate_count && packed[order[end]].level == packed[order[first]].level &&
+		       packed[order[end]].op == packed[order[first]].op)
+			end++;
+		auto source = [&](int gi, int pin) {
+			int src = alias_src[gi * 2 + pin];
+			return src >= 0 ? out_net[src] : INT_MAX;
+		};
+		std::stable_sort(order.begin() + first, order.begin() + end, [&](int a, int b) {
+			if (source(a, 0) != source(b, 0)) return source(a, 0) < source(b, 0);
+			return source(a, 1) < source(b, 1);
+		});
+		
+		net = (net + 63) & ~63;
+		PackedGroup& grp = groups.Add();
+		grp.op = packed[order[first]].op;
+		grp.level = packed[order[first]].level;
+		grp.first = first;
+		grp.count = end - first;
+		grp.out_net = net;
+		for (int i = first; i < end; i++)
+			out_net[order[i]] = net++;
+		first = end;
+	}
+	
+	Vector<int> new_index;
+	new_index.SetCount(gate_count);
+	for (int i = 0; i < gate_count; i++)
+		new_index[order[i]] = i;
+	for (int i = 0; i < gate_count; i++) {
+		gates.Add(packed[order[i]]);
+		gates.Top().out = out_net[order[i]];
+		gate_index[i] = new_index[i];  // keys were added in the old order
+	}
+	
+	// Input nets: one word aligned operand range per group and pin, so that Eval runs
+	// a group as whole-word logic ops. Boundary inputs are loaded straight into their
+	// operand bit; internal nets are gathered from the driving outputs by moves.
+	for (PackedGroup& grp : groups) {
+		grp.first_move = moves.GetCount();
+		for (int pin = 0; pin < GetInputCount(grp.op); pin++) {
+			net = (net + 63) & ~63;
+			grp.in_net[pin] = net;
+			for (int k = 0; k < grp.count; k++) {
+				PackedGate& g = gates[grp.first + k];
+				int old_i = order[grp.first + k];
+				g.in[pin] = net++;
+				int src = alias_src[old_i * 2 + pin];
+				if (src >= 0) {
+					g.src[pin] = out_net[src];
+					PackedMove* last = moves.GetCount() > grp.first_move ? &moves.Top() : 0;
+					if (last && last->src + last->count == g.src[pin] && last->dst + last->count == g.in[pin])
+						last->count++;
+					else {
+						PackedMove& m = moves.Add();
+						m.src = g.src[pin];
+						m.dst = g.in[pin];
+						m.count = 1;
+					}
+					continue;
+				}
+				ElcBase::PinStorage s;
+				g.node->GetPinStorage(pin, s);
+				PackedPort& p = inputs.Add();
+				p.net = g.in[pin];
+				if (cut_src[old_i * 2 + pin] >= 0)
+					p.driver = out_net[cut_src[old_i * 2 + pin]];
+				p.data = s.data;
+				p.bit = s.bit;
+			}
+		}
+		grp.move_count = moves.GetCount() - grp.first_move;
+	}
+	net_count = net;
+	nets.SetCount((net_count + 63) / 64, 0);
+	
+	// Start from the values the gates currently hold
+	for (const PackedGate& g : gates) {
+		ElcBase::PinStorage s;
+		g.node->GetPinStorage(GetInputCount(g.op), s);
+		SetNet(g.out, (*s.data >> s.bit) & 1);
+	}
+	
+	// Schedule: Eval runs in place of the first packed tick, and the internal writes go away
+	op_flags.SetCount(op_count, 0);
+	eval_op = op_count;
+	for (const PackedGate& g : gates) {
+		op_flags[g.tick_op] |= SKIP;
+		eval_op = min(eval_op, g.tick_op);
+	}
+	for (int op_i : alias_op) {
+		if (op_i >= 0)
+			op_flags[op_i] |= SKIP;
+	}
+	
+	Vector<bool> stored;
+	stored.SetCount(gate_count, false);
+	for (int i = 0; i < op_count; i++) {
+		const ProcessOp& op = l.rt_ops[i];
+		if (op.type != WRITE || (op_flags[i] & SKIP))
+			continue;
+		int dest_tick = Contains(op.dest) ? eval_op : op.dest->tick_op;
+		if (dest_tick >= 0 && dest_tick < i)
+			op_flags[i] |= FEEDBACK;
+		int pi = gate_index.Find((size_t)op.processor);
+		int proc_tick = pi >= 0 ? eval_op : op.processor->tick_op;
+		if (proc_tick > i) {
+			op_flags[i] |= EARLY;
+			early_ops.Add(i);
+		}
+		// Boundary outputs are read by Process, so Eval keeps their storage current
+		if (pi >= 0 && !stored[gate_index[pi]]) {
+			const PackedGate& g = gates[gate_index[pi]];
+			stored[gate_index[pi]] = true;
+			ElcBase::PinStorage s;
+			g.node->GetPinStorage(GetInputCount(g.op), s);
+			PackedPort& p = outputs.Add();
+			p.net = g.out;
+			p.data = s.data;
+			p.bit = s.bit;
+		}
+	}
+	
+	return true;
+}
+
+void PackedNetlist::Eval() {
+	for (const PackedPort& p : inputs)
+		SetNet(p.net, (*p.data >> p.bit) & 1);
+	
+	uint64* w = nets.Begin();
+	for (const PackedGroup& grp : groups) {
+		for (int i = grp.first_move; i < grp.first_move + grp.move_count; i++)
+			CopyNetBits(w, moves[i].src, moves[i].dst, moves[i].count);
+		
+		// Operands and outputs are word aligned ranges in gate order; the padding bits
+		// of the last word belong to no net
+		const uint64* a = w + (grp.in_net[0] >> 6);
+		const uint64* b = grp.in_net[1] >= 0 ? w + (grp.in_net[1] >> 6) : a;
+		uint64* out = w + (grp.out_net >> 6);
+		int words = (grp.count + 63) >> 6;
+		for (int i = 0; i < words; i++)
+			out[i] = EvalGateOp(grp.op, a[i], b[i]);
+	}
+	
+	for (const PackedPort& p : outputs) {
+		byte v = GetNet(p.net);
+		*p.data = (*p.data & ~(1 << p.bit)) | (v << p.bit);
+	}
+}
+
+int PackedNetlist::FindNet(const ElcBase* node, int conn) const {
+	int i = gate_index.Find((size_t)node);
+	if (i < 0)
+		return -1;
+	const PackedGate& g = gates[gate_index[i]];
+	int in_count = GetInputCount(g.op);
+	if (conn == in_count)
+		return g.out;
+	if (conn < 0 || conn > in_count)
+		return -1;
+	return g.in[conn];
+}
+
+int PackedNetlist::FindNet(const String& node_name, const String& conn_name) const {
+	for (const PackedGate& g : gates) {
+		if (g.node->GetName() != node_name)
+			continue;
+		for (int i = 0; i < g.node->GetConnectorCount(); i++)
+			if (g.node->Get(i).name == conn_name)
+				return FindNet(g.node, i);
+	}
+	return -1;
+}
+
+String PackedNetlist::ToString() const {
+	String s;
+	s << gates.GetCount() << " gates in " << level_count << " levels, "
+	  << groups.GetCount() << " groups, " << net_count << " nets ("
+	  << inputs.GetCount() << " in, " << outputs.GetCount() << " out, "
+	  << moves.GetCount() << " moves)";
+	return s;
+}
+
+void LaneNetlist::Init(const PackedNetlist& nl) {
+	netlist = &nl;
+	lanes.SetCount(0);
+	lanes.SetCount(nl.net_count, 0);
+	force_mask.SetCount(0);
+	force_mask.SetCount(nl.net_count, 0);
+	force_value.SetCount(0);
+	force_value.SetCount(nl.net_count, 0);
+	unsettled = 0;
+}
+
+void LaneNetlist::Force(int net, uint64 lane_mask, bool value) {
+	force_mask[net] |= lane_mask;
+	if (value)
+		force_value[net] |= lane_mask;
+	else
+		force_value[net] &= ~lane_mask;
+}
+
+void LaneNetlist::ClearForces() {
+	for (uint64& m : force_mask)
+		m = 0;
+	for (uint64& v : force_value)
+		v = 0;
+}
+
+bool LaneNetlist::Eval() {
+	ASSERT(netlist);
+	const PackedNetlist& nl = *netlist;
+	
+	for (int pass = 0; pass < max_passes; pass++) {
+		for (const PackedPort& p : nl.inputs) {
+			uint64& v = lanes[p.net];
+			v = (v & ~force_mask[p.net]) | force_value[p.net];
+		}
+		
+		// Gates are sorted by level, so every input is final when its gate runs. Forces
+		// on an input pin apply when its operand is copied from the driving net.
+		for (const PackedGate& g : nl.gates) {
+			for (int pin = 0; pin < 2; pin++) {
+				int in = g.in[pin];
+				if (g.src[pin] >= 0)
+					lanes[in] = (lanes[g.src[pin]] & ~force_mask[in]) | force_value[in];
+			}
+			uint64 a = lanes[g.in[0]];
+			uint64 b = g.in[1] >= 0 ? lanes[g.in[1]] : 0;
+			uint64 r = EvalGateOp(g.op, a, b);
+			lanes[g.out] = (r & ~force_mask[g.out]) | force_value[g.out];
+		}
+		
+		// Carry cut feedback loops around until every lane settles
+		uint64 changed = 0;
+		for (const PackedPort& p : nl.inputs) {
+			if (p.driver < 0)
+				continue;
+			uint64 v = (lanes[p.driver] & ~force_mask[p.net]) | force_value[p.net];
+			changed |= lanes[p.net] ^ v;
+			lanes[p.net] = v;
+		}
+		unsettled = changed;
+		if (!changed)
+			return true;
+	}
+	
+	LOG("LaneNetlist::Eval: feedback did not settle in " << max_passes << " passes");
+	return false;
+}
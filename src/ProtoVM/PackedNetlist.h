@@ -0,0 +1,116 @@
+#ifndef _ProtoVM_PackedNetlist_h_
+#define _ProtoVM_PackedNetlist_h_
+
+
+
+
+// Gate-level view of the circuit where every single-bit net lives in one packed
+// bitvector. Gates reporting a GateOp are levelized and grouped by (level, op). Each
+// group's outputs and each of its input operands occupy a word aligned range in gate
+// order, so a group is evaluated as whole-word logic ops, 64 gates at a time. The
+// operands are gathered from the driving outputs by bit-range moves; the gates in a
+// group are ordered at build time so that these moves cover long runs.
+// Nets between two packed gates never touch the gate objects; nets crossing to the
+// rest of the circuit are loaded from / stored back to the gates' pin storage.
+struct PackedGate : Moveable<PackedGate> {
+	ElcBase* node = 0;
+	ElcBase::GateOp op = ElcBase::GATE_NONE;
+	int level = 0;
+	int tick_op = -1;
+	int in[2] = {-1, -1};   // operand net of each input pin
+	int src[2] = {-1, -1};  // output net of the packed gate driving the pin, if any
+	int out = -1;
+};
+
+struct PackedGroup : Moveable<PackedGroup> {
+	ElcBase::GateOp op = ElcBase::GATE_NONE;
+	int level = 0;
+	int first = 0;   // first index in PackedNetlist::gates
+	int count = 0;
+	int out_net = 0; // first output net, always word aligned
+	int in_net[2] = {-1, -1};  // first operand net per input pin, word aligned
+	int first_move = 0;        // operand gathers in PackedNetlist::moves
+	int move_count = 0;
+};
+
+// Copies count consecutive nets from src to dst
+struct PackedMove : Moveable<PackedMove> {
+	int src = 0;
+	int dst = 0;
+	int count = 0;
+};
+
+struct PackedPort : Moveable<PackedPort> {
+	int net = -1;
+	int driver = -1;  // inputs: output net of the packed gate behind a cut feedback loop
+	byte* data = 0;
+	byte bit = 0;
+};
+
+class PackedNetlist {
+public:
+	typedef enum : byte {
+		SKIP     = 1,  // replaced by Eval
+		FEEDBACK = 2,  // sink has already been evaluated when this write runs
+		EARLY    = 4,  // processor is evaluated after this write runs
+	} OpFlag;
+	
+	Vector<uint64> nets;
+	Vector<PackedGate> gates;
+	Vector<PackedGroup> groups;
+	Vector<PackedMove> moves;
+	Vector<PackedPort> inputs;   // loaded from gate storage before each Eval
+	Vector<PackedPort> outputs;  // stored to gate storage for the writes that still run
+	Vector<byte> op_flags;       // OpFlag bits per rt_ops index
+	Vector<int> early_ops;       // rt_ops indices with the EARLY flag
+	VectorMap<size_t, int> gate_index;
+	int eval_op = -1;            // rt_ops index where Eval replaces the packed ticks
+	int level_count = 0;
+	int net_count = 0;
+	
+	void Clear();
+	bool Build(const LinkBaseMap& l);
+	void Eval();
+	bool IsEmpty() const {return gates.IsEmpty();}
+	bool Contains(const ElcBase* n) const {return gate_index.Find((size_t)n) >= 0;}
+	bool GetNet(int net) const {return (nets[net >> 6] >> (net & 63)) & 1;}
+	void SetNet(int net, bool b);
+	String ToString() const;
+	
+	// Net of a gate pin. An input pin resolves to its own operand net, not to the net
+	// of the gate driving it, so forcing it affects that gate alone.
+	int FindNet(const ElcBase* node, int conn) const;
+	int FindNet(const String& node_name, const String& conn_name) const;
+	
+	static int GetInputCount(ElcBase::GateOp op) {return op == ElcBase::GATE_NOT ? 1 : 2;}
+	
+};
+
+// Runs a PackedNetlist as 64 independent instances: every net is one uint64 whose
+// bits are the lanes, so a gate evaluation advances all instances at once. The lanes
+// never touch the gate objects; inputs are set per lane and nets can be forced per
+// lane, which is how test vector batches and stuck-at fault campaigns use it.
+class LaneNetlist {
+public:
+	static const int LANES = 64;
+	
+	const PackedNetlist* netlist = 0;
+	Vector<uint64> lanes;       // per net
+	Vector<uint64> force_mask;  // per net: lanes whose value is forced
+	Vector<uint64> force_value; // per net: forced value of those lanes
+	int max_passes = 64;        // limit for settling cut feedback loops
+	uint64 unsettled = 0;       // lanes still changing when the last Eval gave up
+	
+	void Init(const PackedNetlist& nl);
+	void SetLanes(int net, uint64 v) {lanes[net] = v;}
+	uint64 GetLanes(int net) const {return lanes[net];}
+	void Force(int net, uint64 lane_mask, bool value);
+	void ClearForces();
+	bool Eval();  // false if some lanes were still changing after max_passes
+	
+};
+
+
+
+
+#endif
@@ -209,6 +209,7 @@ void Pcb::GetLinkBases(Array<LinkBase>& links) {
 				}
 					
 				LinkBase& l = links.Add();
+				l.order = links.GetCount() - 1;
 				// Handle bidirectional components properly
 				if (from.is_src && from.is_sink) {
 					// 'from' is bidirectional, so it can act as a source
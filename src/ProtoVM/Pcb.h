@@ -10,6 +10,7 @@ class Pcb {
 	
 protected:
 	friend class Machine;
+	friend class ElectricNodeBase;
 	Machine* mach = 0;
 	Array<ElectricNodeBase> nodes;
 	Array<ElectricNodeBase> refs;
@@ -249,6 +249,10 @@ CONSOLE_APP_MAIN {
 		Cout() << "  --verbosity=N   Set verbosity level directly (0=minimal, 1=default, 2=verbose, 3=very verbose)\n";
 		Cout() << "  -t, --ticks N  Run simulation for N ticks (default: 100)\n";
 		Cout() << "  --cli          Start in interactive CLI mode\n";
+		Cout() << "  --event-driven Only evaluate components whose inputs changed\n";
+		Cout() << "  --compiled     Run the flat compiled schedule instead of ProcessOps\n";
+		Cout() << "  --packed       Evaluate logic gates from a bit-packed netlist\n";
+		Cout() << "  --partitioned  Run every board on its own worker thread\n";
 		Cout() << "  --load-binary <file> [addr]  Load binary program file into memory at specified address\n";
 		Cout() << "Circuits:\n";
 		Cout() << "  flipflop         - Simple flip-flop test circuit\n";
@@ -306,6 +310,10 @@ CONSOLE_APP_MAIN {
 	int max_ticks = 100;
 	bool interactive_cli = false;
 	bool run_psl_test = false;
+	bool event_driven = false;
+	bool compiled = false;
+	bool packed = false;
+	bool partitioned = false;
 	int verbosity_level = 0;  // 0=minimal output, 1=default output, 2=verbose output, 3=very verbose
 	String binary_file = "";  // Binary file to load
 	int load_address = 0; // Address to load the binary file
@@ -323,6 +331,18 @@ CONSOLE_APP_MAIN {
 		else if (arg == "--psl-test") {
 			run_psl_test = true;
 		}
+		else if (arg == "--event-driven") {
+			event_driven = true;
+		}
+		else if (arg == "--compiled") {
+			compiled = true;
+		}
+		else if (arg == "--packed") {
+			packed = true;
+		}
+		else if (arg == "--partitioned") {
+			partitioned = true;
+		}
 		else if (arg == "--load-binary" || arg == "-lb") {
 			if (i + 1 < args.GetCount()) {
 				binary_file = args[i + 1];
@@ -354,6 +374,10 @@ CONSOLE_APP_MAIN {
 
 	// Create the simulation machine
     Machine mach;
+    mach.use_event_driven = event_driven;
+    mach.use_compiled_schedule = compiled;
+    mach.use_packed_nets = packed;
+    mach.use_partitions = partitioned;
 
 	// Setup the requested circuit first
 	if (!circuit_name.IsEmpty()) {
@@ -16,6 +16,9 @@ using namespace Upp;
 #include "Component.h"
 #include "Bus.h"
 #include "Link.h"
+#include "CompiledSchedule.h"
+#include "PackedNetlist.h"
+#include "TimingWheel.h"
 #include "Pcb.h"
 #include "Machine.h"
 #include "Generic.h"
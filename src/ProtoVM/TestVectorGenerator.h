@@ -38,6 +38,10 @@ private:
     Vector<TestResult> test_results;
     String component_name;    // Name of the component being tested
     String test_suite_name;   // Name of the test suite
+    Vector<int> lane_inputs;  // PackedNetlist nets fed by the input bits, LSB of inputs[0] first
+    Vector<int> lane_outputs; // PackedNetlist nets read back as output bits
+    
+    bool RunAllTestsInLanes(Machine& mach);
     
 public:
     TestVectorGenerator(const String& comp_name = "", const String& suite_name = "");
@@ -74,6 +78,9 @@ public:
     // Setters
     void SetComponentName(const String& name) { component_name = name; }
     void SetTestSuiteName(const String& name) { test_suite_name = name; }
+    // Bind vector bits to packed nets so RunAllTests evaluates 64 vectors per pass
+    // (requires Machine::use_packed_nets; see PackedNetlist::FindNet)
+    void SetLaneBinding(const Vector<int>& input_nets, const Vector<int>& output_nets);
 };
 
 // Specialized test generator for ALU components
@@ -0,0 +1,66 @@
+#include "ProtoVM.h"
+
+
+
+
+void TimingWheel::Clear() {
+	for (Vector<DelayedEvent>& slot : slots)
+		slot.SetCount(0);
+	running.SetCount(0);
+	overflow.SetCount(0);
+	actions.Clear();
+	free_actions.SetCount(0);
+	cursor = 0;
+	seq = 0;
+	wheel_count = 0;
+}
+
+void TimingWheel::Add(int64 tick, const DelayedEvent& e) {
+	// Overdue events run with the current slot while running, otherwise in the next call
+	if (tick <= cursor)
+		tick = in_run ? cursor : cursor + 1;
+	
+	if (tick - cursor < SLOTS) {
+		slots[tick & (SLOTS - 1)].Add(e);
+		wheel_count++;
+		return;
+	}
+	
+	Pending& p = overflow.Add();
+	p.tick = tick;
+	p.seq = seq++;
+	p.e = e;
+	std::push_heap(overflow.begin(), overflow.end());
+}
+
+int TimingWheel::AddAction(int64 tick, Action action) {
+	DelayedEvent e;
+	if (free_actions.IsEmpty()) {
+		e.action = actions.GetCount();
+		actions.Add(new Action(pick(action)));
+	}
+	else {
+		e.action = free_actions.Pop();
+		actions[e.action] = pick(action);
+	}
+	Add(tick, e);
+	return e.action;
+}
+
+bool TimingWheel::RunAction(const DelayedEvent& e) {
+	ASSERT(e.action >= 0 && e.action < actions.GetCount());
+	Action action = pick(actions[e.action]);
+	actions[e.action] = Action();
+	free_actions.Add(e.action);
+	return action ? action() : false;
+}
+
+void TimingWheel::Promote() {
+	while (!overflow.IsEmpty() && overflow[0].tick - cursor < SLOTS) {
+		std::pop_heap(overflow.begin(), overflow.end());
+		const Pending& p = overflow.Top();
+		slots[p.tick & (SLOTS - 1)].Add(p.e);
+		wheel_count++;
+		overflow.Drop();
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef _ProtoVM_TimingWheel_h_
+#define _ProtoVM_TimingWheel_h_
+
+#include <functional>
+#include <algorithm>
+
+
+
+
+// A delayed event. The common case is a plain value delivered to a connector with
+// PutRaw, stored inline; anything else goes through a std::function kept aside.
+struct DelayedEvent : Moveable<DelayedEvent> {
+	ElcBase* dest = 0;     // PutRaw target, or 0 for an action event
+	uint16 conn_id = 0;
+	byte bytes = 0;
+	byte bits = 0;
+	byte value[8];
+	int action = -1;       // TimingWheel action slot when dest is 0
+};
+
+// Timing wheel keyed by execution tick. Each slot holds the events of exactly one
+// tick inside the window [cursor + 1, cursor + SLOTS - 1] (Add accepts
+// tick - cursor < SLOTS; the slot of the cursor itself only takes overdue events
+// added while it is being run). Later events wait in an overflow heap and move
+// into the wheel as the cursor approaches them. Events of the same tick run in
+// scheduling order.
+class TimingWheel {
+public:
+	static const int SLOTS = 256;
+	
+	typedef std::function<bool()> Action;
+	
+	void Clear();
+	void Add(int64 tick, const DelayedEvent& e);
+	int AddAction(int64 tick, Action action);
+	template <class F> void Run(int64 tick, F fn);
+	template <class F> void ForEach(F fn) const;
+	
+	int64 GetCursor() const {return cursor;}
+	int GetCount() const {return wheel_count + overflow.GetCount();}
+	bool IsEmpty() const {return GetCount() == 0;}
+	bool RunAction(const DelayedEvent& e);
+	
+private:
+	struct Pending : Moveable<Pending> {
+		int64 tick;
+		int64 seq;
+		DelayedEvent e;
+		// Reversed for std::push_heap, so that the earliest event is on top
+		bool operator<(const Pending& b) const {return tick != b.tick ? tick > b.tick : seq > b.seq;}
+	};
+	
+	Vector<DelayedEvent> slots[SLOTS];
+	Vector<DelayedEvent> running;
+	Vector<Pending> overflow;
+	Array<Action> actions;
+	Vector<int> free_actions;
+	int64 cursor = 0;      // last tick that has been run
+	int64 seq = 0;
+	int wheel_count = 0;
+	bool in_run = false;
+	
+	void Promote();
+
+};
+
+// Runs everything due up to and including tick, calling fn for every event.
+// Events added while running that are due by then run in the same call.
+template <class F>
+void TimingWheel::Run(int64 tick, F fn) {
+	in_run = true;
+	while (cursor < tick) {
+		// Skip empty stretches instead of walking them slot by slot
+		if (!wheel_count) {
+			if (overflow.IsEmpty()) {
+				cursor = tick;
+				break;
+			}
+			cursor = max(cursor, min(tick, overflow[0].tick - 1));
+			Promote();
+			if (cursor == tick)
+				break;
+		}
+		cursor++;
+		Promote();
+		Vector<DelayedEvent>& slot = slots[cursor & (SLOTS - 1)];
+		while (!slot.IsEmpty()) {
+			// Swap buffers so the slot keeps its capacity for the next round
+			running.SetCount(0);
+			Swap(running, slot);
+			wheel_count -= running.GetCount();
+			for (const DelayedEvent& e : running)
+				fn(e);
+		}
+	}
+	in_run = false;
+}
+
+// Visits every pending event as fn(tick, event), in the order Run would execute them
+template <class F>
+void TimingWheel::ForEach(F fn) const {
+	for (int i = 1; i < SLOTS; i++)
+		for (const DelayedEvent& e : slots[(cursor + i) & (SLOTS - 1)])
+			fn(cursor + i, e);
+	Vector<Pending> sorted;
+	sorted <<= overflow;
+	std::sort(sorted.begin(), sorted.end(), [](const Pending& a, const Pending& b) {return b < a;});
+	for (const Pending& p : sorted)
+		fn(p.tick, p.e);
+}
+
+
+
+
+#endif
@@ -22,6 +22,8 @@ TriodeTube::TriodeTube() {
     AddSink("GRID");     // Control grid input
     AddBidirectional("PLATE");  // Plate (anode) - can source or sink current
     AddBidirectional("CATHODE"); // Cathode - can source or sink current
+    analog_values.resize(3, 0.0);
+    UpdatePerveance();
 
     LOG("TriodeTube: Initialized with 12AX7 parameters");
 }
@@ -30,22 +32,35 @@ void TriodeTube::SetAmplificationFactor(double mu) {
     amplification_factor = mu;
     // Update transconductance based on relationship gm = mu/rp
     transconductance = amplification_factor / plate_resistance;
+    UpdatePerveance();
 }
 
 void TriodeTube::SetPlateResistance(double rp) {
     plate_resistance = rp;
     // Update transconductance based on relationship gm = mu/rp
     transconductance = amplification_factor / plate_resistance;
+    UpdatePerveance();
 }
 
 void TriodeTube::SetTransconductance(double gm) {
     transconductance = gm;
     // Update plate resistance based on relationship rp = mu/gm
     plate_resistance = amplification_factor / transconductance;
+    UpdatePerveance();
+}
+
+void TriodeTube::UpdatePerveance() {
+    // With Ip = Kp * x^1.5, 1/rp = dIp/dVpk = 1.5 * Kp * x^0.5 = 1.5 * Ip / x, so the
+    // reference current flows at x = 1.5 * rp * Ip
+    double x = 1.5 * plate_resistance * REFERENCE_PLATE_CURRENT;
+    perveance = REFERENCE_PLATE_CURRENT / pow(x, 1.5);
 }
 
 bool TriodeTube::Tick() {
     // Update the triode state based on current voltages
+    grid_voltage = GetAnalogValue(GRID);
+    plate_voltage = GetAnalogValue(PLATE);
+    cathode_voltage = GetAnalogValue(CATHODE);
     UpdateTriodeState();
 
     return true;
@@ -105,12 +120,15 @@ bool TriodeTube::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bit
         
         if (conn_name == "GRID") {
             grid_voltage = voltage;
+            SetAnalogValue(GRID, voltage);
             SetChanged(true);
         } else if (conn_name == "PLATE") {
             plate_voltage = voltage;
+            SetAnalogValue(PLATE, voltage);
             SetChanged(true);
         } else if (conn_name == "CATHODE") {
             cathode_voltage = voltage;
+            SetAnalogValue(CATHODE, voltage);
             SetChanged(true);
         }
     }
@@ -118,36 +136,61 @@ bool TriodeTube::PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bit
     return true;
 }
 
-double TriodeTube::CalculatePlateCurrent(double vg, double vp) {
-    // Calculate the plate current based on triode equations
-    // A simple model: Ip = gm * (Vg + (Vp/mu)) for linear region
-    // Add clipping for saturation/cutoff
-
-    double effective_grid_voltage = vg - (-vp / amplification_factor);  // Account for dc bias
-
-    if (effective_grid_voltage <= -4.0) {  // Cutoff region (-4V is approximate cutoff for 12AX7)
-        return 0.0;
+double TriodeTube::CalculatePlateCurrent(double vgk, double vpk, double* gm, double* gp) const {
+    // Child-Langmuir law: Ip = Kp * (mu * Vgk + Vpk)^1.5, cut off when the effective
+    // voltage is not positive and clipped at max_plate_current. gm and gp receive the
+    // derivatives by Vgk and Vpk.
+    double effective_voltage = amplification_factor * vgk + vpk;
+    double current = 0.0;
+    double slope = 0.0;
+    
+    if (effective_voltage > 0.0) {
+        double root = sqrt(effective_voltage);
+        current = perveance * effective_voltage * root;
+        slope = 1.5 * perveance * root;
+        
+        // Apply saturation limit
+        if (current > max_plate_current) {
+            current = max_plate_current;
+            slope = 0.0;
+        }
     }
+    
+    if (gm) *gm = slope * amplification_factor;
+    if (gp) *gp = slope;
+    return current;
+}
 
-    // Linear region: use transconductance model
-    double current = transconductance * effective_grid_voltage * amplification_factor;
+void TriodeTube::GetPinCurrents(const double* v, double* i) const {
+    double g[9];
+    GetPinConductances(v, i, g);
+}
 
-    // Apply saturation limit
-    if (current > max_plate_current) {
-        current = max_plate_current;
+bool TriodeTube::GetPinConductances(const double* v, double* i, double* g) const {
+    // No grid current; the plate current flows in at the plate and out at the cathode
+    double gm, gp;
+    double ip = CalculatePlateCurrent(v[GRID] - v[CATHODE], v[PLATE] - v[CATHODE], &gm, &gp);
+    i[GRID] = 0.0;
+    i[PLATE] = ip;
+    i[CATHODE] = -ip;
+    
+    // Rows are the pin currents, columns the grid, plate and cathode voltages
+    for (int q = 0; q < 3; q++) {
+        g[GRID * 3 + q] = 0.0;
     }
-
-    if (current < 0) {
-        current = 0;
+    g[PLATE * 3 + GRID] = gm;
+    g[PLATE * 3 + PLATE] = gp;
+    g[PLATE * 3 + CATHODE] = -(gm + gp);
+    for (int q = 0; q < 3; q++) {
+        g[CATHODE * 3 + q] = -g[PLATE * 3 + q];
     }
-
-    return current;
+    return true;
 }
 
 void TriodeTube::UpdateTriodeState() {
     // Calculate new plate current based on current grid and plate voltages
     // In a real triode, the grid controls the electron flow from cathode to plate
-    plate_current = CalculatePlateCurrent(grid_voltage, plate_voltage);
+    plate_current = CalculatePlateCurrent(grid_voltage - cathode_voltage, plate_voltage - cathode_voltage);
 
     // For the simulation model, we need to represent this as a current source/sink
     // depending on the operating point
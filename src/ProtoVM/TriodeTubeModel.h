@@ -13,9 +13,14 @@
  * of electron flow between cathode, grid, and anode (plate).
  * 
  * The simplest model uses the Child-Langmuir law modified for triodes:
- * Ip = Kp * (Vg - mu*Vp)^1.5
+ * Ip = Kp * (mu*Vgk + Vpk)^1.5
  * 
  * For small signal analysis, transconductance gm and plate resistance rp are used.
+ * The perveance Kp is chosen so that both hold at REFERENCE_PLATE_CURRENT.
+ *
+ * The tube is stamped into AnalogSimulation with the analytic derivatives of that
+ * law. Voltages received through PutRaw land in analog_values as well, so Tick works
+ * the same whether the solver or a digital driver sets them.
  */
 
 class TriodeTube : public AnalogNodeBase {
@@ -28,6 +33,9 @@ public:
     bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override;
 
     String GetClassName() const override { return "TriodeTube"; }
+    bool IsStamped() const override { return true; }
+    void GetPinCurrents(const double* v, double* i) const override;
+    bool GetPinConductances(const double* v, double* i, double* g) const override;
 
     // Set tube parameters
     void SetAmplificationFactor(double mu);
@@ -45,6 +53,7 @@ private:
     double plate_resistance;       // rp (plate resistance in ohms)
     double transconductance;       // gm (transconductance in siemens)
     double max_plate_current;      // Maximum plate current for saturation modeling
+    double perveance;              // Kp of the Child-Langmuir law
 
     // Operating point
     double plate_current;
@@ -62,7 +71,10 @@ public:
 
 private:
     void UpdateTriodeState();
-    double CalculatePlateCurrent(double vg, double vp);
+    void UpdatePerveance();
+    double CalculatePlateCurrent(double vgk, double vpk, double* gm = nullptr, double* gp = nullptr) const;
+    
+    static constexpr double REFERENCE_PLATE_CURRENT = 1e-3;  // 1mA, a typical 12AX7 bias
 };
 
 #endif
\ No newline at end of file
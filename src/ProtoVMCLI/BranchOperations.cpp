@@ -85,6 +85,8 @@ Result<BranchCreateResult> BranchOperations::CreateBranch(
     new_branch.base_revision = source_revision;
     new_branch.is_default = false;
     
+    // The revisions up to base_revision are logged under the source branch, so the
+    // caller checkpoints the new branch there (CircuitFacade::CheckpointBranchFrom)
     session.branches.push_back(new_branch);
     
     BranchCreateResult result;
@@ -211,12 +213,15 @@ Result<BranchMergeResult> BranchOperations::MergeBranch(
     result.target_branch = target_branch;
 
     if (source_branch_meta.head_revision > target_branch_meta.head_revision) {
-        // Update the target branch to have the same head revision as source
+        result.merged_ops_count = static_cast<int>(source_branch_meta.head_revision - target_branch_meta.head_revision);
+
+        // Update the target branch to have the same head revision as source. The source
+        // revisions are logged under the source branch, so the caller checkpoints the
+        // target at its new head (CircuitFacade::CheckpointBranchFrom).
         target_branch_meta.head_revision = source_branch_meta.head_revision;
         target_branch_meta.sim_revision = source_branch_meta.sim_revision;  // Update sim revision too
 
         result.target_new_revision = target_branch_meta.head_revision;
-        result.merged_ops_count = static_cast<int>(source_branch_meta.head_revision - target_branch_meta.head_revision);
 
         return Result<BranchMergeResult>::MakeOk(result);
     } else {
@@ -29,4 +29,41 @@ namespace CircuitIdGenerator {
         return CircuitEntityId(ss.str());
     }
 
+    // Number of an id in the "<prefix><digits>" format, 0 for any other id
+    static int IdNumber(const CircuitEntityId& id, char prefix) {
+        const std::string& s = id.id;
+        if (s.size() < 2 || s.size() > 10 || s[0] != prefix) {
+            return 0;
+        }
+        int n = 0;
+        for (size_t i = 1; i < s.size(); i++) {
+            if (s[i] < '0' || s[i] > '9') {
+                return 0;
+            }
+            n = n * 10 + (s[i] - '0');
+        }
+        return n;
+    }
+
+    static void ReserveAbove(std::atomic<int>& counter, int used) {
+        int next = counter.load();
+        while (next <= used && !counter.compare_exchange_weak(next, used + 1)) {
+        }
+    }
+
+    void ReserveIdsOf(const CircuitData& circuit) {
+        for (const auto& comp : circuit.components) {
+            ReserveAbove(component_counter, IdNumber(comp.id, 'C'));
+            for (const auto& pin : comp.inputs) {
+                ReserveAbove(pin_counter, IdNumber(pin.id, 'P'));
+            }
+            for (const auto& pin : comp.outputs) {
+                ReserveAbove(pin_counter, IdNumber(pin.id, 'P'));
+            }
+        }
+        for (const auto& wire : circuit.wires) {
+            ReserveAbove(wire_counter, IdNumber(wire.id, 'W'));
+        }
+    }
+
 } // namespace CircuitIdGenerator
\ No newline at end of file
@@ -75,6 +75,10 @@ namespace CircuitIdGenerator {
     CircuitEntityId GenerateComponentId();
     CircuitEntityId GenerateWireId();
     CircuitEntityId GeneratePinId();
+
+    // Moves the counters past the ids already used in circuit, so that a new
+    // process doesn't hand out ids of entities loaded from disk
+    void ReserveIdsOf(const CircuitData& circuit);
 }
 
 #endif // _ProtoVM_CircuitData_h_
\ No newline at end of file
@@ -28,6 +28,8 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <cstdio>
+#include <limits>
 
 namespace fs = std::filesystem;
 
@@ -88,6 +90,189 @@ std::string GetCurrentTimestamp() {
     return std::string(buffer);
 }
 
+// Binary encoding of edit operations (journal payloads) and circuit checkpoints
+template <class T>
+static void PutRaw(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+static void PutString(std::string& out, const std::string& s) {
+    PutRaw<uint32_t>(out, (uint32_t)s.size());
+    out += s;
+}
+
+struct BinaryReader {
+    const std::string& data;
+    size_t pos = 0;
+    bool ok = true;
+
+    explicit BinaryReader(const std::string& d) : data(d) {}
+
+    template <class T>
+    T Get() {
+        T v = T();
+        if (!ok || pos + sizeof(T) > data.size()) {
+            ok = false;
+            return v;
+        }
+        std::copy(data.data() + pos, data.data() + pos + sizeof(T), reinterpret_cast<char*>(&v));
+        pos += sizeof(T);
+        return v;
+    }
+
+    std::string GetString() {
+        uint32_t len = Get<uint32_t>();
+        if (!ok || pos + len > data.size()) {
+            ok = false;
+            return std::string();
+        }
+        std::string s = data.substr(pos, len);
+        pos += len;
+        return s;
+    }
+};
+
+static std::string EncodeEditOperation(const EditOperation& op) {
+    std::string out;
+    PutRaw<int32_t>(out, (int32_t)op.type);
+    PutRaw<int64_t>(out, op.revision_base);
+    PutString(out, op.component_id.id);
+    PutString(out, op.wire_id.id);
+    PutRaw<int32_t>(out, op.x);
+    PutRaw<int32_t>(out, op.y);
+    PutString(out, op.property_name);
+    PutString(out, op.property_value);
+    PutString(out, op.target_component_id.id);
+    PutString(out, op.pin_name);
+    PutString(out, op.target_pin_name);
+    PutString(out, op.component_type);
+    PutString(out, op.component_name);
+    PutRaw<uint32_t>(out, (uint32_t)op.properties.size());
+    for (const auto& prop : op.properties) {
+        PutString(out, prop.first);
+        PutString(out, prop.second);
+    }
+    return out;
+}
+
+static bool DecodeEditOperation(const std::string& data, EditOperation& op) {
+    BinaryReader r(data);
+    op.type = (EditOpType)r.Get<int32_t>();
+    op.revision_base = r.Get<int64_t>();
+    op.component_id.id = r.GetString();
+    op.wire_id.id = r.GetString();
+    op.x = r.Get<int32_t>();
+    op.y = r.Get<int32_t>();
+    op.property_name = r.GetString();
+    op.property_value = r.GetString();
+    op.target_component_id.id = r.GetString();
+    op.pin_name = r.GetString();
+    op.target_pin_name = r.GetString();
+    op.component_type = r.GetString();
+    op.component_name = r.GetString();
+    uint32_t prop_count = r.Get<uint32_t>();
+    op.properties.clear();
+    for (uint32_t i = 0; i < prop_count && r.ok; i++) {
+        std::string name = r.GetString();
+        std::string value = r.GetString();
+        op.properties.emplace_back(name, value);
+    }
+    return r.ok && r.pos == data.size();
+}
+
+static void PutPins(std::string& out, const std::vector<PinData>& pins) {
+    PutRaw<uint32_t>(out, (uint32_t)pins.size());
+    for (const PinData& pin : pins) {
+        PutString(out, pin.id.id);
+        PutString(out, pin.name);
+        PutRaw<uint8_t>(out, pin.is_input);
+        PutRaw<int32_t>(out, pin.x);
+        PutRaw<int32_t>(out, pin.y);
+    }
+}
+
+static void GetPins(BinaryReader& r, std::vector<PinData>& pins) {
+    uint32_t count = r.Get<uint32_t>();
+    pins.clear();
+    for (uint32_t i = 0; i < count && r.ok; i++) {
+        PinData pin;
+        pin.id.id = r.GetString();
+        pin.name = r.GetString();
+        pin.is_input = r.Get<uint8_t>() != 0;
+        pin.x = r.Get<int32_t>();
+        pin.y = r.Get<int32_t>();
+        pins.push_back(pin);
+    }
+}
+
+static const char circuit_snapshot_magic[8] = {'P', 'V', 'M', 'C', 'I', 'R', 'C', 0};
+static const int32_t CIRCUIT_SNAPSHOT_VERSION = 1;
+
+static std::string EncodeCircuitSnapshot(const CircuitData& circuit, const std::string& branch_name, int64_t revision) {
+    std::string out(circuit_snapshot_magic, sizeof(circuit_snapshot_magic));
+    PutRaw<int32_t>(out, CIRCUIT_SNAPSHOT_VERSION);
+    PutString(out, branch_name);
+    PutRaw<int64_t>(out, revision);
+    PutString(out, circuit.name);
+    PutString(out, circuit.description);
+    PutRaw<uint32_t>(out, (uint32_t)circuit.components.size());
+    for (const ComponentData& comp : circuit.components) {
+        PutString(out, comp.id.id);
+        PutString(out, comp.type);
+        PutString(out, comp.name);
+        PutRaw<int32_t>(out, comp.x);
+        PutRaw<int32_t>(out, comp.y);
+        PutPins(out, comp.inputs);
+        PutPins(out, comp.outputs);
+    }
+    PutRaw<uint32_t>(out, (uint32_t)circuit.wires.size());
+    for (const WireData& wire : circuit.wires) {
+        PutString(out, wire.id.id);
+        PutString(out, wire.start_component_id.id);
+        PutString(out, wire.start_pin_name);
+        PutString(out, wire.end_component_id.id);
+        PutString(out, wire.end_pin_name);
+    }
+    return out;
+}
+
+static bool DecodeCircuitSnapshot(const std::string& data, const std::string& branch_name, int64_t revision, CircuitData& circuit) {
+    if (data.compare(0, sizeof(circuit_snapshot_magic), circuit_snapshot_magic, sizeof(circuit_snapshot_magic)) != 0) {
+        return false;
+    }
+    BinaryReader r(data);
+    r.pos = sizeof(circuit_snapshot_magic);
+    if (r.Get<int32_t>() != CIRCUIT_SNAPSHOT_VERSION || r.GetString() != branch_name || r.Get<int64_t>() != revision) {
+        return false;
+    }
+    circuit = CircuitData();
+    circuit.name = r.GetString();
+    circuit.description = r.GetString();
+    uint32_t comp_count = r.Get<uint32_t>();
+    for (uint32_t i = 0; i < comp_count && r.ok; i++) {
+        ComponentData comp;
+        comp.id.id = r.GetString();
+        comp.type = r.GetString();
+        comp.name = r.GetString();
+        comp.x = r.Get<int32_t>();
+        comp.y = r.Get<int32_t>();
+        GetPins(r, comp.inputs);
+        GetPins(r, comp.outputs);
+        circuit.components.push_back(std::move(comp));
+    }
+    uint32_t wire_count = r.Get<uint32_t>();
+    for (uint32_t i = 0; i < wire_count && r.ok; i++) {
+        WireData wire;
+        wire.id.id = r.GetString();
+        wire.start_component_id.id = r.GetString();
+        wire.start_pin_name = r.GetString();
+        wire.end_component_id.id = r.GetString();
+        wire.end_pin_name = r.GetString();
+        circuit.wires.push_back(std::move(wire));
+    }
+    return r.ok && r.pos == data.size();
+}
+
 Result<CircuitRevisionInfo> CircuitFacade::LoadCurrentCircuit(
     const SessionMetadata& session,
     const std::string& session_dir,
@@ -116,28 +301,25 @@ Result<CircuitRevisionInfo> CircuitFacade::LoadCurrentCircuitForBranch(
         BranchMetadata branch = branch_opt.value();
         int64_t branch_revision = branch.head_revision;
 
-        // First, try to load from a circuit snapshot if it exists and is up-to-date
-        int64_t snapshot_rev = GetLatestCircuitSnapshotRevision(session_dir);
-        if (snapshot_rev > 0 && snapshot_rev < branch_revision) {
-            // Load from snapshot and replay events from snapshot_rev+1 to branch_revision
-            auto load_result = LoadCircuitFromSnapshot(session_dir, out_circuit);
+        // First, try the branch's latest checkpoint at or before the revision, and
+        // replay only the events after it
+        int64_t snapshot_rev = GetCircuitSnapshotRevision(session_dir, branch_name, branch_revision);
+        if (snapshot_rev > 0) {
+            auto load_result = LoadCircuitFromSnapshot(session_dir, branch_name, snapshot_rev, out_circuit);
             if (load_result.ok) {
-                auto replay_result = ReplayCircuitEventsForBranch(out_circuit, session_dir,
-                                                                 snapshot_rev + 1, branch_revision, branch_name);
+                auto replay_result = Result<bool>::MakeOk(true);
+                if (snapshot_rev < branch_revision) {
+                    replay_result = ReplayCircuitEventsForBranch(out_circuit, session_dir,
+                                                                snapshot_rev + 1, branch_revision, branch_name);
+                }
                 if (replay_result.ok) {
                     CircuitRevisionInfo info;
                     info.revision = branch_revision;
                     return Result<CircuitRevisionInfo>::MakeOk(info);
                 }
             }
-        } else if (snapshot_rev == branch_revision) {
-            // Load directly from the snapshot
-            auto load_result = LoadCircuitFromSnapshot(session_dir, out_circuit);
-            if (load_result.ok) {
-                CircuitRevisionInfo info;
-                info.revision = branch_revision;
-                return Result<CircuitRevisionInfo>::MakeOk(info);
-            }
+            // Otherwise fall back to a full replay
+            out_circuit = CircuitData();
         }
 
         // If no snapshot or it's not usable, start with the initial circuit
@@ -268,6 +450,19 @@ Result<CircuitRevisionInfo> CircuitFacade::ApplyEditOperationsToBranch(
             );
         }
 
+        // Assign the ids of new components and wires here, so the logged operations
+        // recreate the same ids when they are replayed. The counters start at 1 in
+        // every process, so they first skip the ids the circuit already has.
+        CircuitIdGenerator::ReserveIdsOf(current_circuit);
+        for (auto& op : final_ops) {
+            if (op.type == EditOpType::AddComponent && !op.component_id.IsValid()) {
+                op.component_id = CircuitIdGenerator::GenerateComponentId();
+            }
+            else if (op.type == EditOpType::Connect && !op.wire_id.IsValid()) {
+                op.wire_id = CircuitIdGenerator::GenerateWireId();
+            }
+        }
+
         // Apply each operation to the circuit
         for (const auto& op : final_ops) {
             auto apply_result = ApplyEditOperation(current_circuit, op);
@@ -279,112 +474,257 @@ Result<CircuitRevisionInfo> CircuitFacade::ApplyEditOperationsToBranch(
             }
         }
 
-        // Increment the circuit revision for this branch
-        int64_t new_revision = branch_revision + 1;
+        return CommitEditOperations(session, session_dir, current_circuit, final_ops, user_id,
+                                    branch_name, branch_revision, client_revision);
+    }
+    catch (const std::exception& e) {
+        return Result<CircuitRevisionInfo>::MakeError(
+            ErrorCode::InternalError,
+            std::string("Exception in ApplyEditOperationsToBranch: ") + e.what()
+        );
+    }
+}
+
+Result<CircuitRevisionInfo> CircuitFacade::ApplyEditOperationBatchToBranch(
+    SessionMetadata& session,
+    const std::string& session_dir,
+    std::vector<EditOperation>& ops,
+    const std::string& user_id,
+    const std::string& branch_name,
+    bool all_or_nothing,
+    std::vector<std::string>& op_errors
+) {
+    try {
+        op_errors.assign(ops.size(), std::string());
 
-        // Save circuit snapshot periodically (e.g., every 50 edits or at certain intervals)
-        if (new_revision % 50 == 0) {
-            auto snapshot_result = SaveCircuitSnapshot(current_circuit, session_dir, new_revision);
-            if (!snapshot_result.ok) {
-                // This is a warning, not a fatal error - we can continue without snapshot
-                // Log the issue but don't fail the operation
-            }
+        std::optional<BranchMetadata> branch_opt = FindBranchByName(session, branch_name);
+        if (!branch_opt.has_value()) {
+            return Result<CircuitRevisionInfo>::MakeError(
+                ErrorCode::InvalidEditOperation,
+                "Branch not found: " + branch_name
+            );
         }
+        int64_t branch_revision = branch_opt->head_revision;
 
-        // Update branch's head_revision in session metadata
-        for (auto& branch : session.branches) {
-            if (branch.name == branch_name) {
-                branch.head_revision = new_revision;
-                break;
-            }
+        CircuitData circuit;
+        auto load_result = LoadCurrentCircuitForBranch(session, session_dir, branch_name, circuit);
+        if (!load_result.ok) {
+            return Result<CircuitRevisionInfo>::MakeError(
+                load_result.error_code,
+                load_result.error_message
+            );
         }
 
-        // Log the operation as an event with branch information
-        for (const auto& op : final_ops) {
-            EventLogEntry event;
-            event.timestamp = GetCurrentTimestamp(); // We'll need to define this helper
-            event.user_id = user_id;
-            event.session_id = session.session_id;
-            event.branch = branch_name;  // Add the branch information
-
-            // Map EditOpType to string command
-            std::string op_cmd;
-            switch (op.type) {
-                case EditOpType::AddComponent: op_cmd = "add_component"; break;
-                case EditOpType::RemoveComponent: op_cmd = "remove_component"; break;
-                case EditOpType::MoveComponent: op_cmd = "move_component"; break;
-                case EditOpType::SetComponentProperty: op_cmd = "set_component_property"; break;
-                case EditOpType::Connect: op_cmd = "connect"; break;
-                case EditOpType::Disconnect: op_cmd = "disconnect"; break;
-            }
-            event.command = op_cmd;
-
-            // Create params object for the operation
-            Upp::ValueMap params;
-            params.Add("revision", Upp::String(std::to_string(new_revision).c_str()));
-            params.Add("branch", Upp::String(branch_name.c_str()));
-            if (op.component_id.IsValid()) {
-                params.Add("component_id", Upp::String(op.component_id.id.c_str()));
-            }
-            if (op.wire_id.IsValid()) {
-                params.Add("wire_id", Upp::String(op.wire_id.id.c_str()));
-            }
-            params.Add("x", op.x);
-            params.Add("y", op.y);
-            if (!op.property_name.empty()) {
-                params.Add("property_name", Upp::String(op.property_name.c_str()));
-            }
-            if (!op.property_value.empty()) {
-                params.Add("property_value", Upp::String(op.property_value.c_str()));
-            }
-            if (op.target_component_id.IsValid()) {
-                params.Add("target_component_id", Upp::String(op.target_component_id.id.c_str()));
-            }
-            if (!op.pin_name.empty()) {
-                params.Add("pin_name", Upp::String(op.pin_name.c_str()));
-            }
-            if (!op.target_pin_name.empty()) {
-                params.Add("target_pin_name", Upp::String(op.target_pin_name.c_str()));
-            }
-            if (!op.component_type.empty()) {
-                params.Add("component_type", Upp::String(op.component_type.c_str()));
+        // New ids must not repeat the ones of the loaded circuit
+        CircuitIdGenerator::ReserveIdsOf(circuit);
+
+        // Each operation sees the ones before it; a failed one is left out of the revision
+        std::vector<EditOperation> applied;
+        bool failed = false;
+        for (size_t i = 0; i < ops.size(); i++) {
+            EditOperation& op = ops[i];
+            if (op.type == EditOpType::AddComponent && !op.component_id.IsValid()) {
+                op.component_id = CircuitIdGenerator::GenerateComponentId();
             }
-            if (!op.component_name.empty()) {
-                params.Add("component_name", Upp::String(op.component_name.c_str()));
+            else if (op.type == EditOpType::Connect && !op.wire_id.IsValid()) {
+                op.wire_id = CircuitIdGenerator::GenerateWireId();
             }
 
-            // Add collaboration-specific parameters
-            if (client_revision > 0) {
-                params.Add("expected_revision", Upp::String(std::to_string(client_revision).c_str()));
+            auto apply_result = ApplyEditOperation(circuit, op);
+            if (!apply_result.ok) {
+                op_errors[i] = apply_result.error_message;
+                failed = true;
+                if (all_or_nothing) {
+                    break;
+                }
+                continue;
             }
+            applied.push_back(op);
+        }
 
-            event.params = Upp::String().Cat() << params;
+        if (applied.empty() || (failed && all_or_nothing)) {
+            CircuitRevisionInfo info;
+            info.revision = branch_revision;
+            return Result<CircuitRevisionInfo>::MakeOk(info);
+        }
 
-            // Create result object
-            Upp::ValueMap result_data;
-            result_data.Add("revision", Upp::String(std::to_string(new_revision).c_str()));
-            result_data.Add("branch", Upp::String(branch_name.c_str()));
-            if (client_revision != -1 && client_revision != branch_revision) {
-                result_data.Add("merged", true);
-                result_data.Add("conflict", false);
-            }
-            event.result = Upp::String().Cat() << result_data;
+        return CommitEditOperations(session, session_dir, circuit, applied, user_id,
+                                    branch_name, branch_revision, -1);
+    }
+    catch (const std::exception& e) {
+        return Result<CircuitRevisionInfo>::MakeError(
+            ErrorCode::InternalError,
+            std::string("Exception in ApplyEditOperationBatchToBranch: ") + e.what()
+        );
+    }
+}
+
+Result<CircuitRevisionInfo> CircuitFacade::CommitEditOperations(
+    SessionMetadata& session,
+    const std::string& session_dir,
+    const CircuitData& circuit,
+    const std::vector<EditOperation>& final_ops,
+    const std::string& user_id,
+    const std::string& branch_name,
+    int64_t branch_revision,
+    int64_t client_revision
+) {
+    // Increment the circuit revision for this branch
+    int64_t new_revision = branch_revision + 1;
+
+    // Log the operations as events with branch information
+    std::vector<EventLogEntry> events;
+    for (const auto& op : final_ops) {
+        EventLogEntry event;
+        event.timestamp = GetCurrentTimestamp(); // We'll need to define this helper
+        event.user_id = user_id;
+        event.session_id = session.session_id;
+        event.branch = branch_name;  // Add the branch information
+        event.revision = new_revision;
+        event.payload = EncodeEditOperation(op);
+
+        // Map EditOpType to string command
+        std::string op_cmd;
+        switch (op.type) {
+            case EditOpType::AddComponent: op_cmd = "add_component"; break;
+            case EditOpType::RemoveComponent: op_cmd = "remove_component"; break;
+            case EditOpType::MoveComponent: op_cmd = "move_component"; break;
+            case EditOpType::SetComponentProperty: op_cmd = "set_component_property"; break;
+            case EditOpType::Connect: op_cmd = "connect"; break;
+            case EditOpType::Disconnect: op_cmd = "disconnect"; break;
+        }
+        event.command = op_cmd;
+
+        // Create params object for the operation
+        Upp::ValueMap params;
+        params.Add("revision", Upp::String(std::to_string(new_revision).c_str()));
+        params.Add("branch", Upp::String(branch_name.c_str()));
+        if (op.component_id.IsValid()) {
+            params.Add("component_id", Upp::String(op.component_id.id.c_str()));
+        }
+        if (op.wire_id.IsValid()) {
+            params.Add("wire_id", Upp::String(op.wire_id.id.c_str()));
+        }
+        params.Add("x", op.x);
+        params.Add("y", op.y);
+        if (!op.property_name.empty()) {
+            params.Add("property_name", Upp::String(op.property_name.c_str()));
+        }
+        if (!op.property_value.empty()) {
+            params.Add("property_value", Upp::String(op.property_value.c_str()));
+        }
+        if (op.target_component_id.IsValid()) {
+            params.Add("target_component_id", Upp::String(op.target_component_id.id.c_str()));
+        }
+        if (!op.pin_name.empty()) {
+            params.Add("pin_name", Upp::String(op.pin_name.c_str()));
+        }
+        if (!op.target_pin_name.empty()) {
+            params.Add("target_pin_name", Upp::String(op.target_pin_name.c_str()));
+        }
+        if (!op.component_type.empty()) {
+            params.Add("component_type", Upp::String(op.component_type.c_str()));
+        }
+        if (!op.component_name.empty()) {
+            params.Add("component_name", Upp::String(op.component_name.c_str()));
+        }
 
-            EventLogger::LogEvent(session_dir, event);
+        // Add collaboration-specific parameters
+        if (client_revision > 0) {
+            params.Add("expected_revision", Upp::String(std::to_string(client_revision).c_str()));
         }
 
-        // The session would be updated by the caller, as CircuitFacade doesn't have direct
-        // access to the session store. The caller is responsible for saving the updated
-        // session metadata that includes the new branch revision.
+        event.params = Upp::String().Cat() << params;
 
-        CircuitRevisionInfo info;
-        info.revision = new_revision;
-        return Result<CircuitRevisionInfo>::MakeOk(info);
+        // Create result object
+        Upp::ValueMap result_data;
+        result_data.Add("revision", Upp::String(std::to_string(new_revision).c_str()));
+        result_data.Add("branch", Upp::String(branch_name.c_str()));
+        if (client_revision != -1 && client_revision != branch_revision) {
+            result_data.Add("merged", true);
+            result_data.Add("conflict", false);
+        }
+        event.result = Upp::String().Cat() << result_data;
+
+        events.push_back(std::move(event));
     }
-    catch (const std::exception& e) {
+
+    // The revision exists once all of its events are in the journal; replay would
+    // otherwise rebuild a different circuit than the one this edit produced
+    if (!events.empty() && !EventLogger::LogEvents(session_dir, events)) {
         return Result<CircuitRevisionInfo>::MakeError(
+            ErrorCode::StorageIoError,
+            "Could not log revision " + std::to_string(new_revision) + " of branch " + branch_name +
+            " to the event journal of " + session_dir
+        );
+    }
+
+    // Update branch's head_revision in session metadata
+    for (auto& branch : session.branches) {
+        if (branch.name == branch_name) {
+            branch.head_revision = new_revision;
+            break;
+        }
+    }
+
+    // Save a circuit checkpoint every circuit_checkpoint_interval_ revisions. It comes
+    // after the events, so a crash in between never leaves a checkpoint of a revision
+    // the journal doesn't have.
+    if (circuit_checkpoint_interval_ > 0 && new_revision % circuit_checkpoint_interval_ == 0) {
+        auto snapshot_result = SaveCircuitSnapshot(circuit, session_dir, branch_name, new_revision);
+        if (!snapshot_result.ok) {
+            // This is a warning, not a fatal error - we can continue without snapshot
+            // Log the issue but don't fail the operation
+        }
+    }
+
+    // The session would be updated by the caller, as CircuitFacade doesn't have direct
+    // access to the session store. The caller is responsible for saving the updated
+    // session metadata that includes the new branch revision.
+
+    CircuitRevisionInfo info;
+    info.revision = new_revision;
+    return Result<CircuitRevisionInfo>::MakeOk(info);
+}
+
+Result<bool> CircuitFacade::CheckpointBranchFrom(
+    const SessionMetadata& session,
+    const std::string& session_dir,
+    const std::string& source_branch,
+    const std::string& branch_name,
+    int64_t revision
+) {
+    try {
+        // Checkpoints above the revision belong to a deleted branch of the same name
+        const int64_t any_revision = std::numeric_limits<int64_t>::max();
+        for (int64_t rev; (rev = GetCircuitSnapshotRevision(session_dir, branch_name, any_revision)) > revision; ) {
+            fs::remove(GetCircuitSnapshotPath(session_dir, branch_name, rev));
+        }
+
+        // Revision 0 is the initial circuit, which every branch loads without events
+        if (revision <= 0) {
+            return Result<bool>::MakeOk(true);
+        }
+
+        // Load the source branch as it was at the revision
+        SessionMetadata at_revision = session;
+        for (auto& branch : at_revision.branches) {
+            if (branch.name == source_branch) {
+                branch.head_revision = revision;
+            }
+        }
+        CircuitData circuit;
+        auto load_result = LoadCurrentCircuitForBranch(at_revision, session_dir, source_branch, circuit);
+        if (!load_result.ok) {
+            return Result<bool>::MakeError(load_result.error_code, load_result.error_message);
+        }
+
+        return SaveCircuitSnapshot(circuit, session_dir, branch_name, revision);
+    }
+    catch (const std::exception& e) {
+        return Result<bool>::MakeError(
             ErrorCode::InternalError,
-            std::string("Exception in ApplyEditOperationsToBranch: ") + e.what()
+            std::string("Exception in CheckpointBranchFrom: ") + e.what()
         );
     }
 }
@@ -713,136 +1053,52 @@ Result<bool> CircuitFacade::ApplyEditOperation(CircuitData& circuit, const EditO
 
 Result<bool> CircuitFacade::ReplayCircuitEvents(CircuitData& circuit, const std::string& session_dir, 
                                                int64_t from_revision, int64_t to_revision) {
-    try {
-        // For this implementation, we'll read the event log and apply operations
-        // In a real implementation, we'd parse the event log file to extract circuit edit operations
-        // and apply them to the circuit in order
-        
-        std::string events_file = session_dir + "/events.log";
-        if (!fs::exists(events_file)) {
-            if (from_revision > 0) {
-                // If events file doesn't exist but we expect events to be there, it's an error
-                return Result<bool>::MakeError(
-                    ErrorCode::CircuitStateCorrupt,
-                    "Events file does not exist but expected revisions " + 
-                    std::to_string(from_revision) + " to " + std::to_string(to_revision)
-                );
-            }
-            // If from_revision is 0, there are no events to replay
-            return Result<bool>::MakeOk(true);
-        }
-        
-        // Read and process events from the log
-        std::ifstream file(events_file);
-        if (!file.is_open()) {
-            return Result<bool>::MakeError(
-                ErrorCode::StorageIoError,
-                "Could not open events file: " + events_file
-            );
-        }
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            // This is a simplified implementation that would require a full JSON parser
-            // In practice, we'd need to properly parse the JSON events to extract
-            // circuit editing operations and apply them in order.
-        }
-        
-        return Result<bool>::MakeOk(true);
-    }
-    catch (const std::exception& e) {
-        return Result<bool>::MakeError(
-            ErrorCode::InternalError,
-            std::string("Exception in ReplayCircuitEvents: ") + e.what()
-        );
-    }
+    // Events without a branch belong to the main branch
+    return ReplayCircuitEventsForBranch(circuit, session_dir, from_revision, to_revision, "main");
 }
 
 Result<bool> CircuitFacade::ReplayCircuitEventsForBranch(CircuitData& circuit, const std::string& session_dir,
                                                         int64_t from_revision, int64_t to_revision,
                                                         const std::string& branch_name) {
     try {
-        // For branch-aware replay, we need to read the event log and filter events by branch
-        std::string events_file = session_dir + "/events.log";
-        if (!fs::exists(events_file)) {
-            if (from_revision > 0) {
-                // If events file doesn't exist but we expect events to be there, it's an error
-                return Result<bool>::MakeError(
-                    ErrorCode::CircuitStateCorrupt,
-                    "Events file does not exist but expected revisions " +
-                    std::to_string(from_revision) + " to " + std::to_string(to_revision) +
-                    " for branch " + branch_name
-                );
-            }
-            // If from_revision is 0, there are no events to replay
-            return Result<bool>::MakeOk(true);
-        }
-
-        // Read and process events from the log
-        std::ifstream file(events_file);
-        if (!file.is_open()) {
+        // The journal index locates the branch's events in the revision range
+        std::vector<EventLogEntry> events;
+        if (!EventLogger::ReadEvents(session_dir, branch_name, from_revision, to_revision, events)) {
             return Result<bool>::MakeError(
                 ErrorCode::StorageIoError,
-                "Could not open events file: " + events_file
+                "Could not read the event journal of " + session_dir
             );
         }
 
-        std::string line;
-        while (std::getline(file, line)) {
-            // Parse the JSON event to check if it belongs to the specified branch
-            // This would require a proper JSON parser implementation
-            // For now, we'll implement a simplified parsing logic
-
-            // Check if the event is for the requested branch
-            size_t branch_pos = line.find("\"branch\":\"");
-            if (branch_pos == std::string::npos) {
-                // If no branch field exists, this follows the old format; assume it's on main branch
-                if (branch_name != "main" && branch_name != "master") {
-                    continue; // Skip this event if not on the main branch
-                }
-            } else {
-                // Extract the branch name from the event
-                branch_pos += 10; // Length of "\"branch\":\""
-                size_t branch_end = line.find("\"", branch_pos);
-                if (branch_end == std::string::npos) {
-                    continue; // Malformed event, skip it
-                }
-
-                std::string event_branch = line.substr(branch_pos, branch_end - branch_pos);
-                if (event_branch != branch_name) {
-                    continue; // Skip events not for the requested branch
-                }
-            }
-
-            // Extract the revision from the event
-            size_t rev_pos = line.find("\"revision\":");
-            if (rev_pos == std::string::npos) {
-                continue; // Skip events without revision
-            }
-
-            rev_pos += 11; // Length of "\"revision\":"
-            size_t rev_end = line.find_first_not_of("0123456789", rev_pos);
-            if (rev_end == std::string::npos) {
-                continue; // Malformed revision number
-            }
+        // Sessions from before the journal logged their edits to events.log without the
+        // operations, so revisions from that time can't be rebuilt from events
+        if (from_revision <= to_revision && fs::exists(session_dir + "/events.log") &&
+            (events.empty() || events.front().revision > from_revision)) {
+            return Result<bool>::MakeError(
+                ErrorCode::CircuitStateCorrupt,
+                "Revision " + std::to_string(from_revision) + " of branch " + branch_name +
+                " was logged to the legacy events.log, which has no replayable edits; "
+                "only circuit checkpoints can restore it"
+            );
+        }
 
-            std::string rev_str = line.substr(rev_pos, rev_end - rev_pos);
-            int64_t event_revision;
-            try {
-                event_revision = std::stoll(rev_str);
-            } catch (...) {
-                continue; // Malformed revision number
+        for (const auto& event : events) {
+            EditOperation op;
+            if (!DecodeEditOperation(event.payload, op)) {
+                return Result<bool>::MakeError(
+                    ErrorCode::CircuitStateCorrupt,
+                    "Malformed " + event.command + " event at revision " + std::to_string(event.revision) +
+                    " for branch " + branch_name
+                );
             }
 
-            // Only apply events within the requested revision range
-            if (event_revision < from_revision || event_revision > to_revision) {
-                continue;
+            auto apply_result = ApplyEditOperation(circuit, op);
+            if (!apply_result.ok) {
+                return Result<bool>::MakeError(
+                    ErrorCode::CircuitStateCorrupt,
+                    "Replaying revision " + std::to_string(event.revision) + " failed: " + apply_result.error_message
+                );
             }
-
-            // Actually parse and apply the operation from the event
-            // This is a simplified implementation; a full parser would extract specific
-            // operation details from the event and apply them to the circuit
-            // For now, we'll skip the actual implementation as it would require full JSON parsing
         }
 
         return Result<bool>::MakeOk(true);
@@ -855,26 +1111,35 @@ Result<bool> CircuitFacade::ReplayCircuitEventsForBranch(CircuitData& circuit, c
     }
 }
 
-int64_t CircuitFacade::GetLatestCircuitSnapshotRevision(const std::string& session_dir) {
+std::string CircuitFacade::GetCircuitSnapshotPath(const std::string& session_dir, const std::string& branch_name,
+                                                  int64_t revision) const {
+    // Branch names aren't necessarily valid file names, so the directory is named by hash
+    char branch_dir[16];
+    std::snprintf(branch_dir, sizeof(branch_dir), "%08x", EventLogger::HashBranch(branch_name));
+    std::string path = session_dir + "/circuit_snapshots/" + branch_dir;
+    if (revision > 0) {
+        path += "/circuit_snap_" + std::to_string(revision) + ".bin";
+    }
+    return path;
+}
+
+int64_t CircuitFacade::GetCircuitSnapshotRevision(const std::string& session_dir, const std::string& branch_name,
+                                                  int64_t max_revision) {
     try {
-        std::string snapshots_dir = session_dir + "/circuit_snapshots";
+        std::string snapshots_dir = GetCircuitSnapshotPath(session_dir, branch_name, 0);
         if (!fs::exists(snapshots_dir)) {
             return 0;
         }
 
-        int64_t max_rev = 0;
+        const std::string prefix = "circuit_snap_";
+        int64_t best_rev = 0;
         for (const auto& entry : fs::directory_iterator(snapshots_dir)) {
-            if (entry.is_regular_file()) {
+            if (entry.is_regular_file() && entry.path().extension() == ".bin") {
                 std::string filename = entry.path().filename().string();
-                if (filename.substr(0, 15) == "circuit_snap_") {  // circuit_snap_<revision>.json
-                    std::string rev_str = filename.substr(15);  // Remove prefix
-                    size_t dot_pos = rev_str.find('.');
-                    if (dot_pos != std::string::npos) {
-                        rev_str = rev_str.substr(0, dot_pos);
-                    }
+                if (filename.compare(0, prefix.size(), prefix) == 0) {  // circuit_snap_<revision>.bin
                     try {
-                        int64_t rev = std::stoll(rev_str);
-                        if (rev > max_rev) max_rev = rev;
+                        int64_t rev = std::stoll(filename.substr(prefix.size()));
+                        if (rev > best_rev && rev <= max_revision) best_rev = rev;
                     } catch (...) {
                         // Skip invalid revision numbers
                     }
@@ -882,37 +1147,37 @@ int64_t CircuitFacade::GetLatestCircuitSnapshotRevision(const std::string& sessi
             }
         }
 
-        return max_rev;
+        return best_rev;
     }
     catch (...) {
         return 0;  // On error, assume no snapshots
     }
 }
 
-Result<bool> CircuitFacade::LoadCircuitFromSnapshot(const std::string& session_dir, CircuitData& out_circuit) {
+Result<bool> CircuitFacade::LoadCircuitFromSnapshot(const std::string& session_dir, const std::string& branch_name,
+                                                    int64_t revision, CircuitData& out_circuit) {
     try {
-        int64_t latest_rev = GetLatestCircuitSnapshotRevision(session_dir);
-        if (latest_rev <= 0) {
+        std::string snapshot_file = GetCircuitSnapshotPath(session_dir, branch_name, revision);
+
+        std::ifstream file(snapshot_file, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
             return Result<bool>::MakeError(
                 ErrorCode::CircuitStateCorrupt,
-                "No circuit snapshots found"
+                "Circuit snapshot file does not exist: " + snapshot_file
             );
         }
 
-        std::string snapshot_file = session_dir + "/circuit_snapshots/circuit_snap_" + 
-                                   std::to_string(latest_rev) + ".json";
-        
-        if (!fs::exists(snapshot_file)) {
+        std::string data;
+        data.resize((size_t)file.tellg());
+        file.seekg(0);
+        if (!file.read(&data[0], data.size()) ||
+            !DecodeCircuitSnapshot(data, branch_name, revision, out_circuit)) {
             return Result<bool>::MakeError(
                 ErrorCode::CircuitStateCorrupt,
-                "Circuit snapshot file does not exist: " + snapshot_file
+                "Invalid circuit snapshot file: " + snapshot_file
             );
         }
 
-        // Load the circuit from the snapshot file
-        // This would require a proper JSON parser implementation
-        // For now, this is a placeholder for the actual implementation
-        
         return Result<bool>::MakeOk(true);
     }
     catch (const std::exception& e) {
@@ -923,17 +1188,26 @@ Result<bool> CircuitFacade::LoadCircuitFromSnapshot(const std::string& session_d
     }
 }
 
-Result<bool> CircuitFacade::SaveCircuitSnapshot(const CircuitData& circuit, const std::string& session_dir, int64_t revision) {
+Result<bool> CircuitFacade::SaveCircuitSnapshot(const CircuitData& circuit, const std::string& session_dir,
+                                                const std::string& branch_name, int64_t revision) {
     try {
-        std::string snapshots_dir = session_dir + "/circuit_snapshots";
-        fs::create_directories(snapshots_dir);
+        fs::create_directories(GetCircuitSnapshotPath(session_dir, branch_name, 0));
+
+        // Write to a temporary file first, so a reader never sees a partial checkpoint
+        std::string snapshot_file = GetCircuitSnapshotPath(session_dir, branch_name, revision);
+        std::string tmp_file = snapshot_file + ".tmp";
+        std::string data = EncodeCircuitSnapshot(circuit, branch_name, revision);
+        {
+            std::ofstream file(tmp_file, std::ios::binary | std::ios::trunc);
+            if (!file.is_open() || !file.write(data.data(), data.size())) {
+                return Result<bool>::MakeError(
+                    ErrorCode::StorageIoError,
+                    "Could not write circuit snapshot file: " + tmp_file
+                );
+            }
+        }
+        fs::rename(tmp_file, snapshot_file);
 
-        std::string snapshot_file = snapshots_dir + "/circuit_snap_" + std::to_string(revision) + ".json";
-        
-        // Write circuit data to snapshot file
-        // This would require a proper JSON serialization implementation
-        // For now, this is a placeholder for the actual implementation
-        
         return Result<bool>::MakeOk(true);
     }
     catch (const std::exception& e) {
@@ -106,6 +106,32 @@ public:
         const std::string& branch_name
     );
 
+    // Apply operations one at a time to a single load of the branch's circuit, for
+    // batches of edits. The ones that succeed become one revision. op_errors gets an
+    // entry per operation, empty if it applied. With all_or_nothing, one failure
+    // leaves the branch unchanged. ops receive the ids assigned to new entities.
+    Result<CircuitRevisionInfo> ApplyEditOperationBatchToBranch(
+        SessionMetadata& session,
+        const std::string& session_dir,
+        std::vector<EditOperation>& ops,
+        const std::string& user_id,
+        const std::string& branch_name,
+        bool all_or_nothing,
+        std::vector<std::string>& op_errors
+    );
+
+    // Checkpoints the circuit of source_branch at revision as branch_name's circuit at
+    // the same revision. Branch create and merge call this: the events up to revision
+    // were logged under source_branch, so branch_name's own replay starts after them.
+    // Later checkpoints left by an earlier branch of the same name are removed.
+    Result<bool> CheckpointBranchFrom(
+        const SessionMetadata& session,
+        const std::string& session_dir,
+        const std::string& source_branch,
+        const std::string& branch_name,
+        int64_t revision
+    );
+
     // Optional: export entire circuit state as JSON for clients.
     Result<CircuitStateExport> ExportCircuitState(
         const SessionMetadata& session,
@@ -567,20 +593,29 @@ private:
     // Internal helper to apply an edit operation to a circuit
     Result<bool> ApplyEditOperation(CircuitData& circuit, const EditOperation& op);
 
+    // Internal helper that records operations already applied to circuit as the
+    // branch's next revision: checkpoint, head_revision and event log
+    Result<CircuitRevisionInfo> CommitEditOperations(SessionMetadata& session, const std::string& session_dir,
+                                                     const CircuitData& circuit, const std::vector<EditOperation>& final_ops,
+                                                     const std::string& user_id, const std::string& branch_name,
+                                                     int64_t branch_revision, int64_t client_revision);
+
     // Internal helper to replay circuit events and update the circuit
     Result<bool> ReplayCircuitEvents(CircuitData& circuit, const std::string& session_dir, int64_t from_revision, int64_t to_revision);
 
     // Internal helper to replay circuit events for a specific branch
     Result<bool> ReplayCircuitEventsForBranch(CircuitData& circuit, const std::string& session_dir, int64_t from_revision, int64_t to_revision, const std::string& branch_name);
 
-    // Internal helper to get the latest circuit snapshot revision
-    int64_t GetLatestCircuitSnapshotRevision(const std::string& session_dir);
+    // Internal helper to get the latest circuit checkpoint of a branch at or before max_revision, 0 if none
+    int64_t GetCircuitSnapshotRevision(const std::string& session_dir, const std::string& branch_name, int64_t max_revision);
+
+    // Internal helper to load circuit from a checkpoint
+    Result<bool> LoadCircuitFromSnapshot(const std::string& session_dir, const std::string& branch_name, int64_t revision, CircuitData& out_circuit);
 
-    // Internal helper to load circuit from a snapshot
-    Result<bool> LoadCircuitFromSnapshot(const std::string& session_dir, CircuitData& out_circuit);
+    // Internal helper to save circuit checkpoint
+    Result<bool> SaveCircuitSnapshot(const CircuitData& circuit, const std::string& session_dir, const std::string& branch_name, int64_t revision);
 
-    // Internal helper to save circuit snapshot
-    Result<bool> SaveCircuitSnapshot(const CircuitData& circuit, const std::string& session_dir, int64_t revision);
+    std::string GetCircuitSnapshotPath(const std::string& session_dir, const std::string& branch_name, int64_t revision) const;
 
     // Internal helper for retiming analysis
     Result<Vector<RetimingPlan>> PerformRetimingAnalysis(
@@ -597,8 +632,13 @@ public:
         return session_store_;
     }
 
+    // A circuit checkpoint is written every this many revisions of a branch, so
+    // loading a revision replays at most this many revisions of events
+    void SetCircuitCheckpointInterval(int64_t revisions) { circuit_checkpoint_interval_ = revisions; }
+
 private:
     std::shared_ptr<ISessionStore> session_store_;
+    int64_t circuit_checkpoint_interval_ = 50;
 };
 
 } // namespace ProtoVMCLI
@@ -50,6 +50,13 @@ int main(int argc, char** argv) {
             opts.pcb_id = 0;
         }
     }
+    if (args.Find("state") >= 0) {
+        try {
+            opts.session_state = args.Get("state", 0);
+        } catch (...) {
+            opts.session_state = 0;
+        }
+    }
     if (args.Find("circuit-file") >= 0) {
         opts.circuit_file = args.Get("circuit-file", Upp::String("")).ToStd();
     }
@@ -173,134 +180,136 @@ int main(int argc, char** argv) {
     // Create command dispatcher
     ProtoVMCLI::CommandDispatcher dispatcher(std::move(session_store));
 
-    // Dispatch to appropriate command handler
+    // Dispatch to appropriate command handler. Regular commands return the response
+    // envelope, the debug streams return their text directly.
+    Upp::ValueMap response;
     Upp::String result;
 
     if (command == "init-workspace") {
-        result = dispatcher.RunInitWorkspace(opts);
+        response = dispatcher.RunInitWorkspace(opts);
     }
     else if (command == "create-session") {
-        result = dispatcher.RunCreateSession(opts);
+        response = dispatcher.RunCreateSession(opts);
     }
     else if (command == "list-sessions") {
-        result = dispatcher.RunListSessions(opts);
+        response = dispatcher.RunListSessions(opts);
     }
     else if (command == "run-ticks") {
-        result = dispatcher.RunRunTicks(opts);
+        response = dispatcher.RunRunTicks(opts);
     }
     else if (command == "get-state") {
-        result = dispatcher.RunGetState(opts);
+        response = dispatcher.RunGetState(opts);
     }
     else if (command == "export-netlist") {
-        result = dispatcher.RunExportNetlist(opts);
+        response = dispatcher.RunExportNetlist(opts);
     }
     else if (command == "destroy-session") {
-        result = dispatcher.RunDestroySession(opts);
+        response = dispatcher.RunDestroySession(opts);
     }
     else if (command == "edit-add-component") {
-        result = dispatcher.RunEditAddComponent(opts);
+        response = dispatcher.RunEditAddComponent(opts);
     }
     else if (command == "edit-remove-component") {
-        result = dispatcher.RunEditRemoveComponent(opts);
+        response = dispatcher.RunEditRemoveComponent(opts);
     }
     else if (command == "edit-move-component") {
-        result = dispatcher.RunEditMoveComponent(opts);
+        response = dispatcher.RunEditMoveComponent(opts);
     }
     else if (command == "edit-set-component-property") {
-        result = dispatcher.RunEditSetComponentProperty(opts);
+        response = dispatcher.RunEditSetComponentProperty(opts);
     }
     else if (command == "edit-connect") {
-        result = dispatcher.RunEditConnect(opts);
+        response = dispatcher.RunEditConnect(opts);
     }
     else if (command == "edit-disconnect") {
-        result = dispatcher.RunEditDisconnect(opts);
+        response = dispatcher.RunEditDisconnect(opts);
     }
     else if (command == "edit-get-circuit") {
-        result = dispatcher.RunEditGetCircuit(opts);
+        response = dispatcher.RunEditGetCircuit(opts);
     }
     else if (command == "lint-circuit") {
-        result = dispatcher.RunLintCircuit(opts);
+        response = dispatcher.RunLintCircuit(opts);
     }
     else if (command == "analyze-circuit") {
-        result = dispatcher.RunAnalyzeCircuit(opts);
+        response = dispatcher.RunAnalyzeCircuit(opts);
     }
     else if (command == "circuit-diff") {
-        result = dispatcher.RunCircuitDiff(opts);
+        response = dispatcher.RunCircuitDiff(opts);
     }
     else if (command == "circuit-patch") {
-        result = dispatcher.RunCircuitPatch(opts);
+        response = dispatcher.RunCircuitPatch(opts);
     }
     else if (command == "circuit-replay") {
-        result = dispatcher.RunCircuitReplay(opts);
+        response = dispatcher.RunCircuitReplay(opts);
     }
     else if (command == "circuit-history") {
-        result = dispatcher.RunCircuitHistory(opts);
+        response = dispatcher.RunCircuitHistory(opts);
     }
     else if (command == "branch-list") {
-        result = dispatcher.RunBranchList(opts);
+        response = dispatcher.RunBranchList(opts);
     }
     else if (command == "branch-create") {
-        result = dispatcher.RunBranchCreate(opts);
+        response = dispatcher.RunBranchCreate(opts);
     }
     else if (command == "branch-switch") {
-        result = dispatcher.RunBranchSwitch(opts);
+        response = dispatcher.RunBranchSwitch(opts);
     }
     else if (command == "branch-delete") {
-        result = dispatcher.RunBranchDelete(opts);
+        response = dispatcher.RunBranchDelete(opts);
     }
     else if (command == "branch-merge") {
-        result = dispatcher.RunBranchMerge(opts);
+        response = dispatcher.RunBranchMerge(opts);
     }
     else if (command == "graph-export") {
-        result = dispatcher.RunGraphExport(opts);
+        response = dispatcher.RunGraphExport(opts);
     }
     else if (command == "graph-paths") {
-        result = dispatcher.RunGraphPaths(opts);
+        response = dispatcher.RunGraphPaths(opts);
     }
     else if (command == "graph-fanin") {
-        result = dispatcher.RunGraphFanIn(opts);
+        response = dispatcher.RunGraphFanIn(opts);
     }
     else if (command == "graph-fanout") {
-        result = dispatcher.RunGraphFanOut(opts);
+        response = dispatcher.RunGraphFanOut(opts);
     }
     else if (command == "graph-stats") {
-        result = dispatcher.RunGraphStats(opts);
+        response = dispatcher.RunGraphStats(opts);
     }
     else if (command == "refactor-suggest") {
-        result = dispatcher.RunRefactorSuggest(opts);
+        response = dispatcher.RunRefactorSuggest(opts);
     }
     else if (command == "refactor-suggest-block") {
-        result = dispatcher.RunRefactorSuggestBlock(opts);
+        response = dispatcher.RunRefactorSuggestBlock(opts);
     }
     else if (command == "refactor-apply") {
-        result = dispatcher.RunRefactorApply(opts);
+        response = dispatcher.RunRefactorApply(opts);
     }
     else if (command == "schedule-block") {
-        result = dispatcher.RunScheduleBlock(opts);
+        response = dispatcher.RunScheduleBlock(opts);
     }
     else if (command == "schedule-node-region") {
-        result = dispatcher.RunScheduleNodeRegion(opts);
+        response = dispatcher.RunScheduleNodeRegion(opts);
     }
     else if (command == "pipeline-block") {
-        result = dispatcher.RunPipelineBlock(opts);
+        response = dispatcher.RunPipelineBlock(opts);
     }
     else if (command == "pipeline-subsystem") {
-        result = dispatcher.RunPipelineSubsystem(opts);
+        response = dispatcher.RunPipelineSubsystem(opts);
     }
     else if (command == "instrument-build-hybrid") {
-        result = dispatcher.RunInstrumentBuildHybrid(opts);
+        response = dispatcher.RunInstrumentBuildHybrid(opts);
     }
     else if (command == "instrument-render-hybrid") {
-        result = dispatcher.RunInstrumentRenderHybrid(opts);
+        response = dispatcher.RunInstrumentRenderHybrid(opts);
     }
     else if (command == "instrument-export-cpp") {
-        result = dispatcher.RunInstrumentExportCpp(opts);
+        response = dispatcher.RunInstrumentExportCpp(opts);
     }
     else if (command == "instrument-export-plugin-skeleton") {
-        result = dispatcher.RunInstrumentExportPluginSkeleton(opts);
+        response = dispatcher.RunInstrumentExportPluginSkeleton(opts);
     }
     else if (command == "instrument-export-plugin-project") {
-        result = dispatcher.RunInstrumentExportPluginProject(opts);
+        response = dispatcher.RunInstrumentExportPluginProject(opts);
     }
     else if (command == "debug") {
         // Extract subcommand for debug
@@ -363,11 +372,13 @@ int main(int argc, char** argv) {
         }
     }
     else {
-        result = ProtoVMCLI::JsonIO::ErrorResponse(
+        response = ProtoVMCLI::JsonIO::ErrorEnvelope(
             command.ToStd(), "Unknown command: " + command.ToStd(), "UNKNOWN_COMMAND");
     }
 
     // Output result as JSON
+    if (result.IsEmpty())
+        result = ProtoVMCLI::JsonIO::ValueMapToJson(response);
     std::cout << result.ToStd() << std::endl;
 
     // Extract success status from JSON response
@@ -62,9 +62,9 @@ std::string GetCurrentTimestamp() {
     return std::string(buffer);
 }
 
-Upp::String CommandDispatcher::RunInitWorkspace(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunInitWorkspace(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("init-workspace", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("init-workspace", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -77,7 +77,7 @@ Upp::String CommandDispatcher::RunInitWorkspace(const CommandOptions& opts) {
 
         if (already_exists && !has_workspace_json) {
             // Existing directory but no workspace.json - invalid workspace
-            return JsonIO::ErrorResponse("init-workspace",
+            return JsonIO::ErrorEnvelope("init-workspace",
                                        "Directory exists but is not a valid ProtoVM workspace (missing workspace.json)",
                                        "INVALID_WORKSPACE");
         }
@@ -111,30 +111,30 @@ Upp::String CommandDispatcher::RunInitWorkspace(const CommandOptions& opts) {
         response_data.Add("created", !already_exists);  // true if we just created it
         response_data.Add("version", "0.1");
 
-        return JsonIO::SuccessResponse("init-workspace", response_data);
+        return JsonIO::SuccessEnvelope("init-workspace", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("init-workspace",
+        return JsonIO::ErrorEnvelope("init-workspace",
                                    "Failed to initialize workspace: " + std::string(e.what()),
                                    "WORKSPACE_INITIALIZATION_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCreateSession(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCreateSession(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("create-session", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("create-session", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.circuit_file.has_value()) {
-        return JsonIO::ErrorResponse("create-session", "Circuit file path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("create-session", "Circuit file path is required", "INVALID_ARGUMENT");
     }
 
     if (!ValidateWorkspace(opts.workspace)) {
-        return JsonIO::ErrorResponse("create-session", "Invalid workspace path", "INVALID_WORKSPACE");
+        return JsonIO::ErrorEnvelope("create-session", "Invalid workspace path", "INVALID_WORKSPACE");
     }
 
     // Check if circuit file exists
     if (!fs::exists(opts.circuit_file.value())) {
-        return JsonIO::ErrorResponse("create-session",
+        return JsonIO::ErrorEnvelope("create-session",
                                     "Circuit file does not exist: " + opts.circuit_file.value(),
                                     "CIRCUIT_FILE_NOT_FOUND");
     }
@@ -145,7 +145,7 @@ Upp::String CommandDispatcher::RunCreateSession(const CommandOptions& opts) {
 
         if (!result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("create-session", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("create-session", result.error_message, error_code_str);
         }
 
         // Create the session directory structure
@@ -166,9 +166,10 @@ Upp::String CommandDispatcher::RunCreateSession(const CommandOptions& opts) {
             if (!init_result.ok) {
                 // Rollback: delete the session if engine initialization failed
                 session_store_->DeleteSession(result.data);
+                EventLogger::CloseJournal(session_dir);
                 fs::remove_all(session_dir);
                 std::string error_code_str = JsonIO::ErrorCodeToString(init_result.error_code);
-                return JsonIO::ErrorResponse("create-session", init_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("create-session", init_result.error_message, error_code_str);
             }
 
             // Update the session metadata with snapshot information
@@ -207,29 +208,31 @@ Upp::String CommandDispatcher::RunCreateSession(const CommandOptions& opts) {
 
         EventLogger::LogEvent(session_dir, event);
 
-        return JsonIO::SuccessResponse("create-session", response_data);
+        return JsonIO::SuccessEnvelope("create-session", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("create-session",
+        return JsonIO::ErrorEnvelope("create-session",
                                    "Failed to create session: " + std::string(e.what()),
                                    "SESSION_CREATION_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunListSessions(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunListSessions(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("list-sessions", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("list-sessions", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!ValidateWorkspace(opts.workspace)) {
-        return JsonIO::ErrorResponse("list-sessions", "Invalid workspace path", "INVALID_WORKSPACE");
+        return JsonIO::ErrorEnvelope("list-sessions", "Invalid workspace path", "INVALID_WORKSPACE");
     }
 
     try {
-        auto result = session_store_->ListSessions();
+        auto result = opts.session_state
+            ? session_store_->ListSessionsInState(static_cast<SessionState>(*opts.session_state))
+            : session_store_->ListSessions();
 
         if (!result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("list-sessions", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("list-sessions", result.error_message, error_code_str);
         }
 
         Upp::ValueArray sessions_array;
@@ -254,26 +257,26 @@ Upp::String CommandDispatcher::RunListSessions(const CommandOptions& opts) {
         response_data.Add("sessions", sessions_array);
         response_data.Add("corrupt_sessions", corrupt_sessions_array);
 
-        return JsonIO::SuccessResponse("list-sessions", response_data);
+        return JsonIO::SuccessEnvelope("list-sessions", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("list-sessions",
+        return JsonIO::ErrorEnvelope("list-sessions",
                                    "Failed to list sessions: " + std::string(e.what()),
                                    "SESSION_LIST_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRunTicks(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRunTicks(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("run-ticks", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("run-ticks", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("run-ticks", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("run-ticks", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     int ticks = opts.ticks.value_or(1);
     if (ticks <= 0) {
-        return JsonIO::ErrorResponse("run-ticks", "Ticks must be positive", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("run-ticks", "Ticks must be positive", "INVALID_ARGUMENT");
     }
 
     try {
@@ -281,7 +284,7 @@ Upp::String CommandDispatcher::RunRunTicks(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("run-ticks", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("run-ticks", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -293,7 +296,7 @@ Upp::String CommandDispatcher::RunRunTicks(const CommandOptions& opts) {
         // Find the branch metadata
         std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
         if (!branch_opt.has_value()) {
-            return JsonIO::ErrorResponse("run-ticks", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("run-ticks", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         BranchMetadata& branch = const_cast<BranchMetadata&>(branch_opt.value());
@@ -314,7 +317,7 @@ Upp::String CommandDispatcher::RunRunTicks(const CommandOptions& opts) {
 
         if (!load_snapshot_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_snapshot_result.error_code);
-            return JsonIO::ErrorResponse("run-ticks", load_snapshot_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("run-ticks", load_snapshot_result.error_message, error_code_str);
         }
 
         auto run_result = engine_facade.RunTicksAndSnapshot(
@@ -322,7 +325,7 @@ Upp::String CommandDispatcher::RunRunTicks(const CommandOptions& opts) {
 
         if (!run_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(run_result.error_code);
-            return JsonIO::ErrorResponse("run-ticks", run_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("run-ticks", run_result.error_message, error_code_str);
         }
 
         // Update the session metadata with new tick count
@@ -348,7 +351,7 @@ Upp::String CommandDispatcher::RunRunTicks(const CommandOptions& opts) {
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("run-ticks", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("run-ticks", save_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
@@ -377,21 +380,21 @@ Upp::String CommandDispatcher::RunRunTicks(const CommandOptions& opts) {
 
         EventLogger::LogEvent(session_dir, event);
 
-        return JsonIO::SuccessResponse("run-ticks", response_data);
+        return JsonIO::SuccessEnvelope("run-ticks", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("run-ticks",
+        return JsonIO::ErrorEnvelope("run-ticks",
                                    "Failed to run ticks: " + std::string(e.what()),
                                    "RUN_TICKS_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunGetState(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunGetState(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("get-state", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("get-state", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("get-state", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("get-state", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -399,7 +402,7 @@ Upp::String CommandDispatcher::RunGetState(const CommandOptions& opts) {
 
         if (!result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("get-state", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("get-state", result.error_message, error_code_str);
         }
 
         auto metadata = result.data;  // Make a copy since we might modify it
@@ -411,7 +414,7 @@ Upp::String CommandDispatcher::RunGetState(const CommandOptions& opts) {
         // Find the branch metadata
         std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
         if (!branch_opt.has_value()) {
-            return JsonIO::ErrorResponse("get-state", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("get-state", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         BranchMetadata& branch = const_cast<BranchMetadata&>(branch_opt.value());
@@ -450,21 +453,21 @@ Upp::String CommandDispatcher::RunGetState(const CommandOptions& opts) {
             response_data.Add("last_snapshot_file", Upp::String(latest_snapshot.c_str()));
         }
 
-        return JsonIO::SuccessResponse("get-state", response_data);
+        return JsonIO::SuccessEnvelope("get-state", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("get-state",
+        return JsonIO::ErrorEnvelope("get-state",
                                    "Failed to get state: " + std::string(e.what()),
                                    "GET_STATE_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunExportNetlist(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunExportNetlist(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("export-netlist", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("export-netlist", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("export-netlist", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("export-netlist", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     int pcb_id = opts.pcb_id.value_or(0);
@@ -474,7 +477,7 @@ Upp::String CommandDispatcher::RunExportNetlist(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("export-netlist", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("export-netlist", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -489,7 +492,7 @@ Upp::String CommandDispatcher::RunExportNetlist(const CommandOptions& opts) {
 
         if (!load_snapshot_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_snapshot_result.error_code);
-            return JsonIO::ErrorResponse("export-netlist", load_snapshot_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("export-netlist", load_snapshot_result.error_message, error_code_str);
         }
 
         auto export_result = engine_facade.ExportNetlist(
@@ -497,7 +500,7 @@ Upp::String CommandDispatcher::RunExportNetlist(const CommandOptions& opts) {
 
         if (!export_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(export_result.error_code);
-            return JsonIO::ErrorResponse("export-netlist", export_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("export-netlist", export_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
@@ -522,34 +525,37 @@ Upp::String CommandDispatcher::RunExportNetlist(const CommandOptions& opts) {
 
         EventLogger::LogEvent(session_dir, event);
 
-        return JsonIO::SuccessResponse("export-netlist", response_data);
+        return JsonIO::SuccessEnvelope("export-netlist", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("export-netlist",
+        return JsonIO::ErrorEnvelope("export-netlist",
                                    "Failed to export netlist: " + std::string(e.what()),
                                    "NETLIST_EXPORT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDestroySession(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDestroySession(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("destroy-session", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("destroy-session", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("destroy-session", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("destroy-session", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
+        // Close the session's event journal before its files go away
+        std::string session_dir = opts.workspace + "/sessions/" + std::to_string(opts.session_id.value());
+        EventLogger::CloseJournal(session_dir);
+
         // For now, we'll just call the store's delete function
         auto result = session_store_->DeleteSession(opts.session_id.value());
 
         if (!result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("destroy-session", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("destroy-session", result.error_message, error_code_str);
         }
 
         // Delete the session directory and its contents
-        std::string session_dir = opts.workspace + "/sessions/" + std::to_string(opts.session_id.value());
         if (fs::exists(session_dir)) {
             fs::remove_all(session_dir);
         }
@@ -575,9 +581,9 @@ Upp::String CommandDispatcher::RunDestroySession(const CommandOptions& opts) {
 
         EventLogger::LogEvent(session_dir, event);
 
-        return JsonIO::SuccessResponse("destroy-session", response_data);
+        return JsonIO::SuccessEnvelope("destroy-session", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("destroy-session",
+        return JsonIO::ErrorEnvelope("destroy-session",
                                    "Failed to destroy session: " + std::string(e.what()),
                                    "SESSION_DELETION_ERROR");
     }
@@ -796,13 +802,13 @@ Upp::String CommandDispatcher::RunDebugPollStream(const Upp::String& poll_id) {
     }
 }
 
-Upp::String CommandDispatcher::RunEditAddComponent(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunEditAddComponent(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("edit-add-component", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-add-component", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("edit-add-component", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-add-component", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -810,7 +816,7 @@ Upp::String CommandDispatcher::RunEditAddComponent(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("edit-add-component", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-add-component", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -825,7 +831,7 @@ Upp::String CommandDispatcher::RunEditAddComponent(const CommandOptions& opts) {
         // For this implementation, we'll get component details from command arguments
         // This would typically come from stdin JSON or additional command-specific args
         if (component_type.empty()) {
-            return JsonIO::ErrorResponse("edit-add-component", "Component type is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("edit-add-component", "Component type is required", "INVALID_ARGUMENT");
         }
 
         if (component_name.empty()) {
@@ -850,14 +856,14 @@ Upp::String CommandDispatcher::RunEditAddComponent(const CommandOptions& opts) {
 
         if (!apply_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(apply_result.error_code);
-            return JsonIO::ErrorResponse("edit-add-component", apply_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-add-component", apply_result.error_message, error_code_str);
         }
 
         // Save updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("edit-add-component", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-add-component", save_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
@@ -866,21 +872,21 @@ Upp::String CommandDispatcher::RunEditAddComponent(const CommandOptions& opts) {
         // In a real implementation, we would return the actual component ID generated
         response_data.Add("component_id", Upp::String("C0000001")); // Placeholder
 
-        return JsonIO::SuccessResponse("edit-add-component", response_data);
+        return JsonIO::SuccessEnvelope("edit-add-component", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("edit-add-component",
+        return JsonIO::ErrorEnvelope("edit-add-component",
                                    "Failed to add component: " + std::string(e.what()),
                                    "ADD_COMPONENT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunEditRemoveComponent(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunEditRemoveComponent(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("edit-remove-component", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-remove-component", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("edit-remove-component", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-remove-component", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -888,7 +894,7 @@ Upp::String CommandDispatcher::RunEditRemoveComponent(const CommandOptions& opts
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("edit-remove-component", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-remove-component", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -898,7 +904,7 @@ Upp::String CommandDispatcher::RunEditRemoveComponent(const CommandOptions& opts
         // For a complete implementation, we'd need proper argument parsing for component ID
         std::string component_id_str = opts.circuit_file.has_value() ? opts.circuit_file.value() : "";
         if (component_id_str.empty()) {
-            return JsonIO::ErrorResponse("edit-remove-component", "Component ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("edit-remove-component", "Component ID is required", "INVALID_ARGUMENT");
         }
 
         CircuitEntityId component_id(component_id_str);
@@ -917,35 +923,35 @@ Upp::String CommandDispatcher::RunEditRemoveComponent(const CommandOptions& opts
 
         if (!apply_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(apply_result.error_code);
-            return JsonIO::ErrorResponse("edit-remove-component", apply_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-remove-component", apply_result.error_message, error_code_str);
         }
 
         // Save updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("edit-remove-component", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-remove-component", save_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
         response_data.Add("session_id", opts.session_id.value());
         response_data.Add("circuit_revision", apply_result.data.revision);
 
-        return JsonIO::SuccessResponse("edit-remove-component", response_data);
+        return JsonIO::SuccessEnvelope("edit-remove-component", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("edit-remove-component",
+        return JsonIO::ErrorEnvelope("edit-remove-component",
                                    "Failed to remove component: " + std::string(e.what()),
                                    "REMOVE_COMPONENT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunEditMoveComponent(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunEditMoveComponent(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("edit-move-component", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-move-component", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("edit-move-component", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-move-component", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -953,7 +959,7 @@ Upp::String CommandDispatcher::RunEditMoveComponent(const CommandOptions& opts)
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("edit-move-component", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-move-component", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -965,7 +971,7 @@ Upp::String CommandDispatcher::RunEditMoveComponent(const CommandOptions& opts)
         int y = opts.pcb_id.value_or(0);
 
         if (component_id_str.empty()) {
-            return JsonIO::ErrorResponse("edit-move-component", "Component ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("edit-move-component", "Component ID is required", "INVALID_ARGUMENT");
         }
 
         CircuitEntityId component_id(component_id_str);
@@ -986,35 +992,35 @@ Upp::String CommandDispatcher::RunEditMoveComponent(const CommandOptions& opts)
 
         if (!apply_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(apply_result.error_code);
-            return JsonIO::ErrorResponse("edit-move-component", apply_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-move-component", apply_result.error_message, error_code_str);
         }
 
         // Save updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("edit-move-component", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-move-component", save_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
         response_data.Add("session_id", opts.session_id.value());
         response_data.Add("circuit_revision", apply_result.data.revision);
 
-        return JsonIO::SuccessResponse("edit-move-component", response_data);
+        return JsonIO::SuccessEnvelope("edit-move-component", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("edit-move-component",
+        return JsonIO::ErrorEnvelope("edit-move-component",
                                    "Failed to move component: " + std::string(e.what()),
                                    "MOVE_COMPONENT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunEditSetComponentProperty(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunEditSetComponentProperty(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("edit-set-component-property", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-set-component-property", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("edit-set-component-property", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-set-component-property", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1022,7 +1028,7 @@ Upp::String CommandDispatcher::RunEditSetComponentProperty(const CommandOptions&
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("edit-set-component-property", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-set-component-property", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1035,11 +1041,11 @@ Upp::String CommandDispatcher::RunEditSetComponentProperty(const CommandOptions&
         std::string property_value = std::to_string(property_value_int); // Convert int to string for this example
 
         if (component_id_str.empty()) {
-            return JsonIO::ErrorResponse("edit-set-component-property", "Component ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("edit-set-component-property", "Component ID is required", "INVALID_ARGUMENT");
         }
 
         if (property_name.empty()) {
-            return JsonIO::ErrorResponse("edit-set-component-property", "Property name is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("edit-set-component-property", "Property name is required", "INVALID_ARGUMENT");
         }
 
         CircuitEntityId component_id(component_id_str);
@@ -1060,35 +1066,35 @@ Upp::String CommandDispatcher::RunEditSetComponentProperty(const CommandOptions&
 
         if (!apply_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(apply_result.error_code);
-            return JsonIO::ErrorResponse("edit-set-component-property", apply_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-set-component-property", apply_result.error_message, error_code_str);
         }
 
         // Save updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("edit-set-component-property", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-set-component-property", save_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
         response_data.Add("session_id", opts.session_id.value());
         response_data.Add("circuit_revision", apply_result.data.revision);
 
-        return JsonIO::SuccessResponse("edit-set-component-property", response_data);
+        return JsonIO::SuccessEnvelope("edit-set-component-property", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("edit-set-component-property",
+        return JsonIO::ErrorEnvelope("edit-set-component-property",
                                    "Failed to set component property: " + std::string(e.what()),
                                    "SET_COMPONENT_PROPERTY_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunEditConnect(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunEditConnect(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("edit-connect", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-connect", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("edit-connect", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-connect", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1096,7 +1102,7 @@ Upp::String CommandDispatcher::RunEditConnect(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("edit-connect", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-connect", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1112,7 +1118,7 @@ Upp::String CommandDispatcher::RunEditConnect(const CommandOptions& opts) {
 
         if (start_component_id_str.empty() || start_pin_name.empty() ||
             end_component_id_str.empty() || end_pin_name.empty()) {
-            return JsonIO::ErrorResponse("edit-connect", "All connection parameters are required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("edit-connect", "All connection parameters are required", "INVALID_ARGUMENT");
         }
 
         CircuitEntityId start_component_id(start_component_id_str);
@@ -1135,35 +1141,35 @@ Upp::String CommandDispatcher::RunEditConnect(const CommandOptions& opts) {
 
         if (!apply_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(apply_result.error_code);
-            return JsonIO::ErrorResponse("edit-connect", apply_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-connect", apply_result.error_message, error_code_str);
         }
 
         // Save updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("edit-connect", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-connect", save_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
         response_data.Add("session_id", opts.session_id.value());
         response_data.Add("circuit_revision", apply_result.data.revision);
 
-        return JsonIO::SuccessResponse("edit-connect", response_data);
+        return JsonIO::SuccessEnvelope("edit-connect", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("edit-connect",
+        return JsonIO::ErrorEnvelope("edit-connect",
                                    "Failed to create connection: " + std::string(e.what()),
                                    "CONNECT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunEditDisconnect(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunEditDisconnect(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("edit-disconnect", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-disconnect", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("edit-disconnect", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-disconnect", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1171,7 +1177,7 @@ Upp::String CommandDispatcher::RunEditDisconnect(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("edit-disconnect", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-disconnect", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1187,7 +1193,7 @@ Upp::String CommandDispatcher::RunEditDisconnect(const CommandOptions& opts) {
 
         if (start_component_id_str.empty() || start_pin_name.empty() ||
             end_component_id_str.empty() || end_pin_name.empty()) {
-            return JsonIO::ErrorResponse("edit-disconnect", "All disconnection parameters are required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("edit-disconnect", "All disconnection parameters are required", "INVALID_ARGUMENT");
         }
 
         CircuitEntityId start_component_id(start_component_id_str);
@@ -1210,35 +1216,35 @@ Upp::String CommandDispatcher::RunEditDisconnect(const CommandOptions& opts) {
 
         if (!apply_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(apply_result.error_code);
-            return JsonIO::ErrorResponse("edit-disconnect", apply_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-disconnect", apply_result.error_message, error_code_str);
         }
 
         // Save updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("edit-disconnect", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-disconnect", save_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
         response_data.Add("session_id", opts.session_id.value());
         response_data.Add("circuit_revision", apply_result.data.revision);
 
-        return JsonIO::SuccessResponse("edit-disconnect", response_data);
+        return JsonIO::SuccessEnvelope("edit-disconnect", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("edit-disconnect",
+        return JsonIO::ErrorEnvelope("edit-disconnect",
                                    "Failed to disconnect: " + std::string(e.what()),
                                    "DISCONNECT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunEditGetCircuit(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunEditGetCircuit(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("edit-get-circuit", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-get-circuit", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("edit-get-circuit", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("edit-get-circuit", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1246,7 +1252,7 @@ Upp::String CommandDispatcher::RunEditGetCircuit(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("edit-get-circuit", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-get-circuit", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1258,7 +1264,7 @@ Upp::String CommandDispatcher::RunEditGetCircuit(const CommandOptions& opts) {
 
         if (!export_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(export_result.error_code);
-            return JsonIO::ErrorResponse("edit-get-circuit", export_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("edit-get-circuit", export_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
@@ -1266,21 +1272,21 @@ Upp::String CommandDispatcher::RunEditGetCircuit(const CommandOptions& opts) {
         response_data.Add("circuit_revision", export_result.data.revision);
         response_data.Add("circuit_data", export_result.data.circuit_json);
 
-        return JsonIO::SuccessResponse("edit-get-circuit", response_data);
+        return JsonIO::SuccessEnvelope("edit-get-circuit", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("edit-get-circuit",
+        return JsonIO::ErrorEnvelope("edit-get-circuit",
                                    "Failed to get circuit: " + std::string(e.what()),
                                    "GET_CIRCUIT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunLintCircuit(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunLintCircuit(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("lint-circuit", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("lint-circuit", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("lint-circuit", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("lint-circuit", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1288,7 +1294,7 @@ Upp::String CommandDispatcher::RunLintCircuit(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("lint-circuit", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("lint-circuit", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1301,7 +1307,7 @@ Upp::String CommandDispatcher::RunLintCircuit(const CommandOptions& opts) {
 
         if (!load_circuit_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_circuit_result.error_code);
-            return JsonIO::ErrorResponse("lint-circuit", load_circuit_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("lint-circuit", load_circuit_result.error_message, error_code_str);
         }
 
         // Run circuit analysis
@@ -1310,7 +1316,7 @@ Upp::String CommandDispatcher::RunLintCircuit(const CommandOptions& opts) {
 
         if (!analysis_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(analysis_result.error_code);
-            return JsonIO::ErrorResponse("lint-circuit", analysis_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("lint-circuit", analysis_result.error_message, error_code_str);
         }
 
         // Build response with diagnostics
@@ -1319,21 +1325,21 @@ Upp::String CommandDispatcher::RunLintCircuit(const CommandOptions& opts) {
         response_data.Add("circuit_revision", metadata.circuit_revision);
         response_data.Add("diagnostics", JsonIO::CircuitDiagnosticsToValueArray(analysis_result.data));
 
-        return JsonIO::SuccessResponse("lint-circuit", response_data);
+        return JsonIO::SuccessEnvelope("lint-circuit", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("lint-circuit",
+        return JsonIO::ErrorEnvelope("lint-circuit",
                                    "Failed to lint circuit: " + std::string(e.what()),
                                    "CIRCUIT_LINT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunAnalyzeCircuit(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunAnalyzeCircuit(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("analyze-circuit", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("analyze-circuit", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("analyze-circuit", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("analyze-circuit", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1341,7 +1347,7 @@ Upp::String CommandDispatcher::RunAnalyzeCircuit(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("analyze-circuit", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("analyze-circuit", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1354,7 +1360,7 @@ Upp::String CommandDispatcher::RunAnalyzeCircuit(const CommandOptions& opts) {
 
         if (!load_circuit_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_circuit_result.error_code);
-            return JsonIO::ErrorResponse("analyze-circuit", load_circuit_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("analyze-circuit", load_circuit_result.error_message, error_code_str);
         }
 
         // Run circuit analysis
@@ -1363,7 +1369,7 @@ Upp::String CommandDispatcher::RunAnalyzeCircuit(const CommandOptions& opts) {
 
         if (!analysis_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(analysis_result.error_code);
-            return JsonIO::ErrorResponse("analyze-circuit", analysis_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("analyze-circuit", analysis_result.error_message, error_code_str);
         }
 
         // Build response with diagnostics and summary
@@ -1377,21 +1383,21 @@ Upp::String CommandDispatcher::RunAnalyzeCircuit(const CommandOptions& opts) {
         response_data.Add("summary", summary);
         response_data.Add("diagnostics", JsonIO::CircuitDiagnosticsToValueArray(analysis_result.data));
 
-        return JsonIO::SuccessResponse("analyze-circuit", response_data);
+        return JsonIO::SuccessEnvelope("analyze-circuit", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("analyze-circuit",
+        return JsonIO::ErrorEnvelope("analyze-circuit",
                                    "Failed to analyze circuit: " + std::string(e.what()),
                                    "CIRCUIT_ANALYSIS_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCircuitDiff(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCircuitDiff(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("circuit-diff", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("circuit-diff", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("circuit-diff", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("circuit-diff", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1399,7 +1405,7 @@ Upp::String CommandDispatcher::RunCircuitDiff(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("circuit-diff", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("circuit-diff", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1419,21 +1425,21 @@ Upp::String CommandDispatcher::RunCircuitDiff(const CommandOptions& opts) {
         Upp::ValueArray diff_ops;
         response_data.Add("diff", diff_ops);
 
-        return JsonIO::SuccessResponse("circuit-diff", response_data);
+        return JsonIO::SuccessEnvelope("circuit-diff", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("circuit-diff",
+        return JsonIO::ErrorEnvelope("circuit-diff",
                                    "Failed to generate circuit diff: " + std::string(e.what()),
                                    "CIRCUIT_DIFF_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCircuitPatch(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCircuitPatch(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("circuit-patch", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("circuit-patch", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("circuit-patch", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("circuit-patch", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1441,7 +1447,7 @@ Upp::String CommandDispatcher::RunCircuitPatch(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("circuit-patch", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("circuit-patch", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1454,21 +1460,21 @@ Upp::String CommandDispatcher::RunCircuitPatch(const CommandOptions& opts) {
         response_data.Add("circuit_revision", metadata.circuit_revision + 1);
         response_data.Add("applied", true);
 
-        return JsonIO::SuccessResponse("circuit-patch", response_data);
+        return JsonIO::SuccessEnvelope("circuit-patch", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("circuit-patch",
+        return JsonIO::ErrorEnvelope("circuit-patch",
                                    "Failed to apply circuit patch: " + std::string(e.what()),
                                    "CIRCUIT_PATCH_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCircuitReplay(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCircuitReplay(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("circuit-replay", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("circuit-replay", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("circuit-replay", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("circuit-replay", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1476,7 +1482,7 @@ Upp::String CommandDispatcher::RunCircuitReplay(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("circuit-replay", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("circuit-replay", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1497,14 +1503,14 @@ Upp::String CommandDispatcher::RunCircuitReplay(const CommandOptions& opts) {
 
         if (!load_circuit_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_circuit_result.error_code);
-            return JsonIO::ErrorResponse("circuit-replay", load_circuit_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("circuit-replay", load_circuit_result.error_message, error_code_str);
         }
 
         // Export the circuit state at the target revision
         auto export_result = circuit_facade.ExportCircuitState(temp_metadata, session_dir);
         if (!export_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(export_result.error_code);
-            return JsonIO::ErrorResponse("circuit-replay", export_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("circuit-replay", export_result.error_message, error_code_str);
         }
 
         Upp::ValueMap response_data;
@@ -1512,21 +1518,21 @@ Upp::String CommandDispatcher::RunCircuitReplay(const CommandOptions& opts) {
         response_data.Add("revision", target_revision);
         response_data.Add("circuit_data", export_result.data.circuit_json);
 
-        return JsonIO::SuccessResponse("circuit-replay", response_data);
+        return JsonIO::SuccessEnvelope("circuit-replay", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("circuit-replay",
+        return JsonIO::ErrorEnvelope("circuit-replay",
                                    "Failed to replay circuit: " + std::string(e.what()),
                                    "CIRCUIT_REPLAY_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCircuitHistory(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCircuitHistory(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("circuit-history", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("circuit-history", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("circuit-history", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("circuit-history", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1534,7 +1540,7 @@ Upp::String CommandDispatcher::RunCircuitHistory(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("circuit-history", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("circuit-history", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1544,7 +1550,7 @@ Upp::String CommandDispatcher::RunCircuitHistory(const CommandOptions& opts) {
         std::string branch_name = opts.branch.value_or(metadata.current_branch);
         std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
         if (!branch_opt.has_value()) {
-            return JsonIO::ErrorResponse("circuit-history", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("circuit-history", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         int64_t branch_revision = branch_opt->head_revision;
@@ -1568,21 +1574,21 @@ Upp::String CommandDispatcher::RunCircuitHistory(const CommandOptions& opts) {
         }
         response_data.Add("history", history_entries);
 
-        return JsonIO::SuccessResponse("circuit-history", response_data);
+        return JsonIO::SuccessEnvelope("circuit-history", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("circuit-history",
+        return JsonIO::ErrorEnvelope("circuit-history",
                                    "Failed to get circuit history: " + std::string(e.what()),
                                    "CIRCUIT_HISTORY_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunBranchList(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunBranchList(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("branch-list", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-list", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("branch-list", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-list", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1590,7 +1596,7 @@ Upp::String CommandDispatcher::RunBranchList(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("branch-list", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-list", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -1599,7 +1605,7 @@ Upp::String CommandDispatcher::RunBranchList(const CommandOptions& opts) {
         auto list_result = BranchOperations::ListBranches(metadata);
         if (!list_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(list_result.error_code);
-            return JsonIO::ErrorResponse("branch-list", list_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-list", list_result.error_message, error_code_str);
         }
 
         // Convert the result to the response format
@@ -1619,21 +1625,21 @@ Upp::String CommandDispatcher::RunBranchList(const CommandOptions& opts) {
         }
         response_data.Add("branches", branches_array);
 
-        return JsonIO::SuccessResponse("branch-list", response_data);
+        return JsonIO::SuccessEnvelope("branch-list", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("branch-list",
+        return JsonIO::ErrorEnvelope("branch-list",
                                    "Failed to list branches: " + std::string(e.what()),
                                    "BRANCH_LIST_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunBranchCreate(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunBranchCreate(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("branch-create", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-create", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("branch-create", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-create", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1641,14 +1647,14 @@ Upp::String CommandDispatcher::RunBranchCreate(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("branch-create", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-create", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
 
         // Get the branch name from command options
         if (!opts.branch_name.has_value()) {
-            return JsonIO::ErrorResponse("branch-create", "Branch name is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("branch-create", "Branch name is required", "INVALID_ARGUMENT");
         }
 
         std::string branch_name = opts.branch_name.value();
@@ -1658,14 +1664,24 @@ Upp::String CommandDispatcher::RunBranchCreate(const CommandOptions& opts) {
         auto create_result = BranchOperations::CreateBranch(metadata, branch_name, from_branch);
         if (!create_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(create_result.error_code);
-            return JsonIO::ErrorResponse("branch-create", create_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-create", create_result.error_message, error_code_str);
+        }
+
+        // Replay of the new branch starts from a checkpoint of the source at the fork
+        std::string session_dir = opts.workspace + "/sessions/" + std::to_string(opts.session_id.value());
+        CircuitFacade circuit_facade;
+        auto checkpoint_result = circuit_facade.CheckpointBranchFrom(metadata, session_dir, from_branch, branch_name,
+                                                                     create_result.data.branch.base_revision);
+        if (!checkpoint_result.ok) {
+            std::string error_code_str = JsonIO::ErrorCodeToString(checkpoint_result.error_code);
+            return JsonIO::ErrorEnvelope("branch-create", checkpoint_result.error_message, error_code_str);
         }
 
         // Save the updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("branch-create", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-create", save_result.error_message, error_code_str);
         }
 
         // Convert the result to the response format
@@ -1680,21 +1696,21 @@ Upp::String CommandDispatcher::RunBranchCreate(const CommandOptions& opts) {
         branch_map.Add("is_default", create_result.data.branch.is_default);
         response_data.Add("branch", branch_map);
 
-        return JsonIO::SuccessResponse("branch-create", response_data);
+        return JsonIO::SuccessEnvelope("branch-create", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("branch-create",
+        return JsonIO::ErrorEnvelope("branch-create",
                                    "Failed to create branch: " + std::string(e.what()),
                                    "BRANCH_CREATE_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunBranchSwitch(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunBranchSwitch(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("branch-switch", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-switch", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("branch-switch", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-switch", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1702,13 +1718,13 @@ Upp::String CommandDispatcher::RunBranchSwitch(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("branch-switch", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-switch", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
 
         if (!opts.branch_name.has_value()) {
-            return JsonIO::ErrorResponse("branch-switch", "Branch name is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("branch-switch", "Branch name is required", "INVALID_ARGUMENT");
         }
 
         std::string branch_name = opts.branch_name.value();
@@ -1717,14 +1733,14 @@ Upp::String CommandDispatcher::RunBranchSwitch(const CommandOptions& opts) {
         auto switch_result = BranchOperations::SwitchBranch(metadata, branch_name);
         if (!switch_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(switch_result.error_code);
-            return JsonIO::ErrorResponse("branch-switch", switch_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-switch", switch_result.error_message, error_code_str);
         }
 
         // Save the updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("branch-switch", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-switch", save_result.error_message, error_code_str);
         }
 
         // Convert the result to the response format
@@ -1732,21 +1748,21 @@ Upp::String CommandDispatcher::RunBranchSwitch(const CommandOptions& opts) {
         response_data.Add("session_id", opts.session_id.value());
         response_data.Add("current_branch", Upp::String(switch_result.data.current_branch.c_str()));
 
-        return JsonIO::SuccessResponse("branch-switch", response_data);
+        return JsonIO::SuccessEnvelope("branch-switch", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("branch-switch",
+        return JsonIO::ErrorEnvelope("branch-switch",
                                    "Failed to switch branch: " + std::string(e.what()),
                                    "BRANCH_SWITCH_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunBranchDelete(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunBranchDelete(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("branch-delete", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-delete", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("branch-delete", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-delete", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1754,13 +1770,13 @@ Upp::String CommandDispatcher::RunBranchDelete(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("branch-delete", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-delete", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
 
         if (!opts.branch_name.has_value()) {
-            return JsonIO::ErrorResponse("branch-delete", "Branch name is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("branch-delete", "Branch name is required", "INVALID_ARGUMENT");
         }
 
         std::string branch_name = opts.branch_name.value();
@@ -1769,14 +1785,14 @@ Upp::String CommandDispatcher::RunBranchDelete(const CommandOptions& opts) {
         auto delete_result = BranchOperations::DeleteBranch(metadata, branch_name);
         if (!delete_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(delete_result.error_code);
-            return JsonIO::ErrorResponse("branch-delete", delete_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-delete", delete_result.error_message, error_code_str);
         }
 
         // Save the updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("branch-delete", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-delete", save_result.error_message, error_code_str);
         }
 
         // Convert the result to the response format
@@ -1784,21 +1800,21 @@ Upp::String CommandDispatcher::RunBranchDelete(const CommandOptions& opts) {
         response_data.Add("session_id", opts.session_id.value());
         response_data.Add("deleted_branch", Upp::String(delete_result.data.deleted_branch.c_str()));
 
-        return JsonIO::SuccessResponse("branch-delete", response_data);
+        return JsonIO::SuccessEnvelope("branch-delete", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("branch-delete",
+        return JsonIO::ErrorEnvelope("branch-delete",
                                    "Failed to delete branch: " + std::string(e.what()),
                                    "BRANCH_DELETE_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("branch-merge", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-merge", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("branch-merge", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("branch-merge", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -1806,13 +1822,13 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("branch-merge", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-merge", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
 
         if (!opts.branch_from.has_value() || !opts.branch_to.has_value()) {
-            return JsonIO::ErrorResponse("branch-merge", "Both source and target branches are required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("branch-merge", "Both source and target branches are required", "INVALID_ARGUMENT");
         }
 
         std::string source_branch = opts.branch_from.value();
@@ -1822,14 +1838,26 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         auto merge_result = BranchOperations::MergeBranch(metadata, source_branch, target_branch);
         if (!merge_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(merge_result.error_code);
-            return JsonIO::ErrorResponse("branch-merge", merge_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-merge", merge_result.error_message, error_code_str);
+        }
+
+        // The target's new head was logged under the source branch
+        if (merge_result.data.merged_ops_count > 0) {
+            std::string session_dir = opts.workspace + "/sessions/" + std::to_string(opts.session_id.value());
+            CircuitFacade circuit_facade;
+            auto checkpoint_result = circuit_facade.CheckpointBranchFrom(metadata, session_dir, source_branch, target_branch,
+                                                                         merge_result.data.target_new_revision);
+            if (!checkpoint_result.ok) {
+                std::string error_code_str = JsonIO::ErrorCodeToString(checkpoint_result.error_code);
+                return JsonIO::ErrorEnvelope("branch-merge", checkpoint_result.error_message, error_code_str);
+            }
         }
 
         // Save the updated session metadata
         auto save_result = session_store_->SaveSession(metadata);
         if (!save_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(save_result.error_code);
-            return JsonIO::ErrorResponse("branch-merge", save_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("branch-merge", save_result.error_message, error_code_str);
         }
 
         // Convert the result to the response format
@@ -1840,22 +1868,22 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         response_data.Add("target_new_revision", merge_result.data.target_new_revision);
         response_data.Add("merged_ops_count", merge_result.data.merged_ops_count);
 
-        return JsonIO::SuccessResponse("branch-merge", response_data);
+        return JsonIO::SuccessEnvelope("branch-merge", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("branch-merge",
+        return JsonIO::ErrorEnvelope("branch-merge",
                                    "Failed to merge branches: " + std::string(e.what()),
                                    "BRANCH_MERGE_ERROR");
     }
 }
 
     // Graph commands
-    Upp::String CommandDispatcher::RunGraphExport(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunGraphExport(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("graph-export", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-export", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("graph-export", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-export", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -1863,7 +1891,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("graph-export", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-export", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -1875,7 +1903,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("graph-export", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("graph-export", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Load the circuit for the specified branch
@@ -1886,7 +1914,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!load_circuit_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_circuit_result.error_code);
-                return JsonIO::ErrorResponse("graph-export", load_circuit_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-export", load_circuit_result.error_message, error_code_str);
             }
 
             // Build the graph
@@ -1894,7 +1922,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = builder.BuildGraph(circuit);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("graph-export", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-export", graph_result.error_message, error_code_str);
             }
 
             // Convert the graph to JSON format for response
@@ -1944,21 +1972,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             graph_map.Add("edges", edges_array);
             response_data.Set("graph", graph_map);
 
-            return JsonIO::SuccessResponse("graph-export", response_data);
+            return JsonIO::SuccessEnvelope("graph-export", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("graph-export",
+            return JsonIO::ErrorEnvelope("graph-export",
                                        "Failed to export graph: " + std::string(e.what()),
                                        "GRAPH_EXPORT_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunGraphPaths(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunGraphPaths(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("graph-paths", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-paths", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("graph-paths", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-paths", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -1966,7 +1994,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("graph-paths", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-paths", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -1978,7 +2006,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("graph-paths", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("graph-paths", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Load the circuit for the specified branch
@@ -1989,7 +2017,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!load_circuit_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_circuit_result.error_code);
-                return JsonIO::ErrorResponse("graph-paths", load_circuit_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-paths", load_circuit_result.error_message, error_code_str);
             }
 
             // Build the graph
@@ -1997,7 +2025,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = builder.BuildGraph(circuit);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("graph-paths", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-paths", graph_result.error_message, error_code_str);
             }
 
             // Get source and target from command options
@@ -2042,7 +2070,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto paths_result = queries.FindSignalPaths(graph_result.data, source_node, target_node, max_depth);
             if (!paths_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(paths_result.error_code);
-                return JsonIO::ErrorResponse("graph-paths", paths_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-paths", paths_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2068,21 +2096,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             }
             response_data.Add("paths", paths_array);
 
-            return JsonIO::SuccessResponse("graph-paths", response_data);
+            return JsonIO::SuccessEnvelope("graph-paths", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("graph-paths",
+            return JsonIO::ErrorEnvelope("graph-paths",
                                        "Failed to find paths: " + std::string(e.what()),
                                        "GRAPH_PATHS_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunGraphFanIn(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunGraphFanIn(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("graph-fanin", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-fanin", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("graph-fanin", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-fanin", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2090,7 +2118,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("graph-fanin", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-fanin", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2102,7 +2130,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("graph-fanin", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("graph-fanin", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Load the circuit for the specified branch
@@ -2113,7 +2141,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!load_circuit_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_circuit_result.error_code);
-                return JsonIO::ErrorResponse("graph-fanin", load_circuit_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-fanin", load_circuit_result.error_message, error_code_str);
             }
 
             // Build the graph
@@ -2121,7 +2149,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = builder.BuildGraph(circuit);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("graph-fanin", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-fanin", graph_result.error_message, error_code_str);
             }
 
             // Get target node from command options
@@ -2152,7 +2180,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto fanin_result = queries.FindFanIn(graph_result.data, target_node, max_depth);
             if (!fanin_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(fanin_result.error_code);
-                return JsonIO::ErrorResponse("graph-fanin", fanin_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-fanin", fanin_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2178,21 +2206,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             }
             response_data.Add("endpoints", endpoints_array);
 
-            return JsonIO::SuccessResponse("graph-fanin", response_data);
+            return JsonIO::SuccessEnvelope("graph-fanin", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("graph-fanin",
+            return JsonIO::ErrorEnvelope("graph-fanin",
                                        "Failed to find fan-in: " + std::string(e.what()),
                                        "GRAPH_FANIN_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunGraphFanOut(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunGraphFanOut(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("graph-fanout", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-fanout", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("graph-fanout", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-fanout", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2200,7 +2228,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("graph-fanout", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-fanout", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2212,7 +2240,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("graph-fanout", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("graph-fanout", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Load the circuit for the specified branch
@@ -2223,7 +2251,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!load_circuit_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_circuit_result.error_code);
-                return JsonIO::ErrorResponse("graph-fanout", load_circuit_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-fanout", load_circuit_result.error_message, error_code_str);
             }
 
             // Build the graph
@@ -2231,7 +2259,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = builder.BuildGraph(circuit);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("graph-fanout", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-fanout", graph_result.error_message, error_code_str);
             }
 
             // Get source node from command options
@@ -2262,7 +2290,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto fanout_result = queries.FindFanOut(graph_result.data, source_node, max_depth);
             if (!fanout_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(fanout_result.error_code);
-                return JsonIO::ErrorResponse("graph-fanout", fanout_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-fanout", fanout_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2288,21 +2316,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             }
             response_data.Add("endpoints", endpoints_array);
 
-            return JsonIO::SuccessResponse("graph-fanout", response_data);
+            return JsonIO::SuccessEnvelope("graph-fanout", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("graph-fanout",
+            return JsonIO::ErrorEnvelope("graph-fanout",
                                        "Failed to find fan-out: " + std::string(e.what()),
                                        "GRAPH_FANOUT_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunGraphStats(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunGraphStats(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("graph-stats", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-stats", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("graph-stats", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("graph-stats", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2310,7 +2338,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("graph-stats", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-stats", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2322,7 +2350,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("graph-stats", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("graph-stats", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Load the circuit for the specified branch
@@ -2333,7 +2361,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!load_circuit_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_circuit_result.error_code);
-                return JsonIO::ErrorResponse("graph-stats", load_circuit_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-stats", load_circuit_result.error_message, error_code_str);
             }
 
             // Build the graph
@@ -2341,7 +2369,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = builder.BuildGraph(circuit);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("graph-stats", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-stats", graph_result.error_message, error_code_str);
             }
 
             // Get stats
@@ -2350,7 +2378,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto stats_result = queries.ComputeGraphStats(graph_result.data, node_count, edge_count);
             if (!stats_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(stats_result.error_code);
-                return JsonIO::ErrorResponse("graph-stats", stats_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("graph-stats", stats_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2360,21 +2388,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("node_count", node_count);
             response_data.Add("edge_count", edge_count);
 
-            return JsonIO::SuccessResponse("graph-stats", response_data);
+            return JsonIO::SuccessEnvelope("graph-stats", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("graph-stats",
+            return JsonIO::ErrorEnvelope("graph-stats",
                                        "Failed to compute stats: " + std::string(e.what()),
                                        "GRAPH_STATS_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunTimingSummary(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunTimingSummary(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("timing-summary", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("timing-summary", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("timing-summary", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("timing-summary", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2382,7 +2410,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("timing-summary", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-summary", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2394,7 +2422,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("timing-summary", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("timing-summary", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Load timing graph for the specified branch
@@ -2404,7 +2432,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!timing_graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(timing_graph_result.error_code);
-                return JsonIO::ErrorResponse("timing-summary", timing_graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-summary", timing_graph_result.error_message, error_code_str);
             }
 
             // Perform timing analysis
@@ -2416,7 +2444,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!summary_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(summary_result.error_code);
-                return JsonIO::ErrorResponse("timing-summary", summary_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-summary", summary_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2426,21 +2454,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("max_depth", summary_result.data.max_depth);
             response_data.Add("path_count", summary_result.data.path_count);
 
-            return JsonIO::SuccessResponse("timing-summary", response_data);
+            return JsonIO::SuccessEnvelope("timing-summary", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("timing-summary",
+            return JsonIO::ErrorEnvelope("timing-summary",
                                        "Failed to compute timing summary: " + std::string(e.what()),
                                        "TIMING_SUMMARY_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunTimingCriticalPaths(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunTimingCriticalPaths(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("timing-critical-paths", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("timing-critical-paths", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("timing-critical-paths", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("timing-critical-paths", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2448,7 +2476,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("timing-critical-paths", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-critical-paths", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2460,7 +2488,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("timing-critical-paths", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("timing-critical-paths", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Get max_paths and max_depth from options
@@ -2487,7 +2515,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!timing_graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(timing_graph_result.error_code);
-                return JsonIO::ErrorResponse("timing-critical-paths", timing_graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-critical-paths", timing_graph_result.error_message, error_code_str);
             }
 
             // Perform timing analysis for critical paths
@@ -2501,7 +2529,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!paths_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(paths_result.error_code);
-                return JsonIO::ErrorResponse("timing-critical-paths", paths_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-critical-paths", paths_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2510,21 +2538,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("branch", Upp::String(branch_name.c_str()));
             response_data.Add("paths", JsonIO::TimingPathsToValueArray(paths_result.data));
 
-            return JsonIO::SuccessResponse("timing-critical-paths", response_data);
+            return JsonIO::SuccessEnvelope("timing-critical-paths", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("timing-critical-paths",
+            return JsonIO::ErrorEnvelope("timing-critical-paths",
                                        "Failed to compute critical paths: " + std::string(e.what()),
                                        "TIMING_CRITICAL_PATHS_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunTimingLoops(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunTimingLoops(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("timing-loops", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("timing-loops", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("timing-loops", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("timing-loops", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2532,7 +2560,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("timing-loops", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-loops", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2544,7 +2572,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("timing-loops", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("timing-loops", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Load timing graph for the specified branch
@@ -2554,7 +2582,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!timing_graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(timing_graph_result.error_code);
-                return JsonIO::ErrorResponse("timing-loops", timing_graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-loops", timing_graph_result.error_message, error_code_str);
             }
 
             // Perform timing analysis to detect loops
@@ -2566,7 +2594,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!loops_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(loops_result.error_code);
-                return JsonIO::ErrorResponse("timing-loops", loops_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-loops", loops_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2575,21 +2603,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("branch", Upp::String(branch_name.c_str()));
             response_data.Add("loops", JsonIO::TimingLoopsToValueArray(loops_result.data));
 
-            return JsonIO::SuccessResponse("timing-loops", response_data);
+            return JsonIO::SuccessEnvelope("timing-loops", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("timing-loops",
+            return JsonIO::ErrorEnvelope("timing-loops",
                                        "Failed to detect loops: " + std::string(e.what()),
                                        "TIMING_LOOPS_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunTimingHazards(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunTimingHazards(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("timing-hazards", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("timing-hazards", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("timing-hazards", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("timing-hazards", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2597,7 +2625,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("timing-hazards", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-hazards", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2609,7 +2637,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("timing-hazards", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("timing-hazards", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Get max_results from options
@@ -2628,7 +2656,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!timing_graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(timing_graph_result.error_code);
-                return JsonIO::ErrorResponse("timing-hazards", timing_graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-hazards", timing_graph_result.error_message, error_code_str);
             }
 
             // Perform hazard analysis
@@ -2641,7 +2669,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!hazards_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(hazards_result.error_code);
-                return JsonIO::ErrorResponse("timing-hazards", hazards_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("timing-hazards", hazards_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2650,21 +2678,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("branch", Upp::String(branch_name.c_str()));
             response_data.Add("hazards", JsonIO::HazardCandidatesToValueArray(hazards_result.data));
 
-            return JsonIO::SuccessResponse("timing-hazards", response_data);
+            return JsonIO::SuccessEnvelope("timing-hazards", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("timing-hazards",
+            return JsonIO::ErrorEnvelope("timing-hazards",
                                        "Failed to detect hazards: " + std::string(e.what()),
                                        "TIMING_HAZARDS_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunDepsSummary(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunDepsSummary(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("deps-summary", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-summary", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("deps-summary", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-summary", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         // Extract node parameters
@@ -2680,7 +2708,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         }
 
         if (node_id.empty()) {
-            return JsonIO::ErrorResponse("deps-summary", "Node ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-summary", "Node ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2688,7 +2716,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("deps-summary", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-summary", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2700,7 +2728,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("deps-summary", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("deps-summary", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Resolve the functional node
@@ -2708,13 +2736,13 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = circuit_facade.BuildGraphForBranch(metadata, session_dir, branch_name);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("deps-summary", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-summary", graph_result.error_message, error_code_str);
             }
 
             auto resolve_result = ResolveFunctionalNode(graph_result.data, node_id, node_kind);
             if (!resolve_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(resolve_result.error_code);
-                return JsonIO::ErrorResponse("deps-summary", resolve_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-summary", resolve_result.error_message, error_code_str);
             }
 
             FunctionalNodeId func_node = resolve_result.data;
@@ -2725,7 +2753,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!summary_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(summary_result.error_code);
-                return JsonIO::ErrorResponse("deps-summary", summary_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-summary", summary_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2736,21 +2764,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("upstream_count", summary_result.data.upstream_count);
             response_data.Add("downstream_count", summary_result.data.downstream_count);
 
-            return JsonIO::SuccessResponse("deps-summary", response_data);
+            return JsonIO::SuccessEnvelope("deps-summary", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("deps-summary",
+            return JsonIO::ErrorEnvelope("deps-summary",
                                        "Failed to compute dependency summary: " + std::string(e.what()),
                                        "DEPS_SUMMARY_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunDepsBackward(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunDepsBackward(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("deps-backward", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-backward", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("deps-backward", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-backward", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         // Extract node parameters
@@ -2766,7 +2794,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         }
 
         if (node_id.empty()) {
-            return JsonIO::ErrorResponse("deps-backward", "Node ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-backward", "Node ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2774,7 +2802,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("deps-backward", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-backward", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2786,7 +2814,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("deps-backward", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("deps-backward", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Resolve the functional node
@@ -2794,13 +2822,13 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = circuit_facade.BuildGraphForBranch(metadata, session_dir, branch_name);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("deps-backward", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-backward", graph_result.error_message, error_code_str);
             }
 
             auto resolve_result = ResolveFunctionalNode(graph_result.data, node_id, node_kind);
             if (!resolve_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(resolve_result.error_code);
-                return JsonIO::ErrorResponse("deps-backward", resolve_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-backward", resolve_result.error_message, error_code_str);
             }
 
             FunctionalNodeId func_node = resolve_result.data;
@@ -2811,7 +2839,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!cone_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(cone_result.error_code);
-                return JsonIO::ErrorResponse("deps-backward", cone_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-backward", cone_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2820,21 +2848,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("branch", Upp::String(branch_name.c_str()));
             response_data.Add("cone", JsonIO::FunctionalConeToValueMap(cone_result.data));
 
-            return JsonIO::SuccessResponse("deps-backward", response_data);
+            return JsonIO::SuccessEnvelope("deps-backward", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("deps-backward",
+            return JsonIO::ErrorEnvelope("deps-backward",
                                        "Failed to compute backward cone: " + std::string(e.what()),
                                        "DEPS_BACKWARD_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunDepsForward(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunDepsForward(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("deps-forward", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-forward", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("deps-forward", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-forward", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         // Extract node parameters
@@ -2850,7 +2878,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         }
 
         if (node_id.empty()) {
-            return JsonIO::ErrorResponse("deps-forward", "Node ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-forward", "Node ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2858,7 +2886,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("deps-forward", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-forward", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2870,7 +2898,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("deps-forward", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("deps-forward", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Resolve the functional node
@@ -2878,13 +2906,13 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = circuit_facade.BuildGraphForBranch(metadata, session_dir, branch_name);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("deps-forward", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-forward", graph_result.error_message, error_code_str);
             }
 
             auto resolve_result = ResolveFunctionalNode(graph_result.data, node_id, node_kind);
             if (!resolve_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(resolve_result.error_code);
-                return JsonIO::ErrorResponse("deps-forward", resolve_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-forward", resolve_result.error_message, error_code_str);
             }
 
             FunctionalNodeId func_node = resolve_result.data;
@@ -2895,7 +2923,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!cone_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(cone_result.error_code);
-                return JsonIO::ErrorResponse("deps-forward", cone_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-forward", cone_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -2904,21 +2932,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("branch", Upp::String(branch_name.c_str()));
             response_data.Add("cone", JsonIO::FunctionalConeToValueMap(cone_result.data));
 
-            return JsonIO::SuccessResponse("deps-forward", response_data);
+            return JsonIO::SuccessEnvelope("deps-forward", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("deps-forward",
+            return JsonIO::ErrorEnvelope("deps-forward",
                                        "Failed to compute forward cone: " + std::string(e.what()),
                                        "DEPS_FORWARD_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunDepsBoth(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunDepsBoth(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("deps-both", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-both", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("deps-both", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-both", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         // Extract node parameters
@@ -2934,7 +2962,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         }
 
         if (node_id.empty()) {
-            return JsonIO::ErrorResponse("deps-both", "Node ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("deps-both", "Node ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -2942,7 +2970,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("deps-both", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-both", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -2954,7 +2982,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Find the branch metadata
             std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, branch_name);
             if (!branch_opt.has_value()) {
-                return JsonIO::ErrorResponse("deps-both", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+                return JsonIO::ErrorEnvelope("deps-both", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
             }
 
             // Resolve the functional node
@@ -2962,13 +2990,13 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto graph_result = circuit_facade.BuildGraphForBranch(metadata, session_dir, branch_name);
             if (!graph_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-                return JsonIO::ErrorResponse("deps-both", graph_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-both", graph_result.error_message, error_code_str);
             }
 
             auto resolve_result = ResolveFunctionalNode(graph_result.data, node_id, node_kind);
             if (!resolve_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(resolve_result.error_code);
-                return JsonIO::ErrorResponse("deps-both", resolve_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-both", resolve_result.error_message, error_code_str);
             }
 
             FunctionalNodeId func_node = resolve_result.data;
@@ -2979,7 +3007,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!backward_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(backward_result.error_code);
-                return JsonIO::ErrorResponse("deps-both", backward_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-both", backward_result.error_message, error_code_str);
             }
 
             auto forward_result = circuit_facade.BuildForwardConeForBranch(
@@ -2987,7 +3015,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!forward_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(forward_result.error_code);
-                return JsonIO::ErrorResponse("deps-both", forward_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-both", forward_result.error_message, error_code_str);
             }
 
             // Also compute the dependency summary
@@ -2996,7 +3024,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!summary_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(summary_result.error_code);
-                return JsonIO::ErrorResponse("deps-both", summary_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("deps-both", summary_result.error_message, error_code_str);
             }
 
             // Format the response
@@ -3008,21 +3036,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             response_data.Add("forward", JsonIO::FunctionalConeToValueMap(forward_result.data));
             response_data.Add("summary", JsonIO::DependencySummaryToValueMap(summary_result.data));
 
-            return JsonIO::SuccessResponse("deps-both", response_data);
+            return JsonIO::SuccessEnvelope("deps-both", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("deps-both",
+            return JsonIO::ErrorEnvelope("deps-both",
                                        "Failed to compute both cones: " + std::string(e.what()),
                                        "DEPS_BOTH_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunBlocksList(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunBlocksList(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("blocks-list", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("blocks-list", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("blocks-list", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("blocks-list", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -3033,7 +3061,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("blocks-list", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("blocks-list", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -3046,7 +3074,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto block_result = facade.BuildBlockGraphForBranch(metadata, session_dir, branch_name);
             if (!block_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(block_result.error_code);
-                return JsonIO::ErrorResponse("blocks-list", block_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("blocks-list", block_result.error_message, error_code_str);
             }
 
             // Convert result to JSON
@@ -3103,21 +3131,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             }
             response_data.Add("blocks", blocks_array);
 
-            return JsonIO::SuccessResponse("blocks-list", response_data);
+            return JsonIO::SuccessEnvelope("blocks-list", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("blocks-list",
+            return JsonIO::ErrorEnvelope("blocks-list",
                                        "Failed to list blocks: " + std::string(e.what()),
                                        "BLOCKS_LIST_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunBlocksExport(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunBlocksExport(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("blocks-export", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("blocks-export", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("blocks-export", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("blocks-export", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -3128,7 +3156,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("blocks-export", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("blocks-export", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -3141,7 +3169,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto block_result = facade.BuildBlockGraphForBranch(metadata, session_dir, branch_name);
             if (!block_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(block_result.error_code);
-                return JsonIO::ErrorResponse("blocks-export", block_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("blocks-export", block_result.error_message, error_code_str);
             }
 
             // Convert result to JSON
@@ -3207,25 +3235,25 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             response_data.Add("block_graph", block_graph_map);
 
-            return JsonIO::SuccessResponse("blocks-export", response_data);
+            return JsonIO::SuccessEnvelope("blocks-export", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("blocks-export",
+            return JsonIO::ErrorEnvelope("blocks-export",
                                        "Failed to export block graph: " + std::string(e.what()),
                                        "BLOCKS_EXPORT_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunBlockInspect(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunBlockInspect(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("block-inspect", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("block-inspect", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("block-inspect", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("block-inspect", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.block_id.has_value()) {
-            return JsonIO::ErrorResponse("block-inspect", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("block-inspect", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -3236,7 +3264,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("block-inspect", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("block-inspect", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -3249,7 +3277,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto block_result = facade.BuildBlockGraphForBranch(metadata, session_dir, branch_name);
             if (!block_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(block_result.error_code);
-                return JsonIO::ErrorResponse("block-inspect", block_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("block-inspect", block_result.error_message, error_code_str);
             }
 
             // Find the requested block
@@ -3262,7 +3290,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             }
 
             if (!found_block) {
-                return JsonIO::ErrorResponse("block-inspect",
+                return JsonIO::ErrorEnvelope("block-inspect",
                                            "Block not found: " + opts.block_id.value(),
                                            "NOT_FOUND");
             }
@@ -3323,25 +3351,25 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             response_data.Add("block", block_map);
 
-            return JsonIO::SuccessResponse("block-inspect", response_data);
+            return JsonIO::SuccessEnvelope("block-inspect", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("block-inspect",
+            return JsonIO::ErrorEnvelope("block-inspect",
                                        "Failed to inspect block: " + std::string(e.what()),
                                        "BLOCK_INSPECT_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunBehaviorBlock(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunBehaviorBlock(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("behavior-block", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("behavior-block", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("behavior-block", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("behavior-block", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.block_id.has_value()) {
-            return JsonIO::ErrorResponse("behavior-block", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("behavior-block", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -3352,7 +3380,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("behavior-block", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("behavior-block", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -3367,7 +3395,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!behavior_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(behavior_result.error_code);
-                return JsonIO::ErrorResponse("behavior-block", behavior_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("behavior-block", behavior_result.error_message, error_code_str);
             }
 
             // Convert the behavior descriptor to JSON
@@ -3417,21 +3445,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             response_data.Add("behavior", behavior_map);
 
-            return JsonIO::SuccessResponse("behavior-block", response_data);
+            return JsonIO::SuccessEnvelope("behavior-block", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("behavior-block",
+            return JsonIO::ErrorEnvelope("behavior-block",
                                        "Failed to infer behavior for block: " + std::string(e.what()),
                                        "BEHAVIOR_BLOCK_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunBehaviorNode(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunBehaviorNode(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("behavior-node", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("behavior-node", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("behavior-node", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("behavior-node", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         if (opts.node_id.empty()) {
@@ -3442,7 +3470,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         }
 
         if (opts.node_id.empty()) {
-            return JsonIO::ErrorResponse("behavior-node", "Node ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("behavior-node", "Node ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -3459,7 +3487,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("behavior-node", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("behavior-node", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -3474,7 +3502,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!behavior_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(behavior_result.error_code);
-                return JsonIO::ErrorResponse("behavior-node", behavior_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("behavior-node", behavior_result.error_message, error_code_str);
             }
 
             // Convert the behavior descriptor to JSON
@@ -3524,25 +3552,25 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             response_data.Add("behavior", behavior_map);
 
-            return JsonIO::SuccessResponse("behavior-node", response_data);
+            return JsonIO::SuccessEnvelope("behavior-node", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("behavior-node",
+            return JsonIO::ErrorEnvelope("behavior-node",
                                        "Failed to infer behavior for node: " + std::string(e.what()),
                                        "BEHAVIOR_NODE_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunIrBlock(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunIrBlock(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("ir-block", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("ir-block", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("ir-block", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("ir-block", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.block_id.has_value()) {
-            return JsonIO::ErrorResponse("ir-block", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("ir-block", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -3553,7 +3581,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("ir-block", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("ir-block", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -3568,7 +3596,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!ir_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(ir_result.error_code);
-                return JsonIO::ErrorResponse("ir-block", ir_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("ir-block", ir_result.error_message, error_code_str);
             }
 
             // Convert the IR module to JSON
@@ -3579,21 +3607,21 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Use JsonIO to serialize the IR module
             response_data.Add("ir", JsonIO::IrModuleToValueMap(ir_result.data));
 
-            return JsonIO::SuccessResponse("ir-block", response_data);
+            return JsonIO::SuccessEnvelope("ir-block", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("ir-block",
+            return JsonIO::ErrorEnvelope("ir-block",
                                        "Failed to build IR for block: " + std::string(e.what()),
                                        "IR_BLOCK_ERROR");
         }
     }
 
-    Upp::String CommandDispatcher::RunIrNodeRegion(const CommandOptions& opts) {
+    Upp::ValueMap CommandDispatcher::RunIrNodeRegion(const CommandOptions& opts) {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("ir-node-region", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("ir-node-region", "Workspace path is required", "INVALID_ARGUMENT");
         }
 
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("ir-node-region", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("ir-node-region", "Session ID is required", "INVALID_ARGUMENT");
         }
 
         if (opts.node_id.empty()) {
@@ -3604,7 +3632,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
         }
 
         if (opts.node_id.empty()) {
-            return JsonIO::ErrorResponse("ir-node-region", "Node ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("ir-node-region", "Node ID is required", "INVALID_ARGUMENT");
         }
 
         try {
@@ -3626,7 +3654,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             auto load_result = session_store_->LoadSession(opts.session_id.value());
             if (!load_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-                return JsonIO::ErrorResponse("ir-node-region", load_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("ir-node-region", load_result.error_message, error_code_str);
             }
 
             SessionMetadata metadata = load_result.data;
@@ -3641,7 +3669,7 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
 
             if (!ir_result.ok) {
                 std::string error_code_str = JsonIO::ErrorCodeToString(ir_result.error_code);
-                return JsonIO::ErrorResponse("ir-node-region", ir_result.error_message, error_code_str);
+                return JsonIO::ErrorEnvelope("ir-node-region", ir_result.error_message, error_code_str);
             }
 
             // Convert the IR module to JSON
@@ -3652,18 +3680,18 @@ Upp::String CommandDispatcher::RunBranchMerge(const CommandOptions& opts) {
             // Use JsonIO to serialize the IR module
             response_data.Add("ir", JsonIO::IrModuleToValueMap(ir_result.data));
 
-            return JsonIO::SuccessResponse("ir-node-region", response_data);
+            return JsonIO::SuccessEnvelope("ir-node-region", response_data);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("ir-node-region",
+            return JsonIO::ErrorEnvelope("ir-node-region",
                                        "Failed to build IR for node region: " + std::string(e.what()),
                                        "IR_NODE_REGION_ERROR");
         }
     }
 
-Upp::String CommandDispatcher::RunRefactorSuggest(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRefactorSuggest(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty() || opts.session_id.empty()) {
-            return JsonIO::ErrorResponse("refactor-suggest",
+            return JsonIO::ErrorEnvelope("refactor-suggest",
                                        "Required parameters: --workspace, --session-id",
                                        "PARAMETER_ERROR");
         }
@@ -3671,7 +3699,7 @@ Upp::String CommandDispatcher::RunRefactorSuggest(const CommandOptions& opts) {
         // Get session metadata
         auto session_result = session_store_->LoadSession(opts.session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("refactor-suggest",
+            return JsonIO::ErrorEnvelope("refactor-suggest",
                                        session_result.error_message,
                                        JsonIO::ErrorCodeToString(session_result.error_code));
         }
@@ -3688,7 +3716,7 @@ Upp::String CommandDispatcher::RunRefactorSuggest(const CommandOptions& opts) {
             try {
                 max_plans = std::stoi(opts.max_plans);
             } catch (const std::exception&) {
-                return JsonIO::ErrorResponse("refactor-suggest",
+                return JsonIO::ErrorEnvelope("refactor-suggest",
                                            "Invalid max-plans value: " + opts.max_plans,
                                            "PARAMETER_ERROR");
             }
@@ -3700,7 +3728,7 @@ Upp::String CommandDispatcher::RunRefactorSuggest(const CommandOptions& opts) {
             session, session_dir, branch_name, max_plans);
 
         if (!plans_result.ok) {
-            return JsonIO::ErrorResponse("refactor-suggest",
+            return JsonIO::ErrorEnvelope("refactor-suggest",
                                        plans_result.error_message,
                                        JsonIO::ErrorCodeToString(plans_result.error_code));
         }
@@ -3723,18 +3751,18 @@ Upp::String CommandDispatcher::RunRefactorSuggest(const CommandOptions& opts) {
         }
         response_data.Add("plans", plans_array);
 
-        return JsonIO::SuccessResponse("refactor-suggest", response_data);
+        return JsonIO::SuccessEnvelope("refactor-suggest", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("refactor-suggest",
+        return JsonIO::ErrorEnvelope("refactor-suggest",
                                    "Failed to suggest transformations: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRefactorSuggestBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRefactorSuggestBlock(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty() || opts.session_id.empty() || opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("refactor-suggest-block",
+            return JsonIO::ErrorEnvelope("refactor-suggest-block",
                                        "Required parameters: --workspace, --session-id, --block-id",
                                        "PARAMETER_ERROR");
         }
@@ -3742,7 +3770,7 @@ Upp::String CommandDispatcher::RunRefactorSuggestBlock(const CommandOptions& opt
         // Get session metadata
         auto session_result = session_store_->LoadSession(opts.session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("refactor-suggest-block",
+            return JsonIO::ErrorEnvelope("refactor-suggest-block",
                                        session_result.error_message,
                                        JsonIO::ErrorCodeToString(session_result.error_code));
         }
@@ -3759,7 +3787,7 @@ Upp::String CommandDispatcher::RunRefactorSuggestBlock(const CommandOptions& opt
             try {
                 max_plans = std::stoi(opts.max_plans);
             } catch (const std::exception&) {
-                return JsonIO::ErrorResponse("refactor-suggest-block",
+                return JsonIO::ErrorEnvelope("refactor-suggest-block",
                                            "Invalid max-plans value: " + opts.max_plans,
                                            "PARAMETER_ERROR");
             }
@@ -3771,7 +3799,7 @@ Upp::String CommandDispatcher::RunRefactorSuggestBlock(const CommandOptions& opt
             session, session_dir, branch_name, opts.block_id, max_plans);
 
         if (!plans_result.ok) {
-            return JsonIO::ErrorResponse("refactor-suggest-block",
+            return JsonIO::ErrorEnvelope("refactor-suggest-block",
                                        plans_result.error_message,
                                        JsonIO::ErrorCodeToString(plans_result.error_code));
         }
@@ -3795,18 +3823,18 @@ Upp::String CommandDispatcher::RunRefactorSuggestBlock(const CommandOptions& opt
         }
         response_data.Add("plans", plans_array);
 
-        return JsonIO::SuccessResponse("refactor-suggest-block", response_data);
+        return JsonIO::SuccessEnvelope("refactor-suggest-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("refactor-suggest-block",
+        return JsonIO::ErrorEnvelope("refactor-suggest-block",
                                    "Failed to suggest transformations for block: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRefactorApply(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRefactorApply(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty() || opts.session_id.empty() || opts.plan_id.empty()) {
-            return JsonIO::ErrorResponse("refactor-apply",
+            return JsonIO::ErrorEnvelope("refactor-apply",
                                        "Required parameters: --workspace, --session-id, --plan-id",
                                        "PARAMETER_ERROR");
         }
@@ -3814,7 +3842,7 @@ Upp::String CommandDispatcher::RunRefactorApply(const CommandOptions& opts) {
         // Get session metadata
         auto session_result = session_store_->LoadSession(opts.session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("refactor-apply",
+            return JsonIO::ErrorEnvelope("refactor-apply",
                                        session_result.error_message,
                                        JsonIO::ErrorCodeToString(session_result.error_code));
         }
@@ -3828,20 +3856,20 @@ Upp::String CommandDispatcher::RunRefactorApply(const CommandOptions& opts) {
         // For now, we'll implement a simple approach where the plan is specified as JSON in the options
         // In a more advanced implementation, plans might be stored and referenced by ID
         // For now, this is a simplified implementation that will return an error
-        return JsonIO::ErrorResponse("refactor-apply",
+        return JsonIO::ErrorEnvelope("refactor-apply",
                                    "Plan application requires the full plan details, which is not provided in this implementation",
                                    "NOT_IMPLEMENTED_ERROR");
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("refactor-apply",
+        return JsonIO::ErrorEnvelope("refactor-apply",
                                    "Failed to apply transformation: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunIrOptBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunIrOptBlock(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty() || opts.session_id.empty() || opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("ir-opt-block",
+            return JsonIO::ErrorEnvelope("ir-opt-block",
                                        "Required parameters: --workspace, --session-id, --block-id",
                                        "PARAMETER_ERROR");
         }
@@ -3849,7 +3877,7 @@ Upp::String CommandDispatcher::RunIrOptBlock(const CommandOptions& opts) {
         // Get session metadata
         auto session_result = session_store_->LoadSession(opts.session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("ir-opt-block",
+            return JsonIO::ErrorEnvelope("ir-opt-block",
                                        session_result.error_message,
                                        JsonIO::ErrorCodeToString(session_result.error_code));
         }
@@ -3904,7 +3932,7 @@ Upp::String CommandDispatcher::RunIrOptBlock(const CommandOptions& opts) {
         // Run IR optimization
         auto result = facade.OptimizeBlockIrInBranch(session, session_dir, branch_name, opts.block_id, passes_to_run);
         if (!result.ok) {
-            return JsonIO::ErrorResponse("ir-opt-block",
+            return JsonIO::ErrorEnvelope("ir-opt-block",
                                        result.error_message,
                                        JsonIO::ErrorCodeToString(result.error_code));
         }
@@ -3925,16 +3953,16 @@ Upp::String CommandDispatcher::RunIrOptBlock(const CommandOptions& opts) {
 
         return JsonIO::FromResult<IrOptimizationResult>("ir-opt-block", result, converter);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("ir-opt-block",
+        return JsonIO::ErrorEnvelope("ir-opt-block",
                                    "Failed to run IR optimization: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunIrOptRefactorBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunIrOptRefactorBlock(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty() || opts.session_id.empty() || opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("ir-opt-refactor-block",
+            return JsonIO::ErrorEnvelope("ir-opt-refactor-block",
                                        "Required parameters: --workspace, --session-id, --block-id",
                                        "PARAMETER_ERROR");
         }
@@ -3942,7 +3970,7 @@ Upp::String CommandDispatcher::RunIrOptRefactorBlock(const CommandOptions& opts)
         // Get session metadata
         auto session_result = session_store_->LoadSession(opts.session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("ir-opt-refactor-block",
+            return JsonIO::ErrorEnvelope("ir-opt-refactor-block",
                                        session_result.error_message,
                                        JsonIO::ErrorCodeToString(session_result.error_code));
         }
@@ -3997,7 +4025,7 @@ Upp::String CommandDispatcher::RunIrOptRefactorBlock(const CommandOptions& opts)
         // Run IR-based transformation proposal
         auto result = facade.ProposeIrBasedTransformationsForBlock(session, session_dir, branch_name, opts.block_id, passes_to_run);
         if (!result.ok) {
-            return JsonIO::ErrorResponse("ir-opt-refactor-block",
+            return JsonIO::ErrorEnvelope("ir-opt-refactor-block",
                                        result.error_message,
                                        JsonIO::ErrorCodeToString(result.error_code));
         }
@@ -4014,17 +4042,17 @@ Upp::String CommandDispatcher::RunIrOptRefactorBlock(const CommandOptions& opts)
 
         return JsonIO::FromResult<std::vector<TransformationPlan>>("ir-opt-refactor-block", result, converter);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("ir-opt-refactor-block",
+        return JsonIO::ErrorEnvelope("ir-opt-refactor-block",
                                    "Failed to run IR optimization refactor: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunBehaviorDiffBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunBehaviorDiffBlock(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty() || opts.session_id.empty() || opts.block_id.empty() ||
             opts.branch_before.empty() || opts.branch_after.empty()) {
-            return JsonIO::ErrorResponse("behavior-diff-block",
+            return JsonIO::ErrorEnvelope("behavior-diff-block",
                                        "Required parameters: --workspace, --session-id, --block-id, --branch-before, --branch-after",
                                        "PARAMETER_ERROR");
         }
@@ -4032,7 +4060,7 @@ Upp::String CommandDispatcher::RunBehaviorDiffBlock(const CommandOptions& opts)
         // Get session metadata
         auto session_result = session_store_->LoadSession(opts.session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("behavior-diff-block",
+            return JsonIO::ErrorEnvelope("behavior-diff-block",
                                        session_result.error_message,
                                        JsonIO::ErrorCodeToString(session_result.error_code));
         }
@@ -4046,7 +4074,7 @@ Upp::String CommandDispatcher::RunBehaviorDiffBlock(const CommandOptions& opts)
             session, session_dir, opts.branch_before, opts.branch_after, opts.block_id);
 
         if (!diff_result.ok) {
-            return JsonIO::ErrorResponse("behavior-diff-block",
+            return JsonIO::ErrorEnvelope("behavior-diff-block",
                                        diff_result.error_message,
                                        JsonIO::ErrorCodeToString(diff_result.error_code));
         }
@@ -4058,19 +4086,19 @@ Upp::String CommandDispatcher::RunBehaviorDiffBlock(const CommandOptions& opts)
         response_data.Add("branch_after", Upp::String(opts.branch_after.c_str()));
         response_data.Add("behavior_diff", JsonIO::BehaviorDiffToValueMap(diff_result.data));
 
-        return JsonIO::SuccessResponse("behavior-diff-block", response_data);
+        return JsonIO::SuccessEnvelope("behavior-diff-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("behavior-diff-block",
+        return JsonIO::ErrorEnvelope("behavior-diff-block",
                                    "Failed to compute behavior diff: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunIrDiffBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunIrDiffBlock(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty() || opts.session_id.empty() || opts.block_id.empty() ||
             opts.branch_before.empty() || opts.branch_after.empty()) {
-            return JsonIO::ErrorResponse("ir-diff-block",
+            return JsonIO::ErrorEnvelope("ir-diff-block",
                                        "Required parameters: --workspace, --session-id, --block-id, --branch-before, --branch-after",
                                        "PARAMETER_ERROR");
         }
@@ -4078,7 +4106,7 @@ Upp::String CommandDispatcher::RunIrDiffBlock(const CommandOptions& opts) {
         // Get session metadata
         auto session_result = session_store_->LoadSession(opts.session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("ir-diff-block",
+            return JsonIO::ErrorEnvelope("ir-diff-block",
                                        session_result.error_message,
                                        JsonIO::ErrorCodeToString(session_result.error_code));
         }
@@ -4092,7 +4120,7 @@ Upp::String CommandDispatcher::RunIrDiffBlock(const CommandOptions& opts) {
             session, session_dir, opts.branch_before, opts.branch_after, opts.block_id);
 
         if (!diff_result.ok) {
-            return JsonIO::ErrorResponse("ir-diff-block",
+            return JsonIO::ErrorEnvelope("ir-diff-block",
                                        diff_result.error_message,
                                        JsonIO::ErrorCodeToString(diff_result.error_code));
         }
@@ -4104,19 +4132,19 @@ Upp::String CommandDispatcher::RunIrDiffBlock(const CommandOptions& opts) {
         response_data.Add("branch_after", Upp::String(opts.branch_after.c_str()));
         response_data.Add("ir_diff", JsonIO::IrDiffToValueMap(diff_result.data));
 
-        return JsonIO::SuccessResponse("ir-diff-block", response_data);
+        return JsonIO::SuccessEnvelope("ir-diff-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("ir-diff-block",
+        return JsonIO::ErrorEnvelope("ir-diff-block",
                                    "Failed to compute IR diff: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunIrDiffNodeRegion(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunIrDiffNodeRegion(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty() || opts.session_id.empty() || opts.node_id.empty() ||
             opts.branch_before.empty() || opts.branch_after.empty()) {
-            return JsonIO::ErrorResponse("ir-diff-node-region",
+            return JsonIO::ErrorEnvelope("ir-diff-node-region",
                                        "Required parameters: --workspace, --session-id, --node-id, --branch-before, --branch-after",
                                        "PARAMETER_ERROR");
         }
@@ -4124,7 +4152,7 @@ Upp::String CommandDispatcher::RunIrDiffNodeRegion(const CommandOptions& opts) {
         // Get session metadata
         auto session_result = session_store_->LoadSession(opts.session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("ir-diff-node-region",
+            return JsonIO::ErrorEnvelope("ir-diff-node-region",
                                        session_result.error_message,
                                        JsonIO::ErrorCodeToString(session_result.error_code));
         }
@@ -4138,7 +4166,7 @@ Upp::String CommandDispatcher::RunIrDiffNodeRegion(const CommandOptions& opts) {
             try {
                 max_depth = std::stoi(opts.max_depth);
             } catch (const std::exception&) {
-                return JsonIO::ErrorResponse("ir-diff-node-region",
+                return JsonIO::ErrorEnvelope("ir-diff-node-region",
                                            "Invalid max-depth value: " + opts.max_depth,
                                            "PARAMETER_ERROR");
             }
@@ -4151,7 +4179,7 @@ Upp::String CommandDispatcher::RunIrDiffNodeRegion(const CommandOptions& opts) {
             opts.node_id, opts.node_kind_hint, max_depth);
 
         if (!diff_result.ok) {
-            return JsonIO::ErrorResponse("ir-diff-node-region",
+            return JsonIO::ErrorEnvelope("ir-diff-node-region",
                                        diff_result.error_message,
                                        JsonIO::ErrorCodeToString(diff_result.error_code));
         }
@@ -4163,19 +4191,19 @@ Upp::String CommandDispatcher::RunIrDiffNodeRegion(const CommandOptions& opts) {
         response_data.Add("branch_after", Upp::String(opts.branch_after.c_str()));
         response_data.Add("ir_diff", JsonIO::IrDiffToValueMap(diff_result.data));
 
-        return JsonIO::SuccessResponse("ir-diff-node-region", response_data);
+        return JsonIO::SuccessEnvelope("ir-diff-node-region", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("ir-diff-node-region",
+        return JsonIO::ErrorEnvelope("ir-diff-node-region",
                                    "Failed to compute node region IR diff: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerCreateSession(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerCreateSession(const CommandOptions& opts) {
     try {
         // Extract required parameters
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("designer-create-session", "proto_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-create-session", "proto_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string branch = opts.branch.value_or("main");
@@ -4196,20 +4224,20 @@ Upp::String CommandDispatcher::RunDesignerCreateSession(const CommandOptions& op
 
         response_data.Add("designer_session", designer_session_map);
 
-        return JsonIO::SuccessResponse("designer-create-session", response_data);
+        return JsonIO::SuccessEnvelope("designer-create-session", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-create-session",
+        return JsonIO::ErrorEnvelope("designer-create-session",
                                    "Failed to create co-designer session: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerSetFocus(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerSetFocus(const CommandOptions& opts) {
     try {
         // Extract required parameters
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-set-focus", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-set-focus", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string block_id = opts.payload.Get("block_id", Upp::String("")).ToStd();
@@ -4232,19 +4260,19 @@ Upp::String CommandDispatcher::RunDesignerSetFocus(const CommandOptions& opts) {
 
         response_data.Add("designer_session", designer_session_map);
 
-        return JsonIO::SuccessResponse("designer-set-focus", response_data);
+        return JsonIO::SuccessEnvelope("designer-set-focus", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-set-focus",
+        return JsonIO::ErrorEnvelope("designer-set-focus",
                                    "Failed to set co-designer focus: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerGetContext(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerGetContext(const CommandOptions& opts) {
     try {
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-get-context", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-get-context", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         // This is a simulation of the command
@@ -4262,19 +4290,19 @@ Upp::String CommandDispatcher::RunDesignerGetContext(const CommandOptions& opts)
 
         response_data.Add("designer_session", designer_session_map);
 
-        return JsonIO::SuccessResponse("designer-get-context", response_data);
+        return JsonIO::SuccessEnvelope("designer-get-context", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-get-context",
+        return JsonIO::ErrorEnvelope("designer-get-context",
                                    "Failed to get co-designer context: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerAnalyze(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerAnalyze(const CommandOptions& opts) {
     try {
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-analyze", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-analyze", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         bool include_behavior = opts.payload.Get("include_behavior", true);
@@ -4325,19 +4353,19 @@ Upp::String CommandDispatcher::RunDesignerAnalyze(const CommandOptions& opts) {
             response_data.Add("block", block_map);
         }
 
-        return JsonIO::SuccessResponse("designer-analyze", response_data);
+        return JsonIO::SuccessEnvelope("designer-analyze", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-analyze",
+        return JsonIO::ErrorEnvelope("designer-analyze",
                                    "Failed to analyze: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerOptimize(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerOptimize(const CommandOptions& opts) {
     try {
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-optimize", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-optimize", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string target = opts.payload.Get("target", Upp::String("block")).ToStd();
@@ -4385,19 +4413,19 @@ Upp::String CommandDispatcher::RunDesignerOptimize(const CommandOptions& opts) {
         optimization_map.Add("summaries", summaries_array);
         response_data.Add("optimization", optimization_map);
 
-        return JsonIO::SuccessResponse("designer-optimize", response_data);
+        return JsonIO::SuccessEnvelope("designer-optimize", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-optimize",
+        return JsonIO::ErrorEnvelope("designer-optimize",
                                    "Failed to optimize: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerProposeRefactors(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerProposeRefactors(const CommandOptions& opts) {
     try {
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-propose-refactors", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-propose-refactors", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string target = opts.payload.Get("target", Upp::String("block")).ToStd();
@@ -4439,19 +4467,19 @@ Upp::String CommandDispatcher::RunDesignerProposeRefactors(const CommandOptions&
 
         response_data.Add("plans", plans_array);
 
-        return JsonIO::SuccessResponse("designer-propose-refactors", response_data);
+        return JsonIO::SuccessEnvelope("designer-propose-refactors", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-propose-refactors",
+        return JsonIO::ErrorEnvelope("designer-propose-refactors",
                                    "Failed to propose refactors: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerApplyRefactors(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerApplyRefactors(const CommandOptions& opts) {
     try {
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-apply-refactors", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-apply-refactors", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         Upp::ValueArray plans_array = opts.payload.Get("plans", Upp::ValueArray());
@@ -4481,19 +4509,19 @@ Upp::String CommandDispatcher::RunDesignerApplyRefactors(const CommandOptions& o
         response_data.Add("applied_plan_ids", applied_ids_array);
         response_data.Add("new_circuit_revision", 43);
 
-        return JsonIO::SuccessResponse("designer-apply-refactors", response_data);
+        return JsonIO::SuccessEnvelope("designer-apply-refactors", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-apply-refactors",
+        return JsonIO::ErrorEnvelope("designer-apply-refactors",
                                    "Failed to apply refactors: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerDiff(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerDiff(const CommandOptions& opts) {
     try {
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-diff", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-diff", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string compare_branch = opts.payload.Get("compare_branch", Upp::String("main")).ToStd();
@@ -4539,19 +4567,19 @@ Upp::String CommandDispatcher::RunDesignerDiff(const CommandOptions& opts) {
             response_data.Add("ir_diff", JsonIO::IrDiffToValueMap(ir_diff));
         }
 
-        return JsonIO::SuccessResponse("designer-diff", response_data);
+        return JsonIO::SuccessEnvelope("designer-diff", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-diff",
+        return JsonIO::ErrorEnvelope("designer-diff",
                                    "Failed to compute diff: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerCodegen(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerCodegen(const CommandOptions& opts) {
     try {
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-codegen", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-codegen", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string target = opts.payload.Get("target", Upp::String("block")).ToStd();
@@ -4599,19 +4627,19 @@ Upp::String CommandDispatcher::RunDesignerCodegen(const CommandOptions& opts) {
         codegen_map.Add("code", Upp::String(code.c_str()));
         response_data.Add("codegen", codegen_map);
 
-        return JsonIO::SuccessResponse("designer-codegen", response_data);
+        return JsonIO::SuccessEnvelope("designer-codegen", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-codegen",
+        return JsonIO::ErrorEnvelope("designer-codegen",
                                    "Failed to generate code: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerRunPlaybook(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerRunPlaybook(const CommandOptions& opts) {
     try {
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-run-playbook", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-run-playbook", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         // This is a simulation of the command - in a real implementation, this would
@@ -4797,25 +4825,25 @@ Upp::String CommandDispatcher::RunDesignerRunPlaybook(const CommandOptions& opts
 
         response_data.Add("playbook_result", playbook_result_map);
 
-        return JsonIO::SuccessResponse("designer-run-playbook", response_data);
+        return JsonIO::SuccessEnvelope("designer-run-playbook", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-run-playbook",
+        return JsonIO::ErrorEnvelope("designer-run-playbook",
                                    "Failed to run playbook: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunScheduleBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunScheduleBlock(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("schedule-block", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("schedule-block", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("schedule-block", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("schedule-block", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.block_id.has_value()) {
-        return JsonIO::ErrorResponse("schedule-block", "Block ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("schedule-block", "Block ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -4826,7 +4854,7 @@ Upp::String CommandDispatcher::RunScheduleBlock(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("schedule-block", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("schedule-block", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -4851,7 +4879,7 @@ Upp::String CommandDispatcher::RunScheduleBlock(const CommandOptions& opts) {
         } else if (strategy_str == "FixedStageCount") {
             config.strategy = SchedulingStrategy::FixedStageCount;
         } else {
-            return JsonIO::ErrorResponse("schedule-block",
+            return JsonIO::ErrorEnvelope("schedule-block",
                                        "Invalid strategy: " + strategy_str +
                                        ". Must be SingleStage, DepthBalancedStages, or FixedStageCount",
                                        "INVALID_ARGUMENT");
@@ -4872,7 +4900,7 @@ Upp::String CommandDispatcher::RunScheduleBlock(const CommandOptions& opts) {
 
         if (!scheduled_ir_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(scheduled_ir_result.error_code);
-            return JsonIO::ErrorResponse("schedule-block", scheduled_ir_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("schedule-block", scheduled_ir_result.error_message, error_code_str);
         }
 
         // Convert the scheduled IR module to JSON
@@ -4884,21 +4912,21 @@ Upp::String CommandDispatcher::RunScheduleBlock(const CommandOptions& opts) {
         // Use JsonIO to serialize the scheduled IR module
         response_data.Add("scheduled_ir", JsonIO::ScheduledModuleToValueMap(scheduled_ir_result.data));
 
-        return JsonIO::SuccessResponse("schedule-block", response_data);
+        return JsonIO::SuccessEnvelope("schedule-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("schedule-block",
+        return JsonIO::ErrorEnvelope("schedule-block",
                                    "Failed to build scheduled IR for block: " + std::string(e.what()),
                                    "SCHEDULE_BLOCK_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunScheduleNodeRegion(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunScheduleNodeRegion(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("schedule-node-region", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("schedule-node-region", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("schedule-node-region", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("schedule-node-region", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (opts.node_id.empty()) {
@@ -4909,7 +4937,7 @@ Upp::String CommandDispatcher::RunScheduleNodeRegion(const CommandOptions& opts)
     }
 
     if (opts.node_id.empty()) {
-        return JsonIO::ErrorResponse("schedule-node-region", "Node ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("schedule-node-region", "Node ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -4931,7 +4959,7 @@ Upp::String CommandDispatcher::RunScheduleNodeRegion(const CommandOptions& opts)
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("schedule-node-region", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("schedule-node-region", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -4956,7 +4984,7 @@ Upp::String CommandDispatcher::RunScheduleNodeRegion(const CommandOptions& opts)
         } else if (strategy_str == "FixedStageCount") {
             config.strategy = SchedulingStrategy::FixedStageCount;
         } else {
-            return JsonIO::ErrorResponse("schedule-node-region",
+            return JsonIO::ErrorEnvelope("schedule-node-region",
                                        "Invalid strategy: " + strategy_str +
                                        ". Must be SingleStage, DepthBalancedStages, or FixedStageCount",
                                        "INVALID_ARGUMENT");
@@ -4977,7 +5005,7 @@ Upp::String CommandDispatcher::RunScheduleNodeRegion(const CommandOptions& opts)
 
         if (!scheduled_ir_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(scheduled_ir_result.error_code);
-            return JsonIO::ErrorResponse("schedule-node-region", scheduled_ir_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("schedule-node-region", scheduled_ir_result.error_message, error_code_str);
         }
 
         // Convert the scheduled IR module to JSON
@@ -4989,25 +5017,25 @@ Upp::String CommandDispatcher::RunScheduleNodeRegion(const CommandOptions& opts)
         // Use JsonIO to serialize the scheduled IR module
         response_data.Add("scheduled_ir", JsonIO::ScheduledModuleToValueMap(scheduled_ir_result.data));
 
-        return JsonIO::SuccessResponse("schedule-node-region", response_data);
+        return JsonIO::SuccessEnvelope("schedule-node-region", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("schedule-node-region",
+        return JsonIO::ErrorEnvelope("schedule-node-region",
                                    "Failed to build scheduled IR for node region: " + std::string(e.what()),
                                    "SCHEDULE_NODE_REGION_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunPipelineBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunPipelineBlock(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("pipeline-block", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("pipeline-block", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("pipeline-block", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("pipeline-block", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.block_id.has_value()) {
-        return JsonIO::ErrorResponse("pipeline-block", "Block ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("pipeline-block", "Block ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -5018,7 +5046,7 @@ Upp::String CommandDispatcher::RunPipelineBlock(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("pipeline-block", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("pipeline-block", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -5033,7 +5061,7 @@ Upp::String CommandDispatcher::RunPipelineBlock(const CommandOptions& opts) {
 
         if (!pipeline_map_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(pipeline_map_result.error_code);
-            return JsonIO::ErrorResponse("pipeline-block", pipeline_map_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("pipeline-block", pipeline_map_result.error_message, error_code_str);
         }
 
         // Convert the pipeline map to JSON
@@ -5045,29 +5073,29 @@ Upp::String CommandDispatcher::RunPipelineBlock(const CommandOptions& opts) {
         // Use JsonIO to serialize the pipeline map
         response_data.Add("pipeline_map", JsonIO::PipelineMapToValueMap(pipeline_map_result.data));
 
-        return JsonIO::SuccessResponse("pipeline-block", response_data);
+        return JsonIO::SuccessEnvelope("pipeline-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("pipeline-block",
+        return JsonIO::ErrorEnvelope("pipeline-block",
                                    "Failed to build pipeline map for block: " + std::string(e.what()),
                                    "PIPELINE_BLOCK_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunPipelineSubsystem(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunPipelineSubsystem(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("pipeline-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("pipeline-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("pipeline-subsystem", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("pipeline-subsystem", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.subsystem_id.has_value()) {
-        return JsonIO::ErrorResponse("pipeline-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("pipeline-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.block_ids.has_value()) {
-        return JsonIO::ErrorResponse("pipeline-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("pipeline-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -5078,7 +5106,7 @@ Upp::String CommandDispatcher::RunPipelineSubsystem(const CommandOptions& opts)
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("pipeline-subsystem", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("pipeline-subsystem", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -5108,7 +5136,7 @@ Upp::String CommandDispatcher::RunPipelineSubsystem(const CommandOptions& opts)
 
         if (!pipeline_map_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(pipeline_map_result.error_code);
-            return JsonIO::ErrorResponse("pipeline-subsystem", pipeline_map_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("pipeline-subsystem", pipeline_map_result.error_message, error_code_str);
         }
 
         // Convert the pipeline map to JSON
@@ -5121,25 +5149,25 @@ Upp::String CommandDispatcher::RunPipelineSubsystem(const CommandOptions& opts)
         // Use JsonIO to serialize the pipeline map
         response_data.Add("pipeline_map", JsonIO::PipelineMapToValueMap(pipeline_map_result.data));
 
-        return JsonIO::SuccessResponse("pipeline-subsystem", response_data);
+        return JsonIO::SuccessEnvelope("pipeline-subsystem", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("pipeline-subsystem",
+        return JsonIO::ErrorEnvelope("pipeline-subsystem",
                                    "Failed to build pipeline map for subsystem: " + std::string(e.what()),
                                    "PIPELINE_SUBSYSTEM_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCdcBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCdcBlock(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("cdc-block", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("cdc-block", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("cdc-block", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("cdc-block", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.block_id.has_value()) {
-        return JsonIO::ErrorResponse("cdc-block", "Block ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("cdc-block", "Block ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -5150,7 +5178,7 @@ Upp::String CommandDispatcher::RunCdcBlock(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("cdc-block", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("cdc-block", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -5165,7 +5193,7 @@ Upp::String CommandDispatcher::RunCdcBlock(const CommandOptions& opts) {
 
         if (!cdc_report_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(cdc_report_result.error_code);
-            return JsonIO::ErrorResponse("cdc-block", cdc_report_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("cdc-block", cdc_report_result.error_message, error_code_str);
         }
 
         // Convert the CDC report to JSON
@@ -5177,29 +5205,29 @@ Upp::String CommandDispatcher::RunCdcBlock(const CommandOptions& opts) {
         // Use JsonIO to serialize the CDC report (after implementing JsonIO serialization)
         response_data.Add("cdc_report", JsonIO::CdcReportToValueMap(cdc_report_result.data));
 
-        return JsonIO::SuccessResponse("cdc-block", response_data);
+        return JsonIO::SuccessEnvelope("cdc-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("cdc-block",
+        return JsonIO::ErrorEnvelope("cdc-block",
                                    "Failed to build CDC report for block: " + std::string(e.what()),
                                    "CDC_BLOCK_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCdcSubsystem(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCdcSubsystem(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("cdc-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("cdc-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("cdc-subsystem", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("cdc-subsystem", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.subsystem_id.has_value()) {
-        return JsonIO::ErrorResponse("cdc-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("cdc-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.block_ids.has_value()) {
-        return JsonIO::ErrorResponse("cdc-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("cdc-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -5210,7 +5238,7 @@ Upp::String CommandDispatcher::RunCdcSubsystem(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("cdc-subsystem", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("cdc-subsystem", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -5240,7 +5268,7 @@ Upp::String CommandDispatcher::RunCdcSubsystem(const CommandOptions& opts) {
 
         if (!cdc_report_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(cdc_report_result.error_code);
-            return JsonIO::ErrorResponse("cdc-subsystem", cdc_report_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("cdc-subsystem", cdc_report_result.error_message, error_code_str);
         }
 
         // Convert the CDC report to JSON
@@ -5253,25 +5281,25 @@ Upp::String CommandDispatcher::RunCdcSubsystem(const CommandOptions& opts) {
         // Use JsonIO to serialize the CDC report (after implementing JsonIO serialization)
         response_data.Add("cdc_report", JsonIO::CdcReportToValueMap(cdc_report_result.data));
 
-        return JsonIO::SuccessResponse("cdc-subsystem", response_data);
+        return JsonIO::SuccessEnvelope("cdc-subsystem", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("cdc-subsystem",
+        return JsonIO::ErrorEnvelope("cdc-subsystem",
                                    "Failed to build CDC report for subsystem: " + std::string(e.what()),
                                    "CDC_SUBSYSTEM_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRetimeBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRetimeBlock(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("retime-block", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-block", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-block", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-block", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.block_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-block", "Block ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-block", "Block ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -5282,7 +5310,7 @@ Upp::String CommandDispatcher::RunRetimeBlock(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("retime-block", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-block", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -5309,7 +5337,7 @@ Upp::String CommandDispatcher::RunRetimeBlock(const CommandOptions& opts) {
 
         if (!retiming_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(retiming_result.error_code);
-            return JsonIO::ErrorResponse("retime-block", retiming_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-block", retiming_result.error_message, error_code_str);
         }
 
         // Filter results based on min_depth if specified
@@ -5340,29 +5368,29 @@ Upp::String CommandDispatcher::RunRetimeBlock(const CommandOptions& opts) {
         }
         response_data.Add("retiming_plans", plans_array);
 
-        return JsonIO::SuccessResponse("retime-block", response_data);
+        return JsonIO::SuccessEnvelope("retime-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("retime-block",
+        return JsonIO::ErrorEnvelope("retime-block",
                                    "Failed to analyze retiming for block: " + std::string(e.what()),
                                    "RETIME_BLOCK_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRetimeSubsystem(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRetimeSubsystem(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("retime-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-subsystem", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.subsystem_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.block_ids.has_value()) {
-        return JsonIO::ErrorResponse("retime-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -5373,7 +5401,7 @@ Upp::String CommandDispatcher::RunRetimeSubsystem(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("retime-subsystem", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-subsystem", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -5415,7 +5443,7 @@ Upp::String CommandDispatcher::RunRetimeSubsystem(const CommandOptions& opts) {
 
         if (!retiming_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(retiming_result.error_code);
-            return JsonIO::ErrorResponse("retime-subsystem", retiming_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-subsystem", retiming_result.error_message, error_code_str);
         }
 
         // Filter results based on min_depth if specified
@@ -5448,25 +5476,25 @@ Upp::String CommandDispatcher::RunRetimeSubsystem(const CommandOptions& opts) {
         }
         response_data.Add("retiming_plans", plans_array);
 
-        return JsonIO::SuccessResponse("retime-subsystem", response_data);
+        return JsonIO::SuccessEnvelope("retime-subsystem", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("retime-subsystem",
+        return JsonIO::ErrorEnvelope("retime-subsystem",
                                    "Failed to analyze retiming for subsystem: " + std::string(e.what()),
                                    "RETIME_SUBSYSTEM_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRetimeBlockApply(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRetimeBlockApply(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("retime-block-apply", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-block-apply", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-block-apply", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-block-apply", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.plan_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-block-apply", "Plan ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-block-apply", "Plan ID is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -5477,7 +5505,7 @@ Upp::String CommandDispatcher::RunRetimeBlockApply(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("retime-block-apply", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-block-apply", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -5492,7 +5520,7 @@ Upp::String CommandDispatcher::RunRetimeBlockApply(const CommandOptions& opts) {
 
         if (!plans_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(plans_result.error_code);
-            return JsonIO::ErrorResponse("retime-block-apply", plans_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-block-apply", plans_result.error_message, error_code_str);
         }
 
         // Find the specific plan by ID
@@ -5505,7 +5533,7 @@ Upp::String CommandDispatcher::RunRetimeBlockApply(const CommandOptions& opts) {
         }
 
         if (!target_plan) {
-            return JsonIO::ErrorResponse("retime-block-apply",
+            return JsonIO::ErrorEnvelope("retime-block-apply",
                                        "Retiming plan not found: " + opts.plan_id.value(),
                                        "RETIME_PLAN_NOT_FOUND");
         }
@@ -5522,7 +5550,7 @@ Upp::String CommandDispatcher::RunRetimeBlockApply(const CommandOptions& opts) {
 
         if (!application_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(application_result.error_code);
-            return JsonIO::ErrorResponse("retime-block-apply", application_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-block-apply", application_result.error_message, error_code_str);
         }
 
         // Convert the application result to JSON
@@ -5538,33 +5566,33 @@ Upp::String CommandDispatcher::RunRetimeBlockApply(const CommandOptions& opts) {
         auto app_result_data = JsonIO::RetimingApplicationResultToValueMap(application_result.data);
         response_data.Add("application_result", app_result_data);
 
-        return JsonIO::SuccessResponse("retime-block-apply", response_data);
+        return JsonIO::SuccessEnvelope("retime-block-apply", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("retime-block-apply",
+        return JsonIO::ErrorEnvelope("retime-block-apply",
                                    "Failed to apply retiming for block: " + std::string(e.what()),
                                    "RETIME_BLOCK_APPLY_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRetimeSubsystemApply(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRetimeSubsystemApply(const CommandOptions& opts) {
     if (opts.workspace.empty()) {
-        return JsonIO::ErrorResponse("retime-subsystem-apply", "Workspace path is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem-apply", "Workspace path is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.session_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-subsystem-apply", "Session ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem-apply", "Session ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.plan_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-subsystem-apply", "Plan ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem-apply", "Plan ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.subsystem_id.has_value()) {
-        return JsonIO::ErrorResponse("retime-subsystem-apply", "Subsystem ID is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem-apply", "Subsystem ID is required", "INVALID_ARGUMENT");
     }
 
     if (!opts.block_ids.has_value()) {
-        return JsonIO::ErrorResponse("retime-subsystem-apply", "Block IDs list is required", "INVALID_ARGUMENT");
+        return JsonIO::ErrorEnvelope("retime-subsystem-apply", "Block IDs list is required", "INVALID_ARGUMENT");
     }
 
     try {
@@ -5575,7 +5603,7 @@ Upp::String CommandDispatcher::RunRetimeSubsystemApply(const CommandOptions& opt
         auto load_result = session_store_->LoadSession(opts.session_id.value());
         if (!load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("retime-subsystem-apply", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-subsystem-apply", load_result.error_message, error_code_str);
         }
 
         SessionMetadata metadata = load_result.data;
@@ -5605,7 +5633,7 @@ Upp::String CommandDispatcher::RunRetimeSubsystemApply(const CommandOptions& opt
 
         if (!plans_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(plans_result.error_code);
-            return JsonIO::ErrorResponse("retime-subsystem-apply", plans_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-subsystem-apply", plans_result.error_message, error_code_str);
         }
 
         // Find the specific plan by ID
@@ -5618,7 +5646,7 @@ Upp::String CommandDispatcher::RunRetimeSubsystemApply(const CommandOptions& opt
         }
 
         if (!target_plan) {
-            return JsonIO::ErrorResponse("retime-subsystem-apply",
+            return JsonIO::ErrorEnvelope("retime-subsystem-apply",
                                        "Retiming plan not found: " + opts.plan_id.value(),
                                        "RETIME_PLAN_NOT_FOUND");
         }
@@ -5635,7 +5663,7 @@ Upp::String CommandDispatcher::RunRetimeSubsystemApply(const CommandOptions& opt
 
         if (!application_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(application_result.error_code);
-            return JsonIO::ErrorResponse("retime-subsystem-apply", application_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-subsystem-apply", application_result.error_message, error_code_str);
         }
 
         // Convert the application result to JSON
@@ -5653,27 +5681,27 @@ Upp::String CommandDispatcher::RunRetimeSubsystemApply(const CommandOptions& opt
         auto app_result_data = JsonIO::RetimingApplicationResultToValueMap(application_result.data);
         response_data.Add("application_result", app_result_data);
 
-        return JsonIO::SuccessResponse("retime-subsystem-apply", response_data);
+        return JsonIO::SuccessEnvelope("retime-subsystem-apply", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("retime-subsystem-apply",
+        return JsonIO::ErrorEnvelope("retime-subsystem-apply",
                                    "Failed to apply retiming for subsystem: " + std::string(e.what()),
                                    "RETIME_SUBSYSTEM_APPLY_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRetimeOptBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRetimeOptBlock(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-block", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-block", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-block", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-block", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-id").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-block", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-block", "Block ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("objective").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-block", "Objective is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-block", "Objective is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -5690,7 +5718,7 @@ Upp::String CommandDispatcher::RunRetimeOptBlock(const CommandOptions& opts) {
         auto load_result = session_store_->LoadSessionMetadata(session_id);
         if (!load_result.ok) {
             std::string error_code_str = ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("retime-opt-block", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-opt-block", load_result.error_message, error_code_str);
         }
 
         SessionMetadata session = load_result.data;
@@ -5706,7 +5734,7 @@ Upp::String CommandDispatcher::RunRetimeOptBlock(const CommandOptions& opts) {
         } else if (objective_str == "BalanceStages") {
             objective_kind = RetimingObjectiveKind::BalanceStages;
         } else {
-            return JsonIO::ErrorResponse("retime-opt-block", "Invalid objective: " + objective_str, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-block", "Invalid objective: " + objective_str, "INVALID_ARGUMENT");
         }
 
         // Parse objective constraints
@@ -5743,7 +5771,7 @@ Upp::String CommandDispatcher::RunRetimeOptBlock(const CommandOptions& opts) {
 
         if (!result.ok) {
             std::string error_code_str = ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("retime-opt-block", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-opt-block", result.error_message, error_code_str);
         }
 
         // Build response
@@ -5753,30 +5781,30 @@ Upp::String CommandDispatcher::RunRetimeOptBlock(const CommandOptions& opts) {
         response_data.Add("block_id", Upp::String(block_id.c_str()));
         response_data.Add("optimization_result", JsonIO::ToValueMap(result.data));
 
-        return JsonIO::SuccessResponse("retime-opt-block", response_data);
+        return JsonIO::SuccessEnvelope("retime-opt-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("retime-opt-block",
+        return JsonIO::ErrorEnvelope("retime-opt-block",
                                    "Failed to optimize retiming for block: " + std::string(e.what()),
                                    "RETIME_OPT_BLOCK_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunRetimeOptSubsystem(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunRetimeOptSubsystem(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-subsystem", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-subsystem", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("subsystem-id").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-ids").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("objective").empty()) {
-            return JsonIO::ErrorResponse("retime-opt-subsystem", "Objective is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-subsystem", "Objective is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -5794,7 +5822,7 @@ Upp::String CommandDispatcher::RunRetimeOptSubsystem(const CommandOptions& opts)
         auto load_result = session_store_->LoadSessionMetadata(session_id);
         if (!load_result.ok) {
             std::string error_code_str = ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("retime-opt-subsystem", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-opt-subsystem", load_result.error_message, error_code_str);
         }
 
         SessionMetadata session = load_result.data;
@@ -5810,7 +5838,7 @@ Upp::String CommandDispatcher::RunRetimeOptSubsystem(const CommandOptions& opts)
         } else if (objective_str == "BalanceStages") {
             objective_kind = RetimingObjectiveKind::BalanceStages;
         } else {
-            return JsonIO::ErrorResponse("retime-opt-subsystem", "Invalid objective: " + objective_str, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("retime-opt-subsystem", "Invalid objective: " + objective_str, "INVALID_ARGUMENT");
         }
 
         // Parse objective constraints
@@ -5849,7 +5877,7 @@ Upp::String CommandDispatcher::RunRetimeOptSubsystem(const CommandOptions& opts)
 
         if (!result.ok) {
             std::string error_code_str = ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("retime-opt-subsystem", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("retime-opt-subsystem", result.error_message, error_code_str);
         }
 
         // Build response
@@ -5860,27 +5888,27 @@ Upp::String CommandDispatcher::RunRetimeOptSubsystem(const CommandOptions& opts)
         response_data.Add("block_ids", JsonIO::ToValueArray(Vector<String>(block_ids.begin(), block_ids.end())));
         response_data.Add("optimization_result", JsonIO::ToValueMap(result.data));
 
-        return JsonIO::SuccessResponse("retime-opt-subsystem", response_data);
+        return JsonIO::SuccessEnvelope("retime-opt-subsystem", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("retime-opt-subsystem",
+        return JsonIO::ErrorEnvelope("retime-opt-subsystem",
                                    "Failed to optimize retiming for subsystem: " + std::string(e.what()),
                                    "RETIME_OPT_SUBSYSTEM_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunGlobalPipelineSubsystem(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunGlobalPipelineSubsystem(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-subsystem", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-subsystem", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("subsystem-id").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-ids").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -5898,7 +5926,7 @@ Upp::String CommandDispatcher::RunGlobalPipelineSubsystem(const CommandOptions&
         auto load_result = session_store_->LoadSessionMetadata(session_id);
         if (!load_result.ok) {
             std::string error_code_str = ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("global-pipeline-subsystem", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("global-pipeline-subsystem", load_result.error_message, error_code_str);
         }
 
         SessionMetadata session = load_result.data;
@@ -5913,7 +5941,7 @@ Upp::String CommandDispatcher::RunGlobalPipelineSubsystem(const CommandOptions&
 
         if (!result.ok()) {
             std::string error_code_str = ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("global-pipeline-subsystem", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("global-pipeline-subsystem", result.error_message, error_code_str);
         }
 
         // Build response
@@ -5924,30 +5952,30 @@ Upp::String CommandDispatcher::RunGlobalPipelineSubsystem(const CommandOptions&
         response_data.Add("block_ids", JsonIO::ToValueArray(Vector<String>(block_ids.begin(), block_ids.end())));
         response_data.Add("global_pipeline", JsonIO::GlobalPipelineMapToValueMap(result.value()));
 
-        return JsonIO::SuccessResponse("global-pipeline-subsystem", response_data);
+        return JsonIO::SuccessEnvelope("global-pipeline-subsystem", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("global-pipeline-subsystem",
+        return JsonIO::ErrorEnvelope("global-pipeline-subsystem",
                                    "Failed to build global pipeline map for subsystem: " + std::string(e.what()),
                                    "GLOBAL_PIPELINE_SUBSYSTEM_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunGlobalPipelineOptSubsystem(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunGlobalPipelineOptSubsystem(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-opt-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-opt-subsystem", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("subsystem-id").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-opt-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem", "Subsystem ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-ids").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-opt-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem", "Block IDs list is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("strategy").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-opt-subsystem", "Strategy is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem", "Strategy is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -5965,7 +5993,7 @@ Upp::String CommandDispatcher::RunGlobalPipelineOptSubsystem(const CommandOption
         auto load_result = session_store_->LoadSessionMetadata(session_id);
         if (!load_result.ok) {
             std::string error_code_str = ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("global-pipeline-opt-subsystem", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem", load_result.error_message, error_code_str);
         }
 
         SessionMetadata session = load_result.data;
@@ -5979,7 +6007,7 @@ Upp::String CommandDispatcher::RunGlobalPipelineOptSubsystem(const CommandOption
         } else if (strategy_str == "ReduceCriticalPath") {
             strategy_kind = GlobalPipeliningStrategyKind::ReduceCriticalPath;
         } else {
-            return JsonIO::ErrorResponse("global-pipeline-opt-subsystem", "Invalid strategy: " + strategy_str, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem", "Invalid strategy: " + strategy_str, "INVALID_ARGUMENT");
         }
 
         // Parse objective constraints
@@ -6009,7 +6037,7 @@ Upp::String CommandDispatcher::RunGlobalPipelineOptSubsystem(const CommandOption
 
         if (!result.ok()) {
             std::string error_code_str = ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("global-pipeline-opt-subsystem", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem", result.error_message, error_code_str);
         }
 
         // Build response
@@ -6020,24 +6048,24 @@ Upp::String CommandDispatcher::RunGlobalPipelineOptSubsystem(const CommandOption
         response_data.Add("block_ids", JsonIO::ToValueArray(Vector<String>(block_ids.begin(), block_ids.end())));
         response_data.Add("global_plans", JsonIO::ToValueArray(result.value()));
 
-        return JsonIO::SuccessResponse("global-pipeline-opt-subsystem", response_data);
+        return JsonIO::SuccessEnvelope("global-pipeline-opt-subsystem", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("global-pipeline-opt-subsystem",
+        return JsonIO::ErrorEnvelope("global-pipeline-opt-subsystem",
                                    "Failed to propose global pipelining plans for subsystem: " + std::string(e.what()),
                                    "GLOBAL_PIPELINE_OPT_SUBSYSTEM_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunGlobalPipelineApply(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunGlobalPipelineApply(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-apply", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-apply", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-apply", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-apply", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("plan-id").empty()) {
-            return JsonIO::ErrorResponse("global-pipeline-apply", "Plan ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("global-pipeline-apply", "Plan ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6054,7 +6082,7 @@ Upp::String CommandDispatcher::RunGlobalPipelineApply(const CommandOptions& opts
         auto load_result = session_store_->LoadSessionMetadata(session_id);
         if (!load_result.ok) {
             std::string error_code_str = ErrorCodeToString(load_result.error_code);
-            return JsonIO::ErrorResponse("global-pipeline-apply", load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("global-pipeline-apply", load_result.error_message, error_code_str);
         }
 
         SessionMetadata session = load_result.data;
@@ -6081,7 +6109,7 @@ Upp::String CommandDispatcher::RunGlobalPipelineApply(const CommandOptions& opts
 
         if (!result.ok()) {
             std::string error_code_str = ErrorCodeToString(result.error_code);
-            return JsonIO::ErrorResponse("global-pipeline-apply", result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("global-pipeline-apply", result.error_message, error_code_str);
         }
 
         // Build response
@@ -6090,24 +6118,24 @@ Upp::String CommandDispatcher::RunGlobalPipelineApply(const CommandOptions& opts
         response_data.Add("branch", Upp::String(branch_name.c_str()));
         response_data.Add("applied_plan", JsonIO::ToValueMap(result.value()));
 
-        return JsonIO::SuccessResponse("global-pipeline-apply", response_data);
+        return JsonIO::SuccessEnvelope("global-pipeline-apply", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("global-pipeline-apply",
+        return JsonIO::ErrorEnvelope("global-pipeline-apply",
                                    "Failed to apply global pipelining plan: " + std::string(e.what()),
                                    "GLOBAL_PIPELINE_APPLY_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunStructAnalyzeBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunStructAnalyzeBlock(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("struct-analyze-block", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-analyze-block", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("struct-analyze-block", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-analyze-block", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-id").empty()) {
-            return JsonIO::ErrorResponse("struct-analyze-block", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-analyze-block", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6122,14 +6150,14 @@ Upp::String CommandDispatcher::RunStructAnalyzeBlock(const CommandOptions& opts)
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("struct-analyze-block", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("struct-analyze-block", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("struct-analyze-block", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-analyze-block", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Create CircuitFacade and analyze the block structure
@@ -6143,7 +6171,7 @@ Upp::String CommandDispatcher::RunStructAnalyzeBlock(const CommandOptions& opts)
 
         if (!analysis_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(analysis_result.error_code);
-            return JsonIO::ErrorResponse("struct-analyze-block", analysis_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("struct-analyze-block", analysis_result.error_message, error_code_str);
         }
 
         // Build response
@@ -6153,27 +6181,27 @@ Upp::String CommandDispatcher::RunStructAnalyzeBlock(const CommandOptions& opts)
         response_data.Add("block_id", Upp::String(block_id.c_str()));
         response_data.Add("structural_refactor_plan", JsonIO::ToValueMap(analysis_result.data));
 
-        return JsonIO::SuccessResponse("struct-analyze-block", response_data);
+        return JsonIO::SuccessEnvelope("struct-analyze-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("struct-analyze-block",
+        return JsonIO::ErrorEnvelope("struct-analyze-block",
                                    "Failed to analyze block structure: " + std::string(e.what()),
                                    "STRUCT_ANALYZE_BLOCK_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunStructApplyBlock(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunStructApplyBlock(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("struct-apply-block", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-apply-block", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("struct-apply-block", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-apply-block", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("plan-id").empty()) {
-            return JsonIO::ErrorResponse("struct-apply-block", "Plan ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-apply-block", "Plan ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-id").empty()) {
-            return JsonIO::ErrorResponse("struct-apply-block", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-apply-block", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6192,14 +6220,14 @@ Upp::String CommandDispatcher::RunStructApplyBlock(const CommandOptions& opts) {
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("struct-apply-block", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("struct-apply-block", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("struct-apply-block", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-apply-block", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // For now, we'll need to retrieve the plan somehow - in a real implementation
@@ -6218,7 +6246,7 @@ Upp::String CommandDispatcher::RunStructApplyBlock(const CommandOptions& opts) {
 
         if (!analysis_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(analysis_result.error_code);
-            return JsonIO::ErrorResponse("struct-apply-block", analysis_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("struct-apply-block", analysis_result.error_message, error_code_str);
         }
 
         // Find the plan with the matching ID
@@ -6233,7 +6261,7 @@ Upp::String CommandDispatcher::RunStructApplyBlock(const CommandOptions& opts) {
         }
 
         if (!found) {
-            return JsonIO::ErrorResponse("struct-apply-block", "Plan not found: " + plan_id, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("struct-apply-block", "Plan not found: " + plan_id, "INVALID_ARGUMENT");
         }
 
         // Apply the structural refactor plan
@@ -6247,7 +6275,7 @@ Upp::String CommandDispatcher::RunStructApplyBlock(const CommandOptions& opts) {
 
         if (!apply_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(apply_result.error_code);
-            return JsonIO::ErrorResponse("struct-apply-block", apply_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("struct-apply-block", apply_result.error_message, error_code_str);
         }
 
         // Build response
@@ -6257,24 +6285,24 @@ Upp::String CommandDispatcher::RunStructApplyBlock(const CommandOptions& opts) {
         response_data.Add("block_id", Upp::String(block_id.c_str()));
         response_data.Add("application_result", JsonIO::ToValueMap(apply_result.data));
 
-        return JsonIO::SuccessResponse("struct-apply-block", response_data);
+        return JsonIO::SuccessEnvelope("struct-apply-block", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("struct-apply-block",
+        return JsonIO::ErrorEnvelope("struct-apply-block",
                                    "Failed to apply structural refactor: " + std::string(e.what()),
                                    "STRUCT_APPLY_BLOCK_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCodegenBlockIr(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCodegenBlockIr(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-ir", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-ir", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-ir", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-ir", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-id").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-ir", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-ir", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6289,14 +6317,14 @@ Upp::String CommandDispatcher::RunCodegenBlockIr(const CommandOptions& opts) {
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-ir", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-ir", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("codegen-block-ir", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-ir", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Build the codegen module for the block
@@ -6310,7 +6338,7 @@ Upp::String CommandDispatcher::RunCodegenBlockIr(const CommandOptions& opts) {
 
         if (!codegen_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(codegen_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-ir", codegen_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-ir", codegen_result.error_message, error_code_str);
         }
 
         // Build response with the codegen module
@@ -6320,24 +6348,24 @@ Upp::String CommandDispatcher::RunCodegenBlockIr(const CommandOptions& opts) {
         response_data.Add("block_id", Upp::String(block_id.c_str()));
         response_data.Add("codegen_module", JsonIO::CodegenModuleToValueMap(codegen_result.data));
 
-        return JsonIO::SuccessResponse("codegen-block-ir", response_data);
+        return JsonIO::SuccessEnvelope("codegen-block-ir", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("codegen-block-ir",
+        return JsonIO::ErrorEnvelope("codegen-block-ir",
                                    "Failed to build codegen IR for block: " + std::string(e.what()),
                                    "CODEGEN_BLOCK_IR_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCodegenBlockC(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCodegenBlockC(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-c", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-c", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-c", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-c", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-id").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-c", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-c", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6361,14 +6389,14 @@ Upp::String CommandDispatcher::RunCodegenBlockC(const CommandOptions& opts) {
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-c", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-c", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("codegen-block-c", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-c", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Generate C/C++ code for the block
@@ -6386,7 +6414,7 @@ Upp::String CommandDispatcher::RunCodegenBlockC(const CommandOptions& opts) {
 
         if (!code_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(code_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-c", code_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-c", code_result.error_message, error_code_str);
         }
 
         // Build response
@@ -6397,24 +6425,24 @@ Upp::String CommandDispatcher::RunCodegenBlockC(const CommandOptions& opts) {
         response_data.Add("language", Upp::String(lang_str.c_str()));
         response_data.Add("code", Upp::String(code_result.data.c_str()));
 
-        return JsonIO::SuccessResponse("codegen-block-c", response_data);
+        return JsonIO::SuccessEnvelope("codegen-block-c", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("codegen-block-c",
+        return JsonIO::ErrorEnvelope("codegen-block-c",
                                    "Failed to generate C/C++ code for block: " + std::string(e.what()),
                                    "CODEGEN_BLOCK_C_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCodegenBlockOscDemo(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCodegenBlockOscDemo(const CommandOptions& opts) {
     try {
         if (opts.Get("workspace").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-osc-demo", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-osc-demo", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("session-id").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-osc-demo", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-osc-demo", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.Get("block-id").empty()) {
-            return JsonIO::ErrorResponse("codegen-block-osc-demo", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-osc-demo", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6438,14 +6466,14 @@ Upp::String CommandDispatcher::RunCodegenBlockOscDemo(const CommandOptions& opts
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-osc-demo", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-osc-demo", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("codegen-block-osc-demo", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-osc-demo", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Generate oscillator demo code for the block
@@ -6460,7 +6488,7 @@ Upp::String CommandDispatcher::RunCodegenBlockOscDemo(const CommandOptions& opts
 
         if (!code_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(code_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-osc-demo", code_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-osc-demo", code_result.error_message, error_code_str);
         }
 
         // Build response
@@ -6471,25 +6499,25 @@ Upp::String CommandDispatcher::RunCodegenBlockOscDemo(const CommandOptions& opts
         response_data.Add("language", Upp::String(lang_str.c_str()));
         response_data.Add("code", Upp::String(code_result.data.c_str()));
 
-        return JsonIO::SuccessResponse("codegen-block-osc-demo", response_data);
+        return JsonIO::SuccessEnvelope("codegen-block-osc-demo", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("codegen-block-osc-demo",
+        return JsonIO::ErrorEnvelope("codegen-block-osc-demo",
                                    "Failed to generate oscillator demo code for block: " + std::string(e.what()),
                                    "CODEGEN_BLOCK_OSC_DEMO_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerRetime(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerRetime(const CommandOptions& opts) {
     try {
         // Extract payload values
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-retime", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-retime", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string target = opts.payload.Get("target", Upp::String("block")).ToStd();
         if (target != "block" && target != "subsystem") {
-            return JsonIO::ErrorResponse("designer-retime", "target must be either 'block' or 'subsystem'", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-retime", "target must be either 'block' or 'subsystem'", "INVALID_PARAMETER");
         }
 
         // Create CoDesignerManager instance
@@ -6504,12 +6532,12 @@ Upp::String CommandDispatcher::RunDesignerRetime(const CommandOptions& opts) {
         if (target == "block") {
             request.block_id = opts.payload.Get("block_id", Upp::String("")).ToStd();
             if (request.block_id.empty()) {
-                return JsonIO::ErrorResponse("designer-retime", "block_id is required when target is 'block'", "INVALID_PARAMETER");
+                return JsonIO::ErrorEnvelope("designer-retime", "block_id is required when target is 'block'", "INVALID_PARAMETER");
             }
         } else if (target == "subsystem") {
             request.subsystem_id = opts.payload.Get("subsystem_id", Upp::String("")).ToStd();
             if (request.subsystem_id.empty()) {
-                return JsonIO::ErrorResponse("designer-retime", "subsystem_id is required when target is 'subsystem'", "INVALID_PARAMETER");
+                return JsonIO::ErrorEnvelope("designer-retime", "subsystem_id is required when target is 'subsystem'", "INVALID_PARAMETER");
             }
 
             // Get block_ids array from payload
@@ -6522,7 +6550,7 @@ Upp::String CommandDispatcher::RunDesignerRetime(const CommandOptions& opts) {
                     }
                 }
             } else {
-                return JsonIO::ErrorResponse("designer-retime", "block_ids must be an array of strings when target is 'subsystem'", "INVALID_PARAMETER");
+                return JsonIO::ErrorEnvelope("designer-retime", "block_ids must be an array of strings when target is 'subsystem'", "INVALID_PARAMETER");
             }
         }
 
@@ -6534,7 +6562,7 @@ Upp::String CommandDispatcher::RunDesignerRetime(const CommandOptions& opts) {
         auto retiming_result = designer_manager.RetimeDesign(request);
         if (!retiming_result.ok()) {
             std::string error_code_str = JsonIO::ErrorCodeToString(retiming_result.error_code());
-            return JsonIO::ErrorResponse("designer-retime", retiming_result.error_message(), error_code_str);
+            return JsonIO::ErrorEnvelope("designer-retime", retiming_result.error_message(), error_code_str);
         }
 
         // Build response data
@@ -6556,30 +6584,30 @@ Upp::String CommandDispatcher::RunDesignerRetime(const CommandOptions& opts) {
         }
         response_data.Add("retiming_plans", plans_array);
 
-        return JsonIO::SuccessResponse("designer-retime", response_data);
+        return JsonIO::SuccessEnvelope("designer-retime", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-retime",
+        return JsonIO::ErrorEnvelope("designer-retime",
                                    "Failed to run designer retime: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerRetimeApply(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerRetimeApply(const CommandOptions& opts) {
     try {
         // Extract payload values
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-retime-apply", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-retime-apply", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string target = opts.payload.Get("target", Upp::String("block")).ToStd();
         if (target != "block" && target != "subsystem") {
-            return JsonIO::ErrorResponse("designer-retime-apply", "target must be either 'block' or 'subsystem'", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-retime-apply", "target must be either 'block' or 'subsystem'", "INVALID_PARAMETER");
         }
 
         std::string plan_id = opts.payload.Get("plan_id", Upp::String("")).ToStd();
         if (plan_id.empty()) {
-            return JsonIO::ErrorResponse("designer-retime-apply", "plan_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-retime-apply", "plan_id is required", "INVALID_PARAMETER");
         }
 
         // Create CircuitFacade to access retiming application functionality
@@ -6599,7 +6627,7 @@ Upp::String CommandDispatcher::RunDesignerRetimeApply(const CommandOptions& opts
         auto application_result = designer_manager.ApplyRetimeDesign(request);
         if (!application_result.ok()) {
             std::string error_code_str = JsonIO::ErrorCodeToString(application_result.error_code());
-            return JsonIO::ErrorResponse("designer-retime-apply", application_result.error_message(), error_code_str);
+            return JsonIO::ErrorEnvelope("designer-retime-apply", application_result.error_message(), error_code_str);
         }
 
         // Build response data
@@ -6618,25 +6646,25 @@ Upp::String CommandDispatcher::RunDesignerRetimeApply(const CommandOptions& opts
         Upp::ValueMap app_result_data = JsonIO::RetimingApplicationResultToValueMap(application_result.data().application_result);
         response_data.Add("application_result", app_result_data);
 
-        return JsonIO::SuccessResponse("designer-retime-apply", response_data);
+        return JsonIO::SuccessEnvelope("designer-retime-apply", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-retime-apply",
+        return JsonIO::ErrorEnvelope("designer-retime-apply",
                                    "Failed to run designer retime apply: " + std::string(e.what()),
                                    "INTERNAL_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerRetimeOpt(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerRetimeOpt(const CommandOptions& opts) {
     try {
         // Extract payload values
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-retime-opt", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-retime-opt", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string target = opts.payload.Get("target", Upp::String("block")).ToStd();
         if (target != "block" && target != "subsystem") {
-            return JsonIO::ErrorResponse("designer-retime-opt", "target must be either 'block' or 'subsystem'", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-retime-opt", "target must be either 'block' or 'subsystem'", "INVALID_PARAMETER");
         }
 
         // Create the request object
@@ -6648,13 +6676,13 @@ Upp::String CommandDispatcher::RunDesignerRetimeOpt(const CommandOptions& opts)
         if (target == "block") {
             std::string block_id = opts.payload.Get("block_id", Upp::String("")).ToStd();
             if (block_id.empty()) {
-                return JsonIO::ErrorResponse("designer-retime-opt", "block_id is required when target is 'block'", "INVALID_PARAMETER");
+                return JsonIO::ErrorEnvelope("designer-retime-opt", "block_id is required when target is 'block'", "INVALID_PARAMETER");
             }
             request.block_id = block_id;
         } else if (target == "subsystem") {
             std::string subsystem_id = opts.payload.Get("subsystem_id", Upp::String("")).ToStd();
             if (subsystem_id.empty()) {
-                return JsonIO::ErrorResponse("designer-retime-opt", "subsystem_id is required when target is 'subsystem'", "INVALID_PARAMETER");
+                return JsonIO::ErrorEnvelope("designer-retime-opt", "subsystem_id is required when target is 'subsystem'", "INVALID_PARAMETER");
             }
             request.subsystem_id = subsystem_id;
 
@@ -6668,7 +6696,7 @@ Upp::String CommandDispatcher::RunDesignerRetimeOpt(const CommandOptions& opts)
                     }
                 }
             } else {
-                return JsonIO::ErrorResponse("designer-retime-opt", "block_ids must be an array of strings when target is 'subsystem'", "INVALID_PARAMETER");
+                return JsonIO::ErrorEnvelope("designer-retime-opt", "block_ids must be an array of strings when target is 'subsystem'", "INVALID_PARAMETER");
             }
         }
 
@@ -6681,7 +6709,7 @@ Upp::String CommandDispatcher::RunDesignerRetimeOpt(const CommandOptions& opts)
         } else if (objective_str == "BalanceStages") {
             request.objective.kind = RetimingObjectiveKind::BalanceStages;
         } else {
-            return JsonIO::ErrorResponse("designer-retime-opt", "Invalid objective: " + objective_str, "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-retime-opt", "Invalid objective: " + objective_str, "INVALID_PARAMETER");
         }
 
         // Extract objective constraints if provided
@@ -6708,7 +6736,7 @@ Upp::String CommandDispatcher::RunDesignerRetimeOpt(const CommandOptions& opts)
 
         if (!result.ok()) {
             std::string error_code_str = ErrorCodeToString(result.error_code());
-            return JsonIO::ErrorResponse("designer-retime-opt", result.error_message(), error_code_str);
+            return JsonIO::ErrorEnvelope("designer-retime-opt", result.error_message(), error_code_str);
         }
 
         // Build response data
@@ -6722,24 +6750,24 @@ Upp::String CommandDispatcher::RunDesignerRetimeOpt(const CommandOptions& opts)
         // Add optimization result
         response_data.Add("optimization_result", JsonIO::ToValueMap(result.value()));
 
-        return JsonIO::SuccessResponse("designer-retime-opt", response_data);
+        return JsonIO::SuccessEnvelope("designer-retime-opt", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-retime-opt",
+        return JsonIO::ErrorEnvelope("designer-retime-opt",
                                    "Failed to run designer retiming optimization: " + std::string(e.what()),
                                    "DESIGNER_RETIME_OPT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCodegenBlockCppClass(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCodegenBlockCppClass(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("codegen-block-cpp-class", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-cpp-class", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("codegen-block-cpp-class", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-cpp-class", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("codegen-block-cpp-class", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-cpp-class", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6760,14 +6788,14 @@ Upp::String CommandDispatcher::RunCodegenBlockCppClass(const CommandOptions& opt
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-cpp-class", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-cpp-class", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("codegen-block-cpp-class", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-cpp-class", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Prepare the CppClassOptions
@@ -6789,7 +6817,7 @@ Upp::String CommandDispatcher::RunCodegenBlockCppClass(const CommandOptions& opt
 
         if (!code_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(code_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-cpp-class", code_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-cpp-class", code_result.error_message, error_code_str);
         }
 
         // Build response
@@ -6800,24 +6828,24 @@ Upp::String CommandDispatcher::RunCodegenBlockCppClass(const CommandOptions& opt
         response_data.Add("language", Upp::String("Cpp"));
         response_data.Add("code", Upp::String(code_result.data.c_str()));
 
-        return JsonIO::SuccessResponse("codegen-block-cpp-class", response_data);
+        return JsonIO::SuccessEnvelope("codegen-block-cpp-class", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("codegen-block-cpp-class",
+        return JsonIO::ErrorEnvelope("codegen-block-cpp-class",
                                    "Failed to generate C++ class code for block: " + std::string(e.what()),
                                    "CODEGEN_BLOCK_CPP_CLASS_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunCodegenBlockAudioDemo(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunCodegenBlockAudioDemo(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("codegen-block-audio-demo", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-audio-demo", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("codegen-block-audio-demo", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-audio-demo", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("codegen-block-audio-demo", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-audio-demo", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6843,14 +6871,14 @@ Upp::String CommandDispatcher::RunCodegenBlockAudioDemo(const CommandOptions& op
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-audio-demo", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-audio-demo", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("codegen-block-audio-demo", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("codegen-block-audio-demo", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Get the circuit facade
@@ -6870,7 +6898,7 @@ Upp::String CommandDispatcher::RunCodegenBlockAudioDemo(const CommandOptions& op
 
         if (!graph_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-audio-demo", graph_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-audio-demo", graph_result.error_message, error_code_str);
         }
 
         // Prepare the CppClassOptions
@@ -6892,7 +6920,7 @@ Upp::String CommandDispatcher::RunCodegenBlockAudioDemo(const CommandOptions& op
 
         if (!code_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(code_result.error_code);
-            return JsonIO::ErrorResponse("codegen-block-audio-demo", code_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("codegen-block-audio-demo", code_result.error_message, error_code_str);
         }
 
         // Build response
@@ -6904,24 +6932,24 @@ Upp::String CommandDispatcher::RunCodegenBlockAudioDemo(const CommandOptions& op
         response_data.Add("audio_dsl", JsonIO::AudioDslGraphToValueMap(graph_result.data));
         response_data.Add("code", Upp::String(code_result.data.c_str()));
 
-        return JsonIO::SuccessResponse("codegen-block-audio-demo", response_data);
+        return JsonIO::SuccessEnvelope("codegen-block-audio-demo", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("codegen-block-audio-demo",
+        return JsonIO::ErrorEnvelope("codegen-block-audio-demo",
                                    "Failed to generate audio demo code for block: " + std::string(e.what()),
                                    "CODEGEN_BLOCK_AUDIO_DEMO_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDspGraphInspect(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDspGraphInspect(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("dsp-graph-inspect", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("dsp-graph-inspect", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("dsp-graph-inspect", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("dsp-graph-inspect", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("dsp-graph-inspect", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("dsp-graph-inspect", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -6942,14 +6970,14 @@ Upp::String CommandDispatcher::RunDspGraphInspect(const CommandOptions& opts) {
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("dsp-graph-inspect", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("dsp-graph-inspect", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("dsp-graph-inspect", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("dsp-graph-inspect", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Get the circuit facade
@@ -6969,7 +6997,7 @@ Upp::String CommandDispatcher::RunDspGraphInspect(const CommandOptions& opts) {
 
         if (!graph_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-            return JsonIO::ErrorResponse("dsp-graph-inspect", graph_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("dsp-graph-inspect", graph_result.error_message, error_code_str);
         }
 
         // Build the DSP graph from the AudioDslGraph
@@ -6983,7 +7011,7 @@ Upp::String CommandDispatcher::RunDspGraphInspect(const CommandOptions& opts) {
 
         if (!dsp_graph_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(dsp_graph_result.error_code);
-            return JsonIO::ErrorResponse("dsp-graph-inspect", dsp_graph_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("dsp-graph-inspect", dsp_graph_result.error_message, error_code_str);
         }
 
         // Build response
@@ -6993,24 +7021,24 @@ Upp::String CommandDispatcher::RunDspGraphInspect(const CommandOptions& opts) {
         response_data.Add("block_id", Upp::String(block_id.c_str()));
         response_data.Add("dsp_graph", JsonIO::DspGraphToValueMap(dsp_graph_result.data));
 
-        return JsonIO::SuccessResponse("dsp-graph-inspect", response_data);
+        return JsonIO::SuccessEnvelope("dsp-graph-inspect", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("dsp-graph-inspect",
+        return JsonIO::ErrorEnvelope("dsp-graph-inspect",
                                    "Failed to inspect DSP graph for block: " + std::string(e.what()),
                                    "DSP_GRAPH_INSPECT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDspRenderOsc(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDspRenderOsc(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("dsp-render-osc", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("dsp-render-osc", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("dsp-render-osc", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("dsp-render-osc", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("dsp-render-osc", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("dsp-render-osc", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -7031,14 +7059,14 @@ Upp::String CommandDispatcher::RunDspRenderOsc(const CommandOptions& opts) {
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("dsp-render-osc", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("dsp-render-osc", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("dsp-render-osc", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("dsp-render-osc", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Get the circuit facade
@@ -7058,7 +7086,7 @@ Upp::String CommandDispatcher::RunDspRenderOsc(const CommandOptions& opts) {
 
         if (!graph_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(graph_result.error_code);
-            return JsonIO::ErrorResponse("dsp-render-osc", graph_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("dsp-render-osc", graph_result.error_message, error_code_str);
         }
 
         // Render the DSP graph
@@ -7075,7 +7103,7 @@ Upp::String CommandDispatcher::RunDspRenderOsc(const CommandOptions& opts) {
 
         if (!render_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(render_result.error_code);
-            return JsonIO::ErrorResponse("dsp-render-osc", render_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("dsp-render-osc", render_result.error_message, error_code_str);
         }
 
         // Calculate statistics
@@ -7127,24 +7155,24 @@ Upp::String CommandDispatcher::RunDspRenderOsc(const CommandOptions& opts) {
         stats.Add("right_max", out_right.empty() ? 0.0 : *std::max_element(out_right.begin(), out_right.end()));
         response_data.Add("render_stats", stats);
 
-        return JsonIO::SuccessResponse("dsp-render-osc", response_data);
+        return JsonIO::SuccessEnvelope("dsp-render-osc", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("dsp-render-osc",
+        return JsonIO::ErrorEnvelope("dsp-render-osc",
                                    "Failed to render DSP graph for oscillator: " + std::string(e.what()),
                                    "DSP_RENDER_OSC_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunAnalogModelInspect(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunAnalogModelInspect(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("analog-model-inspect", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("analog-model-inspect", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("analog-model-inspect", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("analog-model-inspect", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("analog-model-inspect", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("analog-model-inspect", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -7159,14 +7187,14 @@ Upp::String CommandDispatcher::RunAnalogModelInspect(const CommandOptions& opts)
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("analog-model-inspect", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("analog-model-inspect", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("analog-model-inspect", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("analog-model-inspect", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Get the circuit facade
@@ -7182,7 +7210,7 @@ Upp::String CommandDispatcher::RunAnalogModelInspect(const CommandOptions& opts)
 
         if (!model_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(model_result.error_code);
-            return JsonIO::ErrorResponse("analog-model-inspect", model_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("analog-model-inspect", model_result.error_message, error_code_str);
         }
 
         // Build response
@@ -7192,24 +7220,24 @@ Upp::String CommandDispatcher::RunAnalogModelInspect(const CommandOptions& opts)
         response_data.Add("block_id", Upp::String(block_id.c_str()));
         response_data.Add("analog_model", AnalogBlockModelToValueMap(model_result.data));
 
-        return JsonIO::SuccessResponse("analog-model-inspect", response_data);
+        return JsonIO::SuccessEnvelope("analog-model-inspect", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("analog-model-inspect",
+        return JsonIO::ErrorEnvelope("analog-model-inspect",
                                    "Failed to inspect analog model: " + std::string(e.what()),
                                    "ANALOG_MODEL_INSPECT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunAnalogRenderOsc(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunAnalogRenderOsc(const CommandOptions& opts) {
     try {
         if (opts.workspace.empty()) {
-            return JsonIO::ErrorResponse("analog-render-osc", "Workspace path is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("analog-render-osc", "Workspace path is required", "INVALID_ARGUMENT");
         }
         if (!opts.session_id.has_value()) {
-            return JsonIO::ErrorResponse("analog-render-osc", "Session ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("analog-render-osc", "Session ID is required", "INVALID_ARGUMENT");
         }
         if (opts.block_id.empty()) {
-            return JsonIO::ErrorResponse("analog-render-osc", "Block ID is required", "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("analog-render-osc", "Block ID is required", "INVALID_ARGUMENT");
         }
 
         // Parse the workspace path and session ID
@@ -7229,14 +7257,14 @@ Upp::String CommandDispatcher::RunAnalogRenderOsc(const CommandOptions& opts) {
         auto session_load_result = session_store_->LoadSession(session_id);
         if (!session_load_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(session_load_result.error_code);
-            return JsonIO::ErrorResponse("analog-render-osc", session_load_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("analog-render-osc", session_load_result.error_message, error_code_str);
         }
         SessionMetadata session = session_load_result.data;
 
         // Check if the branch exists
         std::optional<BranchMetadata> branch = FindBranchByName(session, branch_name);
         if (!branch) {
-            return JsonIO::ErrorResponse("analog-render-osc", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
+            return JsonIO::ErrorEnvelope("analog-render-osc", "Branch not found: " + branch_name, "INVALID_ARGUMENT");
         }
 
         // Get the circuit facade
@@ -7262,7 +7290,7 @@ Upp::String CommandDispatcher::RunAnalogRenderOsc(const CommandOptions& opts) {
 
         if (!model_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(model_result.error_code);
-            return JsonIO::ErrorResponse("analog-render-osc", model_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("analog-render-osc", model_result.error_message, error_code_str);
         }
 
         // Render the analog block as audio
@@ -7279,7 +7307,7 @@ Upp::String CommandDispatcher::RunAnalogRenderOsc(const CommandOptions& opts) {
 
         if (!render_result.ok) {
             std::string error_code_str = JsonIO::ErrorCodeToString(render_result.error_code);
-            return JsonIO::ErrorResponse("analog-render-osc", render_result.error_message, error_code_str);
+            return JsonIO::ErrorEnvelope("analog-render-osc", render_result.error_message, error_code_str);
         }
 
         // Calculate statistics
@@ -7333,25 +7361,25 @@ Upp::String CommandDispatcher::RunAnalogRenderOsc(const CommandOptions& opts) {
         stats.Add("right_max", out_right.empty() ? 0.0 : *std::max_element(out_right.begin(), out_right.end()));
         response_data.Add("render_stats", stats);
 
-        return JsonIO::SuccessResponse("analog-render-osc", response_data);
+        return JsonIO::SuccessEnvelope("analog-render-osc", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("analog-render-osc",
+        return JsonIO::ErrorEnvelope("analog-render-osc",
                                    "Failed to render analog oscillator: " + std::string(e.what()),
                                    "ANALOG_RENDER_OSC_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerCodegenBlockCppClass(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerCodegenBlockCppClass(const CommandOptions& opts) {
     try {
         // Extract payload values
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-codegen-block-cpp-class", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-codegen-block-cpp-class", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string block_id = opts.payload.Get("block_id", Upp::String("")).ToStd();
         if (block_id.empty()) {
-            return JsonIO::ErrorResponse("designer-codegen-block-cpp-class", "block_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-codegen-block-cpp-class", "block_id is required", "INVALID_PARAMETER");
         }
 
         // Extract parameters
@@ -7378,7 +7406,7 @@ Upp::String CommandDispatcher::RunDesignerCodegenBlockCppClass(const CommandOpti
 
         if (!result.ok()) {
             std::string error_code_str = ErrorCodeToString(result.error_code());
-            return JsonIO::ErrorResponse("designer-codegen-block-cpp-class", result.error_message(), error_code_str);
+            return JsonIO::ErrorEnvelope("designer-codegen-block-cpp-class", result.error_message(), error_code_str);
         }
 
         // Build response data
@@ -7392,25 +7420,25 @@ Upp::String CommandDispatcher::RunDesignerCodegenBlockCppClass(const CommandOpti
         // Add codegen result
         response_data.Add("code", Upp::String(result.value().code.c_str()));
 
-        return JsonIO::SuccessResponse("designer-codegen-block-cpp-class", response_data);
+        return JsonIO::SuccessEnvelope("designer-codegen-block-cpp-class", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-codegen-block-cpp-class",
+        return JsonIO::ErrorEnvelope("designer-codegen-block-cpp-class",
                                    "Failed to run designer C++ class codegen: " + std::string(e.what()),
                                    "DESIGNER_CODEGEN_CPP_CLASS_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunDesignerCodegenBlockAudioDemo(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunDesignerCodegenBlockAudioDemo(const CommandOptions& opts) {
     try {
         // Extract payload values
         std::string designer_session_id = opts.payload.Get("designer_session_id", Upp::String("")).ToStd();
         if (designer_session_id.empty()) {
-            return JsonIO::ErrorResponse("designer-codegen-block-audio-demo", "designer_session_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-codegen-block-audio-demo", "designer_session_id is required", "INVALID_PARAMETER");
         }
 
         std::string block_id = opts.payload.Get("block_id", Upp::String("")).ToStd();
         if (block_id.empty()) {
-            return JsonIO::ErrorResponse("designer-codegen-block-audio-demo", "block_id is required", "INVALID_PARAMETER");
+            return JsonIO::ErrorEnvelope("designer-codegen-block-audio-demo", "block_id is required", "INVALID_PARAMETER");
         }
 
         // Extract parameters
@@ -7443,7 +7471,7 @@ Upp::String CommandDispatcher::RunDesignerCodegenBlockAudioDemo(const CommandOpt
 
         if (!result.ok()) {
             std::string error_code_str = ErrorCodeToString(result.error_code());
-            return JsonIO::ErrorResponse("designer-codegen-block-audio-demo", result.error_message(), error_code_str);
+            return JsonIO::ErrorEnvelope("designer-codegen-block-audio-demo", result.error_message(), error_code_str);
         }
 
         // Build response data
@@ -7458,15 +7486,15 @@ Upp::String CommandDispatcher::RunDesignerCodegenBlockAudioDemo(const CommandOpt
         response_data.Add("audio_dsl", JsonIO::AudioDslGraphToValueMap(result.value().audio_dsl));
         response_data.Add("code", Upp::String(result.value().code.c_str()));
 
-        return JsonIO::SuccessResponse("designer-codegen-block-audio-demo", response_data);
+        return JsonIO::SuccessEnvelope("designer-codegen-block-audio-demo", response_data);
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("designer-codegen-block-audio-demo",
+        return JsonIO::ErrorEnvelope("designer-codegen-block-audio-demo",
                                    "Failed to run designer audio demo codegen: " + std::string(e.what()),
                                    "DESIGNER_CODEGEN_AUDIO_DEMO_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunInstrumentBuildHybrid(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunInstrumentBuildHybrid(const CommandOptions& opts) {
     try {
         // Extract required parameters
         std::string workspace_path = opts.workspace;
@@ -7488,7 +7516,7 @@ Upp::String CommandDispatcher::RunInstrumentBuildHybrid(const CommandOptions& op
 
         // Validate required parameters
         if (session_id_str.empty()) {
-            return JsonIO::ErrorResponse("instrument-build-hybrid", "Session ID is required");
+            return JsonIO::ErrorEnvelope("instrument-build-hybrid", "Session ID is required");
         }
 
         // Parse session ID
@@ -7496,13 +7524,13 @@ Upp::String CommandDispatcher::RunInstrumentBuildHybrid(const CommandOptions& op
         try {
             session_id = std::stoll(session_id_str);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("instrument-build-hybrid", "Invalid session ID format");
+            return JsonIO::ErrorEnvelope("instrument-build-hybrid", "Invalid session ID format");
         }
 
         // Load session metadata
         auto session_result = session_store_->GetSession(session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("instrument-build-hybrid", session_result.error_message);
+            return JsonIO::ErrorEnvelope("instrument-build-hybrid", session_result.error_message);
         }
 
         SessionMetadata session = session_result.data;
@@ -7535,7 +7563,7 @@ Upp::String CommandDispatcher::RunInstrumentBuildHybrid(const CommandOptions& op
         );
 
         if (!instrument_result.ok) {
-            return JsonIO::ErrorResponse("instrument-build-hybrid",
+            return JsonIO::ErrorEnvelope("instrument-build-hybrid",
                                        instrument_result.error_message,
                                        JsonIO::ErrorCodeToString(instrument_result.error_code));
         }
@@ -7546,16 +7574,16 @@ Upp::String CommandDispatcher::RunInstrumentBuildHybrid(const CommandOptions& op
         response_data.Add("branch", Upp::String(branch_name.c_str()));
         response_data.Add("instrument", JsonIO::InstrumentGraphToValueMap(instrument_result.data));
 
-        return JsonIO::SuccessResponse("instrument-build-hybrid", response_data);
+        return JsonIO::SuccessEnvelope("instrument-build-hybrid", response_data);
 
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("instrument-build-hybrid",
+        return JsonIO::ErrorEnvelope("instrument-build-hybrid",
                                    "Failed to build hybrid instrument: " + std::string(e.what()),
                                    "INSTRUMENT_BUILD_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& opts) {
     try {
         // Extract required parameters
         std::string workspace_path = opts.workspace;
@@ -7578,7 +7606,7 @@ Upp::String CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& o
 
         // Validate required parameters
         if (session_id_str.empty()) {
-            return JsonIO::ErrorResponse("instrument-render-hybrid", "Session ID is required");
+            return JsonIO::ErrorEnvelope("instrument-render-hybrid", "Session ID is required");
         }
 
         // Parse session ID
@@ -7586,13 +7614,13 @@ Upp::String CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& o
         try {
             session_id = std::stoll(session_id_str);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("instrument-render-hybrid", "Invalid session ID format");
+            return JsonIO::ErrorEnvelope("instrument-render-hybrid", "Invalid session ID format");
         }
 
         // Load session metadata
         auto session_result = session_store_->GetSession(session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("instrument-render-hybrid", session_result.error_message);
+            return JsonIO::ErrorEnvelope("instrument-render-hybrid", session_result.error_message);
         }
 
         SessionMetadata session = session_result.data;
@@ -7605,7 +7633,7 @@ Upp::String CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& o
             // Load instrument from JSON file
             std::ifstream file(instrument_json_file);
             if (!file.is_open()) {
-                return JsonIO::ErrorResponse("instrument-render-hybrid", "Cannot open instrument JSON file");
+                return JsonIO::ErrorEnvelope("instrument-render-hybrid", "Cannot open instrument JSON file");
             }
 
             std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
@@ -7614,7 +7642,7 @@ Upp::String CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& o
             Upp::ValueMap instrument_map = JsonIO::Deserialize(Upp::String(content.c_str()));
             // Parse instrument from JSON would require additional parsing functions
             // For now, we'll build from parameters
-            return JsonIO::ErrorResponse("instrument-render-hybrid",
+            return JsonIO::ErrorEnvelope("instrument-render-hybrid",
                                        "JSON file loading not implemented yet, use inline parameters");
         } else {
             // Build instrument from inline parameters
@@ -7643,7 +7671,7 @@ Upp::String CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& o
             );
 
             if (!build_result.ok) {
-                return JsonIO::ErrorResponse("instrument-render-hybrid",
+                return JsonIO::ErrorEnvelope("instrument-render-hybrid",
                                            build_result.error_message,
                                            JsonIO::ErrorCodeToString(build_result.error_code));
             }
@@ -7665,7 +7693,7 @@ Upp::String CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& o
         );
 
         if (!render_result.ok) {
-            return JsonIO::ErrorResponse("instrument-render-hybrid",
+            return JsonIO::ErrorEnvelope("instrument-render-hybrid",
                                        render_result.error_message,
                                        JsonIO::ErrorCodeToString(render_result.error_code));
         }
@@ -7703,16 +7731,16 @@ Upp::String CommandDispatcher::RunInstrumentRenderHybrid(const CommandOptions& o
         response_data.Add("left_preview", left_preview);
         response_data.Add("right_preview", right_preview);
 
-        return JsonIO::SuccessResponse("instrument-render-hybrid", response_data);
+        return JsonIO::SuccessEnvelope("instrument-render-hybrid", response_data);
 
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("instrument-render-hybrid",
+        return JsonIO::ErrorEnvelope("instrument-render-hybrid",
                                    "Failed to render hybrid instrument: " + std::string(e.what()),
                                    "INSTRUMENT_RENDER_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts) {
     try {
         // Extract required parameters
         std::string workspace_path = opts.workspace;
@@ -7741,7 +7769,7 @@ Upp::String CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts
 
         // Validate required parameters
         if (session_id_str.empty()) {
-            return JsonIO::ErrorResponse("instrument-export-cpp", "Session ID is required");
+            return JsonIO::ErrorEnvelope("instrument-export-cpp", "Session ID is required");
         }
 
         // Parse session ID
@@ -7749,13 +7777,13 @@ Upp::String CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts
         try {
             session_id = std::stoll(session_id_str);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("instrument-export-cpp", "Invalid session ID format");
+            return JsonIO::ErrorEnvelope("instrument-export-cpp", "Invalid session ID format");
         }
 
         // Load session metadata
         auto session_result = session_store_->GetSession(session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("instrument-export-cpp", session_result.error_message);
+            return JsonIO::ErrorEnvelope("instrument-export-cpp", session_result.error_message);
         }
 
         SessionMetadata session = session_result.data;
@@ -7768,7 +7796,7 @@ Upp::String CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts
             // Load instrument from JSON file
             std::ifstream file(instrument_json_file);
             if (!file.is_open()) {
-                return JsonIO::ErrorResponse("instrument-export-cpp", "Cannot open instrument JSON file");
+                return JsonIO::ErrorEnvelope("instrument-export-cpp", "Cannot open instrument JSON file");
             }
 
             std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
@@ -7776,7 +7804,7 @@ Upp::String CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts
 
             Upp::ValueMap instrument_map = JsonIO::Deserialize(Upp::String(content.c_str()));
             // For now, we'll build from parameters, but should add JSON deserialization later
-            return JsonIO::ErrorResponse("instrument-export-cpp",
+            return JsonIO::ErrorEnvelope("instrument-export-cpp",
                                        "JSON file loading not implemented yet, use inline parameters");
         } else {
             // Build instrument from inline parameters
@@ -7805,7 +7833,7 @@ Upp::String CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts
             );
 
             if (!build_result.ok) {
-                return JsonIO::ErrorResponse("instrument-export-cpp",
+                return JsonIO::ErrorEnvelope("instrument-export-cpp",
                                            build_result.error_message,
                                            JsonIO::ErrorCodeToString(build_result.error_code));
             }
@@ -7832,7 +7860,7 @@ Upp::String CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts
         );
 
         if (!export_result.ok) {
-            return JsonIO::ErrorResponse("instrument-export-cpp",
+            return JsonIO::ErrorEnvelope("instrument-export-cpp",
                                        export_result.error_message,
                                        JsonIO::ErrorCodeToString(export_result.error_code));
         }
@@ -7845,16 +7873,16 @@ Upp::String CommandDispatcher::RunInstrumentExportCpp(const CommandOptions& opts
         response_data.Add("program_name", Upp::String(export_options.program_name.c_str()));
         response_data.Add("cpp_source", Upp::String(export_result.data.c_str()));
 
-        return JsonIO::SuccessResponse("instrument-export-cpp", response_data);
+        return JsonIO::SuccessEnvelope("instrument-export-cpp", response_data);
 
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("instrument-export-cpp",
+        return JsonIO::ErrorEnvelope("instrument-export-cpp",
                                    "Failed to export instrument as C++: " + std::string(e.what()),
                                    "INSTRUMENT_EXPORT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOptions& opts) {
     try {
         // Extract required parameters
         std::string workspace_path = opts.workspace;
@@ -7882,7 +7910,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOp
 
         // Validate required parameters
         if (session_id_str.empty()) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-skeleton", "Session ID is required");
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton", "Session ID is required");
         }
 
         // Parse session ID
@@ -7890,7 +7918,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOp
         try {
             session_id = std::stoll(session_id_str);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-skeleton", "Invalid session ID format");
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton", "Invalid session ID format");
         }
 
         // Parse plugin target
@@ -7904,14 +7932,14 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOp
         } else if (plugin_target_str == "ladspa") {
             target_kind = PluginTargetKind::Ladspa;
         } else {
-            return JsonIO::ErrorResponse("instrument-export-plugin-skeleton",
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton",
                                        "Invalid plugin target. Must be one of: vst3, lv2, clap, ladspa");
         }
 
         // Load session metadata
         auto session_result = session_store_->GetSession(session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-skeleton", session_result.error_message);
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton", session_result.error_message);
         }
 
         SessionMetadata session = session_result.data;
@@ -7924,7 +7952,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOp
             // Load instrument from JSON file
             std::ifstream file(instrument_json_file);
             if (!file.is_open()) {
-                return JsonIO::ErrorResponse("instrument-export-plugin-skeleton", "Cannot open instrument JSON file");
+                return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton", "Cannot open instrument JSON file");
             }
 
             std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
@@ -7932,7 +7960,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOp
 
             Upp::ValueMap instrument_map = JsonIO::Deserialize(Upp::String(content.c_str()));
             // For now, we'll build from parameters, but should add JSON deserialization later
-            return JsonIO::ErrorResponse("instrument-export-plugin-skeleton",
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton",
                                        "JSON file loading not implemented yet, use inline parameters");
         } else {
             // Build instrument from inline parameters
@@ -7961,7 +7989,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOp
             );
 
             if (!build_result.ok) {
-                return JsonIO::ErrorResponse("instrument-export-plugin-skeleton",
+                return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton",
                                            build_result.error_message,
                                            JsonIO::ErrorCodeToString(build_result.error_code));
             }
@@ -7990,7 +8018,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOp
         );
 
         if (!export_result.ok) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-skeleton",
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton",
                                        export_result.error_message,
                                        JsonIO::ErrorCodeToString(export_result.error_code));
         }
@@ -8005,16 +8033,16 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginSkeleton(const CommandOp
         response_data.Add("plugin_id", Upp::String(plugin_id.c_str()));
         response_data.Add("skeleton_source", Upp::String(export_result.data.c_str()));
 
-        return JsonIO::SuccessResponse("instrument-export-plugin-skeleton", response_data);
+        return JsonIO::SuccessEnvelope("instrument-export-plugin-skeleton", response_data);
 
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("instrument-export-plugin-skeleton",
+        return JsonIO::ErrorEnvelope("instrument-export-plugin-skeleton",
                                    "Failed to export plugin skeleton: " + std::string(e.what()),
                                    "PLUGIN_SKELETON_EXPORT_ERROR");
     }
 }
 
-Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOptions& opts) {
+Upp::ValueMap CommandDispatcher::RunInstrumentExportPluginProject(const CommandOptions& opts) {
     try {
         // Extract required parameters
         std::string workspace_path = opts.workspace;
@@ -8044,11 +8072,11 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOpt
 
         // Validate required parameters
         if (session_id_str.empty()) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-project", "Session ID is required");
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-project", "Session ID is required");
         }
 
         if (output_dir.empty()) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-project", "Output directory is required");
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-project", "Output directory is required");
         }
 
         // Parse session ID
@@ -8056,7 +8084,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOpt
         try {
             session_id = std::stoll(session_id_str);
         } catch (const std::exception& e) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-project", "Invalid session ID format");
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-project", "Invalid session ID format");
         }
 
         // Parse plugin target
@@ -8070,14 +8098,14 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOpt
         } else if (plugin_target_str == "ladspa") {
             target_kind = PluginTargetKind::Ladspa;
         } else {
-            return JsonIO::ErrorResponse("instrument-export-plugin-project",
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-project",
                                        "Invalid plugin target. Must be one of: vst3, lv2, clap, ladspa");
         }
 
         // Load session metadata
         auto session_result = session_store_->GetSession(session_id);
         if (!session_result.ok) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-project", session_result.error_message);
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-project", session_result.error_message);
         }
 
         SessionMetadata session = session_result.data;
@@ -8090,7 +8118,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOpt
             // Load instrument from JSON file
             std::ifstream file(instrument_json_file);
             if (!file.is_open()) {
-                return JsonIO::ErrorResponse("instrument-export-plugin-project", "Cannot open instrument JSON file");
+                return JsonIO::ErrorEnvelope("instrument-export-plugin-project", "Cannot open instrument JSON file");
             }
 
             std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
@@ -8098,7 +8126,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOpt
 
             Upp::ValueMap instrument_map = JsonIO::Deserialize(Upp::String(content.c_str()));
             // For now, we'll build from parameters, but should add JSON deserialization later
-            return JsonIO::ErrorResponse("instrument-export-plugin-project",
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-project",
                                        "JSON file loading not implemented yet, use inline parameters");
         } else {
             // Build instrument from inline parameters
@@ -8127,7 +8155,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOpt
             );
 
             if (!build_result.ok) {
-                return JsonIO::ErrorResponse("instrument-export-plugin-project",
+                return JsonIO::ErrorEnvelope("instrument-export-plugin-project",
                                            build_result.error_message,
                                            JsonIO::ErrorCodeToString(build_result.error_code));
             }
@@ -8159,7 +8187,7 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOpt
         );
 
         if (!export_result.ok) {
-            return JsonIO::ErrorResponse("instrument-export-plugin-project",
+            return JsonIO::ErrorEnvelope("instrument-export-plugin-project",
                                        export_result.error_message,
                                        JsonIO::ErrorCodeToString(export_result.error_code));
         }
@@ -8175,10 +8203,10 @@ Upp::String CommandDispatcher::RunInstrumentExportPluginProject(const CommandOpt
         response_data.Add("output_dir", Upp::String(output_dir.c_str()));
         response_data.Add("status", Upp::String("ok"));
 
-        return JsonIO::SuccessResponse("instrument-export-plugin-project", response_data);
+        return JsonIO::SuccessEnvelope("instrument-export-plugin-project", response_data);
 
     } catch (const std::exception& e) {
-        return JsonIO::ErrorResponse("instrument-export-plugin-project",
+        return JsonIO::ErrorEnvelope("instrument-export-plugin-project",
                                    "Failed to export plugin project: " + std::string(e.what()),
                                    "PLUGIN_PROJECT_EXPORT_ERROR");
     }
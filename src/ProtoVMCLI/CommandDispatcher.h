@@ -13,13 +13,13 @@ class CommandDispatcher {
 public:
     CommandDispatcher(std::unique_ptr<ISessionStore> store);
     
-    Upp::String RunInitWorkspace(const CommandOptions& opts);
-    Upp::String RunCreateSession(const CommandOptions& opts);
-    Upp::String RunListSessions(const CommandOptions& opts);
-    Upp::String RunRunTicks(const CommandOptions& opts);
-    Upp::String RunGetState(const CommandOptions& opts);
-    Upp::String RunExportNetlist(const CommandOptions& opts);
-    Upp::String RunDestroySession(const CommandOptions& opts);
+    Upp::ValueMap RunInitWorkspace(const CommandOptions& opts);
+    Upp::ValueMap RunCreateSession(const CommandOptions& opts);
+    Upp::ValueMap RunListSessions(const CommandOptions& opts);
+    Upp::ValueMap RunRunTicks(const CommandOptions& opts);
+    Upp::ValueMap RunGetState(const CommandOptions& opts);
+    Upp::ValueMap RunExportNetlist(const CommandOptions& opts);
+    Upp::ValueMap RunDestroySession(const CommandOptions& opts);
 
     // Streaming debug commands
     Upp::String RunDebugProcessLogs(int process_id);
@@ -27,150 +27,150 @@ public:
     Upp::String RunDebugPollStream(const Upp::String& poll_id);
 
     // Circuit editing commands
-    Upp::String RunEditAddComponent(const CommandOptions& opts);
-    Upp::String RunEditRemoveComponent(const CommandOptions& opts);
-    Upp::String RunEditMoveComponent(const CommandOptions& opts);
-    Upp::String RunEditSetComponentProperty(const CommandOptions& opts);
-    Upp::String RunEditConnect(const CommandOptions& opts);
-    Upp::String RunEditDisconnect(const CommandOptions& opts);
-    Upp::String RunEditGetCircuit(const CommandOptions& opts);
+    Upp::ValueMap RunEditAddComponent(const CommandOptions& opts);
+    Upp::ValueMap RunEditRemoveComponent(const CommandOptions& opts);
+    Upp::ValueMap RunEditMoveComponent(const CommandOptions& opts);
+    Upp::ValueMap RunEditSetComponentProperty(const CommandOptions& opts);
+    Upp::ValueMap RunEditConnect(const CommandOptions& opts);
+    Upp::ValueMap RunEditDisconnect(const CommandOptions& opts);
+    Upp::ValueMap RunEditGetCircuit(const CommandOptions& opts);
 
     // Circuit analysis and linting commands
-    Upp::String RunLintCircuit(const CommandOptions& opts);
-    Upp::String RunAnalyzeCircuit(const CommandOptions& opts);
+    Upp::ValueMap RunLintCircuit(const CommandOptions& opts);
+    Upp::ValueMap RunAnalyzeCircuit(const CommandOptions& opts);
 
     // Collaboration utility commands
-    Upp::String RunCircuitDiff(const CommandOptions& opts);
-    Upp::String RunCircuitPatch(const CommandOptions& opts);
-    Upp::String RunCircuitReplay(const CommandOptions& opts);
-    Upp::String RunCircuitHistory(const CommandOptions& opts);
+    Upp::ValueMap RunCircuitDiff(const CommandOptions& opts);
+    Upp::ValueMap RunCircuitPatch(const CommandOptions& opts);
+    Upp::ValueMap RunCircuitReplay(const CommandOptions& opts);
+    Upp::ValueMap RunCircuitHistory(const CommandOptions& opts);
 
     // Branch commands
-    Upp::String RunBranchList(const CommandOptions& opts);
-    Upp::String RunBranchCreate(const CommandOptions& opts);
-    Upp::String RunBranchSwitch(const CommandOptions& opts);
-    Upp::String RunBranchDelete(const CommandOptions& opts);
-    Upp::String RunBranchMerge(const CommandOptions& opts);
+    Upp::ValueMap RunBranchList(const CommandOptions& opts);
+    Upp::ValueMap RunBranchCreate(const CommandOptions& opts);
+    Upp::ValueMap RunBranchSwitch(const CommandOptions& opts);
+    Upp::ValueMap RunBranchDelete(const CommandOptions& opts);
+    Upp::ValueMap RunBranchMerge(const CommandOptions& opts);
 
     // Graph commands
-    Upp::String RunGraphExport(const CommandOptions& opts);
-    Upp::String RunGraphPaths(const CommandOptions& opts);
-    Upp::String RunGraphFanIn(const CommandOptions& opts);
-    Upp::String RunGraphFanOut(const CommandOptions& opts);
-    Upp::String RunGraphStats(const CommandOptions& opts);
+    Upp::ValueMap RunGraphExport(const CommandOptions& opts);
+    Upp::ValueMap RunGraphPaths(const CommandOptions& opts);
+    Upp::ValueMap RunGraphFanIn(const CommandOptions& opts);
+    Upp::ValueMap RunGraphFanOut(const CommandOptions& opts);
+    Upp::ValueMap RunGraphStats(const CommandOptions& opts);
 
     // Timing analysis commands
-    Upp::String RunTimingSummary(const CommandOptions& opts);
-    Upp::String RunTimingCriticalPaths(const CommandOptions& opts);
-    Upp::String RunTimingLoops(const CommandOptions& opts);
-    Upp::String RunTimingHazards(const CommandOptions& opts);
+    Upp::ValueMap RunTimingSummary(const CommandOptions& opts);
+    Upp::ValueMap RunTimingCriticalPaths(const CommandOptions& opts);
+    Upp::ValueMap RunTimingLoops(const CommandOptions& opts);
+    Upp::ValueMap RunTimingHazards(const CommandOptions& opts);
 
     // Functional dependency analysis commands
-    Upp::String RunDepsSummary(const CommandOptions& opts);
-    Upp::String RunDepsBackward(const CommandOptions& opts);
-    Upp::String RunDepsForward(const CommandOptions& opts);
-    Upp::String RunDepsBoth(const CommandOptions& opts);
+    Upp::ValueMap RunDepsSummary(const CommandOptions& opts);
+    Upp::ValueMap RunDepsBackward(const CommandOptions& opts);
+    Upp::ValueMap RunDepsForward(const CommandOptions& opts);
+    Upp::ValueMap RunDepsBoth(const CommandOptions& opts);
 
     // Block analysis commands
-    Upp::String RunBlocksList(const CommandOptions& opts);
-    Upp::String RunBlocksExport(const CommandOptions& opts);
-    Upp::String RunBlockInspect(const CommandOptions& opts);
+    Upp::ValueMap RunBlocksList(const CommandOptions& opts);
+    Upp::ValueMap RunBlocksExport(const CommandOptions& opts);
+    Upp::ValueMap RunBlockInspect(const CommandOptions& opts);
 
     // Behavioral analysis commands
-    Upp::String RunBehaviorBlock(const CommandOptions& opts);
-    Upp::String RunBehaviorNode(const CommandOptions& opts);
+    Upp::ValueMap RunBehaviorBlock(const CommandOptions& opts);
+    Upp::ValueMap RunBehaviorNode(const CommandOptions& opts);
 
     // HLS IR commands
-    Upp::String RunIrBlock(const CommandOptions& opts);
-    Upp::String RunIrNodeRegion(const CommandOptions& opts);
+    Upp::ValueMap RunIrBlock(const CommandOptions& opts);
+    Upp::ValueMap RunIrNodeRegion(const CommandOptions& opts);
 
     // Scheduled IR commands
-    Upp::String RunScheduleBlock(const CommandOptions& opts);
-    Upp::String RunScheduleNodeRegion(const CommandOptions& opts);
+    Upp::ValueMap RunScheduleBlock(const CommandOptions& opts);
+    Upp::ValueMap RunScheduleNodeRegion(const CommandOptions& opts);
 
     // Refactoring commands
-    Upp::String RunRefactorSuggest(const CommandOptions& opts);
-    Upp::String RunRefactorSuggestBlock(const CommandOptions& opts);
-    Upp::String RunRefactorApply(const CommandOptions& opts);
+    Upp::ValueMap RunRefactorSuggest(const CommandOptions& opts);
+    Upp::ValueMap RunRefactorSuggestBlock(const CommandOptions& opts);
+    Upp::ValueMap RunRefactorApply(const CommandOptions& opts);
 
     // IR optimization commands
-    Upp::String RunIrOptBlock(const CommandOptions& opts);
-    Upp::String RunIrOptRefactorBlock(const CommandOptions& opts);
+    Upp::ValueMap RunIrOptBlock(const CommandOptions& opts);
+    Upp::ValueMap RunIrOptRefactorBlock(const CommandOptions& opts);
 
     // Diff analysis commands
-    Upp::String RunBehaviorDiffBlock(const CommandOptions& opts);
-    Upp::String RunIrDiffBlock(const CommandOptions& opts);
-    Upp::String RunIrDiffNodeRegion(const CommandOptions& opts);
+    Upp::ValueMap RunBehaviorDiffBlock(const CommandOptions& opts);
+    Upp::ValueMap RunIrDiffBlock(const CommandOptions& opts);
+    Upp::ValueMap RunIrDiffNodeRegion(const CommandOptions& opts);
 
     // Pipeline analysis commands
-    Upp::String RunPipelineBlock(const CommandOptions& opts);
-    Upp::String RunPipelineSubsystem(const CommandOptions& opts);
+    Upp::ValueMap RunPipelineBlock(const CommandOptions& opts);
+    Upp::ValueMap RunPipelineSubsystem(const CommandOptions& opts);
 
     // CDC analysis commands
-    Upp::String RunCdcBlock(const CommandOptions& opts);
-    Upp::String RunCdcSubsystem(const CommandOptions& opts);
+    Upp::ValueMap RunCdcBlock(const CommandOptions& opts);
+    Upp::ValueMap RunCdcSubsystem(const CommandOptions& opts);
 
     // Retiming analysis commands
-    Upp::String RunRetimeBlock(const CommandOptions& opts);
-    Upp::String RunRetimeSubsystem(const CommandOptions& opts);
+    Upp::ValueMap RunRetimeBlock(const CommandOptions& opts);
+    Upp::ValueMap RunRetimeSubsystem(const CommandOptions& opts);
 
     // Retiming application commands
-    Upp::String RunRetimeBlockApply(const CommandOptions& opts);
-    Upp::String RunRetimeSubsystemApply(const CommandOptions& opts);
+    Upp::ValueMap RunRetimeBlockApply(const CommandOptions& opts);
+    Upp::ValueMap RunRetimeSubsystemApply(const CommandOptions& opts);
 
     // Retiming optimization commands
-    Upp::String RunRetimeOptBlock(const CommandOptions& opts);
-    Upp::String RunRetimeOptSubsystem(const CommandOptions& opts);
+    Upp::ValueMap RunRetimeOptBlock(const CommandOptions& opts);
+    Upp::ValueMap RunRetimeOptSubsystem(const CommandOptions& opts);
 
     // Global pipeline analysis commands
-    Upp::String RunGlobalPipelineSubsystem(const CommandOptions& opts);
-    Upp::String RunGlobalPipelineOptSubsystem(const CommandOptions& opts);
-    Upp::String RunGlobalPipelineApply(const CommandOptions& opts);
+    Upp::ValueMap RunGlobalPipelineSubsystem(const CommandOptions& opts);
+    Upp::ValueMap RunGlobalPipelineOptSubsystem(const CommandOptions& opts);
+    Upp::ValueMap RunGlobalPipelineApply(const CommandOptions& opts);
 
     // Structural synthesis commands
-    Upp::String RunStructAnalyzeBlock(const CommandOptions& opts);
-    Upp::String RunStructApplyBlock(const CommandOptions& opts);
+    Upp::ValueMap RunStructAnalyzeBlock(const CommandOptions& opts);
+    Upp::ValueMap RunStructApplyBlock(const CommandOptions& opts);
 
     // Codegen commands
-    Upp::String RunCodegenBlockIr(const CommandOptions& opts);
-    Upp::String RunCodegenBlockC(const CommandOptions& opts);
-    Upp::String RunCodegenBlockOscDemo(const CommandOptions& opts);
-    Upp::String RunCodegenBlockCppClass(const CommandOptions& opts);
-    Upp::String RunCodegenBlockAudioDemo(const CommandOptions& opts);
+    Upp::ValueMap RunCodegenBlockIr(const CommandOptions& opts);
+    Upp::ValueMap RunCodegenBlockC(const CommandOptions& opts);
+    Upp::ValueMap RunCodegenBlockOscDemo(const CommandOptions& opts);
+    Upp::ValueMap RunCodegenBlockCppClass(const CommandOptions& opts);
+    Upp::ValueMap RunCodegenBlockAudioDemo(const CommandOptions& opts);
 
     // CoDesigner commands
-    Upp::String RunDesignerCreateSession(const CommandOptions& opts);
-    Upp::String RunDesignerSetFocus(const CommandOptions& opts);
-    Upp::String RunDesignerGetContext(const CommandOptions& opts);
-    Upp::String RunDesignerAnalyze(const CommandOptions& opts);
-    Upp::String RunDesignerOptimize(const CommandOptions& opts);
-    Upp::String RunDesignerProposeRefactors(const CommandOptions& opts);
-    Upp::String RunDesignerApplyRefactors(const CommandOptions& opts);
-    Upp::String RunDesignerDiff(const CommandOptions& opts);
-    Upp::String RunDesignerCodegen(const CommandOptions& opts);
-    Upp::String RunDesignerRunPlaybook(const CommandOptions& opts);
-    Upp::String RunDesignerRetime(const CommandOptions& opts);
-    Upp::String RunDesignerRetimeApply(const CommandOptions& opts);
-    Upp::String RunDesignerRetimeOpt(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerCreateSession(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerSetFocus(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerGetContext(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerAnalyze(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerOptimize(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerProposeRefactors(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerApplyRefactors(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerDiff(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerCodegen(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerRunPlaybook(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerRetime(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerRetimeApply(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerRetimeOpt(const CommandOptions& opts);
 
     // Designer codegen for C++ class and audio demo
-    Upp::String RunDesignerCodegenBlockCppClass(const CommandOptions& opts);
-    Upp::String RunDesignerCodegenBlockAudioDemo(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerCodegenBlockCppClass(const CommandOptions& opts);
+    Upp::ValueMap RunDesignerCodegenBlockAudioDemo(const CommandOptions& opts);
 
     // DSP graph commands
-    Upp::String RunDspGraphInspect(const CommandOptions& opts);
-    Upp::String RunDspRenderOsc(const CommandOptions& opts);
+    Upp::ValueMap RunDspGraphInspect(const CommandOptions& opts);
+    Upp::ValueMap RunDspRenderOsc(const CommandOptions& opts);
 
     // Analog model commands
-    Upp::String RunAnalogModelInspect(const CommandOptions& opts);
-    Upp::String RunAnalogRenderOsc(const CommandOptions& opts);
+    Upp::ValueMap RunAnalogModelInspect(const CommandOptions& opts);
+    Upp::ValueMap RunAnalogRenderOsc(const CommandOptions& opts);
 
     // Hybrid instrument commands
-    Upp::String RunInstrumentBuildHybrid(const CommandOptions& opts);
-    Upp::String RunInstrumentRenderHybrid(const CommandOptions& opts);
-    Upp::String RunInstrumentExportCpp(const CommandOptions& opts);
-    Upp::String RunInstrumentExportPluginSkeleton(const CommandOptions& opts);
-    Upp::String RunInstrumentExportPluginProject(const CommandOptions& opts);
+    Upp::ValueMap RunInstrumentBuildHybrid(const CommandOptions& opts);
+    Upp::ValueMap RunInstrumentRenderHybrid(const CommandOptions& opts);
+    Upp::ValueMap RunInstrumentExportCpp(const CommandOptions& opts);
+    Upp::ValueMap RunInstrumentExportPluginSkeleton(const CommandOptions& opts);
+    Upp::ValueMap RunInstrumentExportPluginProject(const CommandOptions& opts);
 
 private:
     std::unique_ptr<ISessionStore> session_store_;
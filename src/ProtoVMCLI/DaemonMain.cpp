@@ -2,15 +2,48 @@
 #include "JsonIO.h"
 #include <iostream>
 #include <string>
+#include <cstdlib>
+#include <csignal>
+
+static ProtoVMCLI::SessionServer* serving_server = nullptr;
+
+// SIGINT/SIGTERM end the socket server cleanly, which removes the socket file
+static void HandleStopSignal(int) {
+    if (serving_server) {
+        serving_server->StopServing();
+    }
+}
 
 int main(int argc, char** argv) {
     // Initialize the session server
     ProtoVMCLI::SessionServer server;
     
+    std::string socket_path;
+    for (int i = 1; i + 1 < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--max-sessions") {
+            server.SetMaxResidentSessions(std::atoi(argv[++i]));
+        }
+        else if (arg == "--snapshot-interval") {
+            server.SetSnapshotIntervalTicks(std::atoi(argv[++i]));
+        }
+        else if (arg == "--workers") {
+            server.SetWorkerCount(std::atoi(argv[++i]));
+        }
+        else if (arg == "--socket") {
+            socket_path = argv[++i];
+        }
+    }
+    
     std::cout << "ProtoVM Daemon starting..." << std::endl;
     
-    // Process requests from stdin
-    auto result = server.ProcessRequests();
+    // Serve socket clients, or process requests from stdin
+    if (!socket_path.empty()) {
+        serving_server = &server;
+        std::signal(SIGINT, HandleStopSignal);
+        std::signal(SIGTERM, HandleStopSignal);
+    }
+    auto result = socket_path.empty() ? server.ProcessRequests() : server.ServeUnixSocket(socket_path);
     
     if (!result.ok) {
         // Output error as a JSON response
@@ -9,6 +9,10 @@
 #include <iomanip>
 #include <chrono>
 #include <filesystem>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <set>
 
 namespace fs = std::filesystem;
 
@@ -24,6 +28,121 @@ std::string GetCurrentTimestamp() {
     return std::string(buffer);
 }
 
+// Adds the ProtoVM gate for a circuit component type, or returns null for types
+// without a simulation model
+static ElcBase* AddCircuitGate(Pcb& pcb, const ComponentData& comp) {
+    String name = comp.name.empty() ? comp.id.id.c_str() : comp.name.c_str();
+    if (comp.type == "NAND") return &pcb.Add<ElcNand>(name);
+    if (comp.type == "NOR")  return &pcb.Add<ElcNor>(name);
+    if (comp.type == "XOR")  return &pcb.Add<ElcXor>(name);
+    if (comp.type == "XNOR") return &pcb.Add<ElcXnor>(name);
+    if (comp.type == "NOT")  return &pcb.Add<ElcNot>(name);
+    return nullptr;
+}
+
+// ProtoVM connector of a circuit pin: the gate inputs in order, then the output
+static std::string GetGateConnector(const ComponentData& comp, const std::string& pin_name, int& input_index) {
+    input_index = -1;
+    for (size_t k = 0; k < comp.inputs.size(); k++) {
+        if (comp.inputs[k].name == pin_name) {
+            input_index = (int)k;
+            return comp.type == "NOT" ? "I" : "I" + std::to_string(k);
+        }
+    }
+    if (!comp.outputs.empty() && comp.outputs[0].name == pin_name) {
+        return "O";
+    }
+    return "";
+}
+
+// Builds and initializes the Machine for a circuit of logic gates. Parts the simulator
+// cannot model are left out with a warning: components of other types or pin counts,
+// and wires that touch them or do not run from a gate output to a gate input. Inputs
+// nothing drives read low.
+static bool BuildMachineFromCircuit(const CircuitData& circuit, Machine& machine,
+                                    std::vector<std::string>& warnings, std::string& error) {
+    Pcb& pcb = machine.AddPcb();
+    std::map<std::string, ElcBase*> gates;
+    std::map<std::string, const ComponentData*> components;
+    std::set<std::pair<std::string, int>> driven_inputs;
+    std::set<std::string> used_outputs;
+
+    for (const ComponentData& comp : circuit.components) {
+        int expected_inputs = comp.type == "NOT" ? 1 : 2;
+        bool has_model = comp.type == "NAND" || comp.type == "NOR" || comp.type == "XOR" ||
+                         comp.type == "XNOR" || comp.type == "NOT";
+        if (!has_model) {
+            warnings.push_back("component " + comp.id.id + " has type " + comp.type +
+                               ", which has no simulation model; it is not simulated");
+            continue;
+        }
+        if ((int)comp.inputs.size() != expected_inputs || comp.outputs.size() != 1) {
+            warnings.push_back("component " + comp.id.id + " has " + std::to_string(comp.inputs.size()) +
+                               " inputs and " + std::to_string(comp.outputs.size()) + " outputs, which a " +
+                               comp.type + " gate does not have; it is not simulated");
+            continue;
+        }
+        gates[comp.id.id] = AddCircuitGate(pcb, comp);
+        components[comp.id.id] = &comp;
+    }
+
+    for (const WireData& wire : circuit.wires) {
+        auto start = components.find(wire.start_component_id.id);
+        auto end = components.find(wire.end_component_id.id);
+        if (start == components.end() || end == components.end()) {
+            warnings.push_back("wire " + wire.id.id + " connects a component that is not simulated; it is left out");
+            continue;
+        }
+        int start_input, end_input;
+        std::string start_conn = GetGateConnector(*start->second, wire.start_pin_name, start_input);
+        std::string end_conn = GetGateConnector(*end->second, wire.end_pin_name, end_input);
+        if (start_conn.empty() || end_conn.empty()) {
+            warnings.push_back("wire " + wire.id.id + " connects an unknown pin; it is left out");
+            continue;
+        }
+        // Wires may be drawn from either end
+        if (start_input >= 0 && end_input < 0) {
+            std::swap(start, end);
+            std::swap(start_conn, end_conn);
+            std::swap(start_input, end_input);
+        }
+        if (start_input >= 0 || end_input < 0) {
+            warnings.push_back("wire " + wire.id.id + " does not run from an output to an input; it is left out");
+            continue;
+        }
+        if (driven_inputs.count(std::make_pair(end->first, end_input))) {
+            warnings.push_back("wire " + wire.id.id + " drives an input that is already driven; it is left out");
+            continue;
+        }
+        (*gates[start->first])[start_conn.c_str()] >> (*gates[end->first])[end_conn.c_str()];
+        driven_inputs.insert(std::make_pair(end->first, end_input));
+        used_outputs.insert(start->first);
+    }
+
+    for (const auto& entry : components) {
+        const ComponentData& comp = *entry.second;
+        ElcBase& gate = *gates[entry.first];
+        // Outputs nothing reads are fine; the circuit's results are read from them
+        if (!used_outputs.count(comp.id.id)) {
+            gate.NotRequired("O");
+        }
+        for (size_t k = 0; k < comp.inputs.size(); k++) {
+            if (!driven_inputs.count(std::make_pair(comp.id.id, (int)k))) {
+                warnings.push_back("input " + comp.inputs[k].name + " of component " + comp.id.id +
+                                   " is not driven; it reads low");
+                int input_index;
+                gate.NotRequired(GetGateConnector(comp, comp.inputs[k].name, input_index).c_str());
+            }
+        }
+    }
+
+    if (!machine.Init()) {
+        error = "the Machine failed to initialize";
+        return false;
+    }
+    return true;
+}
+
 // Implementation of CreateMachineFromCircuit
 Result<std::unique_ptr<Machine>> EngineFacade::CreateMachineFromCircuit(const std::string& circuit_file) {
     try {
@@ -40,22 +159,25 @@ Result<std::unique_ptr<Machine>> EngineFacade::CreateMachineFromCircuit(const st
 
         // Create a new Machine and build it from the circuit data
         auto machine = std::make_unique<Machine>();
-        
-        // For now, we'll create a simplified approach to convert CircuitData to Machine
-        // This requires more detailed implementation in the real system
-        // For now, just return a basic machine - this is where we'd need to implement
-        // proper conversion from CircuitData to machine components
-        
-        // Since the CircuitData to Machine conversion is complex and requires more code,
-        // we'll implement a simplified approach for now
-        // In practice, this would involve parsing the components and wires from CircuitData
-        // and creating corresponding ElectricNodeBase objects in the Machine
-        
-        // For the purpose of this implementation, return a new machine with basic setup
-        // until proper circuit loading is implemented
-        machine->Init();  // Initialize the machine after loading circuit
-        
+        std::vector<std::string> warnings;
+        std::string error;
+        bool built = BuildMachineFromCircuit(circuitData, *machine, warnings, error);
+        for (const std::string& warning : warnings) {
+            std::cerr << "Warning: circuit " << circuit_file << ": " << warning << std::endl;
+        }
+        if (!built) {
+            return Result<std::unique_ptr<Machine>>::MakeError(
+                ErrorCode::CircuitNotSupported,
+                "Cannot simulate circuit " + circuit_file + ": " + error
+            );
+        }
+
         return Result<std::unique_ptr<Machine>>::MakeOk(std::move(machine));
+    } catch (const Exc& e) {
+        return Result<std::unique_ptr<Machine>>::MakeError(
+            ErrorCode::CircuitNotSupported,
+            "Cannot simulate circuit " + circuit_file + ": " + e.ToStd()
+        );
     } catch (const std::exception& e) {
         return Result<std::unique_ptr<Machine>>::MakeError(
             ErrorCode::InternalError,
@@ -65,14 +187,14 @@ Result<std::unique_ptr<Machine>> EngineFacade::CreateMachineFromCircuit(const st
 }
 
 // Implementation of SaveSnapshot
-Result<bool> EngineFacade::SaveSnapshot(const Machine& machine, const std::string& snapshot_path) {
+Result<bool> EngineFacade::SaveSnapshot(Machine& machine, const std::string& snapshot_path, bool delta) {
     try {
         // Create the snapshot directory if it doesn't exist
         fs::path snap_path(snapshot_path);
         fs::create_directories(snap_path.parent_path());
 
         // Use the MachineSnapshot class to serialize the machine state
-        bool success = MachineSnapshot::SerializeToFile(machine, snapshot_path);
+        bool success = MachineSnapshot::SerializeToFile(machine, snapshot_path, delta);
 
         if (!success) {
             return Result<bool>::MakeError(
@@ -99,19 +221,26 @@ Result<bool> EngineFacade::SaveSnapshot(const Machine& machine, const std::strin
 }
 
 // Implementation of LoadFromSnapshot
-Result<std::unique_ptr<Machine>> EngineFacade::LoadFromSnapshot(const std::string& snapshot_path) {
+Result<std::unique_ptr<Machine>> EngineFacade::LoadFromSnapshot(const std::vector<std::string>& chain, const std::string& circuit_file) {
     try {
-        // Create a new Machine instance
-        auto machine = std::make_unique<Machine>();
+        // Build and initialize the Machine from the circuit; this also rebuilds the
+        // schedules, which aren't part of the snapshot
+        auto machine_result = CreateMachineFromCircuit(circuit_file);
+        if (!machine_result.ok) {
+            return machine_result;
+        }
+        auto machine = std::move(machine_result.data);
 
-        // Use the MachineSnapshot class to deserialize the machine state
-        bool success = MachineSnapshot::DeserializeFromFile(*machine, snapshot_path);
+        // Use the MachineSnapshot class to restore the full image, then apply the deltas
+        for (const std::string& snapshot_path : chain) {
+            bool success = MachineSnapshot::DeserializeFromFile(*machine, snapshot_path);
 
-        if (!success) {
-            return Result<std::unique_ptr<Machine>>::MakeError(
-                ErrorCode::StorageIoError,
-                "Failed to deserialize machine state from snapshot file: " + snapshot_path
-            );
+            if (!success) {
+                return Result<std::unique_ptr<Machine>>::MakeError(
+                    ErrorCode::StorageIoError,
+                    "Failed to deserialize machine state from snapshot file: " + snapshot_path
+                );
+            }
         }
 
         return Result<std::unique_ptr<Machine>>::MakeOk(std::move(machine));
@@ -123,6 +252,57 @@ Result<std::unique_ptr<Machine>> EngineFacade::LoadFromSnapshot(const std::strin
     }
 }
 
+static bool IsDeltaSnapshotFile(const std::string& path) {
+    static const std::string suffix = ".delta.bin";
+    return path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static int GetSnapshotSequence(const std::string& path) {
+    std::string name = fs::path(path).filename().string();
+    return std::atoi(name.c_str() + std::string("snapshot_").size());
+}
+
+std::vector<std::string> EngineFacade::ListSnapshotFiles(const std::string& session_dir) const {
+    std::string snapshots_dir = session_dir + "/snapshots";
+    std::vector<std::string> snapshot_files;
+
+    if (!fs::exists(snapshots_dir)) {
+        return snapshot_files;
+    }
+
+    for (const auto& entry : fs::directory_iterator(snapshots_dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".bin") {
+            snapshot_files.push_back(entry.path().string());
+        }
+    }
+
+    // Sequence numbers are zero padded, so this sorts by sequence
+    std::sort(snapshot_files.begin(), snapshot_files.end());
+    return snapshot_files;
+}
+
+std::vector<std::string> EngineFacade::GetSnapshotChain(const std::string& session_dir) const {
+    std::vector<std::string> snapshot_files = ListSnapshotFiles(session_dir);
+
+    // Walk back from the latest snapshot to the full image it's based on
+    for (int i = (int)snapshot_files.size() - 1; i >= 0; i--) {
+        if (!IsDeltaSnapshotFile(snapshot_files[i])) {
+            return std::vector<std::string>(snapshot_files.begin() + i, snapshot_files.end());
+        }
+    }
+
+    return std::vector<std::string>();
+}
+
+void EngineFacade::PruneSnapshots(const std::string& session_dir, int first_kept) {
+    for (const std::string& path : ListSnapshotFiles(session_dir)) {
+        if (GetSnapshotSequence(path) < first_kept) {
+            std::error_code ec;
+            fs::remove(path, ec);
+        }
+    }
+}
+
 // Implementation of GetLatestSnapshotFileInternal
 std::string EngineFacade::GetLatestSnapshotFileInternal(const std::string& session_dir) {
     std::string snapshots_dir = session_dir + "/snapshots";
@@ -178,27 +358,19 @@ std::string EngineFacade::GetLatestSnapshotFile(const std::string& session_dir)
 }
 
 // Implementation of CreateNewSnapshotPath
-std::string EngineFacade::CreateNewSnapshotPath(const std::string& session_dir, int64 tick_count) {
+std::string EngineFacade::CreateNewSnapshotPath(const std::string& session_dir, int64 tick_count, bool delta) {
     std::string snapshots_dir = session_dir + "/snapshots";
     
     // Create snapshots directory if it doesn't exist
     fs::create_directories(snapshots_dir);
     
-    // Find the next available sequence number
-    int next_seq = 1;
-    std::string next_path = snapshots_dir + "/snapshot_" + 
-                           std::string(8, '0').substr(0, 8 - std::to_string(next_seq).length()) + 
-                           std::to_string(next_seq) + ".bin";
+    // Full and delta snapshots share one sequence, continuing after the latest one
+    std::vector<std::string> snapshot_files = ListSnapshotFiles(session_dir);
+    int next_seq = snapshot_files.empty() ? 1 : GetSnapshotSequence(snapshot_files.back()) + 1;
     
-    // Find the next available snapshot file name
-    while (fs::exists(next_path)) {
-        next_seq++;
-        next_path = snapshots_dir + "/snapshot_" + 
-                   std::string(8, '0').substr(0, 8 - std::to_string(next_seq).length()) + 
-                   std::to_string(next_seq) + ".bin";
-    }
-    
-    return next_path;
+    std::string seq = std::to_string(next_seq);
+    return snapshots_dir + "/snapshot_" + std::string(8 - std::min<size_t>(8, seq.length()), '0') + seq +
+           (delta ? ".delta.bin" : ".bin");
 }
 
 // Implementation of InitializeNewSession
@@ -269,29 +441,14 @@ Result<EngineSnapshotInfo> EngineFacade::LoadFromLatestSnapshot(
 
             out_machine = std::move(machine_result.data);
 
-            // Create a new snapshot at tick 0 based on the current circuit
-            std::string snapshot_path = CreateNewSnapshotPath(session_dir, 0);
-
-            auto save_result = SaveSnapshot(*out_machine, snapshot_path);
-            if (!save_result.ok) {
-                return Result<EngineSnapshotInfo>::MakeError(
-                    save_result.error_code,
-                    save_result.error_message
-                );
-            }
-
-            // Return that the machine was rebuilt and the new snapshot
-            EngineSnapshotInfo info;
-            info.total_ticks = 0;
-            info.snapshot_file = snapshot_path;
-            info.timestamp = GetCurrentTimestamp();
-
-            return Result<EngineSnapshotInfo>::MakeOk(info);
+            // Create a new snapshot at tick 0 based on the current circuit; the new
+            // Machine has no snapshot history, so this is a full one
+            return SnapshotMachine(session, *out_machine, session_dir);
         }
 
         // Circuit hasn't changed, proceed with loading the latest simulation snapshot
-        std::string latest_snapshot = GetLatestSnapshotFileInternal(session_dir);
-        if (latest_snapshot.empty()) {
+        std::vector<std::string> chain = GetSnapshotChain(session_dir);
+        if (chain.empty()) {
             return Result<EngineSnapshotInfo>::MakeError(
                 ErrorCode::StorageIoError,
                 "No snapshots found in session directory: " + session_dir
@@ -299,7 +456,7 @@ Result<EngineSnapshotInfo> EngineFacade::LoadFromLatestSnapshot(
         }
 
         // Load the machine from the snapshot
-        auto load_result = LoadFromSnapshot(latest_snapshot);
+        auto load_result = LoadFromSnapshot(chain, session.circuit_file);
         if (!load_result.ok) {
             return Result<EngineSnapshotInfo>::MakeError(
                 load_result.error_code,
@@ -312,7 +469,7 @@ Result<EngineSnapshotInfo> EngineFacade::LoadFromLatestSnapshot(
         // Create the EngineSnapshotInfo result
         EngineSnapshotInfo info;
         info.total_ticks = out_machine->current_tick;
-        info.snapshot_file = latest_snapshot;
+        info.snapshot_file = chain.back();
         info.timestamp = GetCurrentTimestamp();
 
         return Result<EngineSnapshotInfo>::MakeOk(info);
@@ -343,8 +500,29 @@ Result<EngineSnapshotInfo> EngineFacade::RunTicksAndSnapshot(
         }
 
         // Create a new snapshot after running the ticks
-        std::string snapshot_path = CreateNewSnapshotPath(session_dir, machine->current_tick);
-        auto save_result = SaveSnapshot(*machine, snapshot_path);
+        return SnapshotMachine(session, *machine, session_dir);
+    } catch (const std::exception& e) {
+        return Result<EngineSnapshotInfo>::MakeError(
+            ErrorCode::InternalError,
+            std::string("Exception in RunTicksAndSnapshot: ") + e.what()
+        );
+    }
+}
+
+// Implementation of SnapshotMachine
+Result<EngineSnapshotInfo> EngineFacade::SnapshotMachine(
+    SessionMetadata& session,
+    Machine& machine,
+    const std::string& session_dir
+) {
+    try {
+        // A delta is relative to the state this Machine last stored or loaded, which
+        // is the end of the current chain
+        std::vector<std::string> chain = GetSnapshotChain(session_dir);
+        bool delta = machine.CanStoreDelta() && !chain.empty() && (int)chain.size() <= MAX_DELTA_CHAIN;
+
+        std::string snapshot_path = CreateNewSnapshotPath(session_dir, machine.current_tick, delta);
+        auto save_result = SaveSnapshot(machine, snapshot_path, delta);
 
         if (!save_result.ok) {
             return Result<EngineSnapshotInfo>::MakeError(
@@ -353,9 +531,13 @@ Result<EngineSnapshotInfo> EngineFacade::RunTicksAndSnapshot(
             );
         }
 
-        // Create the EngineSnapshotInfo result
+        // Compaction: a new full image ends the current chain, keep it and drop the older ones
+        if (!delta && !chain.empty()) {
+            PruneSnapshots(session_dir, GetSnapshotSequence(chain.front()));
+        }
+
         EngineSnapshotInfo info;
-        info.total_ticks = machine->current_tick;
+        info.total_ticks = machine.current_tick;
         info.snapshot_file = snapshot_path;
         info.timestamp = GetCurrentTimestamp();
 
@@ -363,7 +545,7 @@ Result<EngineSnapshotInfo> EngineFacade::RunTicksAndSnapshot(
     } catch (const std::exception& e) {
         return Result<EngineSnapshotInfo>::MakeError(
             ErrorCode::InternalError,
-            std::string("Exception in RunTicksAndSnapshot: ") + e.what()
+            std::string("Exception in SnapshotMachine: ") + e.what()
         );
     }
 }
@@ -5,6 +5,7 @@
 #include <ProtoVM/ProtoVM.h>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace ProtoVMCLI {
 
@@ -49,6 +50,20 @@ public:
         const std::string& session_dir
     );
 
+    // Write a new snapshot of a live Machine without running it, e.g. when a
+    // resident session is flushed or evicted. This is a delta on top of the
+    // previous snapshot when possible, see MAX_DELTA_CHAIN.
+    Result<EngineSnapshotInfo> SnapshotMachine(
+        SessionMetadata& session,
+        Machine& machine,
+        const std::string& session_dir
+    );
+
+    // Snapshots form chains of a full image (snapshot_N.bin) followed by deltas
+    // (snapshot_N.delta.bin). After this many deltas the next snapshot is a full
+    // one again, and chains older than the previous one are deleted.
+    static const int MAX_DELTA_CHAIN = 16;
+
     // Export netlist for a given PCB; may or may not need a live Machine
     // depending on architecture.
     Result<std::string> ExportNetlist(
@@ -64,20 +79,31 @@ public:
     );
     
 private:
-    // Helper method to create a Machine from a circuit file
+    // Helper method to create an initialized Machine from a circuit file. NAND, NOR,
+    // XOR, XNOR and NOT gates are simulated; other parts are left out with a warning.
+    // Only a Machine that fails to initialize fails with ErrorCode::CircuitNotSupported.
     Result<std::unique_ptr<Machine>> CreateMachineFromCircuit(const std::string& circuit_file);
 
     // Helper method to save a snapshot of a Machine
-    Result<bool> SaveSnapshot(const Machine& machine, const std::string& snapshot_path);
+    Result<bool> SaveSnapshot(Machine& machine, const std::string& snapshot_path, bool delta = false);
+
+    // Helper method to load a Machine from a snapshot chain (a full snapshot and its
+    // deltas, in order). Snapshots hold state only, so the Machine is built from the
+    // circuit file first.
+    Result<std::unique_ptr<Machine>> LoadFromSnapshot(const std::vector<std::string>& chain, const std::string& circuit_file);
+
+    // Snapshot files of the session, sorted, and the chain ending with the latest one
+    std::vector<std::string> ListSnapshotFiles(const std::string& session_dir) const;
+    std::vector<std::string> GetSnapshotChain(const std::string& session_dir) const;
 
-    // Helper method to load a Machine from a snapshot
-    Result<std::unique_ptr<Machine>> LoadFromSnapshot(const std::string& snapshot_path);
+    // Delete the snapshots numbered below first_kept
+    void PruneSnapshots(const std::string& session_dir, int first_kept);
 
     // Helper method to get the latest snapshot file path (internal use)
     std::string GetLatestSnapshotFileInternal(const std::string& session_dir);
 
     // Helper method to create a new snapshot file path
-    std::string CreateNewSnapshotPath(const std::string& session_dir, int64 tick_count);
+    std::string CreateNewSnapshotPath(const std::string& session_dir, int64 tick_count, bool delta = false);
 
 public:
     // Public method to get the latest snapshot file path (needed for queries)
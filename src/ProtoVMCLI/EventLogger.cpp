@@ -3,6 +3,19 @@
 #include <fstream>
 #include <chrono>
 #include <iomanip>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#ifdef PLATFORM_POSIX
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -18,42 +31,471 @@ std::string GetCurrentTimestamp() {
     return std::string(buffer);
 }
 
+// Journals stay open between events; this many sessions are kept open at once
+static const size_t MAX_OPEN_JOURNALS = 32;
+
+struct IndexEntry {
+    int64_t offset;
+    int64_t revision;
+    uint32_t branch_hash;
+    uint32_t length;
+};
+
+// data_size and entry_count are re-read under the JournalLock on every use, as other
+// processes append to the same files
+struct Journal {
+    std::string session_dir;
+    std::fstream data;
+    std::fstream index;
+    int64_t data_size = 0;
+    int64_t entry_count = 0;
+    std::list<std::string>::iterator lru_pos;
+};
+
+static std::mutex journal_mutex;
+static std::map<std::string, std::unique_ptr<Journal>> open_journals;
+static std::list<std::string> journal_lru;  // most recently used first
+
+// Held around every read and append of a session's journal: journal_mutex keeps out
+// the other threads, an flock on <session>/events.lock the other processes
+class JournalLock {
+public:
+    explicit JournalLock(const std::string& session_dir) : lock_(journal_mutex) {
+#ifdef PLATFORM_POSIX
+        // Without O_CREAT's directory, a deleted session fails here
+        fd_ = open((session_dir + "/events.lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        int rc = -1;
+        if (fd_ >= 0) {
+            while ((rc = flock(fd_, LOCK_EX)) < 0 && errno == EINTR) {}
+        }
+        if (rc < 0) {
+            std::string error = std::strerror(errno);
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+            throw std::runtime_error("Could not lock the event journal: " + error);
+        }
+#endif
+    }
+
+    ~JournalLock() {
+#ifdef PLATFORM_POSIX
+        close(fd_);  // releases the flock
+#endif
+    }
+
+    JournalLock(const JournalLock&) = delete;
+    JournalLock& operator=(const JournalLock&) = delete;
+
+private:
+    std::lock_guard<std::mutex> lock_;
+    int fd_ = -1;
+};
+
+static void DropJournal(const std::string& session_dir) {
+    auto it = open_journals.find(session_dir);
+    if (it != open_journals.end()) {
+        journal_lru.erase(it->second->lru_pos);
+        open_journals.erase(it);
+    }
+}
+
+template <class T>
+static void PutRaw(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+static void PutString(std::string& out, const std::string& s) {
+    PutRaw<uint32_t>(out, (uint32_t)s.size());
+    out += s;
+}
+
+// Bounds checked reader for a record
+struct RecordReader {
+    const std::string& data;
+    size_t pos = 0;
+    bool ok = true;
+
+    explicit RecordReader(const std::string& d) : data(d) {}
+
+    template <class T>
+    T Get() {
+        T v = T();
+        if (!ok || pos + sizeof(T) > data.size()) {
+            ok = false;
+            return v;
+        }
+        std::copy(data.data() + pos, data.data() + pos + sizeof(T), reinterpret_cast<char*>(&v));
+        pos += sizeof(T);
+        return v;
+    }
+
+    std::string GetString() {
+        uint32_t len = Get<uint32_t>();
+        if (!ok || pos + len > data.size()) {
+            ok = false;
+            return std::string();
+        }
+        std::string s = data.substr(pos, len);
+        pos += len;
+        return s;
+    }
+};
+
+uint32_t EventLogger::HashBranch(const std::string& branch_name) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (unsigned char c : branch_name) {
+        h ^= c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static std::string EncodeEvent(const EventLogEntry& entry) {
+    std::string out;
+    PutRaw<int64_t>(out, entry.revision);
+    PutRaw<int32_t>(out, entry.session_id);
+    PutString(out, entry.branch);
+    PutString(out, entry.timestamp);
+    PutString(out, entry.user_id);
+    PutString(out, entry.command);
+    PutString(out, entry.params);
+    PutString(out, entry.result);
+    PutString(out, entry.payload);
+    return out;
+}
+
+static bool DecodeEvent(const std::string& record, EventLogEntry& entry) {
+    RecordReader r(record);
+    entry.revision = r.Get<int64_t>();
+    entry.session_id = r.Get<int32_t>();
+    entry.branch = r.GetString();
+    entry.timestamp = r.GetString();
+    entry.user_id = r.GetString();
+    entry.command = r.GetString();
+    entry.params = r.GetString();
+    entry.result = r.GetString();
+    entry.payload = r.GetString();
+    return r.ok && r.pos == record.size();
+}
+
+static bool RebuildIndex(Journal& journal);
+
+// Value of a string field of a legacy events.log line, which was written without escaping
+static std::string GetLegacyField(const std::string& line, const std::string& name) {
+    std::string key = "\"" + name + "\":\"";
+    size_t begin = line.find(key);
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    begin += key.size();
+    size_t end = line.find('"', begin);
+    return line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+// Converts the JSON lines of a legacy events.log into the journal, once, before the
+// journal is first opened. Those events have no revision and no edit payload, so they
+// are kept as history only; CircuitFacade refuses to replay the revisions they stand for.
+static bool ImportLegacyLog(const std::string& session_dir) {
+    std::string data_file = session_dir + "/events.journal";
+    std::string tmp_file = data_file + ".tmp";
+
+    std::ifstream in(session_dir + "/events.log");
+    std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+    if (!in.is_open() || !out.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        EventLogEntry entry;
+        entry.timestamp = GetLegacyField(line, "timestamp");
+        entry.user_id = GetLegacyField(line, "user_id");
+        entry.branch = GetLegacyField(line, "branch");
+        entry.command = GetLegacyField(line, "command");
+        size_t id_pos = line.find("\"session_id\":");
+        if (id_pos != std::string::npos) {
+            entry.session_id = std::atoi(line.c_str() + id_pos + 13);
+        }
+        // params and result were the last two fields, as raw JSON
+        size_t params_pos = line.find("\"params\":");
+        size_t result_pos = line.rfind(",\"result\":");
+        if (params_pos != std::string::npos && result_pos != std::string::npos && result_pos > params_pos) {
+            entry.params = line.substr(params_pos + 9, result_pos - params_pos - 9);
+            size_t end = line.rfind('}');
+            if (end > result_pos + 10) {
+                entry.result = line.substr(result_pos + 10, end - result_pos - 10);
+            }
+        }
+
+        std::string record = EncodeEvent(entry);
+        uint32_t length = (uint32_t)record.size();
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(record.data(), record.size());
+    }
+    out.close();
+    if (out.fail()) {
+        fs::remove(tmp_file);
+        return false;
+    }
+
+    // The index is rebuilt from the journal when it is opened
+    fs::remove(session_dir + "/events.idx");
+    fs::rename(tmp_file, data_file);
+    return true;
+}
+
+static Journal* OpenJournal(const std::string& session_dir) {
+    auto it = open_journals.find(session_dir);
+    if (it != open_journals.end()) {
+        Journal* journal = it->second.get();
+        journal_lru.splice(journal_lru.begin(), journal_lru, journal->lru_pos);
+        return journal;
+    }
+
+    // Close the least recently used journal, not one that may be in active use
+    if (open_journals.size() >= MAX_OPEN_JOURNALS) {
+        DropJournal(journal_lru.back());
+    }
+
+    // Don't bring back a deleted session
+    if (!fs::is_directory(session_dir)) {
+        return nullptr;
+    }
+    std::string data_file = session_dir + "/events.journal";
+    std::string index_file = session_dir + "/events.idx";
+
+    // Sessions from before the journal logged to events.log
+    if (!fs::exists(data_file) && fs::exists(session_dir + "/events.log") && !ImportLegacyLog(session_dir)) {
+        return nullptr;
+    }
+
+    // fstream in read/write mode doesn't create files
+    std::ofstream(data_file, std::ios::app | std::ios::binary).close();
+    std::ofstream(index_file, std::ios::app | std::ios::binary).close();
+
+    auto journal = std::make_unique<Journal>();
+    journal->session_dir = session_dir;
+    journal->data.open(data_file, std::ios::in | std::ios::out | std::ios::binary);
+    journal->index.open(index_file, std::ios::in | std::ios::out | std::ios::binary);
+    if (!journal->data.is_open() || !journal->index.is_open()) {
+        return nullptr;
+    }
+
+    Journal* ptr = journal.get();
+    journal_lru.push_front(session_dir);
+    ptr->lru_pos = journal_lru.begin();
+    open_journals[session_dir] = std::move(journal);
+    return ptr;
+}
+
+// Picks up what other processes appended since the journal was last used, and repairs
+// the index if it doesn't end with the last record. Called under the JournalLock.
+static bool SyncJournal(Journal& journal) {
+    journal.data_size = (int64_t)fs::file_size(journal.session_dir + "/events.journal");
+    int64_t index_size = (int64_t)fs::file_size(journal.session_dir + "/events.idx");
+    journal.entry_count = index_size / (int64_t)sizeof(IndexEntry);
+    journal.data.clear();
+    journal.index.clear();
+
+    // The index is written after the record, so a crash in between leaves it short
+    bool valid = index_size % (int64_t)sizeof(IndexEntry) == 0;
+    if (valid && journal.entry_count > 0) {
+        IndexEntry last;
+        journal.index.seekg((journal.entry_count - 1) * (int64_t)sizeof(IndexEntry));
+        valid = (bool)journal.index.read(reinterpret_cast<char*>(&last), sizeof(last)) &&
+                last.offset + (int64_t)sizeof(uint32_t) + last.length == journal.data_size;
+        journal.index.clear();
+    }
+    else if (valid) {
+        valid = journal.data_size == 0;
+    }
+
+    return valid || RebuildIndex(journal);
+}
+
+static bool RebuildIndex(Journal& journal) {
+    std::string data_file = journal.session_dir + "/events.journal";
+    std::string index_file = journal.session_dir + "/events.idx";
+
+    journal.index.close();
+    journal.index.open(index_file, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!journal.index.is_open()) {
+        return false;
+    }
+
+    // Index every complete record; a torn record at the end is cut off
+    int64_t offset = 0;
+    journal.entry_count = 0;
+    journal.data.clear();
+    journal.data.seekg(0);
+    while (offset + (int64_t)sizeof(uint32_t) <= journal.data_size) {
+        uint32_t length = 0;
+        if (!journal.data.read(reinterpret_cast<char*>(&length), sizeof(length)) ||
+            offset + (int64_t)sizeof(uint32_t) + length > journal.data_size) {
+            break;
+        }
+
+        std::string record(length, '\0');
+        EventLogEntry entry;
+        if (!journal.data.read(&record[0], length) || !DecodeEvent(record, entry)) {
+            break;
+        }
+
+        IndexEntry ie;
+        ie.offset = offset;
+        ie.revision = entry.revision;
+        ie.branch_hash = EventLogger::HashBranch(entry.branch);
+        ie.length = length;
+        journal.index.write(reinterpret_cast<const char*>(&ie), sizeof(ie));
+        journal.entry_count++;
+        offset += sizeof(uint32_t) + length;
+    }
+    journal.index.flush();
+
+    if (offset != journal.data_size) {
+        journal.data.close();
+        fs::resize_file(data_file, offset);
+        journal.data.open(data_file, std::ios::in | std::ios::out | std::ios::binary);
+        journal.data_size = offset;
+    }
+
+    journal.data.clear();
+    return journal.data.is_open() && journal.index.good();
+}
+
 bool EventLogger::LogEvent(const std::string& session_dir, const EventLogEntry& entry) {
+    return LogEvents(session_dir, std::vector<EventLogEntry>(1, entry));
+}
+
+bool EventLogger::LogEvents(const std::string& session_dir, const std::vector<EventLogEntry>& entries) {
     try {
-        // Create the events log file path
-        std::string events_file = session_dir + "/events.log";
-        
-        // Open the events log file in append mode
-        std::ofstream file(events_file, std::ios::app);
-        if (!file.is_open()) {
+        JournalLock lock(session_dir);
+
+        Journal* journal = OpenJournal(session_dir);
+        if (!journal || !SyncJournal(*journal)) {
+            DropJournal(session_dir);
+            return false;
+        }
+
+        // Records first, then their index entries
+        std::string records;
+        std::string index;
+        for (const EventLogEntry& entry : entries) {
+            std::string record = EncodeEvent(entry);
+            uint32_t length = (uint32_t)record.size();
+
+            IndexEntry ie;
+            ie.offset = journal->data_size + (int64_t)records.size();
+            ie.revision = entry.revision;
+            ie.branch_hash = HashBranch(entry.branch);
+            ie.length = length;
+            index.append(reinterpret_cast<const char*>(&ie), sizeof(ie));
+
+            PutRaw<uint32_t>(records, length);
+            records += record;
+        }
+
+        journal->data.seekp(journal->data_size);
+        journal->data.write(records.data(), records.size());
+        journal->data.flush();
+        journal->index.seekp(journal->entry_count * (int64_t)sizeof(IndexEntry));
+        journal->index.write(index.data(), index.size());
+        journal->index.flush();
+
+        if (!journal->data.good() || !journal->index.good()) {
+            // None of the entries are logged: cut off whatever part reached the files
+            int64_t data_size = journal->data_size;
+            int64_t index_size = journal->entry_count * (int64_t)sizeof(IndexEntry);
+            DropJournal(session_dir);
+            std::error_code ec;
+            fs::resize_file(session_dir + "/events.journal", data_size, ec);
+            fs::resize_file(session_dir + "/events.idx", index_size, ec);
             return false;
         }
-        
-        // Format the event as a JSON line
-        std::string json_line = FormatEventAsJson(entry);
-        
-        // Write the event to the file
-        file << json_line << std::endl;
-        file.close();
-        
+
+        journal->data_size += (int64_t)records.size();
+        journal->entry_count += (int64_t)entries.size();
         return true;
     } catch (const std::exception& e) {
         return false;
     }
 }
 
-std::string EventLogger::FormatEventAsJson(const EventLogEntry& entry) {
-    std::string json = "{";
-    json += "\"timestamp\":\"" + entry.timestamp + "\",";
-    json += "\"user_id\":\"" + entry.user_id + "\",";
-    json += "\"session_id\":" + std::to_string(entry.session_id) + ",";
-    json += "\"branch\":\"" + entry.branch + "\",";
-    json += "\"command\":\"" + entry.command + "\",";
-    json += "\"params\":" + entry.params + ",";
-    json += "\"result\":" + entry.result;
-    json += "}";
+bool EventLogger::ReadEvents(
+    const std::string& session_dir,
+    const std::string& branch_name,
+    int64_t from_revision,
+    int64_t to_revision,
+    std::vector<EventLogEntry>& out
+) {
+    try {
+        JournalLock lock(session_dir);
+
+        Journal* journal = OpenJournal(session_dir);
+        if (!journal || !SyncJournal(*journal)) {
+            DropJournal(session_dir);
+            return false;
+        }
+
+        // Revisions of a branch grow along the journal, so walk the index backwards
+        // and stop at the first event of the branch that precedes the range
+        uint32_t branch_hash = HashBranch(branch_name);
+        std::vector<IndexEntry> matches;
+        std::vector<IndexEntry> chunk;
+        const int64_t chunk_size = 1024;
+        bool done = false;
+
+        for (int64_t end = journal->entry_count; end > 0 && !done; end -= chunk_size) {
+            int64_t begin = std::max<int64_t>(0, end - chunk_size);
+            chunk.resize(end - begin);
+            journal->index.clear();
+            journal->index.seekg(begin * (int64_t)sizeof(IndexEntry));
+            if (!journal->index.read(reinterpret_cast<char*>(chunk.data()), chunk.size() * sizeof(IndexEntry))) {
+                return false;
+            }
+
+            for (auto it = chunk.rbegin(); it != chunk.rend(); ++it) {
+                if (it->branch_hash != branch_hash || it->revision < 0) {
+                    continue;
+                }
+                if (it->revision < from_revision) {
+                    done = true;
+                    break;
+                }
+                if (it->revision <= to_revision) {
+                    matches.push_back(*it);
+                }
+            }
+        }
+
+        journal->data.clear();
+        for (auto it = matches.rbegin(); it != matches.rend(); ++it) {
+            std::string record(it->length, '\0');
+            journal->data.seekg(it->offset + (int64_t)sizeof(uint32_t));
+            EventLogEntry entry;
+            if (!journal->data.read(&record[0], it->length) || !DecodeEvent(record, entry)) {
+                return false;
+            }
+            // The index only has the branch hash
+            if (entry.branch == branch_name) {
+                out.push_back(std::move(entry));
+            }
+        }
+
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
 
-    return json;
+void EventLogger::CloseJournal(const std::string& session_dir) {
+    std::lock_guard<std::mutex> lock(journal_mutex);
+    DropJournal(session_dir);
 }
 
-} // namespace ProtoVMCLI
\ No newline at end of file
+} // namespace ProtoVMCLI
@@ -3,7 +3,9 @@
 
 #include "SessionTypes.h"
 #include <string>
+#include <vector>
 #include <fstream>
+#include <cstdint>
 
 namespace ProtoVMCLI {
 
@@ -15,18 +17,42 @@ struct EventLogEntry {
     std::string params;  // JSON string
     std::string result;  // JSON string
     std::string branch;  // Branch name for this event
+    int64_t revision;    // Circuit revision of a circuit edit, -1 for other events
+    std::string payload; // Encoded edit operation, replayed by CircuitFacade
 
-    EventLogEntry() : session_id(0) {}
+    EventLogEntry() : session_id(0), revision(-1) {}
 };
 
+// Events are appended to a binary journal (events.journal) of length prefixed
+// records. A sidecar index (events.idx) holds one fixed size entry per record,
+// so a revision range is read by seeking to its records instead of parsing the
+// whole log. The index is rebuilt from the journal if it doesn't match it.
+// Every call locks the journal against other threads and processes (flock on
+// events.lock) and re-reads its size, so appends from other processes are seen.
+// A legacy events.log is imported into a new journal once, as history only.
 class EventLogger {
 public:
     static bool LogEvent(const std::string& session_dir, const EventLogEntry& entry);
-    
-private:
-    static std::string FormatEventAsJson(const EventLogEntry& entry);
+
+    // Appends all entries or, on failure, none of them
+    static bool LogEvents(const std::string& session_dir, const std::vector<EventLogEntry>& entries);
+
+    // Reads the events of a branch with from_revision <= revision <= to_revision,
+    // in the order they were logged
+    static bool ReadEvents(
+        const std::string& session_dir,
+        const std::string& branch_name,
+        int64_t from_revision,
+        int64_t to_revision,
+        std::vector<EventLogEntry>& out
+    );
+
+    // Closes the open journal files of a session, e.g. before it is deleted
+    static void CloseJournal(const std::string& session_dir);
+
+    static uint32_t HashBranch(const std::string& branch_name);
 };
 
 } // namespace ProtoVMCLI
 
-#endif
\ No newline at end of file
+#endif
@@ -8,6 +8,19 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <map>
+#include <set>
+#include <mutex>
+#include <memory>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef PLATFORM_POSIX
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -46,6 +59,348 @@ bool AtomicWriteJsonFile(const fs::path& file_path, const Upp::String& content)
     }
 }
 
+// Workspace-wide catalog of session metadata in sessions/catalog.bin, so that
+// listing sessions and allocating ids don't open every session.json. It's an
+// append log: a header {magic, uint64 generation} followed by records
+// {uint32 length, payload}, each one a put, delete or corrupt mark of a session,
+// the latest record of a session winning. Once most records are dead the log is
+// rewritten with the next generation. session.json stays authoritative: a missing
+// or damaged catalog is rebuilt by scanning the session directories once, and so
+// is any catalog on an explicit RebuildSessionCatalog.
+// Changes to a session directory are bracketed by records: an intent record goes
+// to disk first, and the put or delete record once the directory changed. An
+// intent without its record is a writer that died in between, and only that
+// session is reloaded from its directory by the next user of the catalog.
+static const char CATALOG_MAGIC[8] = {'P', 'V', 'M', 'S', 'C', 'A', 'T', '1'};
+static const int64_t CATALOG_HEADER_SIZE = 16;
+
+enum CatalogOp : uint8_t {
+    CATALOG_PUT = 1,
+    CATALOG_DELETE = 2,
+    CATALOG_CORRUPT = 3,
+    CATALOG_INTENT = 4,  // the session directory is about to change
+};
+
+struct SessionCatalog {
+    fs::path file;
+    uint64_t generation = 0;
+    int64_t size = 0;            // bytes of the file applied below, 0 before reading
+    bool torn = false;           // an unfinished record follows size
+    int64_t record_count = 0;
+    std::map<int, SessionMetadata> sessions;
+    std::map<int, std::set<int>> by_state;  // session ids by SessionState
+    std::set<int> corrupt;
+    std::set<int> pending;       // intents not yet followed by a record of the session
+    int next_id = 1;             // above every id ever recorded
+};
+
+// Catalogs stay loaded and are brought up to date from the file on each use, which
+// also picks up records appended by other processes
+static std::mutex catalog_mutex;
+static std::map<std::string, std::unique_ptr<SessionCatalog>> catalogs;
+
+// Held around every use of a workspace's catalog, from reading it through
+// allocating an id to appending the record: catalog_mutex keeps out the other
+// threads, an flock on sessions/catalog.lock the other processes
+class CatalogLock {
+public:
+    explicit CatalogLock(const fs::path& sessions_dir) : lock_(catalog_mutex) {
+#ifdef PLATFORM_POSIX
+        fd_ = open((sessions_dir / "catalog.lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        int rc = -1;
+        if (fd_ >= 0) {
+            while ((rc = flock(fd_, LOCK_EX)) < 0 && errno == EINTR) {}
+        }
+        if (rc < 0) {
+            std::string error = std::strerror(errno);
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+            throw std::runtime_error("Could not lock the session catalog: " + error);
+        }
+#endif
+    }
+
+    ~CatalogLock() {
+#ifdef PLATFORM_POSIX
+        close(fd_);  // releases the flock
+#endif
+    }
+
+    CatalogLock(const CatalogLock&) = delete;
+    CatalogLock& operator=(const CatalogLock&) = delete;
+
+private:
+    std::lock_guard<std::mutex> lock_;
+    int fd_ = -1;
+};
+
+template <class T>
+static void PutRaw(std::string& out, T v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+static void PutString(std::string& out, const std::string& s) {
+    PutRaw<uint32_t>(out, (uint32_t)s.size());
+    out += s;
+}
+
+// Bounds checked reader for a record
+struct CatalogReader {
+    const std::string& data;
+    size_t pos = 0;
+    bool ok = true;
+
+    explicit CatalogReader(const std::string& d) : data(d) {}
+
+    template <class T>
+    T Get() {
+        T v = T();
+        if (!ok || pos + sizeof(T) > data.size()) {
+            ok = false;
+            return v;
+        }
+        std::copy(data.data() + pos, data.data() + pos + sizeof(T), reinterpret_cast<char*>(&v));
+        pos += sizeof(T);
+        return v;
+    }
+
+    std::string GetString() {
+        uint32_t len = Get<uint32_t>();
+        if (!ok || pos + len > data.size()) {
+            ok = false;
+            return std::string();
+        }
+        std::string s = data.substr(pos, len);
+        pos += len;
+        return s;
+    }
+};
+
+static std::string EncodeCatalogRecord(CatalogOp op, int session_id, const SessionMetadata* metadata = nullptr) {
+    std::string out;
+    PutRaw<uint8_t>(out, op);
+    PutRaw<int32_t>(out, session_id);
+    if (op == CATALOG_PUT) {
+        PutRaw<int32_t>(out, static_cast<int32_t>(metadata->state));
+        PutString(out, metadata->circuit_file);
+        PutString(out, metadata->workspace);
+        PutString(out, metadata->created_at);
+        PutString(out, metadata->last_used_at);
+        PutRaw<int32_t>(out, metadata->total_ticks);
+        PutRaw<int32_t>(out, metadata->circuit_revision);
+        PutRaw<int32_t>(out, metadata->sim_revision);
+        PutString(out, metadata->current_branch);
+        PutRaw<uint32_t>(out, (uint32_t)metadata->branches.size());
+        for (const auto& branch : metadata->branches) {
+            PutString(out, branch.name);
+            PutRaw<int64_t>(out, branch.head_revision);
+            PutRaw<int64_t>(out, branch.sim_revision);
+            PutRaw<int64_t>(out, branch.base_revision);
+            PutRaw<uint8_t>(out, branch.is_default);
+        }
+    }
+    return out;
+}
+
+static void RemoveFromCatalog(SessionCatalog& cat, int session_id) {
+    auto it = cat.sessions.find(session_id);
+    if (it != cat.sessions.end()) {
+        cat.by_state[static_cast<int>(it->second.state)].erase(session_id);
+        cat.sessions.erase(it);
+    }
+    cat.corrupt.erase(session_id);
+}
+
+static bool ApplyCatalogRecord(SessionCatalog& cat, const std::string& record) {
+    CatalogReader r(record);
+    uint8_t op = r.Get<uint8_t>();
+    int session_id = r.Get<int32_t>();
+    if (!r.ok || session_id < 0) {
+        return false;
+    }
+
+    if (op == CATALOG_PUT) {
+        SessionMetadata metadata;
+        metadata.session_id = session_id;
+        metadata.state = static_cast<SessionState>(r.Get<int32_t>());
+        metadata.circuit_file = r.GetString();
+        metadata.workspace = r.GetString();
+        metadata.created_at = r.GetString();
+        metadata.last_used_at = r.GetString();
+        metadata.total_ticks = r.Get<int32_t>();
+        metadata.circuit_revision = r.Get<int32_t>();
+        metadata.sim_revision = r.Get<int32_t>();
+        metadata.current_branch = r.GetString();
+        uint32_t branch_count = r.Get<uint32_t>();
+        metadata.branches.clear();
+        for (uint32_t i = 0; i < branch_count && r.ok; i++) {
+            BranchMetadata branch;
+            branch.name = r.GetString();
+            branch.head_revision = r.Get<int64_t>();
+            branch.sim_revision = r.Get<int64_t>();
+            branch.base_revision = r.Get<int64_t>();
+            branch.is_default = r.Get<uint8_t>() != 0;
+            metadata.branches.push_back(branch);
+        }
+        if (!r.ok || r.pos != record.size()) {
+            return false;
+        }
+        RemoveFromCatalog(cat, session_id);
+        cat.by_state[static_cast<int>(metadata.state)].insert(session_id);
+        cat.sessions[session_id] = std::move(metadata);
+    }
+    else if (op == CATALOG_DELETE || op == CATALOG_CORRUPT) {
+        if (r.pos != record.size()) {
+            return false;
+        }
+        RemoveFromCatalog(cat, session_id);
+        if (op == CATALOG_CORRUPT) {
+            cat.corrupt.insert(session_id);
+        }
+    }
+    else if (op == CATALOG_INTENT) {
+        if (r.pos != record.size()) {
+            return false;
+        }
+        cat.pending.insert(session_id);
+    }
+    else {
+        return false;
+    }
+    if (op != CATALOG_INTENT) {
+        cat.pending.erase(session_id);
+    }
+
+    cat.next_id = std::max(cat.next_id, session_id + 1);
+    cat.record_count++;
+    return true;
+}
+
+// Applies the records past cat.size. Returns false if the file isn't a
+// continuation of what cat holds, or is damaged before its last record. A last
+// record that is incomplete or doesn't decode is a write that never finished, as
+// the reader holds the CatalogLock: it's skipped and marked in cat.torn.
+static bool ReadCatalog(SessionCatalog& cat) {
+    std::ifstream in(cat.file, std::ios::binary);
+    char magic[sizeof(CATALOG_MAGIC)];
+    uint64_t generation = 0;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, CATALOG_MAGIC, sizeof(magic)) != 0 ||
+        !in.read(reinterpret_cast<char*>(&generation), sizeof(generation))) {
+        return false;
+    }
+
+    int64_t file_size = (int64_t)fs::file_size(cat.file);
+    if (cat.size == 0) {
+        cat.generation = generation;
+        cat.size = CATALOG_HEADER_SIZE;
+    }
+    else if (generation != cat.generation || file_size < cat.size) {
+        return false;
+    }
+
+    cat.torn = false;
+    in.seekg(cat.size);
+    while (cat.size < file_size) {
+        uint32_t length = 0;
+        int64_t end = cat.size + (int64_t)sizeof(uint32_t);
+        bool complete = end <= file_size && in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        std::string record;
+        if (complete) {
+            end += length;
+            record.resize(length);
+            complete = end <= file_size && in.read(&record[0], length);
+        }
+        if (!complete || !ApplyCatalogRecord(cat, record)) {
+            if (end < file_size) {
+                return false;
+            }
+            cat.torn = true;
+            break;
+        }
+        cat.size = end;
+    }
+    return true;
+}
+
+// Rewrites the log with one record per live session, under the next generation
+static bool WriteCatalog(SessionCatalog& cat) {
+    std::string out(CATALOG_MAGIC, sizeof(CATALOG_MAGIC));
+    PutRaw<uint64_t>(out, cat.generation + 1);
+
+    int64_t record_count = 0;
+    auto add = [&](const std::string& record) {
+        PutRaw<uint32_t>(out, (uint32_t)record.size());
+        out += record;
+        record_count++;
+    };
+    for (const auto& entry : cat.sessions) {
+        add(EncodeCatalogRecord(CATALOG_PUT, entry.first, &entry.second));
+    }
+    for (int session_id : cat.corrupt) {
+        add(EncodeCatalogRecord(CATALOG_CORRUPT, session_id));
+    }
+    // A change may be under way in this very process
+    for (int session_id : cat.pending) {
+        add(EncodeCatalogRecord(CATALOG_INTENT, session_id));
+    }
+    // Keeps the ids of deleted sessions from being handed out again
+    if (cat.next_id > 1 && !cat.sessions.count(cat.next_id - 1) && !cat.corrupt.count(cat.next_id - 1)) {
+        add(EncodeCatalogRecord(CATALOG_DELETE, cat.next_id - 1));
+    }
+
+    fs::path temp_path = cat.file;
+    temp_path += ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.write(out.data(), out.size()) || !file.flush()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp_path, cat.file, ec);
+    if (ec) {
+        return false;
+    }
+
+    cat.generation++;
+    cat.size = (int64_t)out.size();
+    cat.torn = false;
+    cat.record_count = record_count;
+    return true;
+}
+
+static bool AppendCatalogRecord(SessionCatalog& cat, const std::string& record) {
+    std::string buffer;
+    PutRaw<uint32_t>(buffer, (uint32_t)record.size());
+    buffer += record;
+
+    // Overwrite the unfinished record of a writer that died. Only ReadCatalog
+    // decides that, right before under the same CatalogLock, so every complete
+    // record of another process has been applied and stays.
+    if (cat.torn) {
+        fs::resize_file(cat.file, cat.size);
+        cat.torn = false;
+    }
+    {
+        std::fstream file(cat.file, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(cat.size);
+        if (!file.write(buffer.data(), buffer.size()) || !file.flush()) {
+            return false;
+        }
+    }
+    if (!ApplyCatalogRecord(cat, record)) {
+        return false;
+    }
+    cat.size += buffer.size();
+
+    int64_t live = (int64_t)(cat.sessions.size() + cat.corrupt.size() + cat.pending.size());
+    if (cat.record_count > 2 * live + 256) {
+        WriteCatalog(cat);  // on failure the longer log remains valid
+    }
+    return true;
+}
+
 class JsonFilesystemSessionStore : public ISessionStore {
 public:
     JsonFilesystemSessionStore(const std::string& workspace_path)
@@ -55,15 +410,24 @@ public:
 
     Result<int> CreateSession(const SessionCreateInfo& info) override {
         try {
-            // Find next available session ID from workspace.json
-            int next_id = GetNextSessionId();
-
             // Create workspace/sessions directory if it doesn't exist
             if (!fs::exists(sessions_dir_)) {
                 fs::create_directories(sessions_dir_);
             }
 
+            // Held until the session is in the catalog, so that no one else takes the id
+            CatalogLock lock(sessions_dir_);
+
+            // Next available session ID: the catalog remembers deleted ids too, and
+            // workspace.json is honored for workspaces written without a catalog
+            SessionCatalog* catalog = OpenCatalog();
+            int next_id = GetNextSessionId();
+            if (catalog) {
+                next_id = std::max(next_id, catalog->next_id);
+            }
+
             fs::path session_dir = sessions_dir_ / std::to_string(next_id);
+            BeginCatalogChange(next_id);
             fs::create_directories(session_dir);
 
             // Copy circuit file to session directory
@@ -120,6 +484,7 @@ public:
                 return Result<int>::MakeError(ErrorCode::StorageIoError,
                                              "Could not create session metadata file");
             }
+            UpdateCatalog(EncodeCatalogRecord(CATALOG_PUT, next_id, &metadata));
 
             // Update workspace.json with the new next_session_id
             if (!IncrementNextSessionId(next_id + 1)) {
@@ -480,11 +845,19 @@ public:
             json_content += "  \"engine_version\": \"unknown\"\n";  // Placeholder
             json_content += "}";
 
+            // Held across both writes, so that the catalog ends with the session.json
+            // that was written last
+            CatalogLock lock(sessions_dir_);
+            BeginCatalogChange(metadata.session_id);
             if (!AtomicWriteJsonFile(metadata_path, json_content)) {
                 return Result<bool>::MakeError(ErrorCode::StorageIoError,
                                               "Could not save session file");
             }
 
+            SessionMetadata saved = metadata;
+            saved.last_used_at = last_used_at;
+            UpdateCatalog(EncodeCatalogRecord(CATALOG_PUT, metadata.session_id, &saved));
+
             return Result<bool>::MakeOk(true);
         } catch (const std::exception& e) {
             return Result<bool>::MakeError(ErrorCode::StorageIoError,
@@ -493,6 +866,66 @@ public:
     }
 
     Result<ListSessionsResult> ListSessions() override {
+        try {
+            if (!fs::exists(sessions_dir_)) {
+                return Result<ListSessionsResult>::MakeOk(ListSessionsResult());
+            }
+
+            CatalogLock lock(sessions_dir_);
+            SessionCatalog* catalog = OpenCatalog();
+            if (!catalog) {
+                return ScanSessions();
+            }
+
+            ListSessionsResult result;
+            for (const auto& entry : catalog->sessions) {
+                result.sessions.push_back(entry.second);
+            }
+            result.corrupt_sessions.assign(catalog->corrupt.begin(), catalog->corrupt.end());
+            return Result<ListSessionsResult>::MakeOk(result);
+        } catch (const std::exception& e) {
+            return Result<ListSessionsResult>::MakeError(ErrorCode::InternalError,
+                                                        "Failed to list sessions: " + std::string(e.what()));
+        }
+    }
+
+    Result<ListSessionsResult> ListSessionsInState(SessionState state) override {
+        try {
+            if (!fs::exists(sessions_dir_)) {
+                return Result<ListSessionsResult>::MakeOk(ListSessionsResult());
+            }
+
+            CatalogLock lock(sessions_dir_);
+            SessionCatalog* catalog = OpenCatalog();
+            if (!catalog) {
+                // Not through ListSessions, which would take the lock again
+                auto scan = ScanSessions();
+                if (scan.ok) {
+                    auto& sessions = scan.data.sessions;
+                    sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                                                  [state](const SessionMetadata& s) { return s.state != state; }),
+                                   sessions.end());
+                }
+                return scan;
+            }
+
+            ListSessionsResult result;
+            auto ids = catalog->by_state.find(static_cast<int>(state));
+            if (ids != catalog->by_state.end()) {
+                for (int session_id : ids->second) {
+                    result.sessions.push_back(catalog->sessions[session_id]);
+                }
+            }
+            result.corrupt_sessions.assign(catalog->corrupt.begin(), catalog->corrupt.end());
+            return Result<ListSessionsResult>::MakeOk(result);
+        } catch (const std::exception& e) {
+            return Result<ListSessionsResult>::MakeError(ErrorCode::InternalError,
+                                                        "Failed to list sessions: " + std::string(e.what()));
+        }
+    }
+
+    // Lists sessions by loading every session.json, which is what the catalog is built from
+    Result<ListSessionsResult> ScanSessions() {
         try {
             std::vector<SessionMetadata> sessions;
             std::vector<int> corrupt_sessions;
@@ -552,7 +985,10 @@ public:
             }
 
             // Remove the entire session directory and all its contents
+            CatalogLock lock(sessions_dir_);
+            BeginCatalogChange(session_id);
             fs::remove_all(session_dir);
+            UpdateCatalog(EncodeCatalogRecord(CATALOG_DELETE, session_id));
 
             return Result<bool>::MakeOk(true);
         } catch (const std::exception& e) {
@@ -561,6 +997,33 @@ public:
         }
     }
 
+    Result<bool> RebuildSessionCatalog() override {
+        try {
+            if (!fs::exists(sessions_dir_)) {
+                return Result<bool>::MakeOk(true);
+            }
+
+            CatalogLock lock(sessions_dir_);
+            fs::path file = sessions_dir_ / "catalog.bin";
+            std::unique_ptr<SessionCatalog>& catalog = catalogs[file.string()];
+            if (!catalog || !ReadCatalog(*catalog)) {
+                catalog = std::make_unique<SessionCatalog>();
+                catalog->file = file;
+                if (fs::exists(file)) {
+                    ReadCatalog(*catalog);
+                }
+            }
+            if (!ReplaceWithRebuiltCatalog(catalog)) {
+                return Result<bool>::MakeError(ErrorCode::StorageIoError,
+                                              "Could not rebuild the session catalog");
+            }
+            return Result<bool>::MakeOk(true);
+        } catch (const std::exception& e) {
+            return Result<bool>::MakeError(ErrorCode::StorageIoError,
+                                          "Failed to rebuild the session catalog: " + std::string(e.what()));
+        }
+    }
+
     Result<bool> UpdateSessionState(int session_id, SessionState state) override {
         auto result = LoadSession(session_id);
         if (!result.ok) {
@@ -593,6 +1056,108 @@ private:
     std::string workspace_path_;
     fs::path sessions_dir_;
 
+    // The workspace's catalog, up to date with its file, or null if it can neither
+    // be read nor rebuilt. Intents left by a writer that died are resolved unless
+    // resolve_intents is false, which UpdateCatalog passes for the caller's own.
+    // Callers hold the CatalogLock.
+    SessionCatalog* OpenCatalog(bool resolve_intents = true) {
+        fs::path file = sessions_dir_ / "catalog.bin";
+        std::unique_ptr<SessionCatalog>& catalog = catalogs[file.string()];
+        bool valid = catalog && ReadCatalog(*catalog);
+        if (!valid) {
+            // First use, or the file was compacted by someone else: read it from the start
+            catalog = std::make_unique<SessionCatalog>();
+            catalog->file = file;
+            valid = fs::exists(file) && ReadCatalog(*catalog);
+        }
+        if (!valid) {
+            return ReplaceWithRebuiltCatalog(catalog) ? catalog.get() : nullptr;
+        }
+        if (resolve_intents && !catalog->pending.empty() && !ResolveIntents(*catalog)) {
+            return ReplaceWithRebuiltCatalog(catalog) ? catalog.get() : nullptr;
+        }
+        return catalog.get();
+    }
+
+    // Scans the session directories into a new catalog file. The ids and the
+    // generation seen so far carry over, so that no id is handed out again and no
+    // one takes the rebuilt file for a continuation of theirs.
+    bool ReplaceWithRebuiltCatalog(std::unique_ptr<SessionCatalog>& catalog) {
+        auto rebuilt = std::make_unique<SessionCatalog>();
+        rebuilt->file = catalog->file;
+        rebuilt->generation = catalog->generation;
+        rebuilt->next_id = catalog->next_id;
+        std::string key = catalog->file.string();
+        catalog = std::move(rebuilt);
+        if (!RebuildCatalog(*catalog)) {
+            catalogs.erase(key);
+            return false;
+        }
+        return true;
+    }
+
+    // Reloads the sessions whose intent has no record after it from their
+    // directories, and records what the dead writer left behind
+    bool ResolveIntents(SessionCatalog& catalog) {
+        std::set<int> pending = catalog.pending;
+        for (int session_id : pending) {
+            std::string record;
+            if (!fs::exists(sessions_dir_ / std::to_string(session_id))) {
+                record = EncodeCatalogRecord(CATALOG_DELETE, session_id);
+            }
+            else {
+                auto load_result = LoadSession(session_id);
+                record = load_result.ok
+                    ? EncodeCatalogRecord(CATALOG_PUT, session_id, &load_result.data)
+                    : EncodeCatalogRecord(CATALOG_CORRUPT, session_id);
+            }
+            if (!AppendCatalogRecord(catalog, record)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Appends the intent record of a change to a session directory, before the
+    // change is made. Callers hold the CatalogLock until the change is recorded.
+    void BeginCatalogChange(int session_id) {
+        UpdateCatalog(EncodeCatalogRecord(CATALOG_INTENT, session_id), true);
+    }
+
+    bool RebuildCatalog(SessionCatalog& catalog) {
+        if (!fs::exists(sessions_dir_)) {
+            return false;
+        }
+
+        auto scan = ScanSessions();
+        if (!scan.ok) {
+            return false;
+        }
+        for (const auto& metadata : scan.data.sessions) {
+            catalog.by_state[static_cast<int>(metadata.state)].insert(metadata.session_id);
+            catalog.sessions[metadata.session_id] = metadata;
+            catalog.next_id = std::max(catalog.next_id, metadata.session_id + 1);
+        }
+        for (int session_id : scan.data.corrupt_sessions) {
+            catalog.corrupt.insert(session_id);
+            catalog.next_id = std::max(catalog.next_id, session_id + 1);
+        }
+        catalog.next_id = std::max(catalog.next_id, GetNextSessionId());
+        return WriteCatalog(catalog);
+    }
+
+    // Records a change already made to the session directories. If the catalog
+    // can't take it, it's removed, to be rebuilt from the directories next time.
+    // Callers hold the CatalogLock.
+    void UpdateCatalog(const std::string& record, bool resolve_intents = false) {
+        SessionCatalog* catalog = OpenCatalog(resolve_intents);
+        if (catalog && !AppendCatalogRecord(*catalog, record)) {
+            std::error_code ec;
+            fs::remove(catalog->file, ec);
+            catalogs.erase(catalog->file.string());
+        }
+    }
+
     // Get next session ID from workspace.json
     int GetNextSessionId() {
         fs::path workspace_json_path = fs::path(workspace_path_) / "workspace.json";
@@ -16,6 +16,14 @@
 namespace ProtoVMCLI {
 
 Upp::String JsonIO::SuccessResponse(const std::string& command, const Upp::ValueMap& data) {
+    return ValueMapToJson(SuccessEnvelope(command, data));
+}
+
+Upp::String JsonIO::ErrorResponse(const std::string& command, const std::string& error_msg, const std::string& error_code) {
+    return ValueMapToJson(ErrorEnvelope(command, error_msg, error_code));
+}
+
+Upp::ValueMap JsonIO::SuccessEnvelope(const std::string& command, const Upp::ValueMap& data) {
     Upp::ValueMap response;
     response.Add("ok", true);
     response.Add("command", Upp::String(command.c_str()));
@@ -26,10 +34,10 @@ Upp::String JsonIO::SuccessResponse(const std::string& command, const Upp::Value
     } else {
         response.Add("data", Upp::Value());
     }
-    return ValueMapToJson(response);
+    return response;
 }
 
-Upp::String JsonIO::ErrorResponse(const std::string& command, const std::string& error_msg, const std::string& error_code) {
+Upp::ValueMap JsonIO::ErrorEnvelope(const std::string& command, const std::string& error_msg, const std::string& error_code) {
     Upp::ValueMap response;
     response.Add("ok", false);
     response.Add("command", Upp::String(command.c_str()));
@@ -40,11 +48,11 @@ Upp::String JsonIO::ErrorResponse(const std::string& command, const std::string&
     }
     response.Add("error", Upp::String(error_msg.c_str()));
     response.Add("data", Upp::Value());
-    return ValueMapToJson(response);
+    return response;
 }
 
 template<typename T>
-Upp::String JsonIO::FromResult(const std::string& command, const Result<T>& result,
+Upp::ValueMap JsonIO::FromResult(const std::string& command, const Result<T>& result,
                                std::function<Upp::ValueMap(const T&)> converter) {
     if (result.ok) {
         Upp::ValueMap data;
@@ -54,10 +62,10 @@ Upp::String JsonIO::FromResult(const std::string& command, const Result<T>& resu
             // For simple types, just return an empty object or add a value field
             data.Add("value", Upp::Value(result.data));
         }
-        return SuccessResponse(command, data);
+        return SuccessEnvelope(command, data);
     } else {
         std::string code_str = ErrorCodeToString(result.error_code);
-        return ErrorResponse(command, result.error_message, code_str);
+        return ErrorEnvelope(command, result.error_message, code_str);
     }
 }
 
@@ -91,6 +99,8 @@ std::string JsonIO::ErrorCodeToString(ErrorCode code) {
             return "COMMAND_PARSE_ERROR";
         case ErrorCode::InternalError:
             return "INTERNAL_ERROR";
+        case ErrorCode::CircuitNotSupported:
+            return "CIRCUIT_NOT_SUPPORTED";
         default:
             return "UNKNOWN_ERROR";
     }
@@ -111,6 +121,7 @@ ErrorCode JsonIO::StringToErrorCode(const std::string& s) {
     if (s == "STORAGE_SCHEMA_MISMATCH") return ErrorCode::StorageSchemaMismatch;
     if (s == "COMMAND_PARSE_ERROR") return ErrorCode::CommandParseError;
     if (s == "INTERNAL_ERROR") return ErrorCode::InternalError;
+    if (s == "CIRCUIT_NOT_SUPPORTED") return ErrorCode::CircuitNotSupported;
     return ErrorCode::InternalError;  // default for unknown error codes
 }
 
@@ -168,9 +179,12 @@ Upp::String JsonIO::Serialize(const Upp::ValueMap& obj) {
 }
 
 Upp::ValueMap JsonIO::Deserialize(const Upp::String& str) {
-    // This is a simplified implementation that would need a full JSON parser in real use
-    Upp::ValueMap empty_map;
-    return empty_map; // Return empty for now
+    // Anything but a JSON object yields an empty map
+    Upp::Value parsed = Upp::ParseJSON(str);
+    if (parsed.Is<Upp::ValueMap>()) {
+        return parsed;
+    }
+    return Upp::ValueMap();
 }
 
 Upp::String JsonIO::ValueMapToJson(const Upp::ValueMap& vm) {
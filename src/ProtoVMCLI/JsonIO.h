@@ -25,9 +25,13 @@ public:
     // Create an error response with a standard envelope
     static Upp::String ErrorResponse(const std::string& command, const std::string& error_msg, const std::string& error_code = "");
 
-    // Create a response from a Result type with a standard envelope
+    // Same envelopes, unserialized, for callers that embed them in another message
+    static Upp::ValueMap SuccessEnvelope(const std::string& command, const Upp::ValueMap& data = Upp::ValueMap());
+    static Upp::ValueMap ErrorEnvelope(const std::string& command, const std::string& error_msg, const std::string& error_code = "");
+
+    // Create a response envelope from a Result type
     template<typename T>
-    static Upp::String FromResult(const std::string& command, const Result<T>& result,
+    static Upp::ValueMap FromResult(const std::string& command, const Result<T>& result,
                                   std::function<Upp::ValueMap(const T&)> converter = nullptr);
 
     // Parse command line arguments to ValueMap
@@ -408,7 +412,7 @@ public:
 
 // Template implementation needs to be in header
 template<typename T>
-Upp::String JsonIO::FromResult(const std::string& command, const Result<T>& result,
+Upp::ValueMap JsonIO::FromResult(const std::string& command, const Result<T>& result,
                                std::function<Upp::ValueMap(const T&)> converter) {
     if (result.ok) {
         Upp::ValueMap data;
@@ -418,10 +422,10 @@ Upp::String JsonIO::FromResult(const std::string& command, const Result<T>& resu
             // For simple types, just return an empty object or add a value field
             data.Add("value", Upp::Value(result.data));
         }
-        return SuccessResponse(command, data);
+        return SuccessEnvelope(command, data);
     } else {
         std::string code_str = ErrorCodeToString(result.error_code);
-        return ErrorResponse(command, result.error_message, code_str);
+        return ErrorEnvelope(command, result.error_message, code_str);
     }
 }
 
@@ -2,233 +2,113 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
 
 namespace ProtoVMCLI {
 
-bool MachineSnapshot::SerializeToFile(const Machine& machine, const std::string& file_path) {
-    std::ofstream file(file_path, std::ios::binary);
-    if (!file.is_open()) {
+static const char snapshot_magic[8] = {'P', 'V', 'M', 'S', 'N', 'A', 'P', 0};
+
+bool MachineSnapshot::SerializeToFile(Machine& machine, const std::string& file_path, bool delta) {
+    std::string buffer;
+    if (!SerializeToBuffer(machine, buffer, delta)) {
         return false;
     }
     
-    bool result = SerializeToBuffer(machine, reinterpret_cast<std::string&>(file));
-    file.close();
-    
-    return result;
+    // The Machine's delta baseline already moved on to this snapshot, so it must reach
+    // the disk whole: write a temporary file and rename it over the old snapshot
+    std::string tmp_path = file_path + ".tmp";
+    bool written;
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(buffer.data(), buffer.size());
+        file.close();
+        written = !file.fail();
+    }
+    if (!written || std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        // The next delta would be relative to a snapshot that was never stored
+        machine.DiscardSnapshotBase();
+        return false;
+    }
+    return true;
 }
 
 bool MachineSnapshot::DeserializeFromFile(Machine& machine, const std::string& file_path) {
-    std::ifstream file(file_path, std::ios::binary);
+    std::ifstream file(file_path, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         return false;
     }
     
-    // Read the entire file into a buffer
-    std::string buffer((std::istreambuf_iterator<char>(file)),
-                       std::istreambuf_iterator<char>());
-    
-    bool result = DeserializeFromBuffer(machine, buffer);
-    file.close();
+    // Read the entire file in one go, RAM images make snapshots large
+    std::string buffer;
+    buffer.resize((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read(&buffer[0], buffer.size())) {
+        return false;
+    }
     
-    return result;
+    return DeserializeFromBuffer(machine, buffer);
 }
 
-bool MachineSnapshot::SerializeToBuffer(const Machine& machine, std::string& buffer) {
-    std::ostringstream oss(std::ios::binary);
+bool MachineSnapshot::SerializeToBuffer(Machine& machine, std::string& buffer, bool delta) {
+    // Storing updates the Machine's delta baseline, so the next delta is relative to this
+    // one. A buffer that is not produced leaves the next snapshot to be a full one.
+    StringStream ss;
+    if (!machine.SerializeState(ss, delta)) {
+        machine.DiscardSnapshotBase();
+        return false;
+    }
+    String state = ss.GetResult();
     
-    // Write the current tick
-    oss.write(reinterpret_cast<const char*>(&machine.current_tick), sizeof(machine.current_tick));
+    std::ostringstream oss(std::ios::binary);
+    oss.write(snapshot_magic, sizeof(snapshot_magic));
     
-    // Write the timing violation count
-    int timing_violations = machine.timing_violations;
-    oss.write(reinterpret_cast<const char*>(&timing_violations), sizeof(timing_violations));
+    int version = FORMAT_VERSION;
+    oss.write(reinterpret_cast<const char*>(&version), sizeof(version));
     
-    // Write whether topological ordering is enabled
-    bool use_topological_ordering = machine.use_topological_ordering;
-    oss.write(reinterpret_cast<const char*>(&use_topological_ordering), sizeof(use_topological_ordering));
+    int64 state_len = state.GetCount();
+    oss.write(reinterpret_cast<const char*>(&state_len), sizeof(state_len));
+    oss.write(state.Begin(), state_len);
     
-    // Serialize PCBs
-    if (!SerializePcbs(machine.pcbs, oss)) {
+    if (!SerializeSignalTraces(machine.signal_traces, oss) ||
+        !SerializeSignalTransitions(machine.signal_transitions, oss)) {
+        machine.DiscardSnapshotBase();
         return false;
     }
     
-    // For a complete implementation, we would also serialize:
-    // - The link base map (machine.l)
-    // - Delay queue content
-    // - Clock domains
-    // - Signal traces
-    // - Signal transitions
-    // - Breakpoints
-    // - Profiling data
-    // - Analog simulation data if applicable
-    
     buffer = oss.str();
     return true;
 }
 
 bool MachineSnapshot::DeserializeFromBuffer(Machine& machine, const std::string& buffer) {
-    std::istringstream iss(buffer, std::ios::binary);
-    
-    // Read the current tick
-    int current_tick;
-    iss.read(reinterpret_cast<char*>(&current_tick), sizeof(current_tick));
-    machine.current_tick = current_tick;
-    
-    // Read the timing violation count
-    int timing_violations;
-    iss.read(reinterpret_cast<char*>(&timing_violations), sizeof(timing_violations));
-    machine.timing_violations = timing_violations;
-    
-    // Read whether topological ordering is enabled
-    bool use_topological_ordering;
-    iss.read(reinterpret_cast<char*>(&use_topological_ordering), sizeof(use_topological_ordering));
-    machine.use_topological_ordering = use_topological_ordering;
-    
-    // Deserialize PCBs
-    if (!DeserializePcbs(machine.pcbs, iss)) {
+    const size_t header_len = sizeof(snapshot_magic) + sizeof(int) + sizeof(int64);
+    if (buffer.size() < header_len || memcmp(buffer.data(), snapshot_magic, sizeof(snapshot_magic)) != 0) {
         return false;
     }
     
-    // For a complete implementation, we would also deserialize:
-    // - The link base map (machine.l)
-    // - Delay queue content
-    // - Clock domains
-    // - Signal traces
-    // - Signal transitions
-    // - Breakpoints
-    // - Profiling data
-    // - Analog simulation data if applicable
-    
-    return true;
-}
-
-bool MachineSnapshot::SerializePcbs(const Array<Pcb>& pcbs, std::ostream& os) {
-    // Write the number of PCBs
-    int pcb_count = pcbs.GetCount();
-    os.write(reinterpret_cast<const char*>(&pcb_count), sizeof(pcb_count));
-    
-    for (int i = 0; i < pcb_count; i++) {
-        const Pcb& pcb = pcbs[i];
-        // For now, we serialize basic information about each PCB
-        // In a real implementation, we would serialize the full PCB data including:
-        // - All components (nodes)
-        // - All connections
-        // - Component states
-        // - etc.
-        
-        // Write basic PCB info (name, etc.)
-        String pcb_name = pcb.GetName();
-        int name_len = pcb_name.GetCount();
-        os.write(reinterpret_cast<const char*>(&name_len), sizeof(name_len));
-        os.write(pcb_name, name_len);
-    }
-    
-    return true;
-}
-
-bool MachineSnapshot::DeserializePcbs(Array<Pcb>& pcbs, std::istream& is) {
-    // Read the number of PCBs
-    int pcb_count;
-    is.read(reinterpret_cast<char*>(&pcb_count), sizeof(pcb_count));
-    
-    // Clear existing PCBs
-    pcbs.Clear();
-    
-    for (int i = 0; i < pcb_count; i++) {
-        // Read basic PCB info (name, etc.)
-        int name_len;
-        is.read(reinterpret_cast<char*>(&name_len), sizeof(name_len));
-        
-        char* name_buf = new char[name_len + 1];
-        is.read(name_buf, name_len);
-        name_buf[name_len] = '\0';
-        
-        String pcb_name(name_buf);
-        delete[] name_buf;
-        
-        // Add a new PCB with the loaded name
-        Pcb& new_pcb = pcbs.Add();
-        new_pcb.SetName(pcb_name);
-        
-        // In a complete implementation, we would deserialize the full PCB data
-        // including all components, connections, and their states
+    int version;
+    memcpy(&version, buffer.data() + sizeof(snapshot_magic), sizeof(version));
+    if (version != FORMAT_VERSION) {
+        return false;
     }
     
-    return true;
-}
-
-// Placeholder implementations for other serialization methods
-bool MachineSnapshot::SerializeLinks(const LinkBaseMap& links, std::ostream& os) {
-    // For now, this is a placeholder
-    // In a complete implementation, this would serialize link connections
-    int link_count = 0;  // Placeholder
-    os.write(reinterpret_cast<const char*>(&link_count), sizeof(link_count));
-    return true;
-}
-
-bool MachineSnapshot::DeserializeLinks(LinkBaseMap& links, std::istream& is) {
-    // For now, this is a placeholder
-    // In a complete implementation, this would deserialize link connections
-    int link_count;
-    is.read(reinterpret_cast<char*>(&link_count), sizeof(link_count));
-    return true;
-}
-
-bool MachineSnapshot::SerializeClockDomains(const Vector<Machine::ClockDomain>& domains, std::ostream& os) {
-    int domain_count = domains.GetCount();
-    os.write(reinterpret_cast<const char*>(&domain_count), sizeof(domain_count));
-    
-    for (int i = 0; i < domain_count; i++) {
-        const Machine::ClockDomain& domain = domains[i];
-        
-        os.write(reinterpret_cast<const char*>(&domain.id), sizeof(domain.id));
-        os.write(reinterpret_cast<const char*>(&domain.frequency_hz), sizeof(domain.frequency_hz));
-        os.write(reinterpret_cast<const char*>(&domain.period_ticks), sizeof(domain.period_ticks));
-        os.write(reinterpret_cast<const char*>(&domain.last_edge_tick), sizeof(domain.last_edge_tick));
-        os.write(reinterpret_cast<const char*>(&domain.next_edge_tick), sizeof(domain.next_edge_tick));
-        os.write(reinterpret_cast<const char*>(&domain.clock_state), sizeof(domain.clock_state));
-        
-        int comp_count = domain.component_ids.GetCount();
-        os.write(reinterpret_cast<const char*>(&comp_count), sizeof(comp_count));
-        
-        for (int j = 0; j < comp_count; j++) {
-            os.write(reinterpret_cast<const char*>(&domain.component_ids[j]), sizeof(domain.component_ids[j]));
-        }
+    int64 state_len;
+    memcpy(&state_len, buffer.data() + sizeof(snapshot_magic) + sizeof(version), sizeof(state_len));
+    if (state_len < 0 || (size_t)state_len > buffer.size() - header_len) {
+        return false;
     }
     
-    return true;
-}
-
-bool MachineSnapshot::DeserializeClockDomains(Vector<Machine::ClockDomain>& domains, std::istream& is) {
-    int domain_count;
-    is.read(reinterpret_cast<char*>(&domain_count), sizeof(domain_count));
-    
-    domains.Clear();
-    
-    for (int i = 0; i < domain_count; i++) {
-        Machine::ClockDomain domain;
-        
-        is.read(reinterpret_cast<char*>(&domain.id), sizeof(domain.id));
-        is.read(reinterpret_cast<char*>(&domain.frequency_hz), sizeof(domain.frequency_hz));
-        is.read(reinterpret_cast<char*>(&domain.period_ticks), sizeof(domain.period_ticks));
-        is.read(reinterpret_cast<char*>(&domain.last_edge_tick), sizeof(domain.last_edge_tick));
-        is.read(reinterpret_cast<char*>(&domain.next_edge_tick), sizeof(domain.next_edge_tick));
-        is.read(reinterpret_cast<char*>(&domain.clock_state), sizeof(domain.clock_state));
-        
-        int comp_count;
-        is.read(reinterpret_cast<char*>(&comp_count), sizeof(comp_count));
-        
-        domain.component_ids.Clear();
-        for (int j = 0; j < comp_count; j++) {
-            int comp_id;
-            is.read(reinterpret_cast<char*>(&comp_id), sizeof(comp_id));
-            domain.component_ids.Add(comp_id);
-        }
-        
-        domains.Add(domain);
+    // The machine state is read in place, without copying the buffer
+    MemReadStream ms(buffer.data() + header_len, state_len);
+    if (!machine.SerializeState(ms)) {
+        return false;
     }
     
-    return true;
+    std::istringstream iss(buffer.substr(header_len + state_len), std::ios::binary);
+    return DeserializeSignalTraces(machine.signal_traces, iss) &&
+           DeserializeSignalTransitions(machine.signal_transitions, iss);
 }
 
 bool MachineSnapshot::SerializeSignalTraces(const Vector<Machine::SignalTrace>& traces, std::ostream& os) {
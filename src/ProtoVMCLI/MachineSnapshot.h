@@ -7,31 +7,28 @@
 
 namespace ProtoVMCLI {
 
+// Snapshot file layout: "PVMSNAP" magic, format version, the length prefixed
+// Machine::SerializeState blob, then the signal traces and transition log.
+// Restoring needs a Machine built from the same circuit (see EngineFacade).
+// Delta snapshots store only the state changed since the Machine's previous
+// snapshot; loading one applies it on top of the state restored before.
 class MachineSnapshot {
 public:
-    // Serialize the entire machine state to a binary file
-    static bool SerializeToFile(const Machine& machine, const std::string& file_path);
+    static const int FORMAT_VERSION = 2;
+
+    // Serialize the machine state to a binary file, the entire state or a delta
+    static bool SerializeToFile(Machine& machine, const std::string& file_path, bool delta = false);
     
     // Deserialize the entire machine state from a binary file
     static bool DeserializeFromFile(Machine& machine, const std::string& file_path);
     
     // Serialize the machine state to a binary buffer
-    static bool SerializeToBuffer(const Machine& machine, std::string& buffer);
+    static bool SerializeToBuffer(Machine& machine, std::string& buffer, bool delta = false);
     
     // Deserialize the machine state from a binary buffer
     static bool DeserializeFromBuffer(Machine& machine, const std::string& buffer);
     
 private:
-    // Helper functions for serializing different parts of the Machine
-    static bool SerializePcbs(const Array<Pcb>& pcbs, std::ostream& os);
-    static bool DeserializePcbs(Array<Pcb>& pcbs, std::istream& is);
-    
-    static bool SerializeLinks(const LinkBaseMap& links, std::ostream& os);
-    static bool DeserializeLinks(LinkBaseMap& links, std::istream& is);
-    
-    static bool SerializeClockDomains(const Vector<Machine::ClockDomain>& domains, std::ostream& os);
-    static bool DeserializeClockDomains(Vector<Machine::ClockDomain>& domains, std::istream& is);
-    
     static bool SerializeSignalTraces(const Vector<Machine::SignalTrace>& traces, std::ostream& os);
     static bool DeserializeSignalTraces(Vector<Machine::SignalTrace>& traces, std::istream& is);
     
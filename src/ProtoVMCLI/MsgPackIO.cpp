@@ -0,0 +1,244 @@
+#include "MsgPackIO.h"
+#include <cstdint>
+#include <cstring>
+
+namespace ProtoVMCLI {
+
+// Nesting limit when decoding, against malicious input
+static const int MAX_DEPTH = 64;
+
+static void PutBigEndian(Upp::String& out, Upp::uint64 v, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+        out.Cat((char)((v >> (8 * i)) & 0xff));
+    }
+}
+
+static void PutLength(Upp::String& out, int n, int fix_tag, int fix_max, int tag16, int tag32) {
+    if (n <= fix_max) {
+        out.Cat((char)(fix_tag | n));
+    } else if (n < 0x10000) {
+        out.Cat((char)tag16);
+        PutBigEndian(out, n, 2);
+    } else {
+        out.Cat((char)tag32);
+        PutBigEndian(out, n, 4);
+    }
+}
+
+static void PutString(Upp::String& out, const Upp::String& s) {
+    int n = s.GetCount();
+    if (n < 32) {
+        out.Cat((char)(0xa0 | n));
+    } else if (n < 0x100) {
+        out.Cat((char)0xd9);
+        PutBigEndian(out, n, 1);
+    } else if (n < 0x10000) {
+        out.Cat((char)0xda);
+        PutBigEndian(out, n, 2);
+    } else {
+        out.Cat((char)0xdb);
+        PutBigEndian(out, n, 4);
+    }
+    out.Cat(s);
+}
+
+static void PutInt(Upp::String& out, Upp::int64 v) {
+    if (v >= -32 && v <= 127) {
+        out.Cat((char)(v & 0xff));
+    } else if (v >= INT32_MIN && v <= INT32_MAX) {
+        out.Cat((char)0xd2);
+        PutBigEndian(out, (Upp::uint64)v, 4);
+    } else {
+        out.Cat((char)0xd3);
+        PutBigEndian(out, (Upp::uint64)v, 8);
+    }
+}
+
+Upp::String MsgPackIO::Encode(const Upp::Value& val) {
+    Upp::String out;
+    EncodeValue(out, val);
+    return out;
+}
+
+void MsgPackIO::EncodeValue(Upp::String& out, const Upp::Value& val) {
+    if (val.IsVoid() || (Upp::IsNull(val) && !val.Is<Upp::String>())) {
+        out.Cat((char)0xc0);
+    } else if (val.Is<bool>()) {
+        out.Cat((char)(val.Get<bool>() ? 0xc3 : 0xc2));
+    } else if (val.Is<int>()) {
+        PutInt(out, val.Get<int>());
+    } else if (val.Is<Upp::int64>()) {
+        PutInt(out, val.Get<Upp::int64>());
+    } else if (val.Is<double>()) {
+        double d = val.Get<double>();
+        Upp::uint64 bits;
+        memcpy(&bits, &d, sizeof(bits));
+        out.Cat((char)0xcb);
+        PutBigEndian(out, bits, 8);
+    } else if (val.Is<Upp::String>()) {
+        PutString(out, val.Get<Upp::String>());
+    } else if (val.Is<Upp::ValueMap>()) {
+        const Upp::ValueMap& map = val.Get<Upp::ValueMap>();
+        PutLength(out, map.GetCount(), 0x80, 15, 0xde, 0xdf);
+        for (int i = 0; i < map.GetCount(); i++) {
+            EncodeValue(out, map.GetKey(i));
+            EncodeValue(out, map.GetValue(i));
+        }
+    } else if (val.Is<Upp::ValueArray>()) {
+        const Upp::ValueArray& arr = val.Get<Upp::ValueArray>();
+        PutLength(out, arr.GetCount(), 0x90, 15, 0xdc, 0xdd);
+        for (int i = 0; i < arr.GetCount(); i++) {
+            EncodeValue(out, arr[i]);
+        }
+    } else {
+        // Same fallback as JsonIO::ValueToJson
+        PutString(out, Upp::AsString(val));
+    }
+}
+
+bool MsgPackIO::Decode(const Upp::String& data, Upp::Value& out) {
+    int pos = 0;
+    return DecodeValue(data, pos, out, 0) && pos == data.GetCount();
+}
+
+static bool GetBigEndian(const Upp::String& data, int& pos, int bytes, Upp::uint64& v) {
+    if (pos + bytes > data.GetCount()) {
+        return false;
+    }
+    v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v = (v << 8) | (Upp::byte)data[pos++];
+    }
+    return true;
+}
+
+static bool GetBytes(const Upp::String& data, int& pos, Upp::uint64 n, Upp::Value& out) {
+    if (n > (Upp::uint64)(data.GetCount() - pos)) {
+        return false;
+    }
+    out = data.Mid(pos, (int)n);
+    pos += (int)n;
+    return true;
+}
+
+bool MsgPackIO::DecodeValue(const Upp::String& data, int& pos, Upp::Value& out, int depth) {
+    if (pos >= data.GetCount() || depth > MAX_DEPTH) {
+        return false;
+    }
+    
+    int tag = (Upp::byte)data[pos++];
+    Upp::uint64 v = 0;
+    Upp::uint64 count = 0;
+    bool is_map = false;
+    
+    if (tag <= 0x7f) {
+        out = tag;
+        return true;
+    }
+    if (tag >= 0xe0) {
+        out = tag - 0x100;
+        return true;
+    }
+    if ((tag & 0xe0) == 0xa0) {
+        return GetBytes(data, pos, tag & 0x1f, out);
+    }
+    if ((tag & 0xf0) == 0x80 || (tag & 0xf0) == 0x90) {
+        is_map = (tag & 0xf0) == 0x80;
+        count = tag & 0x0f;
+    } else {
+        switch (tag) {
+        case 0xc0: out = Upp::Value(); return true;
+        case 0xc2: out = false; return true;
+        case 0xc3: out = true; return true;
+        // bin and str: a String either way
+        case 0xc4: case 0xd9:
+            return GetBigEndian(data, pos, 1, v) && GetBytes(data, pos, v, out);
+        case 0xc5: case 0xda:
+            return GetBigEndian(data, pos, 2, v) && GetBytes(data, pos, v, out);
+        case 0xc6: case 0xdb:
+            return GetBigEndian(data, pos, 4, v) && GetBytes(data, pos, v, out);
+        case 0xca: {
+            if (!GetBigEndian(data, pos, 4, v)) return false;
+            Upp::dword bits = (Upp::dword)v;
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            out = (double)f;
+            return true;
+        }
+        case 0xcb: {
+            if (!GetBigEndian(data, pos, 8, v)) return false;
+            double d;
+            memcpy(&d, &v, sizeof(d));
+            out = d;
+            return true;
+        }
+        case 0xcc: case 0xcd: case 0xce:
+            if (!GetBigEndian(data, pos, 1 << (tag - 0xcc), v)) return false;
+            out = (Upp::int64)v;
+            return true;
+        case 0xcf:
+            if (!GetBigEndian(data, pos, 8, v)) return false;
+            if (v > (Upp::uint64)INT64_MAX)
+                out = (double)v;
+            else
+                out = (Upp::int64)v;
+            return true;
+        case 0xd0:
+            if (!GetBigEndian(data, pos, 1, v)) return false;
+            out = (int)(Upp::int8)v;
+            return true;
+        case 0xd1:
+            if (!GetBigEndian(data, pos, 2, v)) return false;
+            out = (int)(Upp::int16)v;
+            return true;
+        case 0xd2:
+            if (!GetBigEndian(data, pos, 4, v)) return false;
+            out = (int)(Upp::int32)v;
+            return true;
+        case 0xd3:
+            if (!GetBigEndian(data, pos, 8, v)) return false;
+            out = (Upp::int64)v;
+            return true;
+        case 0xdc: case 0xdd:
+            if (!GetBigEndian(data, pos, tag == 0xdc ? 2 : 4, count)) return false;
+            break;
+        case 0xde: case 0xdf:
+            is_map = true;
+            if (!GetBigEndian(data, pos, tag == 0xde ? 2 : 4, count)) return false;
+            break;
+        default:
+            // ext types aren't used
+            return false;
+        }
+    }
+    
+    // Every element takes at least one byte, which bounds count before allocating
+    if (count > (Upp::uint64)(data.GetCount() - pos)) {
+        return false;
+    }
+    
+    if (is_map) {
+        Upp::ValueMap map;
+        for (Upp::uint64 i = 0; i < count; i++) {
+            Upp::Value key, value;
+            if (!DecodeValue(data, pos, key, depth + 1) || !DecodeValue(data, pos, value, depth + 1)) {
+                return false;
+            }
+            map.Add(key, value);
+        }
+        out = map;
+    } else {
+        Upp::ValueArray arr;
+        for (Upp::uint64 i = 0; i < count; i++) {
+            Upp::Value value;
+            if (!DecodeValue(data, pos, value, depth + 1)) {
+                return false;
+            }
+            arr.Add(value);
+        }
+        out = arr;
+    }
+    return true;
+}
+
+} // namespace ProtoVMCLI
@@ -0,0 +1,26 @@
+#ifndef _ProtoVM_MsgPackIO_h_
+#define _ProtoVM_MsgPackIO_h_
+
+#include <ProtoVM/ProtoVM.h>  // Include U++ types
+#include <string>
+
+namespace ProtoVMCLI {
+
+// MessagePack encoding of U++ Values, the compact alternative to JsonIO for the
+// daemon's socket transport. Maps, arrays, strings, numbers, bools and null/void
+// round-trip; strings are written as str, and bin is read back as a String.
+class MsgPackIO {
+public:
+    static Upp::String Encode(const Upp::Value& val);
+    
+    // Returns false on malformed or truncated input
+    static bool Decode(const Upp::String& data, Upp::Value& out);
+    
+private:
+    static void EncodeValue(Upp::String& out, const Upp::Value& val);
+    static bool DecodeValue(const Upp::String& data, int& pos, Upp::Value& out, int depth);
+};
+
+} // namespace ProtoVMCLI
+
+#endif
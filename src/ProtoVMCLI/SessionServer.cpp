@@ -9,15 +9,32 @@
 #include "DiffAnalysis.h"
 #include "IrOptimization.h"
 #include "Playbooks.h"
+#include "EventLogger.h"
+#include "MsgPackIO.h"
 #include <iostream>
 #include <sstream>
 #include <regex>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <atomic>
+#include <cstring>
+
+#ifdef PLATFORM_POSIX
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
 
 namespace ProtoVMCLI {
 
+// Defined in CommandDispatcher.cpp
+std::string GetCurrentTimestamp();
+
 SessionServer::SessionServer() {
     // Initialize CoDesignerManager with a circuit facade
     // We'll create a circuit facade without a session store since the CoDesigner
@@ -27,12 +44,35 @@ SessionServer::SessionServer() {
 }
 
 SessionServer::~SessionServer() {
+    FlushSessions();
 }
 
 Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonResponse& out_resp) {
+    // One request at a time per session, see RequestLockKey
+    std::string key = RequestLockKey(req);
+    std::shared_ptr<std::recursive_mutex> session_lock = GetSessionLock(key);
+    Result<void> result;
+    {
+        std::lock_guard<std::recursive_mutex> lock(*session_lock);
+        result = DispatchRequest(req, out_resp);
+    }
+    session_lock.reset();
+    PruneSessionLock(key);
+    return result;
+}
+
+Result<void> SessionServer::DispatchRequest(const DaemonRequest& req, DaemonResponse& out_resp) {
     try {
         Result<DaemonResponse> result;
         
+        // Everything else reads the session from disk: bring the disk up to date first,
+        // and drop the resident copy of a session the command may modify
+        if (!IsResidentCommand(req.command) && !req.workspace.empty()) {
+            if (req.session_id >= 0)
+                DropSession(req.session_id, req.workspace, req.command != "destroy-session");
+            FlushSessions(req.workspace);
+        }
+        
         if (req.command == "init-workspace") {
             result = HandleInitWorkspace(req);
         }
@@ -60,6 +100,12 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
         else if (req.command == "analyze-circuit") {
             result = HandleAnalyzeCircuit(req);
         }
+        else if (req.command == "flush-sessions") {
+            result = HandleFlushSessions(req);
+        }
+        else if (req.command == "batch") {
+            result = HandleBatch(req);
+        }
         else if (req.command == "edit-add-component") {
             result = HandleEditAddComponent(req);
         }
@@ -107,10 +153,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the branch-list command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBranchList(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBranchList(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -140,10 +185,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the branch-create command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBranchCreate(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBranchCreate(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -167,10 +211,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the branch-switch command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBranchSwitch(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBranchSwitch(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -194,10 +237,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the branch-delete command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBranchDelete(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBranchDelete(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -227,10 +269,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the branch-merge command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBranchMerge(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBranchMerge(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -259,10 +300,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the refactor-suggest command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunRefactorSuggest(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunRefactorSuggest(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -296,10 +336,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the refactor-suggest-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunRefactorSuggestBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunRefactorSuggestBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -328,10 +367,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the refactor-apply command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunRefactorApply(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunRefactorApply(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -355,10 +393,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the graph-export command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunGraphExport(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunGraphExport(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -407,10 +444,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the graph-paths command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunGraphPaths(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunGraphPaths(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -449,10 +485,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the graph-fanin command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunGraphFanIn(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunGraphFanIn(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -491,10 +526,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the graph-fanout command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunGraphFanOut(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunGraphFanOut(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -518,10 +552,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the graph-stats command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunGraphStats(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunGraphStats(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -545,10 +578,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the timing-summary command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunTimingSummary(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunTimingSummary(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -580,10 +612,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the timing-critical-paths command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunTimingCriticalPaths(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunTimingCriticalPaths(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -607,10 +638,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the timing-loops command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunTimingLoops(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunTimingLoops(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -639,10 +669,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the timing-hazards command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunTimingHazards(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunTimingHazards(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -677,10 +706,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the deps-summary command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunDepsSummary(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunDepsSummary(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -715,10 +743,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the deps-backward command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunDepsBackward(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunDepsBackward(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -753,10 +780,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the deps-forward command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunDepsForward(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunDepsForward(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -791,10 +817,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the deps-both command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunDepsBoth(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunDepsBoth(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -818,10 +843,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the blocks-list command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBlocksList(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBlocksList(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -845,10 +869,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the blocks-export command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBlocksExport(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBlocksExport(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -877,10 +900,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the block-inspect command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBlockInspect(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBlockInspect(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -909,10 +931,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the behavior-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBehaviorBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBehaviorBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -944,10 +965,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the behavior-node command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBehaviorNode(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBehaviorNode(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -976,10 +996,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the ir-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunIrBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunIrBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1019,10 +1038,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the ir-opt-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunIrOptBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunIrOptBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1062,10 +1080,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the ir-opt-refactor-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunIrOptRefactorBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunIrOptRefactorBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1100,10 +1117,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the ir-node-region command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunIrNodeRegion(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunIrNodeRegion(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1135,10 +1151,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the schedule-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunScheduleBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunScheduleBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1176,10 +1191,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the schedule-node-region command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunScheduleNodeRegion(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunScheduleNodeRegion(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1208,10 +1222,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the pipeline-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunPipelineBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunPipelineBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1251,10 +1264,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the pipeline-subsystem command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunPipelineSubsystem(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunPipelineSubsystem(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1286,10 +1298,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the behavior-diff-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunBehaviorDiffBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunBehaviorDiffBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1321,10 +1332,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the ir-diff-block command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunIrDiffBlock(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunIrDiffBlock(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1362,10 +1372,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the ir-diff-node-region command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunIrDiffNodeRegion(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunIrDiffNodeRegion(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1394,10 +1403,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the codegen-block-ir command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunCodegenBlockIr(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunCodegenBlockIr(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1446,10 +1454,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the codegen-block-c command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunCodegenBlockC(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunCodegenBlockC(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1498,10 +1505,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the codegen-block-osc-demo command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunCodegenBlockOscDemo(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunCodegenBlockOscDemo(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1560,10 +1566,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the instrument-build-hybrid command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunInstrumentBuildHybrid(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunInstrumentBuildHybrid(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1622,10 +1627,9 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 
             // Use the CommandDispatcher to handle the instrument-render-hybrid command
             CommandDispatcher dispatcher(std::make_unique<JsonFilesystemSessionStore>(req.workspace));
-            Upp::String response = dispatcher.RunInstrumentRenderHybrid(opts);
+            Upp::ValueMap parsed_response = dispatcher.RunInstrumentRenderHybrid(opts);
 
-            // Parse the response and convert to DaemonResponse
-            Upp::ValueMap parsed_response = JsonIO::Deserialize(response);
+            // Convert to DaemonResponse
             out_resp.id = req.id;
             out_resp.ok = parsed_response.Get("ok", Upp::Value(false)).ToBool();
             out_resp.command = req.command;
@@ -1711,14 +1715,18 @@ Result<void> SessionServer::HandleRequest(const DaemonRequest& req, DaemonRespon
 }
 
 Result<DaemonResponse> SessionServer::ProcessRequestFromJson(const std::string& json_str) {
-    // This is a simplified implementation - in reality we'd need a proper JSON parser
-    // For now, we'll simulate parsing based on the expected structure
-    
-    DaemonRequest req;
+    return Result<DaemonResponse>::MakeOk(ExecuteRequest(ParseRequest(json_str)));
+}
+
+DaemonRequest SessionServer::ParseRequest(const std::string& json_str) {
     Upp::String json_content(json_str.c_str());
-    Upp::ValueMap parsed = JsonIO::Deserialize(json_content);
+    return RequestFromValueMap(JsonIO::Deserialize(json_content));
+}
+
+DaemonRequest SessionServer::RequestFromValueMap(const Upp::ValueMap& parsed) {
+    DaemonRequest req;
     
-    // Extract fields from the parsed JSON
+    // Extract fields from the parsed message
     req.id = parsed.Get("id", Upp::String("")).ToStd();
     req.command = parsed.Get("command", Upp::String("")).ToStd();
     req.workspace = parsed.Get("workspace", Upp::String("")).ToStd();
@@ -1726,23 +1734,36 @@ Result<DaemonResponse> SessionServer::ProcessRequestFromJson(const std::string&
     req.user_id = parsed.Get("user_id", Upp::String("anonymous")).ToStd();
     req.payload = parsed.Get("payload", Upp::ValueMap());
     
+    return req;
+}
+
+DaemonResponse SessionServer::ExecuteRequest(const DaemonRequest& req) {
     DaemonResponse resp;
     auto result = HandleRequest(req, resp);
     
-    if (result.ok) {
-        return Result<DaemonResponse>::MakeOk(resp);
-    } else {
+    if (!result.ok) {
         // Create error response
-        DaemonResponse error_resp;
-        error_resp.id = req.id;
-        error_resp.ok = false;
-        error_resp.command = req.command;
-        error_resp.error_code = JsonIO::ErrorCodeToString(result.error_code);
-        error_resp.error = result.error_message;
-        error_resp.data = Upp::ValueMap();
-        
-        return Result<DaemonResponse>::MakeOk(error_resp);
+        resp = DaemonResponse();
+        resp.ok = false;
+        resp.error_code = JsonIO::ErrorCodeToString(result.error_code);
+        resp.error = result.error_message;
     }
+    // Clients match responses to requests by id, as they may arrive out of order
+    resp.id = req.id;
+    resp.command = req.command;
+    
+    return resp;
+}
+
+Upp::ValueMap SessionServer::ResponseToValueMap(const DaemonResponse& resp) {
+    Upp::ValueMap map;
+    map.Add("id", Upp::String(resp.id.c_str()));
+    map.Add("ok", resp.ok);
+    map.Add("command", Upp::String(resp.command.c_str()));
+    map.Add("error_code", resp.error_code.empty() ? Upp::Value() : Upp::Value(Upp::String(resp.error_code.c_str())));
+    map.Add("error", resp.error.empty() ? Upp::Value() : Upp::Value(Upp::String(resp.error.c_str())));
+    map.Add("data", resp.data);
+    return map;
 }
 
 Result<DaemonResponse> SessionServer::HandleInitWorkspace(const DaemonRequest& req) {
@@ -1755,10 +1776,8 @@ Result<DaemonResponse> SessionServer::HandleInitWorkspace(const DaemonRequest& r
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunInitWorkspace(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunInitWorkspace(opts);
 
-    // Parse the result to get proper response structure
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     return CreateSuccessResponse(req, parsed_result);
 }
@@ -1775,9 +1794,8 @@ Result<DaemonResponse> SessionServer::HandleCreateSession(const DaemonRequest& r
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunCreateSession(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunCreateSession(opts);
 
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     return CreateSuccessResponse(req, parsed_result);
 }
@@ -1786,78 +1804,477 @@ Result<DaemonResponse> SessionServer::HandleListSessions(const DaemonRequest& re
     CommandOptions opts;
     opts.workspace = req.workspace;
     opts.user_id = req.user_id;
+    if (!req.payload.Get("state", Upp::Value()).IsVoid()) {
+        opts.session_state = (int)req.payload.Get("state", 0);
+    }
 
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunListSessions(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunListSessions(opts);
 
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     return CreateSuccessResponse(req, parsed_result);
 }
 
 Result<DaemonResponse> SessionServer::HandleRunTicks(const DaemonRequest& req) {
     int ticks = req.payload.Get("ticks", 1);
+    if (ticks <= 0) {
+        return CreateErrorResponse(req, "Ticks must be positive", "INVALID_ARGUMENT");
+    }
     
-    CommandOptions opts;
-    opts.workspace = req.workspace;
-    opts.session_id = req.session_id;
-    opts.ticks = ticks;
-    opts.user_id = req.user_id;
+    auto session_result = GetOrLoadSession(req.session_id, req.workspace);
+    if (!session_result.ok) {
+        return CreateErrorResponse(req, session_result.error_message, JsonIO::ErrorCodeToString(session_result.error_code));
+    }
     
-    auto session_store = CreateFilesystemSessionStore(opts.workspace);
-    CommandDispatcher dispatcher(std::move(session_store));
+    InMemorySessionState& state = *session_result.data;
     
-    Upp::String result = dispatcher.RunRunTicks(opts);
+    // With "stream", progress events go to the requester every progress_interval_ms,
+    // carrying the values of the "signals" listed as "component.pin"
+    bool stream = req.payload.Get("stream", false);
+    int progress_interval_ms = req.payload.Get("progress_interval_ms", 500);
+    std::vector<std::pair<Upp::String, ElcBase::PinStorage>> signals;
+    if (stream) {
+        Upp::Value names = req.payload.Get("signals", Upp::Value());
+        for (int i = 0; i < names.GetCount(); i++) {
+            Upp::String name = names[i];
+            int dot = name.ReverseFind('.');
+            ElcBase::PinStorage ps;
+            if (dot < 0 || !state.machine->FindPinStorage(name.Left(dot), name.Mid(dot + 1), ps)) {
+                return CreateErrorResponse(req, "Unknown or untraceable signal: " + name.ToStd(), "INVALID_ARGUMENT");
+            }
+            signals.emplace_back(name, ps);
+        }
+    }
     
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
+    auto start_time = std::chrono::steady_clock::now();
+    auto progress_interval = std::chrono::milliseconds(std::max(progress_interval_ms, 1));
+    auto next_progress = start_time + progress_interval;
+    auto send_progress = [&](int ticks_done) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        Upp::ValueMap event;
+        event.Add("event", Upp::String("run-ticks-progress"));
+        event.Add("id", Upp::String(req.id.c_str()));
+        event.Add("session_id", req.session_id);
+        event.Add("ticks_done", ticks_done);
+        event.Add("ticks_total", ticks);
+        event.Add("current_tick", state.machine->current_tick);
+        event.Add("ticks_per_sec", elapsed > 0 ? ticks_done / elapsed : 0.0);
+        Upp::ValueMap values;
+        for (const auto& signal : signals) {
+            values.Add(signal.first, (int)((*signal.second.data >> signal.second.bit) & 1));
+        }
+        event.Add("signals", values);
+        req.emit(event);
+    };
     
-    // If successful, broadcast a session update event
-    if (parsed_result.Get("ok", false)) {
-        Upp::ValueMap data_map = parsed_result.Get("data", Upp::ValueMap());
-        int session_id = data_map.Get("session_id", -1);
-        int total_ticks = data_map.Get("total_ticks", 0);
-        // For now, we'll broadcast after successful run-ticks
-        BroadcastSessionUpdate(session_id, req.workspace, total_ticks, total_ticks);
+    // Cancellation is checked between ticks, so the machine always stops at a tick
+    // boundary and what has run is recorded like a shorter run
+    int ticks_run = 0;
+    bool cancelled = false;
+    bool tick_failed = false;
+    while (ticks_run < ticks) {
+        if (req.cancelled && req.cancelled->load(std::memory_order_relaxed)) {
+            cancelled = true;
+            break;
+        }
+        if (!state.machine->Tick()) {
+            tick_failed = true;
+            break;
+        }
+        ticks_run++;
+        // The clock is read every 256 ticks only, small ticks are cheaper than that
+        if (stream && req.emit && (ticks_run & 255) == 0 && std::chrono::steady_clock::now() >= next_progress) {
+            send_progress(ticks_run);
+            next_progress = std::chrono::steady_clock::now() + progress_interval;
+        }
     }
     
-    return CreateSuccessResponse(req, parsed_result);
+    // Update the metadata in memory, it's written behind together with the snapshot
+    state.metadata.total_ticks = state.machine->current_tick;
+    for (auto& b : state.metadata.branches) {
+        if (b.name == state.current_branch) {
+            b.sim_revision = b.head_revision;
+            break;
+        }
+    }
+    std::string timestamp = GetCurrentTimestamp();
+    state.metadata.last_used_at = timestamp;
+    state.ticks_since_snapshot += ticks_run;
+    state.dirty = true;
+    
+    if (tick_failed) {
+        return CreateErrorResponse(req, "Machine tick failed during execution", "INTERNAL_ERROR");
+    }
+    
+    if (state.ticks_since_snapshot >= snapshot_interval_ticks_) {
+        auto save_result = SaveSessionToDisk(req.session_id, req.workspace, state);
+        if (!save_result.ok) {
+            return CreateErrorResponse(req, save_result.error_message, JsonIO::ErrorCodeToString(save_result.error_code));
+        }
+    }
+    
+    Upp::ValueMap response_data;
+    response_data.Add("session_id", req.session_id);
+    response_data.Add("ticks_run", ticks_run);
+    response_data.Add("ticks_requested", ticks);
+    response_data.Add("cancelled", cancelled);
+    response_data.Add("total_ticks", state.metadata.total_ticks);
+    response_data.Add("last_snapshot_file", Upp::String(state.last_snapshot_file.c_str()));
+    response_data.Add("state", "ready");
+    
+    // Log the event
+    EventLogEntry event;
+    event.timestamp = timestamp;
+    event.user_id = req.user_id;
+    event.session_id = req.session_id;
+    event.command = "run-ticks";
+    
+    Upp::ValueMap params;
+    params.Add("ticks", ticks);
+    event.params = Upp::String().Cat() << params;
+    
+    Upp::ValueMap results;
+    results.Add("ticks_run", ticks_run);
+    results.Add("cancelled", cancelled);
+    results.Add("total_ticks", state.metadata.total_ticks);
+    event.result = Upp::String().Cat() << results;
+    
+    EventLogger::LogEvent(state.session_dir, event);
+    
+    BroadcastSessionUpdate(req.session_id, req.workspace, state.metadata.total_ticks, state.metadata.total_ticks);
+    
+    return CreateSuccessResponse(req, MakeSuccessEnvelope("run-ticks", response_data));
+}
+
+bool SessionServer::IsEditCommand(const std::string& command) {
+    return command == "edit-add-component" || command == "edit-remove-component" ||
+           command == "edit-move-component" || command == "edit-set-component-property" ||
+           command == "edit-connect" || command == "edit-disconnect";
+}
+
+bool SessionServer::EditOperationFromRequest(const DaemonRequest& req, EditOperation& op, std::string& error) {
+    const Upp::ValueMap& p = req.payload;
+    op = EditOperation();
+    op.revision_base = 0;
+    if (req.command == "edit-add-component") {
+        op.type = EditOpType::AddComponent;
+        op.component_type = p.Get("type", Upp::String("")).ToStd();
+        op.component_name = p.Get("name", Upp::String("")).ToStd();
+        op.x = p.Get("x", 0);
+        op.y = p.Get("y", 0);
+        if (op.component_type.empty()) {
+            error = "Component type is required";
+            return false;
+        }
+        return true;
+    }
+
+    op.component_id = CircuitEntityId(p.Get(req.command == "edit-connect" || req.command == "edit-disconnect"
+                                            ? "start_component_id" : "component_id", Upp::String("")).ToStd());
+    if (!op.component_id.IsValid()) {
+        error = "Component ID is required";
+        return false;
+    }
+
+    if (req.command == "edit-remove-component") {
+        op.type = EditOpType::RemoveComponent;
+    }
+    else if (req.command == "edit-move-component") {
+        op.type = EditOpType::MoveComponent;
+        op.x = p.Get("x", 0);
+        op.y = p.Get("y", 0);
+    }
+    else if (req.command == "edit-set-component-property") {
+        op.type = EditOpType::SetComponentProperty;
+        op.property_name = p.Get("property_name", Upp::String("")).ToStd();
+        op.property_value = Upp::AsString(p.Get("property_value", Upp::String(""))).ToStd();
+        if (op.property_name.empty()) {
+            error = "Property name is required";
+            return false;
+        }
+    }
+    else {
+        op.type = req.command == "edit-connect" ? EditOpType::Connect : EditOpType::Disconnect;
+        op.pin_name = p.Get("start_pin_name", Upp::String("")).ToStd();
+        op.target_component_id = CircuitEntityId(p.Get("end_component_id", Upp::String("")).ToStd());
+        op.target_pin_name = p.Get("end_pin_name", Upp::String("")).ToStd();
+        if (op.pin_name.empty() || !op.target_component_id.IsValid() || op.target_pin_name.empty()) {
+            error = "All connection parameters are required";
+            return false;
+        }
+    }
+    return true;
+}
+
+Result<DaemonResponse> SessionServer::HandleBatch(const DaemonRequest& req) {
+    Upp::Value items = req.payload.Get("requests", Upp::Value());
+    bool atomic = req.payload.Get("atomic", false);
+    if (items.GetCount() == 0) {
+        return CreateErrorResponse(req, "requests must be a non-empty array", "INVALID_ARGUMENT");
+    }
+    if (req.session_id < 0) {
+        return CreateErrorResponse(req, "Session ID is required", "INVALID_ARGUMENT");
+    }
+
+    // Sub-requests run for the batch's session and user
+    std::vector<DaemonRequest> subs;
+    for (int i = 0; i < items.GetCount(); i++) {
+        Upp::ValueMap item = items[i];
+        DaemonRequest sub;
+        sub.id = item.Get("id", Upp::String("")).ToStd();
+        sub.command = item.Get("command", Upp::String("")).ToStd();
+        sub.workspace = req.workspace;
+        sub.session_id = req.session_id;
+        sub.user_id = req.user_id;
+        sub.payload = item.Get("payload", Upp::ValueMap());
+        sub.emit = req.emit;
+        sub.cancelled = req.cancelled;
+        if (sub.command == "batch" || sub.command == "cancel") {
+            return CreateErrorResponse(req, sub.command + " can't be part of a batch", "INVALID_ARGUMENT");
+        }
+        // Other commands persist on their own, so they can't be rolled back
+        if (atomic && !IsEditCommand(sub.command)) {
+            return CreateErrorResponse(req, "An atomic batch may only contain edit commands, not " + sub.command,
+                                       "INVALID_ARGUMENT");
+        }
+        subs.push_back(sub);
+    }
+
+    std::vector<DaemonResponse> responses(subs.size());
+    std::vector<size_t> pending;  // edit sub-requests not applied yet
+    int64_t circuit_revision = -1;
+    bool committed = true;
+
+    auto fail = [&](size_t i, const std::string& error, const std::string& error_code) {
+        responses[i] = CreateErrorResponse(subs[i], error, error_code).data;
+    };
+    auto fail_pending = [&](const std::string& error, const std::string& error_code) {
+        for (size_t i : pending) {
+            if (responses[i].command.empty()) {
+                fail(i, error, error_code);
+            }
+        }
+    };
+
+    // Applies the pending edits with one load of the circuit and one save of the session
+    auto apply_pending = [&]() {
+        if (pending.empty()) {
+            return;
+        }
+
+        std::vector<EditOperation> ops;
+        std::vector<size_t> op_requests;
+        for (size_t i : pending) {
+            EditOperation op;
+            std::string error;
+            if (!EditOperationFromRequest(subs[i], op, error)) {
+                fail(i, error, "INVALID_ARGUMENT");
+                continue;
+            }
+            if (op.type == EditOpType::AddComponent && op.component_name.empty()) {
+                op.component_name = op.component_type + "_" + std::to_string(i);
+            }
+            ops.push_back(op);
+            op_requests.push_back(i);
+        }
+        if (atomic && op_requests.size() != pending.size()) {
+            committed = false;
+            fail_pending("Not applied, another edit of the atomic batch is invalid", "NOT_APPLIED");
+            pending.clear();
+            return;
+        }
+
+        // A run-ticks earlier in the batch made the session resident. Its ticks are
+        // written out first, and the stale copy is dropped so that the next run-ticks
+        // loads the metadata saved below instead of writing back the old revision.
+        DropSession(req.session_id, req.workspace, true);
+
+        auto session_store = CreateFilesystemSessionStore(req.workspace);
+        auto load_result = session_store->LoadSession(req.session_id);
+        if (!load_result.ok) {
+            committed = false;
+            fail_pending(load_result.error_message, JsonIO::ErrorCodeToString(load_result.error_code));
+            pending.clear();
+            return;
+        }
+        SessionMetadata metadata = load_result.data;
+        std::string session_dir = req.workspace + "/sessions/" + std::to_string(req.session_id);
+
+        CircuitFacade circuit_facade;
+        std::vector<std::string> op_errors;
+        auto apply_result = circuit_facade.ApplyEditOperationBatchToBranch(
+            metadata, session_dir, ops, req.user_id, metadata.current_branch, atomic, op_errors);
+        if (!apply_result.ok) {
+            committed = false;
+            fail_pending(apply_result.error_message, JsonIO::ErrorCodeToString(apply_result.error_code));
+            pending.clear();
+            return;
+        }
+
+        bool any_failed = false;
+        bool any_applied = false;
+        for (size_t k = 0; k < ops.size(); k++) {
+            if (!op_errors[k].empty()) {
+                fail(op_requests[k], op_errors[k], "INVALID_EDIT_OPERATION");
+                any_failed = true;
+            }
+            else {
+                any_applied = true;
+            }
+        }
+        if (atomic && any_failed) {
+            committed = false;
+            fail_pending("Not applied, another edit of the atomic batch failed", "NOT_APPLIED");
+            pending.clear();
+            return;
+        }
+
+        if (any_applied) {
+            auto save_result = session_store->SaveSession(metadata);
+            if (!save_result.ok) {
+                committed = false;
+                fail_pending(save_result.error_message, JsonIO::ErrorCodeToString(save_result.error_code));
+                pending.clear();
+                return;
+            }
+            circuit_revision = apply_result.data.revision;
+            BroadcastSessionUpdate(req.session_id, req.workspace, (int)circuit_revision, metadata.sim_revision);
+        }
+
+        for (size_t k = 0; k < ops.size(); k++) {
+            if (!op_errors[k].empty()) {
+                continue;
+            }
+            Upp::ValueMap data;
+            data.Add("session_id", req.session_id);
+            data.Add("circuit_revision", apply_result.data.revision);
+            if (ops[k].type == EditOpType::AddComponent) {
+                data.Add("component_id", Upp::String(ops[k].component_id.id.c_str()));
+            }
+            if (ops[k].wire_id.IsValid()) {
+                data.Add("wire_id", Upp::String(ops[k].wire_id.id.c_str()));
+            }
+            size_t i = op_requests[k];
+            responses[i] = CreateSuccessResponse(subs[i], MakeSuccessEnvelope(subs[i].command, data)).data;
+        }
+        pending.clear();
+    };
+
+    for (size_t i = 0; i < subs.size(); i++) {
+        if (IsEditCommand(subs[i].command)) {
+            pending.push_back(i);
+            continue;
+        }
+        // Anything else sees the edits before it
+        apply_pending();
+        if (req.cancelled && req.cancelled->load()) {
+            fail(i, "Batch cancelled", "CANCELLED");
+            continue;
+        }
+        responses[i] = ExecuteRequest(subs[i]);
+    }
+    apply_pending();
+
+    Upp::ValueArray response_array;
+    for (const DaemonResponse& resp : responses) {
+        response_array.Add(ResponseToValueMap(resp));
+    }
+    Upp::ValueMap response_data;
+    response_data.Add("session_id", req.session_id);
+    response_data.Add("responses", response_array);
+    if (circuit_revision >= 0) {
+        response_data.Add("circuit_revision", circuit_revision);
+    }
+    if (atomic) {
+        response_data.Add("committed", committed);
+    }
+
+    return CreateSuccessResponse(req, MakeSuccessEnvelope("batch", response_data));
 }
 
 Result<DaemonResponse> SessionServer::HandleGetState(const DaemonRequest& req) {
-    CommandOptions opts;
-    opts.workspace = req.workspace;
-    opts.session_id = req.session_id;
-    opts.user_id = req.user_id;
+    auto session_result = GetOrLoadSession(req.session_id, req.workspace);
+    if (!session_result.ok) {
+        return CreateErrorResponse(req, session_result.error_message, JsonIO::ErrorCodeToString(session_result.error_code));
+    }
     
-    auto session_store = CreateFilesystemSessionStore(opts.workspace);
-    CommandDispatcher dispatcher(std::move(session_store));
+    InMemorySessionState& state = *session_result.data;
+    const SessionMetadata& metadata = state.metadata;
     
-    Upp::String result = dispatcher.RunGetState(opts);
+    std::optional<BranchMetadata> branch_opt = FindBranchByName(metadata, state.current_branch);
+    if (!branch_opt.has_value()) {
+        return CreateErrorResponse(req, "Branch not found: " + state.current_branch, "INVALID_ARGUMENT");
+    }
     
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
+    Upp::ValueMap response_data;
+    response_data.Add("session_id", req.session_id);
+    response_data.Add("branch", Upp::String(state.current_branch.c_str()));
+    response_data.Add("state", static_cast<int>(metadata.state));
+    response_data.Add("circuit_file", Upp::String(metadata.circuit_file.c_str()));
+    response_data.Add("total_ticks", metadata.total_ticks);
+    response_data.Add("circuit_revision", branch_opt->head_revision);
+    response_data.Add("sim_revision", branch_opt->sim_revision);
+    response_data.Add("created_at", Upp::String(metadata.created_at.c_str()));
+    response_data.Add("last_used_at", Upp::String(metadata.last_used_at.c_str()));
+    response_data.Add("breakpoints", Upp::ValueArray());
+    response_data.Add("traces", Upp::ValueArray());
+    response_data.Add("signals", Upp::ValueArray());
+    if (!state.last_snapshot_file.empty()) {
+        response_data.Add("last_snapshot_file", Upp::String(state.last_snapshot_file.c_str()));
+    }
     
-    return CreateSuccessResponse(req, parsed_result);
+    return CreateSuccessResponse(req, MakeSuccessEnvelope("get-state", response_data));
 }
 
 Result<DaemonResponse> SessionServer::HandleExportNetlist(const DaemonRequest& req) {
     int pcb_id = req.payload.Get("pcb_id", 0);
     
-    CommandOptions opts;
-    opts.workspace = req.workspace;
-    opts.session_id = req.session_id;
-    opts.pcb_id = pcb_id;
-    opts.user_id = req.user_id;
+    auto session_result = GetOrLoadSession(req.session_id, req.workspace);
+    if (!session_result.ok) {
+        return CreateErrorResponse(req, session_result.error_message, JsonIO::ErrorCodeToString(session_result.error_code));
+    }
     
-    auto session_store = CreateFilesystemSessionStore(opts.workspace);
-    CommandDispatcher dispatcher(std::move(session_store));
+    InMemorySessionState& state = *session_result.data;
     
-    Upp::String result = dispatcher.RunExportNetlist(opts);
+    EngineFacade engine_facade;
+    auto export_result = engine_facade.ExportNetlist(state.metadata, state.machine, pcb_id);
+    if (!export_result.ok) {
+        return CreateErrorResponse(req, export_result.error_message, JsonIO::ErrorCodeToString(export_result.error_code));
+    }
     
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
+    Upp::ValueMap response_data;
+    response_data.Add("session_id", req.session_id);
+    response_data.Add("pcb_id", pcb_id);
+    response_data.Add("netlist_file", Upp::String(export_result.data.c_str()));
     
-    return CreateSuccessResponse(req, parsed_result);
+    // Log the event
+    EventLogEntry event;
+    event.timestamp = GetCurrentTimestamp();
+    event.user_id = req.user_id;
+    event.session_id = req.session_id;
+    event.command = "export-netlist";
+    
+    Upp::ValueMap params;
+    params.Add("pcb_id", pcb_id);
+    event.params = Upp::String().Cat() << params;
+    
+    Upp::ValueMap results;
+    results.Add("netlist_file", Upp::String(export_result.data.c_str()));
+    event.result = Upp::String().Cat() << results;
+    
+    EventLogger::LogEvent(state.session_dir, event);
+    
+    return CreateSuccessResponse(req, MakeSuccessEnvelope("export-netlist", response_data));
+}
+
+Result<DaemonResponse> SessionServer::HandleFlushSessions(const DaemonRequest& req) {
+    Upp::ValueMap response_data;
+    response_data.Add("flushed", FlushSessions(req.workspace));
+    response_data.Add("resident", GetResidentSessionCount());
+    
+    return CreateSuccessResponse(req, MakeSuccessEnvelope("flush-sessions", response_data));
 }
 
 Result<DaemonResponse> SessionServer::HandleDestroySession(const DaemonRequest& req) {
@@ -1869,9 +2286,8 @@ Result<DaemonResponse> SessionServer::HandleDestroySession(const DaemonRequest&
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
     
-    Upp::String result = dispatcher.RunDestroySession(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunDestroySession(opts);
     
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
     
     return CreateSuccessResponse(req, parsed_result);
 }
@@ -1885,9 +2301,8 @@ Result<DaemonResponse> SessionServer::HandleLintCircuit(const DaemonRequest& req
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
     
-    Upp::String result = dispatcher.RunLintCircuit(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunLintCircuit(opts);
     
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
     
     return CreateSuccessResponse(req, parsed_result);
 }
@@ -1901,9 +2316,8 @@ Result<DaemonResponse> SessionServer::HandleAnalyzeCircuit(const DaemonRequest&
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
     
-    Upp::String result = dispatcher.RunAnalyzeCircuit(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunAnalyzeCircuit(opts);
     
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
     
     return CreateSuccessResponse(req, parsed_result);
 }
@@ -1930,9 +2344,8 @@ Result<DaemonResponse> SessionServer::HandleEditAddComponent(const DaemonRequest
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunEditAddComponent(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunEditAddComponent(opts);
 
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     // If successful, broadcast a session update event
     if (parsed_result.Get("ok", false)) {
@@ -1973,9 +2386,8 @@ Result<DaemonResponse> SessionServer::HandleEditRemoveComponent(const DaemonRequ
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunEditRemoveComponent(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunEditRemoveComponent(opts);
 
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     // If successful, broadcast a session update event
     if (parsed_result.Get("ok", false)) {
@@ -2020,9 +2432,8 @@ Result<DaemonResponse> SessionServer::HandleEditMoveComponent(const DaemonReques
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunEditMoveComponent(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunEditMoveComponent(opts);
 
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     // If successful, broadcast a session update event
     if (parsed_result.Get("ok", false)) {
@@ -2067,9 +2478,8 @@ Result<DaemonResponse> SessionServer::HandleEditSetComponentProperty(const Daemo
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunEditSetComponentProperty(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunEditSetComponentProperty(opts);
 
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     // If successful, broadcast a session update event
     if (parsed_result.Get("ok", false)) {
@@ -2116,9 +2526,8 @@ Result<DaemonResponse> SessionServer::HandleEditConnect(const DaemonRequest& req
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunEditConnect(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunEditConnect(opts);
 
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     // If successful, broadcast a session update event
     if (parsed_result.Get("ok", false)) {
@@ -2165,9 +2574,8 @@ Result<DaemonResponse> SessionServer::HandleEditDisconnect(const DaemonRequest&
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
 
-    Upp::String result = dispatcher.RunEditDisconnect(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunEditDisconnect(opts);
 
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
 
     // If successful, broadcast a session update event
     if (parsed_result.Get("ok", false)) {
@@ -2201,9 +2609,8 @@ Result<DaemonResponse> SessionServer::HandleEditGetCircuit(const DaemonRequest&
     auto session_store = CreateFilesystemSessionStore(opts.workspace);
     CommandDispatcher dispatcher(std::move(session_store));
     
-    Upp::String result = dispatcher.RunEditGetCircuit(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunEditGetCircuit(opts);
     
-    Upp::ValueMap parsed_result = JsonIO::Deserialize(result);
     
     return CreateSuccessResponse(req, parsed_result);
 }
@@ -2303,6 +2710,242 @@ Result<DaemonResponse> SessionServer::CreateErrorResponse(const DaemonRequest& r
     return Result<DaemonResponse>::MakeOk(resp);
 }
 
+Upp::ValueMap SessionServer::MakeSuccessEnvelope(const std::string& command, const Upp::ValueMap& data) {
+    Upp::ValueMap response;
+    response.Add("ok", true);
+    response.Add("command", Upp::String(command.c_str()));
+    response.Add("error_code", Upp::Value());
+    response.Add("error", Upp::Value());
+    response.Add("data", data);
+    return response;
+}
+
+std::string SessionServer::SessionCacheKey(int session_id, const std::string& workspace) {
+    return workspace + "#" + std::to_string(session_id);
+}
+
+std::shared_ptr<std::recursive_mutex> SessionServer::GetSessionLock(const std::string& key) {
+    std::lock_guard<std::mutex> lock(locks_mutex_);
+    auto& session_lock = session_locks_[key];
+    if (!session_lock) {
+        session_lock = std::make_shared<std::recursive_mutex>();
+    }
+    return session_lock;
+}
+
+void SessionServer::PruneSessionLock(const std::string& key) {
+    std::lock_guard<std::mutex> lock(locks_mutex_);
+    auto it = session_locks_.find(key);
+    // Still held or waited on by someone else
+    if (it == session_locks_.end() || it->second.use_count() > 1)
+        return;
+    {
+        std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+        if (session_cache_.count(key))
+            return;
+    }
+    session_locks_.erase(it);
+}
+
+int SessionServer::GetSessionLockCount() {
+    std::lock_guard<std::mutex> lock(locks_mutex_);
+    return (int)session_locks_.size();
+}
+
+int SessionServer::GetResidentSessionCount() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return (int)session_cache_.size();
+}
+
+bool SessionServer::IsResidentCommand(const std::string& command) {
+    return command == "run-ticks" || command == "get-state" || command == "export-netlist" ||
+           command == "flush-sessions";
+}
+
+Result<InMemorySessionState*> SessionServer::GetOrLoadSession(int session_id, const std::string& workspace) {
+    if (workspace.empty()) {
+        return Result<InMemorySessionState*>::MakeError(ErrorCode::CommandParseError, "Workspace path is required");
+    }
+    if (session_id < 0) {
+        return Result<InMemorySessionState*>::MakeError(ErrorCode::CommandParseError, "Session ID is required");
+    }
+    
+    std::string key = SessionCacheKey(session_id, workspace);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = session_cache_.find(key);
+        if (it != session_cache_.end()) {
+            it->second->last_used = ++use_counter_;
+            return Result<InMemorySessionState*>::MakeOk(it->second.get());
+        }
+    }
+    
+    // Not resident: load the metadata and the latest snapshot once
+    auto session_store = CreateFilesystemSessionStore(workspace);
+    auto load_result = session_store->LoadSession(session_id);
+    if (!load_result.ok) {
+        return Result<InMemorySessionState*>::MakeError(load_result.error_code, load_result.error_message);
+    }
+    
+    auto state = std::make_unique<InMemorySessionState>();
+    state->metadata = load_result.data;
+    state->current_branch = state->metadata.current_branch;
+    state->workspace = workspace;
+    state->session_dir = workspace + "/sessions/" + std::to_string(session_id);
+    state->dirty = false;
+    
+    EngineFacade engine_facade;
+    auto snapshot_result = engine_facade.LoadFromLatestSnapshot(state->metadata, state->session_dir, state->machine);
+    if (!snapshot_result.ok) {
+        return Result<InMemorySessionState*>::MakeError(snapshot_result.error_code, snapshot_result.error_message);
+    }
+    state->last_snapshot_file = snapshot_result.data.snapshot_file;
+    
+    InMemorySessionState* ptr = state.get();
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        state->last_used = ++use_counter_;
+        session_cache_[key] = std::move(state);
+    }
+    EvictLeastRecentlyUsed(key);
+    
+    return Result<InMemorySessionState*>::MakeOk(ptr);
+}
+
+Result<bool> SessionServer::SaveSessionToDisk(int session_id, const std::string& workspace, InMemorySessionState& state) {
+    if (state.machine && state.ticks_since_snapshot > 0) {
+        EngineFacade engine_facade;
+        auto snapshot_result = engine_facade.SnapshotMachine(state.metadata, *state.machine, state.session_dir);
+        if (!snapshot_result.ok) {
+            return Result<bool>::MakeError(snapshot_result.error_code, snapshot_result.error_message);
+        }
+        state.last_snapshot_file = snapshot_result.data.snapshot_file;
+        state.ticks_since_snapshot = 0;
+    }
+    
+    if (state.dirty) {
+        auto session_store = CreateFilesystemSessionStore(workspace);
+        auto save_result = session_store->SaveSession(state.metadata);
+        if (!save_result.ok) {
+            return save_result;
+        }
+        state.dirty = false;
+    }
+    
+    return Result<bool>::MakeOk(true);
+}
+
+void SessionServer::DropSession(int session_id, const std::string& workspace, bool flush) {
+    std::unique_ptr<InMemorySessionState> state;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = session_cache_.find(SessionCacheKey(session_id, workspace));
+        if (it == session_cache_.end())
+            return;
+        state = std::move(it->second);
+        session_cache_.erase(it);
+    }
+    
+    if (flush) {
+        auto save_result = SaveSessionToDisk(session_id, workspace, *state);
+        if (!save_result.ok) {
+            std::cerr << "Failed to save session " << session_id << ": " << save_result.error_message << std::endl;
+        }
+    }
+}
+
+void SessionServer::EvictLeastRecentlyUsed(const std::string& keep_key) {
+    struct Candidate {
+        uint64_t last_used;
+        std::string key;
+        int session_id;
+        std::string workspace;
+    };
+    
+    while (true) {
+        std::vector<Candidate> candidates;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            if ((int)session_cache_.size() <= max_resident_sessions_)
+                return;
+            
+            for (const auto& entry : session_cache_) {
+                if (entry.first != keep_key) {
+                    const InMemorySessionState& state = *entry.second;
+                    candidates.push_back({state.last_used, entry.first, state.metadata.session_id, state.workspace});
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.last_used < b.last_used; });
+        
+        // Evict the least recently used session that isn't busy with a request
+        bool evicted = false;
+        for (const Candidate& c : candidates) {
+            {
+                std::shared_ptr<std::recursive_mutex> session_lock = GetSessionLock(c.key);
+                std::unique_lock<std::recursive_mutex> lock(*session_lock, std::try_to_lock);
+                if (!lock.owns_lock())
+                    continue;
+                DropSession(c.session_id, c.workspace, true);
+            }
+            PruneSessionLock(c.key);
+            evicted = true;
+            break;
+        }
+        
+        // All others are busy: stay over the limit until the next load
+        if (!evicted)
+            return;
+    }
+}
+
+int SessionServer::FlushSessions(const std::string& workspace) {
+    std::vector<std::string> keys;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        for (const auto& entry : session_cache_) {
+            if (workspace.empty() || entry.second->workspace == workspace)
+                keys.push_back(entry.first);
+        }
+    }
+    
+    int flushed = 0;
+    for (const std::string& key : keys) {
+        if (FlushSession(key))
+            flushed++;
+        // The session may have been evicted since the keys were collected
+        PruneSessionLock(key);
+    }
+    
+    return flushed;
+}
+
+bool SessionServer::FlushSession(const std::string& key) {
+    // A session busy with a request is saved by a later flush
+    std::shared_ptr<std::recursive_mutex> session_lock = GetSessionLock(key);
+    std::unique_lock<std::recursive_mutex> lock(*session_lock, std::try_to_lock);
+    if (!lock.owns_lock())
+        return false;
+    
+    InMemorySessionState* state = nullptr;
+    {
+        std::lock_guard<std::mutex> cache_lock(cache_mutex_);
+        auto it = session_cache_.find(key);
+        if (it != session_cache_.end())
+            state = it->second.get();
+    }
+    if (!state || (!state->dirty && state->ticks_since_snapshot == 0))
+        return false;
+    
+    auto save_result = SaveSessionToDisk(state->metadata.session_id, state->workspace, *state);
+    if (!save_result.ok) {
+        std::cerr << "Failed to save session " << state->metadata.session_id << ": " << save_result.error_message << std::endl;
+        return false;
+    }
+    return true;
+}
+
 void SessionServer::BroadcastSessionUpdate(int session_id, const std::string& workspace, int circuit_revision, int sim_revision) {
     // Create and output the broadcast event
     Upp::ValueMap event;
@@ -2312,42 +2955,522 @@ void SessionServer::BroadcastSessionUpdate(int session_id, const std::string& wo
     event.Add("circuit_revision", circuit_revision);
     event.Add("sim_revision", sim_revision);
     
-    // Output to stdout as a JSON line
-    std::cout << JsonIO::ValueMapToJson(event).ToStd() << std::endl;
+    Broadcast(event);
 }
 
 Result<void> SessionServer::ProcessRequests() {
     std::string line;
     
+    StartWorkers();
+    
     // Read from stdin until EOF
     while (std::getline(std::cin, line)) {
         if (line.empty()) {
             continue;
         }
         
-        // Process the request
-        auto result = ProcessRequestFromJson(line);
+        SubmitRequest(ParseRequest(line));
+    }
+    
+    // Finish the requests still queued
+    StopWorkers();
+    
+    return Result<void>::MakeOk();
+}
+
+void SessionServer::StartWorkers() {
+    stopping_ = false;
+    for (int i = 0; i < worker_count_; i++) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+void SessionServer::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void SessionServer::SubmitRequest(DaemonRequest req, std::shared_ptr<DaemonClient> client, int encoding) {
+    if (req.command == "cancel") {
+        SendToRequester(client, encoding, ResponseToValueMap(HandleCancel(req, client)));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        QueuedRequest queued;
+        queued.req = std::move(req);
+        queued.client = std::move(client);
+        queued.encoding = encoding;
+        pending_requests_.push_back(std::move(queued));
+    }
+    queue_cv_.notify_one();
+}
+
+void SessionServer::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        // Take the oldest request whose session isn't running one already. Waiting
+        // here instead of on the session lock keeps workers free for other sessions.
+        auto it = pending_requests_.begin();
+        while (it != pending_requests_.end() && busy_keys_.count(RequestLockKey(it->req))) {
+            ++it;
+        }
         
-        if (result.ok) {
-            // Output the response
-            std::cout << JsonIO::ValueMapToJson(result.data) << std::endl;
+        if (it == pending_requests_.end()) {
+            if (stopping_ && pending_requests_.empty()) {
+                return;
+            }
+            queue_cv_.wait(lock);
+            continue;
+        }
+        
+        QueuedRequest queued = std::move(*it);
+        pending_requests_.erase(it);
+        std::string key = RequestLockKey(queued.req);
+        busy_keys_.insert(key);
+        
+        // Registered under queue_mutex_, so a cancel finds the request either pending
+        // or running. Of several running requests with one id on one connection, the
+        // first is cancellable.
+        DaemonRequest& req = queued.req;
+        std::shared_ptr<DaemonClient> client = queued.client;
+        RequestKey running_key(client.get(), req.id);
+        req.cancelled = std::make_shared<std::atomic<bool>>(false);
+        if (!req.id.empty()) {
+            running_requests_.emplace(running_key, req.cancelled);
+        }
+        int encoding = queued.encoding;
+        req.emit = [this, client, encoding](const Upp::ValueMap& event) {
+            SendToRequester(client, encoding, event);
+        };
+        lock.unlock();
+        
+        SendToRequester(client, encoding, ResponseToValueMap(ExecuteRequest(req)));
+        
+        lock.lock();
+        auto running = running_requests_.find(running_key);
+        if (running != running_requests_.end() && running->second == req.cancelled) {
+            running_requests_.erase(running);
+        }
+        busy_keys_.erase(key);
+        // Requests of this session may be waiting, as may workers stopping
+        queue_cv_.notify_all();
+    }
+}
+
+void SessionServer::SendToRequester(const std::shared_ptr<DaemonClient>& client, int encoding, const Upp::ValueMap& msg) {
+    if (client) {
+        WriteFrame(*client, encoding, msg);
+    } else {
+        WriteLine(JsonIO::ValueMapToJson(msg).ToStd());
+    }
+}
+
+DaemonResponse SessionServer::HandleCancel(const DaemonRequest& req, const std::shared_ptr<DaemonClient>& client) {
+    DaemonResponse resp;
+    resp.id = req.id;
+    resp.command = req.command;
+    
+    std::string target = req.payload.Get("request_id", Upp::String("")).ToStd();
+    if (target.empty()) {
+        resp.error_code = "INVALID_ARGUMENT";
+        resp.error = "request_id is required";
+        return resp;
+    }
+    
+    // A request that hasn't started is dropped and answered as cancelled; a running
+    // one stops at its next check, see DaemonRequest::cancelled. Other clients'
+    // requests are never touched, even if they use the same id.
+    std::string cancel_state;
+    QueuedRequest dropped;
+    bool was_pending = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        for (auto it = pending_requests_.begin(); it != pending_requests_.end(); ++it) {
+            if (it->req.id == target && it->client == client) {
+                dropped = std::move(*it);
+                pending_requests_.erase(it);
+                was_pending = true;
+                cancel_state = "dropped";
+                break;
+            }
+        }
+        if (!was_pending) {
+            auto running = running_requests_.find(RequestKey(client.get(), target));
+            if (running != running_requests_.end()) {
+                running->second->store(true);
+                cancel_state = "signalled";
+            }
+        }
+    }
+    
+    if (cancel_state.empty()) {
+        resp.error_code = "NOT_FOUND";
+        resp.error = "No pending or running request with id " + target;
+        return resp;
+    }
+    
+    if (was_pending) {
+        DaemonResponse cancelled;
+        cancelled.id = dropped.req.id;
+        cancelled.command = dropped.req.command;
+        cancelled.error_code = "CANCELLED";
+        cancelled.error = "Request cancelled before it started";
+        SendToRequester(dropped.client, dropped.encoding, ResponseToValueMap(cancelled));
+    }
+    
+    resp.ok = true;
+    resp.data.Add("request_id", Upp::String(target.c_str()));
+    resp.data.Add("state", Upp::String(cancel_state.c_str()));
+    return resp;
+}
+
+void SessionServer::WriteLine(const std::string& line) {
+    // Whole lines only, responses and broadcasts come from several threads
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    std::cout << line << '\n';
+    std::cout.flush();
+}
+
+void SessionServer::Broadcast(const Upp::ValueMap& event) {
+    if (!serving_socket_) {
+        // Output to stdout as a JSON line
+        WriteLine(JsonIO::ValueMapToJson(event).ToStd());
+        return;
+    }
+    
+    std::vector<std::shared_ptr<DaemonClient>> clients;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        clients = clients_;
+    }
+    for (const auto& client : clients) {
+        WriteFrame(*client, client->encoding, event);
+    }
+}
+
+#ifdef PLATFORM_POSIX
+
+struct SessionServer::DaemonClient {
+    int fd = -1;
+    std::mutex write_mutex;              // frames of concurrent responses must not interleave
+    std::atomic<int> encoding{FRAME_JSON};  // of the latest request, used for broadcasts
+    
+    ~DaemonClient() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+static bool ReadFully(int fd, void* buffer, size_t size) {
+    char* p = static_cast<char*>(buffer);
+    while (size > 0) {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool WriteFully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        // MSG_NOSIGNAL: a client that went away is an error here, not SIGPIPE
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool SessionServer::WriteFrame(DaemonClient& client, int encoding, const Upp::ValueMap& msg) {
+    Upp::String payload = encoding == FRAME_MSGPACK ? MsgPackIO::Encode(msg) : JsonIO::ValueMapToJson(msg);
+    
+    unsigned char header[5];
+    Upp::uint32 length = payload.GetCount();
+    header[0] = (unsigned char)(length >> 24);
+    header[1] = (unsigned char)(length >> 16);
+    header[2] = (unsigned char)(length >> 8);
+    header[3] = (unsigned char)length;
+    header[4] = (unsigned char)encoding;
+    
+    std::lock_guard<std::mutex> lock(client.write_mutex);
+    return WriteFully(client.fd, (const char*)header, sizeof(header)) &&
+           WriteFully(client.fd, payload.Begin(), payload.GetCount());
+}
+
+void SessionServer::ServeClient(std::shared_ptr<DaemonClient> client) {
+    std::string buffer;
+    while (true) {
+        unsigned char header[5];
+        if (!ReadFully(client->fd, header, sizeof(header))) {
+            break;
+        }
+        Upp::uint32 length = ((Upp::uint32)header[0] << 24) | ((Upp::uint32)header[1] << 16) |
+                             ((Upp::uint32)header[2] << 8) | header[3];
+        int encoding = header[4];
+        
+        // The stream can't be resynchronized after a bad header: drop the client
+        if (length > (Upp::uint32)MAX_FRAME_SIZE || (encoding != FRAME_JSON && encoding != FRAME_MSGPACK)) {
+            break;
+        }
+        
+        buffer.resize(length);
+        if (length > 0 && !ReadFully(client->fd, &buffer[0], length)) {
+            break;
+        }
+        Upp::String payload(buffer.data(), (int)length);
+        
+        Upp::ValueMap parsed;
+        if (encoding == FRAME_MSGPACK) {
+            Upp::Value value;
+            if (!MsgPackIO::Decode(payload, value) || !value.Is<Upp::ValueMap>()) {
+                DaemonResponse resp;
+                resp.ok = false;
+                resp.error_code = JsonIO::ErrorCodeToString(ErrorCode::CommandParseError);
+                resp.error = "Malformed MessagePack request";
+                WriteFrame(*client, encoding, ResponseToValueMap(resp));
+                continue;
+            }
+            parsed = value;
         } else {
-            // Output error response
-            DaemonResponse error_resp;
-            error_resp.id = "unknown";
-            error_resp.ok = false;
-            error_resp.command = "unknown";
-            error_resp.error_code = JsonIO::ErrorCodeToString(result.error_code);
-            error_resp.error = result.error_message;
-            error_resp.data = Upp::ValueMap();
-            
-            std::cout << JsonIO::ValueMapToJson(error_resp) << std::endl;
+            parsed = JsonIO::Deserialize(payload);
+        }
+        
+        client->encoding = encoding;
+        SubmitRequest(RequestFromValueMap(parsed), client, encoding);
+    }
+    
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    clients_.erase(std::remove(clients_.begin(), clients_.end(), client), clients_.end());
+}
+
+// Only processes of the daemon's own user may talk to it
+static bool IsPeerSameUser(int fd) {
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t length = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &length) < 0) {
+        return false;
+    }
+    return cred.uid == geteuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    if (getpeereid(fd, &uid, &gid) < 0) {
+        return false;
+    }
+    return uid == geteuid();
+#endif
+}
+
+void SessionServer::StopServing() {
+    stop_serving_ = true;
+    std::lock_guard<std::mutex> lock(stop_pipe_mutex_);
+    if (stop_pipe_write_ >= 0) {
+        char c = 0;
+        ssize_t ignored = write(stop_pipe_write_, &c, 1);
+        (void)ignored;
+    }
+}
+
+Result<void> SessionServer::ServeUnixSocket(const std::string& socket_path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+        return Result<void>::MakeError(ErrorCode::CommandParseError, "Invalid socket path: " + socket_path);
+    }
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    
+    // A socket file left by a previous run would make bind fail. It is only removed
+    // if nothing answers on it; a running daemon keeps its socket.
+    struct stat st;
+    if (lstat(socket_path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            return Result<void>::MakeError(ErrorCode::InternalError, socket_path + " exists and is not a socket");
+        }
+        int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe_fd < 0) {
+            return Result<void>::MakeError(ErrorCode::InternalError, std::string("socket: ") + strerror(errno));
+        }
+        bool answered = connect(probe_fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+        int connect_errno = errno;
+        close(probe_fd);
+        if (answered) {
+            return Result<void>::MakeError(ErrorCode::InternalError, "Another daemon is listening on " + socket_path);
+        }
+        if (connect_errno != ECONNREFUSED) {
+            return Result<void>::MakeError(ErrorCode::InternalError,
+                                           "Cannot probe " + socket_path + ": " + strerror(connect_errno));
+        }
+        unlink(socket_path.c_str());
+    }
+    
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        return Result<void>::MakeError(ErrorCode::InternalError, std::string("socket: ") + strerror(errno));
+    }
+    
+    // Created 0600, so other users can't connect; no worker threads run yet
+    mode_t old_umask = umask(0177);
+    bool listening = bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(listen_fd, SOMAXCONN) == 0;
+    int listen_errno = errno;
+    umask(old_umask);
+    if (!listening) {
+        close(listen_fd);
+        return Result<void>::MakeError(ErrorCode::InternalError,
+                                       "Cannot listen on " + socket_path + ": " + strerror(listen_errno));
+    }
+    
+    int stop_pipe[2];
+    if (pipe(stop_pipe) < 0) {
+        std::string error = strerror(errno);
+        close(listen_fd);
+        unlink(socket_path.c_str());
+        return Result<void>::MakeError(ErrorCode::InternalError, "pipe: " + error);
+    }
+    fcntl(stop_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(stop_pipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(stop_pipe[1], F_SETFL, O_NONBLOCK);
+    {
+        std::lock_guard<std::mutex> lock(stop_pipe_mutex_);
+        stop_pipe_write_ = stop_pipe[1];
+    }
+    
+    serving_socket_ = true;
+    StartWorkers();
+    
+    // Client readers are detached; this counts the running ones
+    std::mutex readers_mutex;
+    std::condition_variable readers_cv;
+    int active_readers = 0;
+    
+    pollfd fds[2];
+    fds[0].fd = listen_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = stop_pipe[0];
+    fds[1].events = POLLIN;
+    while (!stop_serving_) {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            break;
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+        
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        if (!IsPeerSameUser(fd)) {
+            close(fd);
+            continue;
+        }
+        
+        auto client = std::make_shared<DaemonClient>();
+        client->fd = fd;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex_);
+            clients_.push_back(client);
+        }
+        {
+            std::lock_guard<std::mutex> lock(readers_mutex);
+            active_readers++;
         }
+        std::thread([this, client, &readers_mutex, &readers_cv, &active_readers] {
+            ServeClient(client);
+            std::lock_guard<std::mutex> lock(readers_mutex);
+            active_readers--;
+            readers_cv.notify_all();
+        }).detach();
+    }
+    
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    {
+        // A StopServing still writing holds the mutex, so the descriptor stays valid
+        // until it's done; later ones see -1
+        std::lock_guard<std::mutex> lock(stop_pipe_mutex_);
+        stop_pipe_write_ = -1;
+    }
+    close(stop_pipe[0]);
+    close(stop_pipe[1]);
+    
+    // Stop reading from the clients, then answer what they have sent already
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        for (const auto& client : clients_) {
+            shutdown(client->fd, SHUT_RD);
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(readers_mutex);
+        readers_cv.wait(lock, [&active_readers] { return active_readers == 0; });
     }
+    StopWorkers();
+    serving_socket_ = false;
+    stop_serving_ = false;
     
     return Result<void>::MakeOk();
 }
 
+#else
+
+struct SessionServer::DaemonClient {
+    std::atomic<int> encoding{FRAME_JSON};
+};
+
+bool SessionServer::WriteFrame(DaemonClient& client, int encoding, const Upp::ValueMap& msg) {
+    return false;
+}
+
+void SessionServer::ServeClient(std::shared_ptr<DaemonClient> client) {
+}
+
+void SessionServer::StopServing() {
+}
+
+Result<void> SessionServer::ServeUnixSocket(const std::string& socket_path) {
+    return Result<void>::MakeError(ErrorCode::InternalError, "Unix domain sockets aren't supported on this platform");
+}
+
+#endif
+
 void SessionServer::BroadcastCircuitMerged(int session_id, const std::string& workspace, int revision, const std::vector<EditOperation>& ops) {
     // Create and output the broadcast event for a merged circuit operation
     Upp::ValueMap event;
@@ -2370,8 +3493,7 @@ void SessionServer::BroadcastCircuitMerged(int session_id, const std::string& wo
 
     event.Add("merged_ops", ops_array);
 
-    // Output to stdout as a JSON line
-    std::cout << JsonIO::ValueMapToJson(event).ToStd() << std::endl;
+    Broadcast(event);
 }
 
 Result<DaemonResponse> SessionServer::HandleDesignerCreateSession(const DaemonRequest& req) {
@@ -16,9 +16,18 @@
 #include "CoDesigner.h"
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <future>
+#include <list>
+#include <map>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
 
 namespace ProtoVMCLI {
 
@@ -30,6 +39,13 @@ struct InMemorySessionState {
     std::string current_branch;          // current branch in memory
     std::unordered_map<std::string, CircuitData> branch_circuits;  // circuit data per branch
     std::unordered_map<std::string, std::unique_ptr<Machine>> branch_machines;  // machines per branch
+
+    // Residency bookkeeping for SessionServer's session cache
+    std::string workspace;
+    std::string session_dir;
+    std::string last_snapshot_file;      // latest snapshot on disk for this session
+    int ticks_since_snapshot = 0;        // ticks run since last_snapshot_file was written
+    uint64_t last_used = 0;              // LRU stamp, larger is more recent
 };
 
 struct DaemonRequest {
@@ -39,6 +55,12 @@ struct DaemonRequest {
     int session_id = -1;
     std::string user_id;
     Upp::ValueMap payload;
+
+    // Set by the request executor while the request runs. Handlers of long commands
+    // send events to the requester only through emit, and stop early once cancelled
+    // is raised by a "cancel" request. Both are empty for direct HandleRequest calls.
+    std::function<void(const Upp::ValueMap&)> emit;
+    std::shared_ptr<std::atomic<bool>> cancelled;
 };
 
 struct DaemonResponse {
@@ -55,22 +77,132 @@ public:
     SessionServer();
     ~SessionServer();
 
+    // Safe to call from several threads: requests of one session are serialized by
+    // that session's lock, requests of different sessions run concurrently. Commands
+    // that aren't served from resident sessions first flush the workspace, but a
+    // session busy with another request is read as of its last flush, e.g.
+    // list-sessions may report the total_ticks it had before a running run-ticks.
     Result<void> HandleRequest(const DaemonRequest& req, DaemonResponse& out_resp);
     
-    // Process requests from a stream (e.g., stdin)
+    // Process requests from a stream (e.g., stdin). Requests run on a pool of worker
+    // threads; each response carries the id of its request and responses may arrive
+    // out of order, except that the requests of one session complete in order.
     Result<void> ProcessRequests();
     
     // Process a single request from JSON string
     Result<DaemonResponse> ProcessRequestFromJson(const std::string& json_str);
 
+    // Serve any number of clients on a Unix domain socket instead of stdin/stdout,
+    // until StopServing is called or the listening socket fails. Messages in both
+    // directions are frames: a 4 byte big endian payload length, 1 byte
+    // FrameEncoding, then the payload. Responses use the encoding of their request;
+    // broadcast events go to every client, in the encoding of its latest request.
+    // The socket is only accessible to the daemon's user, and it is an error if
+    // another daemon already answers on socket_path.
+    Result<void> ServeUnixSocket(const std::string& socket_path);
+
+    // Makes ServeUnixSocket stop accepting clients, answer the requests it has
+    // received and return. Async-signal-safe, for SIGINT/SIGTERM handlers.
+    void StopServing();
+
+    enum FrameEncoding {
+        FRAME_JSON = 0,      // same JSON as the stdin protocol, the default
+        FRAME_MSGPACK = 1,   // MessagePack, compact for bulk data like traces and memory
+    };
+    static const int MAX_FRAME_SIZE = 64 << 20;
+
+    // Number of worker threads used by ProcessRequests; 1 handles requests one by one
+    void SetWorkerCount(int n) { worker_count_ = n > 0 ? n : 1; }
+
+    static Upp::ValueMap ResponseToValueMap(const DaemonResponse& resp);
+
+    // Resident sessions: run-ticks, get-state and export-netlist are served from
+    // Machines kept in memory. At most max_resident_sessions are kept (least recently
+    // used is evicted) and a snapshot is written behind once snapshot_interval_ticks
+    // ticks have accumulated, or when the session is flushed or evicted.
+    void SetMaxResidentSessions(int n) { max_resident_sessions_ = n > 0 ? n : 1; }
+    void SetSnapshotIntervalTicks(int ticks) { snapshot_interval_ticks_ = ticks; }
+    int GetResidentSessionCount();
+
+    // Write all dirty sessions of a workspace (all workspaces if empty) to disk.
+    // Sessions busy with a request are skipped, their disk copy stays stale until
+    // a later flush or their eviction.
+    int FlushSessions(const std::string& workspace = "");
+
+    // Session locks kept, one per resident session and per request in progress
+    int GetSessionLockCount();
+
 private:
+    // A resident session's state is only used while holding its session lock;
+    // cache_mutex_ guards just the map
     std::unordered_map<std::string, std::unique_ptr<InMemorySessionState>> session_cache_;
     std::mutex cache_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<std::recursive_mutex>> session_locks_;
+    std::mutex locks_mutex_;
+    std::mutex output_mutex_;
     std::shared_ptr<CoDesignerManager> co_designer_manager_;
+    int max_resident_sessions_ = 16;
+    int snapshot_interval_ticks_ = 100000;
+    uint64_t use_counter_ = 0;
+    
+    // Request executor used by ProcessRequests and ServeUnixSocket
+    struct DaemonClient;
+    struct QueuedRequest {
+        DaemonRequest req;
+        std::shared_ptr<DaemonClient> client;  // null for stdin, answered on stdout
+        int encoding = FRAME_JSON;
+    };
+    int worker_count_ = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<std::thread> workers_;
+    std::list<QueuedRequest> pending_requests_;
+    std::unordered_set<std::string> busy_keys_;  // lock keys of the requests being run
+    // Cancel flags by connection and request id; ids are only unique within a connection
+    typedef std::pair<const DaemonClient*, std::string> RequestKey;
+    std::map<RequestKey, std::shared_ptr<std::atomic<bool>>> running_requests_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    bool stopping_ = false;
+    
+    // Socket clients, for broadcasts
+    std::vector<std::shared_ptr<DaemonClient>> clients_;
+    std::mutex clients_mutex_;
+    std::atomic<bool> serving_socket_{false};  // read by Broadcast on any thread
+    std::atomic<bool> stop_serving_{false};
+    // Wakes the accept loop for StopServing. Set and cleared under stop_pipe_mutex_,
+    // which StopServing holds while writing, so the pipe is never closed under it.
+    int stop_pipe_write_ = -1;
+    std::mutex stop_pipe_mutex_;
+    
+    void StartWorkers();
+    void StopWorkers();
+    void SubmitRequest(DaemonRequest req, std::shared_ptr<DaemonClient> client = nullptr, int encoding = FRAME_JSON);
+    void WorkerLoop();
+    void SendToRequester(const std::shared_ptr<DaemonClient>& client, int encoding, const Upp::ValueMap& msg);
+    // "cancel" is answered right away instead of being queued behind the request it
+    // targets, which must come from the same client connection
+    DaemonResponse HandleCancel(const DaemonRequest& req, const std::shared_ptr<DaemonClient>& client);
+    void ServeClient(std::shared_ptr<DaemonClient> client);
+    DaemonRequest ParseRequest(const std::string& json_str);
+    static DaemonRequest RequestFromValueMap(const Upp::ValueMap& parsed);
+    DaemonResponse ExecuteRequest(const DaemonRequest& req);
+    void WriteLine(const std::string& line);
+    static bool WriteFrame(DaemonClient& client, int encoding, const Upp::ValueMap& msg);
+    void Broadcast(const Upp::ValueMap& event);
     
     // Session management methods
+    static std::string SessionCacheKey(int session_id, const std::string& workspace);
+    // Requests without a session share the lock of their workspace
+    static std::string RequestLockKey(const DaemonRequest& req) { return SessionCacheKey(req.session_id, req.workspace); }
+    std::shared_ptr<std::recursive_mutex> GetSessionLock(const std::string& key);
+    // Forgets the lock of a session that is neither resident nor locked by anyone
+    void PruneSessionLock(const std::string& key);
+    Result<void> DispatchRequest(const DaemonRequest& req, DaemonResponse& out_resp);
+    bool FlushSession(const std::string& key);
     Result<InMemorySessionState*> GetOrLoadSession(int session_id, const std::string& workspace);
-    Result<bool> SaveSessionToDisk(int session_id, const std::string& workspace, const InMemorySessionState& state);
+    Result<bool> SaveSessionToDisk(int session_id, const std::string& workspace, InMemorySessionState& state);
+    void DropSession(int session_id, const std::string& workspace, bool flush);
+    void EvictLeastRecentlyUsed(const std::string& keep_key);
+    static bool IsResidentCommand(const std::string& command);
     
     // Command handler methods
     Result<DaemonResponse> HandleInitWorkspace(const DaemonRequest& req);
@@ -82,6 +214,12 @@ private:
     Result<DaemonResponse> HandleDestroySession(const DaemonRequest& req);
     Result<DaemonResponse> HandleLintCircuit(const DaemonRequest& req);
     Result<DaemonResponse> HandleAnalyzeCircuit(const DaemonRequest& req);
+    Result<DaemonResponse> HandleFlushSessions(const DaemonRequest& req);
+    // Runs an ordered list of sub-requests for one session: consecutive edits are grouped into
+    // one revision, non-edit commands see all earlier edits, and atomic batches accept only edits.
+    Result<DaemonResponse> HandleBatch(const DaemonRequest& req);
+    static bool IsEditCommand(const std::string& command);
+    static bool EditOperationFromRequest(const DaemonRequest& req, EditOperation& op, std::string& error);
     
     // Circuit edit handlers
     Result<DaemonResponse> HandleEditAddComponent(const DaemonRequest& req);
@@ -146,6 +284,8 @@ private:
     // Utility methods
     Result<DaemonResponse> CreateSuccessResponse(const DaemonRequest& req, const Upp::ValueMap& data = Upp::ValueMap());
     Result<DaemonResponse> CreateErrorResponse(const DaemonRequest& req, const std::string& error_msg, const std::string& error_code = "");
+    // Same envelope as a parsed JsonIO::SuccessResponse, for handlers not going through CommandDispatcher
+    static Upp::ValueMap MakeSuccessEnvelope(const std::string& command, const Upp::ValueMap& data);
 
     // Broadcast event methods
     void BroadcastSessionUpdate(int session_id, const std::string& workspace, int circuit_revision, int sim_revision);
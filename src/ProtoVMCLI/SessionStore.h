@@ -4,6 +4,7 @@
 #include "SessionTypes.h"
 #include <string>
 #include <vector>
+#include <algorithm>
 
 namespace ProtoVMCLI {
 
@@ -22,9 +23,23 @@ public:
     };
 
     virtual Result<ListSessionsResult> ListSessions() = 0;
+    // Sessions in the given state only; corrupt sessions are reported all the same
+    virtual Result<ListSessionsResult> ListSessionsInState(SessionState state) {
+        auto result = ListSessions();
+        if (result.ok) {
+            auto& sessions = result.data.sessions;
+            sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                                          [state](const SessionMetadata& s) { return s.state != state; }),
+                           sessions.end());
+        }
+        return result;
+    }
     virtual Result<bool> DeleteSession(int session_id) = 0;
     virtual Result<bool> UpdateSessionState(int session_id, SessionState state) = 0;
     virtual Result<bool> UpdateSessionTicks(int session_id, int ticks) = 0;
+    // Rebuilds any index the store keeps over its sessions from the sessions
+    // themselves, e.g. after session directories were copied in or removed by hand
+    virtual Result<bool> RebuildSessionCatalog() { return Result<bool>::MakeOk(true); }
 };
 
 } // namespace ProtoVMCLI
@@ -28,7 +28,8 @@ enum class ErrorCode {
     InternalError,
     Conflict,
     InvalidEditOperation,
-    CircuitStateCorrupt
+    CircuitStateCorrupt,
+    CircuitNotSupported     // the circuit has parts the simulator cannot build
     // add more if needed
 };
 
@@ -142,6 +143,7 @@ struct CommandOptions {
     std::optional<int> session_id;
     std::optional<int> ticks;
     std::optional<int> pcb_id;
+    std::optional<int> session_state;  // list-sessions: only sessions in this SessionState
     std::optional<std::string> circuit_file;
     std::optional<std::string> netlist_file;
     std::optional<bool> soft_delete;
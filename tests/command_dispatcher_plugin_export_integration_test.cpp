@@ -49,15 +49,14 @@ void TestCommandDispatcherIntegration() {
     ProtoVMCLI::CommandDispatcher dispatcher(std::move(session_store));
     
     // Call the command dispatcher method for plugin project export
-    Upp::String result = dispatcher.RunInstrumentExportPluginProject(opts);
+    Upp::ValueMap parsed_result = dispatcher.RunInstrumentExportPluginProject(opts);
     
-    // Parse the result to verify it's a success response
-    Upp::ValueMap parsed_result = ProtoVMCLI::JsonIO::Deserialize(result);
+    // Check whether it's a success response
     bool ok = parsed_result.Get("ok", false);
     
     // Since we're using dummy paths that don't actually exist, this may fail for that reason
     // But we can at least verify the command gets called without crashing
-    std::cout << "  Command result: " << result << std::endl;
+    std::cout << "  Command result: " << ProtoVMCLI::JsonIO::ValueMapToJson(parsed_result) << std::endl;
     
     // For this test, we'll just verify that the call doesn't crash and produces a JSON response
     std::cout << "  CommandDispatcher integration test completed (with dummy paths)\n";
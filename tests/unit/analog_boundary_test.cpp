@@ -0,0 +1,179 @@
+#include "ProtoVM.h"
+#include "AnalogComponents.h"
+#include "AnalogSimulation.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+// One digital output the test sets between machine ticks
+class LevelSource : public ElcBase {
+public:
+    byte value = 0;
+
+    LevelSource() {AddSource("O").SetMultiConn();}
+
+    String GetClassName() const override {return "LevelSource";}
+    bool Tick() override {return true;}
+    bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override {
+        if (type != WRITE)
+            return true;
+        return dest.PutRaw(dest_conn_id, &value, 0, 1);
+    }
+    bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override {return true;}
+};
+
+// Digital input reading an analog net
+class LevelSink : public ElcBase {
+public:
+    byte in = 0;
+
+    LevelSink() {AddSink("I");}
+
+    String GetClassName() const override {return "LevelSink";}
+    bool Tick() override {return true;}
+    bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override {return true;}
+    bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override {
+        in = *data & 1;
+        return true;
+    }
+};
+
+static int countEdges(const std::vector<byte>& levels) {
+    int edges = 0;
+    for (size_t i = 1; i < levels.size(); i++)
+        if (levels[i] != levels[i - 1])
+            edges++;
+    return edges;
+}
+
+// src -> 1 kOhm -> node -> 1 uF -> 0 V, node -> sink, with the unlinked capacitor pin
+// as the 0 V fixed net. The sink sees the node go high on the tick that solves the
+// rise through the upper threshold, and low on the fall through the lower one.
+void testRCCrossingDrivesDigitalInput() {
+    std::cout << "Testing an RC threshold crossing driving a digital input..." << std::endl;
+
+    const double tau = 1e-3;
+    const double period = 1e-5;
+    Machine mach;
+    Pcb& b = mach.AddPcb();
+    LevelSource& src = b.Add<LevelSource>("src");
+    AnalogResistor& r = b.Add<AnalogResistor>("r");
+    AnalogCapacitor& c = b.Add<AnalogCapacitor>("c");
+    LevelSink& sink = b.Add<LevelSink>("sink");
+    r.SetResistance(1000.0);
+    c.SetCapacitance(1e-6);
+    src["O"] >> r["A"];
+    r["B"] >> c["POS"];
+    c["POS"] >> sink["I"];
+    c.NotRequired("NEG");
+    c.SetAnalogValue(1, 0.0);
+    mach.RegisterAnalogComponent(&r);
+    mach.RegisterAnalogComponent(&c);
+    bool ok = mach.Init();
+    assert(ok);
+    AnalogSimulation* sim = mach.GetAnalogSimulation();
+    assert(sim);
+    sim->SetTimeStep(period);
+
+    double upper = sim->GetLogicThreshold() + 0.5 * sim->GetLogicHysteresis();
+    double lower = sim->GetLogicThreshold() - 0.5 * sim->GetLogicHysteresis();
+    double high = AnalogNodeBase::LOGIC_HIGH_VOLTAGE;
+
+    // The driver goes high on the first tick and takes effect on the next one
+    src.value = 1;
+    const int release = 300;
+    std::vector<byte> levels;
+    int rise_tick = -1, fall_tick = -1;
+    for (int i = 1; i <= 2 * release; i++) {
+        if (i == release)
+            src.value = 0;
+        ok = mach.Tick();
+        assert(ok);
+        if (sink.in && rise_tick < 0)
+            rise_tick = i;
+        if (!sink.in && rise_tick >= 0 && fall_tick < 0)
+            fall_tick = i;
+        levels.push_back(sink.in);
+    }
+    assert(sim->GetBoundaryCount() >= 1);
+
+    // Within a tick or two of the analytic crossings, counting the tick the driver
+    // change takes to reach the net
+    double rise = 1.0 + -tau * std::log(1.0 - upper / high) / period;
+    assert(std::fabs(rise_tick - rise) <= 2.0);
+    double v_release = high * (1.0 - std::exp(-(release - 1) * period / tau));
+    double fall = release + 1.0 + -tau * std::log(lower / v_release) / period;
+    assert(std::fabs(fall_tick - fall) <= 2.0);
+    assert(countEdges(levels) == 2);
+
+    // The digital writes over the analog links leave the solved voltages alone
+    double v_end = v_release * std::exp(-release * period / tau);
+    assert(std::fabs(c.GetAnalogValue(0) - v_end) < 0.02);
+    assert(r.GetAnalogValue(1) == c.GetAnalogValue(0));
+
+    std::cout << "RC threshold crossing test passed." << std::endl;
+}
+
+// The unlinked resistor pin is a fixed net that steps a fast RC node through voltages
+// around the threshold. Levels inside the hysteresis band keep the previous state.
+void testHysteresisBand() {
+    std::cout << "Testing threshold hysteresis on a digital input..." << std::endl;
+
+    Machine mach;
+    Pcb& b = mach.AddPcb();
+    AnalogResistor& r = b.Add<AnalogResistor>("r");
+    AnalogCapacitor& c = b.Add<AnalogCapacitor>("c");
+    LevelSink& sink = b.Add<LevelSink>("sink");
+    r.SetResistance(1000.0);
+    c.SetCapacitance(1e-9);
+    r["B"] >> c["POS"];
+    c["POS"] >> sink["I"];
+    r.NotRequired("A");
+    c.NotRequired("NEG");
+    r.SetAnalogValue(0, 0.0);
+    c.SetAnalogValue(1, 0.0);
+    mach.RegisterAnalogComponent(&r);
+    mach.RegisterAnalogComponent(&c);
+    bool ok = mach.Init();
+    assert(ok);
+    AnalogSimulation* sim = mach.GetAnalogSimulation();
+    sim->SetTimeStep(1e-5);
+    sim->SetLogicThreshold(2.5, 0.2);
+
+    // Upper threshold 2.6 V, lower 2.4 V
+    struct Hold {
+        double voltage;
+        byte level;
+    };
+    const Hold holds[] = {
+        {2.0, 0}, {2.55, 0}, {2.42, 0}, {2.58, 0}, {2.7, 1}, {2.45, 1},
+        {2.55, 1}, {2.42, 1}, {2.3, 0}, {2.58, 0}, {2.45, 0}, {3.0, 1},
+    };
+    std::vector<byte> levels;
+    for (const Hold& h : holds) {
+        r.SetAnalogValue(0, h.voltage);
+        for (int i = 0; i < 20; i++) {
+            ok = mach.Tick();
+            assert(ok);
+            levels.push_back(sink.in);
+        }
+        assert(std::fabs(c.GetAnalogValue(0) - h.voltage) < 1e-3);
+        assert(sink.in == h.level);
+    }
+    // No chatter while the node settles inside the band
+    assert(countEdges(levels) == 3);
+
+    std::cout << "Hysteresis test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Analog Boundary Unit Tests..." << std::endl;
+
+    testRCCrossingDrivesDigitalInput();
+    testHysteresisBand();
+
+    std::cout << "All Analog Boundary Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "ProtoVM.h"
+#include "AnalogSemiconductors.h"
+#include "TriodeTubeModel.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+// Compares GetPinConductances with central differences of GetPinCurrents at the pin
+// voltages v, column by column
+static void checkJacobian(const AnalogNodeBase& dev, int pins, const double* v) {
+    std::vector<double> i(pins), g(pins * pins), i_ref(pins);
+    bool ok = dev.GetPinConductances(v, i.data(), g.data());
+    assert(ok);
+
+    // The currents returned with the conductances are the plain pin currents
+    dev.GetPinCurrents(v, i_ref.data());
+    for (int p = 0; p < pins; p++)
+        assert(i[p] == i_ref[p]);
+
+    double scale = 0.0;
+    for (double x : g)
+        scale = std::max(scale, std::fabs(x));
+
+    std::vector<double> vp(v, v + pins), vm(v, v + pins), ip(pins), im(pins);
+    for (int q = 0; q < pins; q++) {
+        double h = 1e-7 * (1.0 + std::fabs(v[q]));
+        vp[q] = v[q] + h;
+        vm[q] = v[q] - h;
+        dev.GetPinCurrents(vp.data(), ip.data());
+        dev.GetPinCurrents(vm.data(), im.data());
+        vp[q] = vm[q] = v[q];
+        for (int p = 0; p < pins; p++) {
+            double fd = (ip[p] - im[p]) / (2.0 * h);
+            double analytic = g[p * pins + q];
+            if (std::fabs(fd - analytic) > 1e-5 * scale + 1e-15) {
+                std::cout << dev.GetClassName() << ": d i" << p << " / d v" << q
+                          << " is " << analytic << ", finite difference " << fd << std::endl;
+                assert(false);
+            }
+        }
+    }
+
+    // Each column sums to zero: the pin currents are conserved
+    for (int q = 0; q < pins; q++) {
+        double sum = 0.0;
+        for (int p = 0; p < pins; p++)
+            sum += g[p * pins + q];
+        assert(std::fabs(sum) <= 1e-12 * scale + 1e-18);
+    }
+}
+
+void testDiodeJacobian() {
+    std::cout << "Testing diode conductances against finite differences..." << std::endl;
+
+    AnalogDiode diode;
+    AnalogDiode led(1e-18, 1.9);
+    // Reverse, around zero, forward, and past the linear continuation of the junction
+    const double vd[] = {-5.0, -0.1, 0.0, 0.3, 0.6, 0.75, 1.5};
+    for (double d : vd) {
+        double v[2] = {d + 1.0, 1.0};
+        checkJacobian(diode, 2, v);
+        checkJacobian(led, 2, v);
+    }
+
+    std::cout << "Diode Jacobian test passed." << std::endl;
+}
+
+void testNPNJacobian() {
+    std::cout << "Testing NPN conductances against finite differences..." << std::endl;
+
+    AnalogNPNTransistor npn(150.0);
+    // Collector, base, emitter: cutoff, forward active, saturation, reverse active
+    const double points[][3] = {
+        {5.0, 0.0, 0.0},
+        {5.0, 0.65, 0.0},
+        {3.0, 2.7, 2.0},
+        {0.1, 0.7, 0.0},
+        {0.0, 0.6, 5.0},
+        {12.0, 1.2, 0.0},
+    };
+    for (const auto& v : points)
+        checkJacobian(npn, 3, v);
+
+    std::cout << "NPN Jacobian test passed." << std::endl;
+}
+
+void testTriodeJacobian() {
+    std::cout << "Testing triode conductances against finite differences..." << std::endl;
+
+    TriodeTube tube;
+    // Grid, plate, cathode: class A bias points, near cutoff, and with a raised cathode.
+    // Cutoff and the current clip are kinks, so the points stay clear of them.
+    const double points[][3] = {
+        {-1.5, 250.0, 0.0},
+        {-1.0, 150.0, 0.0},
+        {-2.2, 250.0, 0.0},
+        {0.0, 200.0, 1.5},
+        {-0.9, 100.0, 0.0},
+    };
+    for (const auto& v : points) {
+        checkJacobian(tube, 3, v);
+        double i[3], g[9];
+        tube.GetPinConductances(v, i, g);
+        assert(i[TriodeTube::PLATE] > 0.0 && g[TriodeTube::PLATE * 3 + TriodeTube::PLATE] > 0.0);
+    }
+
+    // Beyond cutoff nothing flows and nothing responds
+    double v[3] = {-10.0, 100.0, 0.0};
+    double i[3], g[9];
+    tube.GetPinConductances(v, i, g);
+    for (int k = 0; k < 9; k++)
+        assert(g[k] == 0.0);
+    assert(i[TriodeTube::PLATE] == 0.0);
+
+    std::cout << "Triode Jacobian test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Analog Jacobian Unit Tests..." << std::endl;
+
+    testDiodeJacobian();
+    testNPNJacobian();
+    testTriodeJacobian();
+
+    std::cout << "All Analog Jacobian Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "AnalogSparse.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// Resistor ladder: node i to i + 1 through series[i], every node to ground through
+// shunt[i], plus a few long links so that the factorization has fill-in
+struct Ladder {
+    int n = 0;
+    std::vector<double> series, shunt;
+    std::vector<std::pair<int, int>> links;
+    std::vector<double> link_g;
+
+    explicit Ladder(int size) : n(size) {
+        series.assign(n - 1, 0.0);
+        shunt.assign(n, 0.0);
+        for (int i = 0; i < n - 1; i++)
+            series[i] = 1.0 / (100.0 + 7.0 * i);
+        for (int i = 0; i < n; i++)
+            shunt[i] = 1.0 / (10000.0 + 13.0 * i);
+        links.push_back(std::make_pair(0, n - 1));
+        links.push_back(std::make_pair(3, n / 2));
+        links.push_back(std::make_pair(n / 3, 2 * n / 3));
+        link_g.assign(links.size(), 1e-3);
+    }
+
+    std::vector<std::pair<int, int>> Pattern() const {
+        std::vector<std::pair<int, int>> entries;
+        for (int i = 0; i < n - 1; i++) {
+            entries.push_back(std::make_pair(i, i + 1));
+            entries.push_back(std::make_pair(i + 1, i));
+        }
+        for (const auto& l : links) {
+            entries.push_back(l);
+            entries.push_back(std::make_pair(l.second, l.first));
+        }
+        return entries;
+    }
+
+    void Stamp(AnalogSparseMatrix& m, std::vector<std::vector<double>>& dense) const {
+        m.Zero();
+        dense.assign(n, std::vector<double>(n, 0.0));
+        auto add = [&](int r, int c, double v) {
+            int slot = m.Find(r, c);
+            assert(slot >= 0);
+            m.values[slot] += v;
+            dense[r][c] += v;
+        };
+        auto conductance = [&](int a, int b, double g) {
+            add(a, a, g);
+            add(b, b, g);
+            add(a, b, -g);
+            add(b, a, -g);
+        };
+        for (int i = 0; i < n - 1; i++)
+            conductance(i, i + 1, series[i]);
+        for (int i = 0; i < n; i++)
+            add(i, i, shunt[i]);
+        for (size_t k = 0; k < links.size(); k++)
+            conductance(links[k].first, links[k].second, link_g[k]);
+    }
+};
+
+// Gaussian elimination with partial pivoting
+static std::vector<double> solveDense(std::vector<std::vector<double>> a, std::vector<double> b) {
+    int n = (int)b.size();
+    for (int k = 0; k < n; k++) {
+        int p = k;
+        for (int i = k + 1; i < n; i++)
+            if (std::fabs(a[i][k]) > std::fabs(a[p][k]))
+                p = i;
+        std::swap(a[k], a[p]);
+        std::swap(b[k], b[p]);
+        for (int i = k + 1; i < n; i++) {
+            double f = a[i][k] / a[k][k];
+            for (int j = k; j < n; j++)
+                a[i][j] -= f * a[k][j];
+            b[i] -= f * b[k];
+        }
+    }
+    std::vector<double> x(n);
+    for (int i = n - 1; i >= 0; i--) {
+        double s = b[i];
+        for (int j = i + 1; j < n; j++)
+            s -= a[i][j] * x[j];
+        x[i] = s / a[i][i];
+    }
+    return x;
+}
+
+static void checkSolve(const AnalogSparseLU& lu, const std::vector<std::vector<double>>& dense, const std::vector<double>& rhs) {
+    std::vector<double> x = rhs;
+    lu.Solve(x);
+    std::vector<double> expected = solveDense(dense, rhs);
+    for (size_t i = 0; i < x.size(); i++)
+        assert(std::fabs(x[i] - expected[i]) <= 1e-9 * (1.0 + std::fabs(expected[i])));
+}
+
+void testFactorMatchesDenseSolve() {
+    std::cout << "Testing sparse LU against a dense solve on a resistor ladder..." << std::endl;
+
+    Ladder ladder(60);
+    AnalogSparseMatrix m;
+    std::vector<std::pair<int, int>> entries = ladder.Pattern();
+    m.Build(ladder.n, entries);
+    std::vector<std::vector<double>> dense;
+    ladder.Stamp(m, dense);
+
+    AnalogSparseLU lu;
+    bool ok = lu.Factor(m);
+    assert(ok);
+    assert(lu.IsAnalyzed());
+    assert(lu.GetRefactoredRows() == ladder.n);
+
+    // 5 V into node 0 through 1 kOhm, 1 mA out of the last node
+    std::vector<double> rhs(ladder.n, 0.0);
+    rhs[0] = 5.0 / 1000.0;
+    rhs[ladder.n - 1] = -1e-3;
+    checkSolve(lu, dense, rhs);
+
+    std::cout << "Sparse LU factor test passed." << std::endl;
+}
+
+void testRefactorWithChangedValues() {
+    std::cout << "Testing sparse LU refactor after value changes..." << std::endl;
+
+    Ladder ladder(60);
+    AnalogSparseMatrix m;
+    std::vector<std::pair<int, int>> entries = ladder.Pattern();
+    m.Build(ladder.n, entries);
+    std::vector<std::vector<double>> dense;
+    ladder.Stamp(m, dense);
+
+    AnalogSparseLU lu;
+    bool ok = lu.Analyze(m);
+    assert(ok);
+    ok = lu.Refactor(m);
+    assert(ok);
+
+    std::vector<double> rhs(ladder.n, 0.0);
+    for (int i = 0; i < ladder.n; i++)
+        rhs[i] = 1e-3 * std::sin(0.3 * i);
+
+    // Nothing changed: nothing is recomputed
+    ladder.Stamp(m, dense);
+    ok = lu.Refactor(m);
+    assert(ok);
+    assert(lu.GetRefactoredRows() == 0);
+    checkSolve(lu, dense, rhs);
+
+    // A changed shunt recomputes its own row and the rows eliminated with it, so the
+    // nodes late in the elimination order touch only a few rows
+    int rows = ladder.n;
+    for (int node = 0; node < ladder.n; node++) {
+        Ladder changed = ladder;
+        changed.shunt[node] *= 3.0;
+        changed.Stamp(m, dense);
+        ok = lu.Refactor(m);
+        assert(ok);
+        assert(lu.GetRefactoredRows() >= 1);
+        rows = std::min(rows, lu.GetRefactoredRows());
+        checkSolve(lu, dense, rhs);
+        // Back to the original values for the next node
+        ladder.Stamp(m, dense);
+        ok = lu.Refactor(m);
+        assert(ok);
+    }
+    assert(rows < ladder.n);
+
+    // Every value changed
+    for (double& g : ladder.series)
+        g *= 0.5;
+    for (double& g : ladder.link_g)
+        g *= 4.0;
+    ladder.Stamp(m, dense);
+    ok = lu.Refactor(m);
+    assert(ok);
+    assert(lu.GetRefactoredRows() == ladder.n);
+    checkSolve(lu, dense, rhs);
+
+    std::cout << "Sparse LU refactor test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Analog Sparse LU Unit Tests..." << std::endl;
+
+    testFactorMatchesDenseSolve();
+    testRefactorWithChangedValues();
+
+    std::cout << "All Analog Sparse LU Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
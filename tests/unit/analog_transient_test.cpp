@@ -0,0 +1,124 @@
+#include "ProtoVM.h"
+#include "AnalogComponents.h"
+#include "AnalogSimulation.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// 1 kOhm into 1 uF, tau = 1 ms, sampled every 10 us. The free end of the resistor is a
+// fixed net at 5 V that drops to 0 V after five time constants.
+struct RCRun {
+    static constexpr double TAU = 1e-3;
+    static constexpr double PERIOD = 1e-5;
+    static constexpr int STEP_TICKS = 500;
+    static constexpr int WINDOW = 50;
+
+    double max_error = 0.0;
+    std::vector<int> steps;     // accepted steps per window of WINDOW ticks
+    std::vector<int> rejected;  // rejected steps per window
+};
+
+static RCRun runRC(double truncation_tolerance) {
+    Machine mach;
+    Pcb& b = mach.AddPcb();
+    AnalogResistor& r = b.Add<AnalogResistor>("r");
+    AnalogCapacitor& c = b.Add<AnalogCapacitor>("c");
+    r.SetResistance(1000.0);
+    c.SetCapacitance(1e-6);
+    r["B"] >> c["POS"];
+    r.SetAnalogValue(0, 5.0);
+    c.SetAnalogValue(1, 0.0);
+
+    AnalogSimulation sim;
+    sim.RegisterAnalogComponent(&r);
+    sim.RegisterAnalogComponent(&c);
+    sim.SetTimeStep(RCRun::PERIOD);
+    sim.SetTruncationTolerance(truncation_tolerance);
+
+    RCRun run;
+    int steps = 0, rejected = 0;
+    double v_switch = 5.0 * (1.0 - std::exp(-RCRun::STEP_TICKS * RCRun::PERIOD / RCRun::TAU));
+    for (int i = 1; i <= 2 * RCRun::STEP_TICKS; i++) {
+        if (i == RCRun::STEP_TICKS + 1)
+            r.SetAnalogValue(0, 0.0);
+        bool ok = sim.Tick();
+        assert(ok);
+
+        double t = i * RCRun::PERIOD;
+        double expected;
+        if (i <= RCRun::STEP_TICKS)
+            expected = 5.0 * (1.0 - std::exp(-t / RCRun::TAU));
+        else
+            expected = v_switch * std::exp(-(t - RCRun::STEP_TICKS * RCRun::PERIOD) / RCRun::TAU);
+        run.max_error = std::max(run.max_error, std::fabs(c.GetAnalogValue(0) - expected));
+
+        if (i % RCRun::WINDOW == 0) {
+            run.steps.push_back(sim.GetStepCount() - steps);
+            run.rejected.push_back(sim.GetRejectedStepCount() - rejected);
+            steps = sim.GetStepCount();
+            rejected = sim.GetRejectedStepCount();
+        }
+    }
+    return run;
+}
+
+void testRCStepMatchesExponential() {
+    std::cout << "Testing an RC step response against the analytic exponential..." << std::endl;
+
+    RCRun loose = runRC(1e-3);
+    RCRun tight = runRC(1e-5);
+
+    // The global error follows the step tolerance, and costs steps
+    assert(loose.max_error < 0.05);
+    assert(tight.max_error < 0.002);
+    assert(tight.max_error < loose.max_error / 10.0);
+    int loose_steps = 0, tight_steps = 0;
+    for (int n : loose.steps)
+        loose_steps += n;
+    for (int n : tight.steps)
+        tight_steps += n;
+    assert(tight_steps > loose_steps);
+
+    std::cout << "RC step response test passed." << std::endl;
+}
+
+void testStepGrowsAndShrinks() {
+    std::cout << "Testing truncation error driven step growth and shrink..." << std::endl;
+
+    RCRun run = runRC(1e-3);
+    int before = RCRun::STEP_TICKS / RCRun::WINDOW;
+
+    // Charging: the steps grow as the capacitor settles, until one step spans many ticks
+    int charging = 0;
+    for (int w = 0; w < before; w++)
+        charging += run.steps[w];
+    assert(run.steps[before - 1] < run.steps[0]);
+    assert(run.steps[before - 1] <= 2);
+    assert(charging < RCRun::STEP_TICKS / 10);
+    for (int w = 0; w < before; w++)
+        assert(run.rejected[w] == 0);
+
+    // The drive drops: the long step is cut back to resolve the new transient
+    assert(run.steps[before] > run.steps[before - 1]);
+    assert(run.steps[before] >= run.steps[0]);
+    // and while it decays, steps that grew too long are rejected and retried shorter
+    int rejected = 0;
+    for (size_t w = before; w < run.rejected.size(); w++)
+        rejected += run.rejected[w];
+    assert(rejected > 0);
+
+    std::cout << "Step growth and shrink test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Analog Transient Unit Tests..." << std::endl;
+
+    testRCStepMatchesExponential();
+    testStepGrowsAndShrinks();
+
+    std::cout << "All Analog Transient Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
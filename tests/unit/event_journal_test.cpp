@@ -0,0 +1,224 @@
+#include "EventLogger.h"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <fstream>
+#ifdef PLATFORM_POSIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace ProtoVMCLI;
+namespace fs = std::filesystem;
+
+// offset, revision, branch hash, length
+static const int64_t INDEX_ENTRY_SIZE = 8 + 8 + 4 + 4;
+
+static std::string makeSessionDir(const std::string& name) {
+    std::string dir = (fs::temp_directory_path() / ("protovm_" + name)).string();
+    EventLogger::CloseJournal(dir);
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+static EventLogEntry makeEdit(const std::string& branch, int64_t revision) {
+    EventLogEntry e;
+    e.session_id = 1;
+    e.branch = branch;
+    e.revision = revision;
+    e.command = "add_component";
+    e.payload = branch + ":" + std::to_string(revision);
+    return e;
+}
+
+// Two branches of edits with run events in between, which have no revision
+static int writeHistory(const std::string& dir, int revisions) {
+    int records = 0;
+    for (int r = 1; r <= revisions; r++) {
+        bool ok = EventLogger::LogEvent(dir, makeEdit("main", r));
+        assert(ok);
+        ok = EventLogger::LogEvent(dir, makeEdit("dev", r));
+        assert(ok);
+        EventLogEntry run;
+        run.command = "run-ticks";
+        ok = EventLogger::LogEvent(dir, run);
+        assert(ok);
+        records += 3;
+    }
+    return records;
+}
+
+static void checkRange(const std::string& dir, const std::string& branch, int64_t from, int64_t to) {
+    std::vector<EventLogEntry> out;
+    bool ok = EventLogger::ReadEvents(dir, branch, from, to, out);
+    assert(ok);
+    assert((int64_t)out.size() == to - from + 1);
+    for (size_t i = 0; i < out.size(); i++) {
+        assert(out[i].branch == branch);
+        assert(out[i].revision == from + (int64_t)i);
+        assert(out[i].payload == branch + ":" + std::to_string(from + i));
+    }
+}
+
+void testJournalAndIndexWrite() {
+    std::cout << "Testing event journal and index writes..." << std::endl;
+
+    std::string dir = makeSessionDir("journal_write");
+    int records = writeHistory(dir, 10);
+    EventLogger::CloseJournal(dir);
+
+    assert(fs::exists(dir + "/events.journal"));
+    assert((int64_t)fs::file_size(dir + "/events.idx") == records * INDEX_ENTRY_SIZE);
+
+    checkRange(dir, "main", 1, 10);
+    checkRange(dir, "dev", 4, 7);
+
+    // Nothing of the branch in the range
+    std::vector<EventLogEntry> out;
+    bool ok = EventLogger::ReadEvents(dir, "main", 11, 20, out);
+    assert(ok && out.empty());
+    ok = EventLogger::ReadEvents(dir, "other", 1, 10, out);
+    assert(ok && out.empty());
+
+    EventLogger::CloseJournal(dir);
+    fs::remove_all(dir);
+    std::cout << "Journal write test passed." << std::endl;
+}
+
+void testReadFromRevision() {
+    std::cout << "Testing reads from a revision across index chunks..." << std::endl;
+
+    // More records than one backwards chunk of the index
+    std::string dir = makeSessionDir("journal_read");
+    writeHistory(dir, 1500);
+
+    checkRange(dir, "main", 1400, 1500);
+    checkRange(dir, "dev", 1, 1500);
+    checkRange(dir, "main", 700, 700);
+
+    EventLogger::CloseJournal(dir);
+    fs::remove_all(dir);
+    std::cout << "Read from revision test passed." << std::endl;
+}
+
+void testIndexRebuild() {
+    std::cout << "Testing index rebuild after a crash..." << std::endl;
+
+    std::string dir = makeSessionDir("journal_rebuild");
+    int records = writeHistory(dir, 20);
+    EventLogger::CloseJournal(dir);
+
+    // The index entry of the last record never made it to disk
+    int64_t full_index = records * INDEX_ENTRY_SIZE;
+    fs::resize_file(dir + "/events.idx", full_index - INDEX_ENTRY_SIZE);
+    checkRange(dir, "main", 15, 20);
+    EventLogger::CloseJournal(dir);
+    assert((int64_t)fs::file_size(dir + "/events.idx") == full_index);
+
+    // A lost index is rebuilt from the journal
+    fs::remove(dir + "/events.idx");
+    checkRange(dir, "dev", 1, 20);
+    EventLogger::CloseJournal(dir);
+    assert((int64_t)fs::file_size(dir + "/events.idx") == full_index);
+
+    // A torn last record is cut off; its index entry is past the end of the journal
+    int64_t journal_size = (int64_t)fs::file_size(dir + "/events.journal");
+    fs::resize_file(dir + "/events.journal", journal_size - 3);
+    std::vector<EventLogEntry> out;
+    bool ok = EventLogger::ReadEvents(dir, "main", 1, 100, out);
+    assert(ok && out.size() == 20);
+    assert((int64_t)fs::file_size(dir + "/events.idx") == full_index - INDEX_ENTRY_SIZE);
+
+    // and the journal appends after the last complete record
+    ok = EventLogger::LogEvent(dir, makeEdit("dev", 21));
+    assert(ok);
+    EventLogger::CloseJournal(dir);
+    checkRange(dir, "dev", 1, 21);
+
+    EventLogger::CloseJournal(dir);
+    fs::remove_all(dir);
+    std::cout << "Index rebuild test passed." << std::endl;
+}
+
+void testAppendsFromAnotherProcess() {
+    std::cout << "Testing appends from another process..." << std::endl;
+
+    std::string dir = makeSessionDir("journal_processes");
+    writeHistory(dir, 10);
+    checkRange(dir, "main", 1, 10);
+
+#ifdef PLATFORM_POSIX
+    // The journal stays open here while a second process appends to it
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        bool ok = true;
+        for (int r = 11; r <= 15; r++) {
+            ok = EventLogger::LogEvent(dir, makeEdit("main", r)) && ok;
+        }
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Its records are read, and the next append goes after them
+    checkRange(dir, "main", 1, 15);
+    bool ok = EventLogger::LogEvent(dir, makeEdit("main", 16));
+    assert(ok);
+    EventLogger::CloseJournal(dir);
+    checkRange(dir, "main", 1, 16);
+#endif
+
+    EventLogger::CloseJournal(dir);
+    fs::remove_all(dir);
+    std::cout << "Appends from another process test passed." << std::endl;
+}
+
+void testLegacyLogImport() {
+    std::cout << "Testing the import of a legacy event log..." << std::endl;
+
+    std::string dir = makeSessionDir("journal_legacy");
+    {
+        std::ofstream legacy(dir + "/events.log");
+        legacy << "{\"timestamp\":\"2024-01-01T00:00:00Z\",\"user_id\":\"u\",\"session_id\":7,"
+                  "\"branch\":\"main\",\"command\":\"create-session\",\"params\":{},\"result\":{}}\n";
+        legacy << "{\"timestamp\":\"2024-01-01T00:00:01Z\",\"user_id\":\"u\",\"session_id\":7,"
+                  "\"branch\":\"main\",\"command\":\"run-ticks\",\"params\":{\"ticks\":5},\"result\":{}}\n";
+    }
+
+    // The legacy events come first in the journal, as history without revisions
+    bool ok = EventLogger::LogEvent(dir, makeEdit("main", 1));
+    assert(ok);
+    EventLogger::CloseJournal(dir);
+    assert((int64_t)fs::file_size(dir + "/events.idx") == 3 * INDEX_ENTRY_SIZE);
+    checkRange(dir, "main", 1, 1);
+
+    // and are imported only once
+    ok = EventLogger::LogEvent(dir, makeEdit("main", 2));
+    assert(ok);
+    EventLogger::CloseJournal(dir);
+    assert((int64_t)fs::file_size(dir + "/events.idx") == 4 * INDEX_ENTRY_SIZE);
+    checkRange(dir, "main", 1, 2);
+
+    EventLogger::CloseJournal(dir);
+    fs::remove_all(dir);
+    std::cout << "Legacy event log import test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Event Journal Unit Tests..." << std::endl;
+
+    testJournalAndIndexWrite();
+    testReadFromRevision();
+    testIndexRebuild();
+    testAppendsFromAnotherProcess();
+    testLegacyLogImport();
+
+    std::cout << "All Event Journal Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
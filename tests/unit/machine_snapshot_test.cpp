@@ -0,0 +1,128 @@
+#include "ProtoVM.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+
+void SetupTest4_6502(Machine& mach);
+
+static void initBoard(Machine& mach) {
+    SetupTest4_6502(mach);
+    bool ok = mach.Init();
+    assert(ok);
+}
+
+static String storeState(Machine& mach, bool delta) {
+    StringStream out;
+    bool ok = mach.SerializeState(out, delta);
+    assert(ok);
+    return out.GetResult();
+}
+
+static bool loadState(Machine& mach, const String& data) {
+    StringStream in(data);
+    return mach.SerializeState(in);
+}
+
+static void runTicks(Machine& mach, int ticks) {
+    for (int i = 0; i < ticks; i++) {
+        bool ok = mach.Tick();
+        assert(ok);
+    }
+}
+
+void testFullSnapshotRoundTrip() {
+    std::cout << "Testing full machine snapshot round trip..." << std::endl;
+
+    Machine a;
+    initBoard(a);
+    runTicks(a, 300);
+    String snapshot = storeState(a, false);
+
+    // A fresh board loaded from the snapshot stores the same bytes again
+    Machine b;
+    initBoard(b);
+    bool ok = loadState(b, snapshot);
+    assert(ok);
+    assert(b.current_tick == a.current_tick);
+    assert(storeState(b, false) == snapshot);
+
+    // and runs on exactly like the original
+    for (int i = 0; i < 10; i++) {
+        runTicks(a, 50);
+        runTicks(b, 50);
+        assert(storeState(a, false) == storeState(b, false));
+    }
+
+    std::cout << "Full snapshot round trip test passed." << std::endl;
+}
+
+void testDeltaSnapshots() {
+    std::cout << "Testing delta machine snapshots..." << std::endl;
+
+    Machine a;
+    initBoard(a);
+    runTicks(a, 200);
+    String full = storeState(a, false);
+
+    // Nothing ran: the delta carries no nodes
+    String empty_delta = storeState(a, true);
+    runTicks(a, 100);
+    String delta1 = storeState(a, true);
+    runTicks(a, 100);
+    String delta2 = storeState(a, true);
+    assert(empty_delta.GetCount() < delta1.GetCount());
+    assert(delta1.GetCount() < full.GetCount() / 4);
+    assert(delta2.GetCount() < full.GetCount() / 4);
+
+    // A delta on its own has nothing to apply to
+    Machine orphan;
+    initBoard(orphan);
+    assert(!loadState(orphan, delta1));
+
+    // The chain restores the state the deltas were taken at
+    Machine b;
+    initBoard(b);
+    bool ok = loadState(b, full);
+    assert(ok);
+    ok = loadState(b, empty_delta);
+    assert(ok);
+    ok = loadState(b, delta1);
+    assert(ok);
+    ok = loadState(b, delta2);
+    assert(ok);
+    assert(b.current_tick == a.current_tick);
+    assert(storeState(b, false) == storeState(a, false));
+
+    // Deltas keep chaining after a load, against the loaded state
+    runTicks(a, 50);
+    runTicks(b, 50);
+    String delta_a = storeState(a, true);
+    String delta_b = storeState(b, true);
+    assert(delta_a == delta_b);
+
+    // A snapshot that never reached the disk takes the baseline with it: the next
+    // one is full and loads without any chain
+    runTicks(a, 50);
+    storeState(a, true);
+    a.DiscardSnapshotBase();
+    assert(!a.CanStoreDelta());
+    String recovered = storeState(a, true);
+    Machine c;
+    initBoard(c);
+    ok = loadState(c, recovered);
+    assert(ok);
+    assert(storeState(c, false) == storeState(a, false));
+
+    std::cout << "Delta snapshot test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Machine Snapshot Unit Tests..." << std::endl;
+
+    testFullSnapshotRoundTrip();
+    testDeltaSnapshots();
+
+    std::cout << "All Machine Snapshot Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
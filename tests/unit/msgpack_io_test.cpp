@@ -0,0 +1,163 @@
+#include "MsgPackIO.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+
+using namespace ProtoVMCLI;
+
+static Upp::String bytes(std::initializer_list<int> list) {
+    Upp::String s;
+    for (int b : list)
+        s.Cat((char)b);
+    return s;
+}
+
+static bool decodes(const Upp::String& data) {
+    Upp::Value out;
+    return MsgPackIO::Decode(data, out);
+}
+
+// A response with every kind of value the daemon sends, in every length class
+static Upp::ValueMap makeMessage() {
+    Upp::ValueArray trace;
+    for (int i = 0; i < 20; i++)
+        trace.Add(i * 1000);
+
+    Upp::ValueMap nested;
+    nested.Add("ticks", (Upp::int64)1 << 40);
+    nested.Add("trace", trace);
+
+    Upp::ValueMap msg;
+    msg.Add("id", "req-1");
+    msg.Add("ok", true);
+    msg.Add("failed", false);
+    msg.Add("error", Upp::Value());
+    msg.Add("small", 5);
+    msg.Add("negative", -20);
+    msg.Add("int", -100000);
+    msg.Add("big", -((Upp::int64)1 << 50));
+    msg.Add("ratio", 3.25);
+    msg.Add("empty", Upp::String());
+    msg.Add("name", Upp::String('n', 40));
+    msg.Add("memory", Upp::String('m', 300));
+    msg.Add("dump", Upp::String('d', 70000));
+    msg.Add("data", nested);
+    return msg;
+}
+
+void testRoundTrip() {
+    std::cout << "Testing MessagePack round trip..." << std::endl;
+
+    Upp::String encoded = MsgPackIO::Encode(makeMessage());
+    Upp::Value decoded;
+    bool ok = MsgPackIO::Decode(encoded, decoded);
+    assert(ok);
+    assert(decoded.Is<Upp::ValueMap>());
+
+    Upp::ValueMap msg = decoded;
+    assert(msg.GetCount() == 14);
+    assert(msg["id"].Get<Upp::String>() == "req-1");
+    assert(msg["ok"].Get<bool>() && !msg["failed"].Get<bool>());
+    assert(msg["error"].IsVoid());
+    assert((int)msg["small"] == 5);
+    assert((int)msg["negative"] == -20);
+    assert((int)msg["int"] == -100000);
+    assert((Upp::int64)msg["big"] == -((Upp::int64)1 << 50));
+    assert((double)msg["ratio"] == 3.25);
+    assert(msg["empty"].Get<Upp::String>().GetCount() == 0);
+    assert(msg["memory"].Get<Upp::String>() == Upp::String('m', 300));
+    assert(msg["dump"].Get<Upp::String>().GetCount() == 70000);
+    Upp::ValueMap nested = msg["data"];
+    assert((Upp::int64)nested["ticks"] == (Upp::int64)1 << 40);
+    assert(nested["trace"].Get<Upp::ValueArray>().GetCount() == 20);
+
+    // Decoding keeps every type and length class, so it encodes to the same bytes
+    assert(MsgPackIO::Encode(decoded) == encoded);
+
+    std::cout << "Round trip test passed." << std::endl;
+}
+
+void testMalformedRejected() {
+    std::cout << "Testing malformed MessagePack input..." << std::endl;
+
+    // Every truncation of a valid message
+    Upp::String encoded = MsgPackIO::Encode(makeMessage());
+    for (int n = 0; n < encoded.GetCount(); n += n < 1000 ? 1 : 997)
+        assert(!decodes(encoded.Mid(0, n)));
+
+    // Trailing bytes after the value
+    Upp::String trailing = encoded;
+    trailing.Cat((char)0xc0);
+    assert(!decodes(trailing));
+
+    // The reserved tag and the unused ext types
+    assert(!decodes(bytes({0xc1})));
+    assert(!decodes(bytes({0xd4, 0x01, 0x00})));
+    assert(!decodes(bytes({0xc7, 0x01, 0x01, 0x00})));
+
+    // A map missing the value of its last key
+    assert(!decodes(bytes({0x81, 0xa1, 'k'})));
+
+    std::cout << "Malformed input test passed." << std::endl;
+}
+
+void testOversizeRejected() {
+    std::cout << "Testing MessagePack lengths beyond the input..." << std::endl;
+
+    // Lengths and counts that claim more than the frame holds are refused before
+    // anything is allocated
+    assert(!decodes(bytes({0xdb, 0xff, 0xff, 0xff, 0xff, 'a'})));
+    assert(!decodes(bytes({0xc6, 0x7f, 0xff, 0xff, 0xff})));
+    assert(!decodes(bytes({0xda, 0x00, 0x03, 'a', 'b'})));
+    assert(!decodes(bytes({0xdd, 0xff, 0xff, 0xff, 0xff, 0xc0})));
+    assert(!decodes(bytes({0xdf, 0x7f, 0xff, 0xff, 0xff, 0xc0, 0xc0})));
+    assert(!decodes(bytes({0xdc, 0x00, 0x03, 0xc0, 0xc0})));
+
+    // while the same headers with the bytes present decode
+    assert(decodes(bytes({0xda, 0x00, 0x02, 'a', 'b'})));
+    assert(decodes(bytes({0xdc, 0x00, 0x02, 0xc0, 0xc0})));
+
+    std::cout << "Oversize test passed." << std::endl;
+}
+
+void testDeepNestingRejected() {
+    std::cout << "Testing deeply nested MessagePack input..." << std::endl;
+
+    // n single element arrays around a nil
+    auto nestedArrays = [](int n) {
+        Upp::String s;
+        for (int i = 0; i < n; i++)
+            s.Cat((char)0x91);
+        s.Cat((char)0xc0);
+        return s;
+    };
+    assert(decodes(nestedArrays(64)));
+    assert(!decodes(nestedArrays(65)));
+
+    // Far past the limit, without running out of stack
+    assert(!decodes(nestedArrays(1000000)));
+
+    // Maps count the same way
+    Upp::String maps;
+    for (int i = 0; i < 100; i++) {
+        maps.Cat((char)0x81);
+        maps.Cat((char)0x00);
+    }
+    maps.Cat((char)0xc0);
+    assert(!decodes(maps));
+
+    std::cout << "Deep nesting test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting MsgPackIO Unit Tests..." << std::endl;
+
+    testRoundTrip();
+    testMalformedRejected();
+    testOversizeRejected();
+    testDeepNestingRejected();
+
+    std::cout << "All MsgPackIO Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "ProtoVM.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+// Drives 8 single-bit outputs from a register the test steps between machine ticks
+class PatternSource : public ElcBase {
+public:
+    uint32 value = 0xACE1;
+    byte out_bits[8] = {};
+
+    PatternSource() {
+        for (int i = 0; i < 8; i++)
+            AddSource("O" + IntStr(i)).SetMultiConn();
+    }
+
+    String GetClassName() const override {return "PatternSource";}
+    bool Tick() override {return true;}
+    bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override {
+        if (type != WRITE)
+            return true;
+        out_bits[conn_id] = (value >> conn_id) & 1;
+        return dest.PutRaw(dest_conn_id, &out_bits[conn_id], 0, 1);
+    }
+    bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override {return true;}
+    void Step() {value = (value >> 1) ^ (-(int)(value & 1) & 0xB400u);}
+};
+
+class BitSink : public ElcBase {
+public:
+    std::vector<byte> in;
+
+    void Init(int count) {
+        in.resize(count);
+        for (int i = 0; i < count; i++)
+            AddSink("I" + IntStr(i));
+    }
+
+    String GetClassName() const override {return "BitSink";}
+    bool Tick() override {return true;}
+    bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override {return true;}
+    bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override {
+        in[conn_id] = *data & 1;
+        return true;
+    }
+};
+
+// x[i] = NOT(src[i % 8]), y[i] = NAND(x[i], x[i + 1]), z[i] = XOR(y[i], x[i]), with
+// more gates per level than one word holds
+void testWideGroupsMatchGateLogic() {
+    std::cout << "Testing packed evaluation of wide gate groups..." << std::endl;
+
+    const int W = 100;
+    Machine mach;
+    Pcb& b = mach.AddPcb();
+    PatternSource& src = b.Add<PatternSource>("src");
+    std::vector<ElcNot*> x;
+    std::vector<ElcNand*> y;
+    std::vector<ElcXor*> z;
+    for (int i = 0; i < W; i++)
+        x.push_back(&b.Add<ElcNot>("x" + IntStr(i)));
+    for (int i = 0; i < W; i++)
+        y.push_back(&b.Add<ElcNand>("y" + IntStr(i)));
+    for (int i = 0; i < W; i++)
+        z.push_back(&b.Add<ElcXor>("z" + IntStr(i)));
+    BitSink& sink = b.Add<BitSink>("sink");
+    sink.Init(W);
+    for (int i = 0; i < W; i++)
+        src["O" + IntStr(i % 8)] >> (*x[i])["I"];
+    for (int i = 0; i < W; i++) {
+        (*x[i])["O"] >> (*y[i])["I0"];
+        (*x[(i + 1) % W])["O"] >> (*y[i])["I1"];
+        (*y[i])["O"] >> (*z[i])["I0"];
+        (*x[i])["O"] >> (*z[i])["I1"];
+        (*z[i])["O"] >> sink["I" + IntStr(i)];
+    }
+
+    mach.use_packed_nets = true;
+    bool ok = mach.Init();
+    assert(ok);
+
+    const PackedNetlist& nl = mach.GetPackedNetlist();
+    assert(nl.gates.GetCount() == 3 * W);
+    assert(nl.groups.GetCount() == 3);
+    // The 4 * W internal inputs are gathered as a few long runs, not bit by bit
+    int moved = 0;
+    for (const PackedMove& m : nl.moves)
+        moved += m.count;
+    assert(moved == 4 * W);
+    assert(nl.moves.GetCount() < W / 10);
+    for (const PackedGroup& grp : nl.groups) {
+        assert(grp.out_net % 64 == 0);
+        assert(grp.in_net[0] % 64 == 0);
+    }
+
+    for (int t = 0; t < 40; t++) {
+        src.Step();
+        ok = mach.Tick();
+        assert(ok);
+        for (int i = 0; i < W; i++) {
+            byte xi = !((src.value >> (i % 8)) & 1);
+            byte xj = !((src.value >> ((i + 1) % W % 8)) & 1);
+            byte expected = (byte)(!(xi & xj)) ^ xi;
+            assert(sink.in[i] == expected);
+        }
+    }
+
+    std::cout << "Wide gate group test passed." << std::endl;
+}
+
+// A chain where every level reads the previous one through scattered wiring, so the
+// gathers fall back to short runs
+void testScatteredWiring() {
+    std::cout << "Testing packed evaluation with scattered wiring..." << std::endl;
+
+    const int W = 70;
+    const int LEVELS = 4;
+    Machine mach;
+    Pcb& b = mach.AddPcb();
+    PatternSource& src = b.Add<PatternSource>("src");
+    std::vector<ElectricNodeBase*> prev;
+    for (int i = 0; i < W; i++) {
+        ElcNot& n = b.Add<ElcNot>("n" + IntStr(i));
+        src["O" + IntStr(i % 8)] >> n["I"];
+        prev.push_back(&n);
+    }
+    for (int level = 0; level < LEVELS; level++) {
+        std::vector<ElectricNodeBase*> next;
+        for (int i = 0; i < W; i++) {
+            String name = "g" + IntStr(level) + "_" + IntStr(i);
+            ElectricNodeBase* g;
+            if (level % 2)
+                g = &b.Add<ElcXnor>(name);
+            else
+                g = &b.Add<ElcNor>(name);
+            (*prev[(i * 7) % W])["O"] >> (*g)["I0"];
+            (*prev[(i * 3 + level) % W])["O"] >> (*g)["I1"];
+            next.push_back(g);
+        }
+        prev = next;
+    }
+    BitSink& sink = b.Add<BitSink>("sink");
+    sink.Init(W);
+    for (int i = 0; i < W; i++)
+        (*prev[i])["O"] >> sink["I" + IntStr(i)];
+
+    mach.use_packed_nets = true;
+    bool ok = mach.Init();
+    assert(ok);
+    assert(mach.GetPackedNetlist().gates.GetCount() == (LEVELS + 1) * W);
+
+    for (int t = 0; t < 40; t++) {
+        src.Step();
+        ok = mach.Tick();
+        assert(ok);
+
+        std::vector<byte> v(W), next(W);
+        for (int i = 0; i < W; i++)
+            v[i] = !((src.value >> (i % 8)) & 1);
+        for (int level = 0; level < LEVELS; level++) {
+            for (int i = 0; i < W; i++) {
+                byte a = v[(i * 7) % W];
+                byte c = v[(i * 3 + level) % W];
+                next[i] = (level % 2) ? !(a ^ c) : !(a | c);
+            }
+            v = next;
+        }
+        for (int i = 0; i < W; i++)
+            assert(sink.in[i] == v[i]);
+    }
+
+    std::cout << "Scattered wiring test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Packed Netlist Unit Tests..." << std::endl;
+
+    testWideGroupsMatchGateLogic();
+    testScatteredWiring();
+
+    std::cout << "All Packed Netlist Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include "SessionServer.h"
+#include "JsonIO.h"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace ProtoVMCLI;
+namespace fs = std::filesystem;
+
+static DaemonResponse request(SessionServer& server, DaemonRequest& req) {
+    DaemonResponse resp;
+    auto result = server.HandleRequest(req, resp);
+    assert(result.ok);
+    assert(resp.ok);
+    return resp;
+}
+
+static DaemonResponse request(SessionServer& server, const std::string& workspace, int session_id,
+                              const std::string& command, const Upp::ValueMap& payload = Upp::ValueMap()) {
+    DaemonRequest req;
+    req.id = command;
+    req.command = command;
+    req.workspace = workspace;
+    req.session_id = session_id;
+    req.user_id = "test";
+    req.payload = payload;
+    return request(server, req);
+}
+
+// The envelope's "data" of a successful response
+static Upp::ValueMap responseData(const DaemonResponse& resp) {
+    Upp::ValueMap data = resp.data["data"];
+    return data;
+}
+
+// run-ticks streaming its progress as often as the 256 tick checks allow
+static Upp::ValueMap streamTicks(int ticks) {
+    Upp::ValueMap payload;
+    payload.Add("ticks", ticks);
+    payload.Add("stream", true);
+    payload.Add("progress_interval_ms", 1);
+    return payload;
+}
+
+// An inverter driving its own input, which the session can simulate
+static std::string writeCircuit(const std::string& dir) {
+    std::string file = dir + "/ring.circuit";
+    std::ofstream out(file);
+    out << "# ProtoVM Circuit File\n";
+    out << "name=ring\n";
+    out << "description=inverter ring\n";
+    out << "\n";
+    out << "# Components (1)\n";
+    out << "component g1 NOT inv 0 0\n";
+    out << " input g1_a A 0 0\n";
+    out << " output g1_y Y 0 0\n";
+    out << "\n";
+    out << "# Wires (1)\n";
+    out << "wire w1 g1 Y g1 A\n";
+    return file;
+}
+
+static int createSession(SessionServer& server, const std::string& dir, std::string& workspace) {
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    workspace = dir + "/workspace";
+    std::string circuit_file = writeCircuit(dir);
+
+    request(server, workspace, -1, "init-workspace");
+    Upp::ValueMap create_payload;
+    create_payload.Add("circuit_file", Upp::String(circuit_file.c_str()));
+    return responseData(request(server, workspace, -1, "create-session", create_payload))["session_id"];
+}
+
+void testProgressAndCancel() {
+    std::cout << "Testing run-ticks progress events and cancellation..." << std::endl;
+
+    std::string dir = (fs::temp_directory_path() / "protovm_run_ticks_progress").string();
+    SessionServer server;
+    std::string workspace;
+    int session_id = createSession(server, dir, workspace);
+
+    // The handler stops at the tick after the third event, as a cancel would
+    std::vector<Upp::ValueMap> events;
+    DaemonRequest req;
+    req.id = "run";
+    req.command = "run-ticks";
+    req.workspace = workspace;
+    req.session_id = session_id;
+    req.user_id = "test";
+    req.payload = streamTicks(1 << 30);
+    req.cancelled = std::make_shared<std::atomic<bool>>(false);
+    req.emit = [&](const Upp::ValueMap& event) {
+        events.push_back(event);
+        if (events.size() == 3)
+            req.cancelled->store(true);
+    };
+    Upp::ValueMap data = responseData(request(server, req));
+
+    // Progress is only reported on the ticks the clock is read, every 256
+    assert(events.size() == 3);
+    int previous = 0;
+    for (const Upp::ValueMap& event : events) {
+        assert(event["event"] == "run-ticks-progress");
+        assert(event["id"] == "run");
+        int ticks_done = event["ticks_done"];
+        assert(ticks_done > previous);
+        assert(ticks_done % 256 == 0);
+        previous = ticks_done;
+    }
+
+    // Cancelled between ticks: what has run counts as a shorter run
+    assert((bool)data["cancelled"]);
+    assert((int)data["ticks_run"] == previous);
+    assert((int)data["total_ticks"] == previous);
+
+    // Raised before the first tick nothing runs
+    events.clear();
+    req.payload = streamTicks(1000);
+    Upp::ValueMap none = responseData(request(server, req));
+    assert((bool)none["cancelled"]);
+    assert((int)none["ticks_run"] == 0);
+    assert((int)none["total_ticks"] == previous);
+    assert(events.empty());
+
+    fs::remove_all(dir);
+    std::cout << "Progress and cancellation test passed." << std::endl;
+}
+
+// A JSON frame client of ServeUnixSocket
+struct Client {
+    int fd = -1;
+
+    bool Connect(const std::string& path) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0)
+            return true;
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void Send(const Upp::ValueMap& msg) {
+        Upp::String payload = JsonIO::ValueMapToJson(msg);
+        unsigned char header[5];
+        Upp::uint32 length = payload.GetCount();
+        header[0] = (unsigned char)(length >> 24);
+        header[1] = (unsigned char)(length >> 16);
+        header[2] = (unsigned char)(length >> 8);
+        header[3] = (unsigned char)length;
+        header[4] = (unsigned char)SessionServer::FRAME_JSON;
+        bool ok = write(fd, header, sizeof(header)) == sizeof(header) &&
+                  write(fd, payload.Begin(), payload.GetCount()) == payload.GetCount();
+        assert(ok);
+    }
+
+    Upp::ValueMap Receive() {
+        unsigned char header[5];
+        ReadFully(header, sizeof(header));
+        Upp::uint32 length = ((Upp::uint32)header[0] << 24) | ((Upp::uint32)header[1] << 16) |
+                             ((Upp::uint32)header[2] << 8) | header[3];
+        std::string payload(length, '\0');
+        ReadFully(&payload[0], length);
+        return JsonIO::Deserialize(Upp::String(payload.c_str()));
+    }
+
+    // Skips broadcasts and progress events
+    Upp::ValueMap ReceiveResponse(const std::string& id) {
+        while (true) {
+            Upp::ValueMap msg = Receive();
+            if (msg["event"].IsVoid() && msg["id"] == id.c_str())
+                return msg;
+        }
+    }
+
+    void ReceiveProgress(const std::string& id) {
+        while (true) {
+            Upp::ValueMap msg = Receive();
+            if (msg["event"] == "run-ticks-progress" && msg["id"] == id.c_str())
+                return;
+        }
+    }
+
+    void ReadFully(void* buffer, size_t size) {
+        char* p = static_cast<char*>(buffer);
+        while (size > 0) {
+            ssize_t n = read(fd, p, size);
+            assert(n > 0);
+            p += n;
+            size -= n;
+        }
+    }
+
+    ~Client() {
+        if (fd >= 0)
+            close(fd);
+    }
+};
+
+static Upp::ValueMap cancelRequest(const std::string& id, const std::string& target) {
+    Upp::ValueMap payload;
+    payload.Add("request_id", Upp::String(target.c_str()));
+    Upp::ValueMap msg;
+    msg.Add("id", Upp::String(id.c_str()));
+    msg.Add("command", "cancel");
+    msg.Add("payload", payload);
+    return msg;
+}
+
+void testCancelIsScopedToClient() {
+    std::cout << "Testing that a cancel only reaches its own client's requests..." << std::endl;
+
+    std::string dir = (fs::temp_directory_path() / "protovm_run_ticks_cancel").string();
+    SessionServer server;
+    std::string workspace;
+    int session_id = createSession(server, dir, workspace);
+
+    std::string socket_path = dir + "/daemon.sock";
+    std::thread serve([&] { server.ServeUnixSocket(socket_path); });
+
+    Client owner;
+    Client other;
+    while (!owner.Connect(socket_path))
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    bool connected = other.Connect(socket_path);
+    assert(connected);
+
+    Upp::ValueMap run;
+    run.Add("id", "run");
+    run.Add("command", "run-ticks");
+    run.Add("workspace", Upp::String(workspace.c_str()));
+    run.Add("session_id", session_id);
+    run.Add("payload", streamTicks(1 << 30));
+    owner.Send(run);
+    owner.ReceiveProgress("run");
+
+    // Another client using the same id finds nothing to cancel
+    other.Send(cancelRequest("cancel", "run"));
+    Upp::ValueMap refused = other.ReceiveResponse("cancel");
+    assert(!(bool)refused["ok"]);
+    assert(refused["error_code"] == "NOT_FOUND");
+    owner.ReceiveProgress("run");
+
+    // The owner's cancel stops the run at a tick boundary; the two responses may
+    // arrive in either order
+    owner.Send(cancelRequest("cancel", "run"));
+    Upp::ValueMap signalled;
+    Upp::ValueMap response;
+    while (signalled.IsEmpty() || response.IsEmpty()) {
+        Upp::ValueMap msg = owner.Receive();
+        if (!msg["event"].IsVoid())
+            continue;
+        if (msg["id"] == "cancel")
+            signalled = msg;
+        else if (msg["id"] == "run")
+            response = msg;
+    }
+    assert((bool)signalled["ok"]);
+    assert(signalled["data"]["state"] == "signalled");
+    assert((bool)response["ok"]);
+    Upp::ValueMap data = response["data"]["data"];
+    assert((bool)data["cancelled"]);
+    assert((int)data["ticks_run"] < (1 << 30));
+
+    server.StopServing();
+    serve.join();
+
+    fs::remove_all(dir);
+    std::cout << "Client scoped cancel test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Run Ticks Unit Tests..." << std::endl;
+
+    testProgressAndCancel();
+    testCancelIsScopedToClient();
+
+    std::cout << "All Run Ticks Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
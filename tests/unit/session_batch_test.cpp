@@ -0,0 +1,147 @@
+#include "SessionServer.h"
+#include "SessionStore.h"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace ProtoVMCLI {
+    // Defined in JsonFilesystemSessionStore.cpp
+    std::unique_ptr<ISessionStore> CreateFilesystemSessionStore(const std::string& workspace_path);
+}
+
+using namespace ProtoVMCLI;
+namespace fs = std::filesystem;
+
+static DaemonResponse request(SessionServer& server, const std::string& workspace, int session_id,
+                              const std::string& command, const Upp::ValueMap& payload = Upp::ValueMap()) {
+    DaemonRequest req;
+    req.id = command;
+    req.command = command;
+    req.workspace = workspace;
+    req.session_id = session_id;
+    req.user_id = "test";
+    req.payload = payload;
+
+    DaemonResponse resp;
+    auto result = server.HandleRequest(req, resp);
+    assert(result.ok);
+    assert(resp.ok);
+    return resp;
+}
+
+// The envelope's "data" of a successful response
+static Upp::ValueMap responseData(const DaemonResponse& resp) {
+    Upp::ValueMap data = resp.data["data"];
+    return data;
+}
+
+static Upp::ValueMap subRequest(const std::string& command, const Upp::ValueMap& payload) {
+    Upp::ValueMap item;
+    item.Add("id", Upp::String(command.c_str()));
+    item.Add("command", Upp::String(command.c_str()));
+    item.Add("payload", payload);
+    return item;
+}
+
+static Upp::ValueMap addComponent(const std::string& name) {
+    Upp::ValueMap payload;
+    payload.Add("type", "NAND");
+    payload.Add("name", Upp::String(name.c_str()));
+    return payload;
+}
+
+static Upp::ValueMap runTicks(int ticks) {
+    Upp::ValueMap payload;
+    payload.Add("ticks", ticks);
+    return payload;
+}
+
+// An inverter driving its own input, which the session can simulate
+static std::string writeCircuit(const std::string& dir) {
+    std::string file = dir + "/ring.circuit";
+    std::ofstream out(file);
+    out << "# ProtoVM Circuit File\n";
+    out << "name=ring\n";
+    out << "description=inverter ring\n";
+    out << "\n";
+    out << "# Components (1)\n";
+    out << "component g1 NOT inv 0 0\n";
+    out << " input g1_a A 0 0\n";
+    out << " output g1_y Y 0 0\n";
+    out << "\n";
+    out << "# Wires (1)\n";
+    out << "wire w1 g1 Y g1 A\n";
+    return file;
+}
+
+void testEditsAndRunTicksInOneBatch() {
+    std::cout << "Testing a batch of edits and run-ticks..." << std::endl;
+
+    std::string dir = (fs::temp_directory_path() / "protovm_session_batch").string();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::string workspace = dir + "/workspace";
+    std::string circuit_file = writeCircuit(dir);
+
+    SessionServer server;
+    request(server, workspace, -1, "init-workspace");
+    Upp::ValueMap create_payload;
+    create_payload.Add("circuit_file", Upp::String(circuit_file.c_str()));
+    int session_id = responseData(request(server, workspace, -1, "create-session", create_payload))["session_id"];
+
+    // Each run-ticks makes the session resident between two groups of edits
+    Upp::ValueArray items;
+    items.Add(subRequest("edit-add-component", addComponent("a")));
+    items.Add(subRequest("run-ticks", runTicks(10)));
+    items.Add(subRequest("edit-add-component", addComponent("b")));
+    items.Add(subRequest("run-ticks", runTicks(10)));
+    Upp::ValueMap batch_payload;
+    batch_payload.Add("requests", items);
+    Upp::ValueMap batch = responseData(request(server, workspace, session_id, "batch", batch_payload));
+
+    Upp::ValueArray responses = batch["responses"];
+    assert(responses.GetCount() == 4);
+    for (int i = 0; i < responses.GetCount(); i++) {
+        Upp::ValueMap resp = responses[i];
+        assert((bool)resp["ok"]);
+    }
+    assert((int)batch["circuit_revision"] == 2);
+
+    // The resident session has the revision of the second group of edits
+    Upp::ValueMap state = responseData(request(server, workspace, session_id, "get-state"));
+    assert((int)state["circuit_revision"] == 2);
+    assert((int)state["total_ticks"] >= 20);
+
+    // and writing it out keeps that revision on disk
+    request(server, workspace, session_id, "flush-sessions");
+    auto store = CreateFilesystemSessionStore(workspace);
+    auto load_result = store->LoadSession(session_id);
+    assert(load_result.ok);
+    std::optional<BranchMetadata> branch = FindBranchByName(load_result.data, load_result.data.current_branch);
+    assert(branch.has_value());
+    assert(branch->head_revision == 2);
+    assert(branch->sim_revision == 2);
+
+    // A later edit continues from it
+    Upp::ValueArray more;
+    more.Add(subRequest("edit-add-component", addComponent("c")));
+    Upp::ValueMap more_payload;
+    more_payload.Add("requests", more);
+    batch = responseData(request(server, workspace, session_id, "batch", more_payload));
+    assert((int)batch["circuit_revision"] == 3);
+
+    fs::remove_all(dir);
+    std::cout << "Batch of edits and run-ticks test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Session Batch Unit Tests..." << std::endl;
+
+    testEditsAndRunTicksInOneBatch();
+
+    std::cout << "All Session Batch Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include "SessionServer.h"
+#include "SessionStore.h"
+#include "JsonIO.h"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <vector>
+
+namespace ProtoVMCLI {
+    // Defined in JsonFilesystemSessionStore.cpp
+    std::unique_ptr<ISessionStore> CreateFilesystemSessionStore(const std::string& workspace_path);
+}
+
+using namespace ProtoVMCLI;
+namespace fs = std::filesystem;
+
+static DaemonResponse request(SessionServer& server, const std::string& workspace, int session_id,
+                              const std::string& command, const Upp::ValueMap& payload = Upp::ValueMap()) {
+    DaemonRequest req;
+    req.id = command;
+    req.command = command;
+    req.workspace = workspace;
+    req.session_id = session_id;
+    req.user_id = "test";
+    req.payload = payload;
+
+    DaemonResponse resp;
+    auto result = server.HandleRequest(req, resp);
+    assert(result.ok);
+    assert(resp.ok);
+    return resp;
+}
+
+// The envelope's "data" of a successful response
+static Upp::ValueMap responseData(const DaemonResponse& resp) {
+    Upp::ValueMap data = resp.data["data"];
+    return data;
+}
+
+static Upp::ValueMap runTicks(int ticks) {
+    Upp::ValueMap payload;
+    payload.Add("ticks", ticks);
+    return payload;
+}
+
+// An inverter driving its own input, which the session can simulate
+static std::string writeCircuit(const std::string& dir) {
+    std::string file = dir + "/ring.circuit";
+    std::ofstream out(file);
+    out << "# ProtoVM Circuit File\n";
+    out << "name=ring\n";
+    out << "description=inverter ring\n";
+    out << "\n";
+    out << "# Components (1)\n";
+    out << "component g1 NOT inv 0 0\n";
+    out << " input g1_a A 0 0\n";
+    out << " output g1_y Y 0 0\n";
+    out << "\n";
+    out << "# Wires (1)\n";
+    out << "wire w1 g1 Y g1 A\n";
+    return file;
+}
+
+// A fresh workspace under the temp directory with sessions of the ring circuit
+static std::string makeWorkspace(SessionServer& server, const std::string& name, int sessions, std::vector<int>& session_ids) {
+    std::string dir = (fs::temp_directory_path() / name).string();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::string workspace = dir + "/workspace";
+    std::string circuit_file = writeCircuit(dir);
+
+    request(server, workspace, -1, "init-workspace");
+    Upp::ValueMap create_payload;
+    create_payload.Add("circuit_file", Upp::String(circuit_file.c_str()));
+    for (int i = 0; i < sessions; i++) {
+        session_ids.push_back(responseData(request(server, workspace, -1, "create-session", create_payload))["session_id"]);
+    }
+    return workspace;
+}
+
+static int ticksOnDisk(const std::string& workspace, int session_id) {
+    auto store = CreateFilesystemSessionStore(workspace);
+    auto load_result = store->LoadSession(session_id);
+    assert(load_result.ok);
+    return load_result.data.total_ticks;
+}
+
+void testWriteBehind() {
+    std::cout << "Testing the write-behind of resident sessions..." << std::endl;
+
+    SessionServer server;
+    server.SetSnapshotIntervalTicks(50);
+    std::vector<int> ids;
+    std::string workspace = makeWorkspace(server, "protovm_session_cache_write_behind", 1, ids);
+
+    // Below the interval the ticks stay in memory
+    Upp::ValueMap first = responseData(request(server, workspace, ids[0], "run-ticks", runTicks(30)));
+    assert((int)first["total_ticks"] == 30);
+    assert(ticksOnDisk(workspace, ids[0]) == 0);
+
+    // Reaching it writes a snapshot and the metadata
+    Upp::ValueMap second = responseData(request(server, workspace, ids[0], "run-ticks", runTicks(30)));
+    assert((int)second["total_ticks"] == 60);
+    assert(second["last_snapshot_file"] != first["last_snapshot_file"]);
+    assert(ticksOnDisk(workspace, ids[0]) == 60);
+
+    // A flush writes what has accumulated since
+    request(server, workspace, ids[0], "run-ticks", runTicks(10));
+    assert(ticksOnDisk(workspace, ids[0]) == 60);
+    assert(server.FlushSessions(workspace) == 1);
+    assert(ticksOnDisk(workspace, ids[0]) == 70);
+    assert(server.FlushSessions(workspace) == 0);
+
+    fs::remove_all(fs::path(workspace).parent_path());
+    std::cout << "Write-behind test passed." << std::endl;
+}
+
+void testLeastRecentlyUsedEviction() {
+    std::cout << "Testing the eviction of the least recently used session..." << std::endl;
+
+    SessionServer server;
+    server.SetMaxResidentSessions(2);
+    std::vector<int> ids;
+    std::string workspace = makeWorkspace(server, "protovm_session_cache_lru", 3, ids);
+
+    request(server, workspace, ids[0], "run-ticks", runTicks(10));
+    request(server, workspace, ids[1], "run-ticks", runTicks(20));
+    assert(server.GetResidentSessionCount() == 2);
+
+    // Using the first session again makes the second one the least recently used
+    request(server, workspace, ids[0], "get-state");
+    request(server, workspace, ids[2], "run-ticks", runTicks(30));
+    assert(server.GetResidentSessionCount() == 2);
+
+    // The evicted session was written out, the resident ones weren't
+    assert(ticksOnDisk(workspace, ids[1]) == 20);
+    assert(ticksOnDisk(workspace, ids[0]) == 0);
+    assert(ticksOnDisk(workspace, ids[2]) == 0);
+
+    // and is loaded back from its snapshot
+    Upp::ValueMap state = responseData(request(server, workspace, ids[1], "get-state"));
+    assert((int)state["total_ticks"] == 20);
+    assert(server.GetResidentSessionCount() == 2);
+    assert(ticksOnDisk(workspace, ids[0]) == 10);
+
+    // Only the resident sessions keep a lock
+    assert(server.GetSessionLockCount() == 2);
+
+    // Dropping a session for a command that reads it from disk forgets its lock too
+    request(server, workspace, ids[1], "list-sessions");
+    assert(server.GetResidentSessionCount() == 1);
+    assert(server.GetSessionLockCount() == 1);
+
+    fs::remove_all(fs::path(workspace).parent_path());
+    std::cout << "Least recently used eviction test passed." << std::endl;
+}
+
+void testWorkerPool() {
+    std::cout << "Testing requests of several sessions on the worker pool..." << std::endl;
+
+    SessionServer server;
+    std::vector<int> ids;
+    std::string workspace = makeWorkspace(server, "protovm_session_cache_workers", 4, ids);
+
+    // Interleave run-ticks of all sessions, as one client would send them on stdin
+    const int rounds = 5;
+    std::ostringstream input;
+    for (int round = 0; round < rounds; round++) {
+        for (int id : ids) {
+            Upp::ValueMap req;
+            req.Add("id", Upp::String((std::to_string(id) + "-" + std::to_string(round)).c_str()));
+            req.Add("command", "run-ticks");
+            req.Add("workspace", Upp::String(workspace.c_str()));
+            req.Add("session_id", id);
+            req.Add("payload", runTicks(100));
+            input << JsonIO::ValueMapToJson(req).ToStd() << '\n';
+        }
+    }
+
+    std::istringstream in(input.str());
+    std::ostringstream out;
+    std::streambuf* old_in = std::cin.rdbuf(in.rdbuf());
+    std::streambuf* old_out = std::cout.rdbuf(out.rdbuf());
+    server.SetWorkerCount(4);
+    auto result = server.ProcessRequests();
+    std::cin.rdbuf(old_in);
+    std::cout.rdbuf(old_out);
+    assert(result.ok);
+
+    // Every request is answered once, and a session's requests complete in order
+    std::map<int, int> answered;
+    std::istringstream lines(out.str());
+    std::string line;
+    while (std::getline(lines, line)) {
+        Upp::ValueMap msg = JsonIO::Deserialize(Upp::String(line.c_str()));
+        if (!msg["event"].IsVoid())
+            continue;
+        assert((bool)msg["ok"]);
+        Upp::ValueMap data = msg["data"]["data"];
+        int id = data["session_id"];
+        std::string expected_id = std::to_string(id) + "-" + std::to_string(answered[id]);
+        assert(msg["id"].ToString().ToStd() == expected_id);
+        answered[id]++;
+        assert((int)data["total_ticks"] == 100 * answered[id]);
+    }
+    assert((int)answered.size() == (int)ids.size());
+    for (const auto& entry : answered) {
+        assert(entry.second == rounds);
+    }
+    assert(server.GetResidentSessionCount() == (int)ids.size());
+    assert(server.GetSessionLockCount() == (int)ids.size());
+
+    fs::remove_all(fs::path(workspace).parent_path());
+    std::cout << "Worker pool test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Session Cache Unit Tests..." << std::endl;
+
+    testWriteBehind();
+    testLeastRecentlyUsedEviction();
+    testWorkerPool();
+
+    std::cout << "All Session Cache Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
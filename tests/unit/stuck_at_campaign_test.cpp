@@ -0,0 +1,147 @@
+#include "ProtoVM.h"
+#include "FaultInjection.h"
+#include <iostream>
+#include <cassert>
+
+// Two constant outputs; the campaign sets its input lanes directly
+class TwoBitSource : public ElcBase {
+public:
+    byte value = 0;
+
+    TwoBitSource() {
+        AddSource("O0").SetMultiConn();
+        AddSource("O1").SetMultiConn();
+    }
+
+    String GetClassName() const override {return "TwoBitSource";}
+    bool Tick() override {return true;}
+    bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override {
+        if (type != WRITE)
+            return true;
+        return dest.PutRaw(dest_conn_id, &value, 0, 1);
+    }
+    bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override {return true;}
+};
+
+class ThreeBitSink : public ElcBase {
+public:
+    ThreeBitSink() {
+        AddSink("I0");
+        AddSink("I1");
+        AddSink("I2");
+    }
+
+    String GetClassName() const override {return "ThreeBitSink";}
+    bool Tick() override {return true;}
+    bool Process(ProcessType type, int bytes, int bits, uint16 conn_id, ElectricNodeBase& dest, uint16 dest_conn_id) override {return true;}
+    bool PutRaw(uint16 conn_id, byte* data, int data_bytes, int data_bits) override {return true;}
+};
+
+// src.O0 -> a -> {b, c}, and a NAND whose output feeds back into its I1, which
+// oscillates whenever its I0 is high
+static void buildCircuit(Machine& mach) {
+    Pcb& pcb = mach.AddPcb();
+    TwoBitSource& src = pcb.Add<TwoBitSource>("src");
+    ElcNot& a = pcb.Add<ElcNot>("a");
+    ElcNot& b = pcb.Add<ElcNot>("b");
+    ElcNot& c = pcb.Add<ElcNot>("c");
+    ElcNand& o = pcb.Add<ElcNand>("o");
+    ThreeBitSink& sink = pcb.Add<ThreeBitSink>("sink");
+    src["O0"] >> a["I"];
+    a["O"] >> b["I"];
+    a["O"] >> c["I"];
+    b["O"] >> sink["I0"];
+    c["O"] >> sink["I1"];
+    src["O1"] >> o["I0"];
+    o["O"] >> o["I1"];
+    o["O"] >> sink["I2"];
+    mach.use_packed_nets = true;
+}
+
+void testInputPinFaultStaysOnItsPin() {
+    std::cout << "Testing that an input pin fault does not force its driver's net..." << std::endl;
+
+    Machine mach;
+    buildCircuit(mach);
+    bool ok = mach.Init();
+    assert(ok);
+    const PackedNetlist& nl = mach.GetPackedNetlist();
+
+    int b_in = nl.FindNet("b", "I");
+    int a_out = nl.FindNet("a", "O");
+    assert(b_in >= 0 && a_out >= 0 && b_in != a_out);
+
+    LaneNetlist sim;
+    sim.Init(nl);
+    sim.SetLanes(nl.FindNet("a", "I"), 0);
+    sim.SetLanes(nl.FindNet("o", "I0"), 0);
+    sim.Force(b_in, 2, false);  // lane 1: b.I stuck at 0
+    ok = sim.Eval();
+    assert(ok);
+
+    // a is high in every lane; only b sees the fault, c still reads a
+    assert(sim.GetLanes(a_out) == ~(uint64)0);
+    assert(((sim.GetLanes(nl.FindNet("b", "O")) >> 1) & 1) == 1);
+    assert(((sim.GetLanes(nl.FindNet("b", "O")) >> 0) & 1) == 0);
+    assert(((sim.GetLanes(nl.FindNet("c", "O")) >> 1) & 1) == 0);
+
+    std::cout << "Input pin fault test passed." << std::endl;
+}
+
+void testOscillatingLaneIsUnknown() {
+    std::cout << "Testing stuck-at campaign with an oscillating fault lane..." << std::endl;
+
+    Machine mach;
+    buildCircuit(mach);
+    bool ok = mach.Init();
+    assert(ok);
+    const PackedNetlist& nl = mach.GetPackedNetlist();
+
+    FaultInjectionManager fim(&mach);
+    int f_b = fim.ScheduleStuckAtFault("b", "I", 0, 0);
+    int f_osc = fim.ScheduleStuckAtFault("o", "I0", 1, 0);
+    int f_none = fim.ScheduleStuckAtFault("o", "I0", 0, 0);
+
+    Vector<int> input_nets, output_nets;
+    input_nets << nl.FindNet("a", "I") << nl.FindNet("o", "I0");
+    output_nets << nl.FindNet("b", "O") << nl.FindNet("c", "O") << nl.FindNet("o", "O");
+
+    // o.I0 stays low, so the fault-free lane always settles
+    Vector<Vector<byte>> patterns;
+    patterns.Add() << (byte)0;
+    patterns.Add() << (byte)1;
+
+    int detected = fim.RunStuckAtCampaign(patterns, input_nets, output_nets);
+    assert(detected == 1);
+
+    const Vector<FaultInjectionResult>& results = fim.GetResults();
+    assert(results.GetCount() == 2);
+    bool seen_b = false, seen_osc = false;
+    for (const FaultInjectionResult& r : results) {
+        assert(r.fault_id != f_none);
+        if (r.fault_id == f_b) {
+            assert(r.caused_failure);
+            assert(r.tick_of_failure == 0);
+            seen_b = true;
+        }
+        if (r.fault_id == f_osc) {
+            assert(!r.caused_failure);
+            assert(r.failure_type == "Oscillating (unknown)");
+            seen_osc = true;
+        }
+    }
+    assert(seen_b && seen_osc);
+
+    std::cout << "Oscillating lane test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting Stuck-At Campaign Unit Tests..." << std::endl;
+
+    testInputPinFaultStaysOnItsPin();
+    testOscillatingLaneIsUnknown();
+
+    std::cout << "All Stuck-At Campaign Unit Tests Passed!" << std::endl;
+
+    return 0;
+}
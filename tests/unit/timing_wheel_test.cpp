@@ -0,0 +1,126 @@
+#include "ProtoVM.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+// Records (tick, id) for every action run by the wheel
+struct WheelLog {
+    std::vector<std::pair<int64, int>> entries;
+    int64 now = 0;
+};
+
+static void addAction(TimingWheel& wheel, WheelLog& log, int64 tick, int id) {
+    wheel.AddAction(tick, [&log, id]() {
+        log.entries.push_back(std::make_pair(log.now, id));
+        return true;
+    });
+}
+
+static void runUntil(TimingWheel& wheel, WheelLog& log, int64 last_tick) {
+    for (log.now = wheel.GetCursor() + 1; log.now <= last_tick; log.now++)
+        wheel.Run(log.now, [&](const DelayedEvent& e) { wheel.RunAction(e); });
+}
+
+void testOrderingInsideWindow() {
+    std::cout << "Testing TimingWheel ordering inside the slot window..." << std::endl;
+
+    TimingWheel wheel;
+    WheelLog log;
+    addAction(wheel, log, 5, 1);
+    addAction(wheel, log, 3, 2);
+    addAction(wheel, log, 5, 3);
+    addAction(wheel, log, TimingWheel::SLOTS - 1, 4);  // last tick of the window
+    assert(wheel.GetCount() == 4);
+
+    runUntil(wheel, log, TimingWheel::SLOTS);
+
+    assert(log.entries.size() == 4);
+    assert(log.entries[0] == std::make_pair((int64)3, 2));
+    // Same tick keeps scheduling order
+    assert(log.entries[1] == std::make_pair((int64)5, 1));
+    assert(log.entries[2] == std::make_pair((int64)5, 3));
+    assert(log.entries[3] == std::make_pair((int64)TimingWheel::SLOTS - 1, 4));
+    assert(wheel.IsEmpty());
+
+    std::cout << "TimingWheel window ordering test passed." << std::endl;
+}
+
+void testOverflowPromotion() {
+    std::cout << "Testing TimingWheel overflow promotion..." << std::endl;
+
+    TimingWheel wheel;
+    WheelLog log;
+    const int64 S = TimingWheel::SLOTS;
+    // First tick outside the window, a slot alias of tick 4 and a far event
+    addAction(wheel, log, S, 1);
+    addAction(wheel, log, S + 4, 2);
+    addAction(wheel, log, 4, 3);
+    addAction(wheel, log, 10 * S + 7, 4);
+    addAction(wheel, log, S, 5);
+
+    // Visit order matches execution order before anything runs
+    std::vector<int64> visited;
+    wheel.ForEach([&](int64 tick, const DelayedEvent&) { visited.push_back(tick); });
+    assert(visited.size() == 5);
+    for (size_t i = 1; i < visited.size(); i++)
+        assert(visited[i - 1] <= visited[i]);
+
+    runUntil(wheel, log, 10 * S + 10);
+
+    assert(log.entries.size() == 5);
+    assert(log.entries[0] == std::make_pair((int64)4, 3));
+    assert(log.entries[1] == std::make_pair(S, 1));
+    assert(log.entries[2] == std::make_pair(S, 5));
+    assert(log.entries[3] == std::make_pair(S + 4, 2));
+    assert(log.entries[4] == std::make_pair(10 * S + 7, 4));
+    assert(wheel.IsEmpty());
+
+    std::cout << "TimingWheel overflow test passed." << std::endl;
+}
+
+void testLateAndOverdueEvents() {
+    std::cout << "Testing TimingWheel events added while running..." << std::endl;
+
+    TimingWheel wheel;
+    WheelLog log;
+    addAction(wheel, log, 2, 1);
+    log.now = 1;
+    wheel.Run(1, [&](const DelayedEvent& e) { wheel.RunAction(e); });
+    log.now = 2;
+    wheel.Run(2, [&](const DelayedEvent& e) {
+        wheel.RunAction(e);
+        // Overdue while running: joins the current slot
+        if (log.entries.size() == 1)
+            addAction(wheel, log, 1, 2);
+    });
+    assert(log.entries.size() == 2);
+    assert(log.entries[1] == std::make_pair((int64)2, 2));
+
+    // Overdue outside of Run: next tick
+    addAction(wheel, log, 0, 3);
+    runUntil(wheel, log, 3);
+    assert(log.entries.size() == 3);
+    assert(log.entries[2] == std::make_pair((int64)3, 3));
+
+    // Skipping a long empty stretch lands exactly on the pending tick
+    addAction(wheel, log, 5000, 4);
+    log.now = 5000;
+    wheel.Run(5000, [&](const DelayedEvent& e) { wheel.RunAction(e); });
+    assert(log.entries.size() == 4);
+    assert(wheel.GetCursor() == 5000);
+    assert(wheel.IsEmpty());
+
+    std::cout << "TimingWheel late event test passed." << std::endl;
+}
+
+int main() {
+    std::cout << "Starting TimingWheel Unit Tests..." << std::endl;
+
+    testOrderingInsideWindow();
+    testOverflowPromotion();
+    testLateAndOverdueEvents();
+
+    std::cout << "All TimingWheel Unit Tests Passed!" << std::endl;
+
+    return 0;
+}